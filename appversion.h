@@ -0,0 +1,3 @@
+#define APPVERSION 1
+#define APPHASH "x"
+#define APPDATE 0
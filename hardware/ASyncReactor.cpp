@@ -0,0 +1,78 @@
+#include "stdafx.h"
+#include "ASyncReactor.h"
+#include "../main/Helper.h"
+#include "../main/Logger.h"
+
+ASyncReactor::ASyncReactor()
+{
+	mWork = std::make_shared<boost::asio::io_service::work>(mIos);
+	for (int ii = 0; ii < ASYNCREACTOR_THREADS; ii++)
+	{
+		mThreads.push_back(std::make_shared<std::thread>([this] { Do_Work(); }));
+		SetThreadName(mThreads.back()->native_handle(), ASYNCREACTOR_THREAD_NAME);
+	}
+}
+
+ASyncReactor::~ASyncReactor()
+{
+	mWork.reset();
+	mIos.stop();
+	for (auto &thread : mThreads)
+		thread->join();
+	mThreads.clear();
+}
+
+boost::asio::io_service &ASyncReactor::GetIoService()
+{
+	static ASyncReactor reactor;
+	return reactor.mIos;
+}
+
+void ASyncReactor::Do_Work()
+{
+	while (true)
+	{
+		try
+		{
+			mIos.run();
+			return;
+		}
+		catch (std::exception &e)
+		{
+			// one misbehaving driver must not take down the transport of all others
+			_log.Log(LOG_ERROR, "ASyncReactor: Exception in handler: %s", e.what());
+		}
+		catch (...)
+		{
+			_log.Log(LOG_ERROR, "ASyncReactor: Unknown exception in handler");
+		}
+	}
+}
+
+void ASyncStrand::op_start()
+{
+	std::lock_guard<std::mutex> l(mPendingMutex);
+	mPending++;
+}
+
+void ASyncStrand::op_done()
+{
+	std::lock_guard<std::mutex> l(mPendingMutex);
+	mPending--;
+	if (mPending == 0)
+		mPendingCond.notify_all();
+}
+
+int ASyncStrand::pending()
+{
+	std::lock_guard<std::mutex> l(mPendingMutex);
+	return mPending;
+}
+
+void ASyncStrand::wait_idle()
+{
+	if (mStrand.running_in_this_thread())
+		return;
+	std::unique_lock<std::mutex> lock(mPendingMutex);
+	mPendingCond.wait(lock, [this] { return mPending == 0; });
+}
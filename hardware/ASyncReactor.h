@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>		 // for condition_variable
+#include <mutex>			 // for mutex
+#include <thread>			 // for thread
+#include <vector>			 // for thread pool
+#include <boost/asio/io_service.hpp>	 // for io_service
+#include <boost/asio/strand.hpp>	 // for strand
+#include "../main/Noncopyable.h"
+
+#define ASYNCREACTOR_THREAD_NAME "ASyncReactor"
+#define ASYNCREACTOR_THREADS 2
+
+// A small pool of threads running a single io_service, shared by all ASyncTCP and
+// AsyncSerial instances instead of every connection or port running its own.
+class ASyncReactor : private domoticz::noncopyable
+{
+      public:
+	static boost::asio::io_service &GetIoService();
+
+      private:
+	ASyncReactor();
+	~ASyncReactor();
+
+	void Do_Work();
+
+	boost::asio::io_service mIos;
+	std::shared_ptr<boost::asio::io_service::work> mWork;
+	std::vector<std::shared_ptr<std::thread>> mThreads;
+};
+
+// Serializes the handlers of one ASyncReactor user and counts the ones still
+// outstanding, so the owner can wait for them before it goes away.
+class ASyncStrand : private domoticz::noncopyable
+{
+      public:
+	ASyncStrand()
+		: mIos(ASyncReactor::GetIoService())
+		, mStrand(mIos)
+	{
+	}
+
+	// Wrap a completion handler so it runs on the strand and is counted until it has run
+	template <typename Handler> auto wrap(Handler handler)
+	{
+		op_start();
+		return mStrand.wrap([this, handler](auto &&... args) mutable {
+			try
+			{
+				handler(std::forward<decltype(args)>(args)...);
+			}
+			catch (...)
+			{
+				op_done();
+				throw;
+			}
+			op_done();
+		});
+	}
+
+	template <typename Handler> void post(Handler handler)
+	{
+		mIos.post(wrap(handler));
+	}
+
+	// Post a handler that only runs once every other outstanding handler has run,
+	// for use from our own handlers where wait_idle() can not block
+	template <typename Handler> void post_when_idle(Handler handler)
+	{
+		post([this, handler]() mutable {
+			// we are still counted ourselves
+			if (pending() > 1)
+			{
+				post_when_idle(handler);
+				return;
+			}
+			handler();
+		});
+	}
+
+	bool running_in_this_thread() const
+	{
+		return mStrand.running_in_this_thread();
+	}
+
+	// Block until no wrapped handler is outstanding anymore. The async operations
+	// must have been cancelled first, otherwise this waits for them to complete.
+	// Returns at once when called from one of our own handlers.
+	void wait_idle();
+
+	boost::asio::io_service &get_io_service()
+	{
+		return mIos;
+	}
+
+      private:
+	void op_start();
+	void op_done();
+	int pending();
+
+	boost::asio::io_service &mIos;
+	boost::asio::io_service::strand mStrand;
+	std::mutex mPendingMutex;
+	std::condition_variable mPendingCond;
+	int mPending = 0;
+};
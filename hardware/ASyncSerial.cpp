@@ -26,6 +26,7 @@
  */
 #include "stdafx.h"
 #include "ASyncSerial.h"
+#include "ASyncReactor.h"
 #include "../main/Logger.h"
 #include "../main/Helper.h"
 
@@ -33,7 +34,6 @@
 #include <algorithm>
 #include <iostream>
 #include <boost/asio.hpp>
-#include <boost/thread.hpp>
 #include <boost/smart_ptr/shared_array.hpp>  // for shared_array
 #include <boost/system/error_code.hpp>       // for error_code
 #include <boost/system/system_error.hpp>     // for system_error
@@ -49,14 +49,15 @@ class AsyncSerialImpl
 {
 public:
   AsyncSerialImpl()
-	  : io()
-	  , port(io)
+	  : port(strand.get_io_service())
+	  , writeDelayTimer(strand.get_io_service())
   {
   }
 
-    boost::asio::io_service io; ///< Io service object
+    ASyncStrand strand; ///< Serializes our handlers on the shared ASyncReactor
     boost::asio::serial_port port; ///< Serial port object
-    boost::thread backgroundThread; ///< Thread that runs read/write operations
+    boost::asio::deadline_timer writeDelayTimer; ///< Pause after a write burst
+    bool writeDelay{ false };	    ///< True while writeDelayTimer is pending
     bool open{ false };		    ///< True if port open
     bool error{ false };	    ///< Error flag
     mutable std::mutex errorMutex; ///< Mutex for access to error
@@ -117,15 +118,10 @@ void AsyncSerial::open(const std::string& devname, unsigned int baud_rate,
 		throw;
 	}
 
-	pimpl->io.reset();
-
-	// This gives some work to the io_service before it is started
-	pimpl->io.post([this] { return doRead(); });
-
-	boost::thread t([p = &pimpl->io] { p->run(); });
-	pimpl->backgroundThread.swap(t);
 	setErrorStatus(false); // If we get here, no error
 	pimpl->open = true;    // Port is now open
+
+	pimpl->strand.post([this] { doRead(); });
 }
 
 void AsyncSerial::openOnlyBaud(const std::string& devname, unsigned int baud_rate,
@@ -149,15 +145,10 @@ void AsyncSerial::openOnlyBaud(const std::string& devname, unsigned int baud_rat
 		throw;
 	}
 
-	pimpl->io.reset();
-
-	//This gives some work to the io_service before it is started
-	pimpl->io.post([this] { return doRead(); });
-
-	boost::thread t([p = &pimpl->io] { p->run(); });
-	pimpl->backgroundThread.swap(t);
 	setErrorStatus(false);//If we get here, no error
 	pimpl->open=true; //Port is now open
+
+	pimpl->strand.post([this] { doRead(); });
 }
 
 bool AsyncSerial::isOpen() const
@@ -176,9 +167,8 @@ void AsyncSerial::close()
     if(!isOpen()) return;
 
     pimpl->open = false;
-    pimpl->io.post([this] { doClose(); });
-    pimpl->backgroundThread.join();
-    pimpl->io.reset();
+    pimpl->strand.post([this] { doClose(); });
+    pimpl->strand.wait_idle();
     if(errorStatus())
     {
         throw(boost::system::system_error(boost::system::error_code(),
@@ -192,7 +182,7 @@ void AsyncSerial::write(const char *data, size_t size)
         std::lock_guard<std::mutex> l(pimpl->writeQueueMutex);
         pimpl->writeQueue.insert(pimpl->writeQueue.end(),data,data+size);
     }
-    pimpl->io.post([this] { doWrite(); });
+    pimpl->strand.post([this] { doWrite(); });
 }
 
 void AsyncSerial::write(const std::string &data)
@@ -201,7 +191,7 @@ void AsyncSerial::write(const std::string &data)
 		std::lock_guard<std::mutex> l(pimpl->writeQueueMutex);
 		pimpl->writeQueue.insert(pimpl->writeQueue.end(), data.c_str(), data.c_str()+data.size());
 	}
-	pimpl->io.post([this] { doWrite(); });
+	pimpl->strand.post([this] { doWrite(); });
 }
 
 void AsyncSerial::write(const std::vector<char>& data)
@@ -211,7 +201,7 @@ void AsyncSerial::write(const std::vector<char>& data)
         pimpl->writeQueue.insert(pimpl->writeQueue.end(),data.begin(),
                 data.end());
     }
-    pimpl->io.post([this] { doWrite(); });
+    pimpl->strand.post([this] { doWrite(); });
 }
 
 void AsyncSerial::writeString(const std::string& s)
@@ -220,13 +210,13 @@ void AsyncSerial::writeString(const std::string& s)
         std::lock_guard<std::mutex> l(pimpl->writeQueueMutex);
         pimpl->writeQueue.insert(pimpl->writeQueue.end(),s.begin(),s.end());
     }
-    pimpl->io.post([this] { doWrite(); });
+    pimpl->strand.post([this] { doWrite(); });
 }
 
 void AsyncSerial::doRead()
 {
 	if(isOpen()==false) return;
-	pimpl->port.async_read_some(boost::asio::buffer(pimpl->readBuffer, sizeof(pimpl->readBuffer)), [this](auto &&err, auto bytes) { readEnd(err, bytes); });
+	pimpl->port.async_read_some(boost::asio::buffer(pimpl->readBuffer, sizeof(pimpl->readBuffer)), pimpl->strand.wrap([this](auto &&err, auto bytes) { readEnd(err, bytes); }));
 }
 
 void AsyncSerial::readEnd(const boost::system::error_code& error,
@@ -250,16 +240,20 @@ void AsyncSerial::readEnd(const boost::system::error_code& error,
 
 void AsyncSerial::doWrite()
 {
-    //If a write operation is already in progress, do nothing
-    if (pimpl->writeBuffer == nullptr)
+    if (isOpen() == false)
+	    return;
+    //If a write operation is already in progress, or we are in the pause after one, do nothing
+    if ((pimpl->writeBuffer == nullptr) && (!pimpl->writeDelay))
     {
 	    std::lock_guard<std::mutex> l(pimpl->writeQueueMutex);
+	    if (pimpl->writeQueue.empty())
+		    return;
 	    pimpl->writeBufferSize = pimpl->writeQueue.size();
 	    pimpl->writeBuffer.reset(new char[pimpl->writeQueue.size()]);
 
 	    copy(pimpl->writeQueue.begin(), pimpl->writeQueue.end(), pimpl->writeBuffer.get());
 	    pimpl->writeQueue.clear();
-	    async_write(pimpl->port, boost::asio::buffer(pimpl->writeBuffer.get(), pimpl->writeBufferSize), [this](auto &&err, auto) { writeEnd(err); });
+	    async_write(pimpl->port, boost::asio::buffer(pimpl->writeBuffer.get(), pimpl->writeBufferSize), pimpl->strand.wrap([this](auto &&err, auto) { writeEnd(err); }));
     }
 }
 
@@ -272,7 +266,13 @@ void AsyncSerial::writeEnd(const boost::system::error_code& error)
         {
             pimpl->writeBuffer.reset();
             pimpl->writeBufferSize=0;
-            sleep_milliseconds(75);
+            // Pause before the next write. A timer instead of a sleep, this thread is shared with other ports
+            pimpl->writeDelay = true;
+            pimpl->writeDelayTimer.expires_from_now(boost::posix_time::milliseconds(75));
+            pimpl->writeDelayTimer.async_wait(pimpl->strand.wrap([this](auto &&) {
+                pimpl->writeDelay = false;
+                doWrite();
+            }));
             return;
         }
         pimpl->writeBufferSize=pimpl->writeQueue.size();
@@ -280,7 +280,7 @@ void AsyncSerial::writeEnd(const boost::system::error_code& error)
         copy(pimpl->writeQueue.begin(),pimpl->writeQueue.end(),
                 pimpl->writeBuffer.get());
         pimpl->writeQueue.clear();
-	async_write(pimpl->port, boost::asio::buffer(pimpl->writeBuffer.get(), pimpl->writeBufferSize), [this](auto &&err, auto) { writeEnd(err); });
+	async_write(pimpl->port, boost::asio::buffer(pimpl->writeBuffer.get(), pimpl->writeBufferSize), pimpl->strand.wrap([this](auto &&err, auto) { writeEnd(err); }));
     } else {
 		try
 		{
@@ -297,6 +297,7 @@ void AsyncSerial::writeEnd(const boost::system::error_code& error)
 void AsyncSerial::doClose()
 {
     boost::system::error_code ec;
+    pimpl->writeDelayTimer.cancel(ec);
     pimpl->port.cancel(ec);
     if(ec) setErrorStatus(true);
     pimpl->port.close(ec);
@@ -339,5 +340,7 @@ void AsyncSerial::terminate(bool silent/*=true*/) {
 			}
 		}
 	}
+	// handlers still queued on the shared reactor reference this instance
+	pimpl->strand.wait_idle();
 }
 
@@ -123,27 +123,27 @@ class AsyncSerial : private domoticz::noncopyable
 
 	/**
 	 * Callback called to start an asynchronous read operation.
-	 * This callback is called by the io_service in the spawned thread.
+	 * This callback is called on the shared ASyncReactor, serialized by our strand.
 	 */
 	void doRead();
 
 	/**
 	 * Callback called at the end of the asynchronous operation.
-	 * This callback is called by the io_service in the spawned thread.
+	 * This callback is called on the shared ASyncReactor, serialized by our strand.
 	 */
 	void readEnd(const boost::system::error_code &error, size_t bytes_transferred);
 
 	/**
 	 * Callback called to start an asynchronous write operation.
 	 * If it is already in progress, does nothing.
-	 * This callback is called by the io_service in the spawned thread.
+	 * This callback is called on the shared ASyncReactor, serialized by our strand.
 	 */
 	void doWrite();
 
 	/**
 	 * Callback called at the end of an asynchronuous write operation,
 	 * if there is more data to write, restarts a new write operation.
-	 * This callback is called by the io_service in the spawned thread.
+	 * This callback is called on the shared ASyncReactor, serialized by our strand.
 	 */
 	void writeEnd(const boost::system::error_code &error);
 
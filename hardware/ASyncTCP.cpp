@@ -28,19 +28,15 @@ ASyncTCP::ASyncTCP(const bool secure)
 
 ASyncTCP::~ASyncTCP()
 {
-	assert(mTcpthread == nullptr);
-	mIsTerminating = true;
-	if (mTcpthread)
+	assert(!mIsActive);
+	if (mIsActive)
 	{
 		//This should never happen. terminate() never called!!
-		_log.Log(LOG_ERROR, "ASyncTCP: Workerthread not closed. terminate() never called!!!");
-		mIos.stop();
-		if (mTcpthread)
-		{
-			mTcpthread->join();
-			mTcpthread.reset();
-		}
+		_log.Log(LOG_ERROR, "ASyncTCP: Connection not closed. terminate() never called!!!");
+		terminate();
 	}
+	// handlers still queued on the shared reactor reference this instance
+	mStrand.wait_idle();
 }
 
 void ASyncTCP::SetReconnectDelay(int32_t Delay)
@@ -57,19 +53,14 @@ void ASyncTCP::connect(const std::string& ip, uint16_t port)
 		terminate();
 	}
 
-	// RK: We reset mIos here because it might have been stopped in terminate()
-	mIos.reset();
-	// RK: After the reset, we need to provide it work anew
-	mTcpwork = std::make_shared<boost::asio::io_service::work>(mIos);
-	if (!mTcpthread)
-		mTcpthread = std::make_shared<std::thread>([p = &mIos] { p->run(); });
+	mIsActive = true;
 
 	mIp = ip;
 	mPort = port;
 	std::string port_str = std::to_string(port);
 	boost::asio::ip::tcp::resolver::query query(ip, port_str);
 	timeout_start_timer();
-	mResolver.async_resolve(query, [this](auto &&err, auto &&iter) { cb_resolve_done(err, iter); });
+	mResolver.async_resolve(query, mStrand.wrap([this](auto &&err, auto &&iter) { cb_resolve_done(err, iter); }));
 }
 
 void ASyncTCP::cb_resolve_done(const boost::system::error_code& error, boost::asio::ip::tcp::resolver::iterator endpoint_iterator)
@@ -98,12 +89,12 @@ void ASyncTCP::connect_start(boost::asio::ip::tcp::resolver::iterator& endpoint_
 	{
 		// we reset the ssl socket, because the ssl context needs to be reinitialized after a reconnect
 		mSslSocket.reset(new boost::asio::ssl::stream<boost::asio::ip::tcp::socket>(mIos, mContext));
-		mSslSocket->lowest_layer().async_connect(mEndPoint, [this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); });
+		mSslSocket->lowest_layer().async_connect(mEndPoint, mStrand.wrap([this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); }));
 	}
 	else
 #endif
 	{
-		mSocket.async_connect(mEndPoint, [this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); });
+		mSocket.async_connect(mEndPoint, mStrand.wrap([this, endpoint_iterator](auto &&err) mutable { cb_connect_done(err, endpoint_iterator); }));
 	}
 }
 
@@ -117,7 +108,7 @@ void ASyncTCP::cb_connect_done(const boost::system::error_code& error, boost::as
 		if (mSecure) 
 		{
 			timeout_start_timer();
-			mSslSocket->async_handshake(boost::asio::ssl::stream_base::client, [this](auto &&err) { cb_handshake_done(err); });
+			mSslSocket->async_handshake(boost::asio::ssl::stream_base::client, mStrand.wrap([this](auto &&err) { cb_handshake_done(err); }));
 		}
 		else
 #endif
@@ -156,13 +147,14 @@ void ASyncTCP::cb_handshake_done(const boost::system::error_code& error)
 void ASyncTCP::reconnect_start_timer()
 {
 	if (mIsReconnecting) return;
+	if (mIsTerminating) return;
 
 	if (mReconnectDelay != 0)
 	{
 		mIsReconnecting = true;
 
 		mReconnectTimer.expires_from_now(boost::posix_time::seconds(mReconnectDelay));
-		mReconnectTimer.async_wait([this](auto &&err) { cb_reconnect_start(err); });
+		mReconnectTimer.async_wait(mStrand.wrap([this](auto &&err) { cb_reconnect_start(err); }));
 	}
 }
 
@@ -184,13 +176,23 @@ void ASyncTCP::terminate(const bool silent)
 {
 	mIsTerminating = true;
 	disconnect(silent);
-	mTcpwork.reset();
-	mIos.stop();
-	if (mTcpthread)
+	mIsActive = false;
+	if (mStrand.running_in_this_thread())
 	{
-		mTcpthread->join();
-		mTcpthread.reset();
+		// called from one of our own handlers, wait_idle() would return at once. Keep
+		// mIsTerminating set until the posted do_close and the cancelled operations have run,
+		// so none of them starts a reconnect
+		mStrand.post_when_idle([this] { terminated(); });
+		return;
 	}
+	// the reactor keeps running for the other connections, so instead of stopping it
+	// wait until the cancelled operations of this one have completed
+	mStrand.wait_idle();
+	terminated();
+}
+
+void ASyncTCP::terminated()
+{
 	mIsReconnecting = false;
 	mIsConnected = false;
 	mWriteQ.clear();
@@ -199,13 +201,15 @@ void ASyncTCP::terminate(const bool silent)
 
 void ASyncTCP::disconnect(const bool silent)
 {
-	mReconnectTimer.cancel();
-	mTimeoutTimer.cancel();
-	if (!mTcpthread) return;
+	if (!mIsActive) return;
 
 	try
 	{
-		mIos.post([this] { do_close(); });
+		mStrand.post([this] {
+			mReconnectTimer.cancel();
+			mTimeoutTimer.cancel();
+			do_close();
+		});
 	}
 	catch (...)
 	{
@@ -223,6 +227,7 @@ void ASyncTCP::do_close()
 	}
 	mReconnectTimer.cancel();
 	mTimeoutTimer.cancel();
+	mResolver.cancel();
 	boost::system::error_code ec;
 #ifdef WWW_ENABLE_SSL
 	if (mSecure)
@@ -252,12 +257,12 @@ void ASyncTCP::do_read_start()
 #ifdef WWW_ENABLE_SSL
 	if (mSecure)
 	{
-		mSslSocket->async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), [this](auto &&err, auto bytes) { cb_read_done(err, bytes); });
+		mSslSocket->async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), mStrand.wrap([this](auto &&err, auto bytes) { cb_read_done(err, bytes); }));
 	}
 	else
 #endif
 	{
-		mSocket.async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), [this](auto &&err, auto bytes) { cb_read_done(err, bytes); });
+		mSocket.async_read_some(boost::asio::buffer(mRxBuffer, sizeof(mRxBuffer)), mStrand.wrap([this](auto &&err, auto bytes) { cb_read_done(err, bytes); }));
 	}
 }
 
@@ -283,9 +288,9 @@ void ASyncTCP::write(const uint8_t* pData, size_t length)
 
 void ASyncTCP::write(const std::string& msg)
 {
-	if (!mTcpthread) return;
+	if (!mIsActive) return;
 
-	mSendStrand.post([this, msg]() { cb_write_queue(msg); });
+	mStrand.post([this, msg]() { cb_write_queue(msg); });
 }
 
 void ASyncTCP::cb_write_queue(const std::string& msg)
@@ -307,12 +312,12 @@ void ASyncTCP::do_write_start()
 #ifdef WWW_ENABLE_SSL
 	if (mSecure) 
 	{
-		boost::asio::async_write(*mSslSocket, boost::asio::buffer(mWriteQ.front()), [this](auto &&err, auto) { cb_write_done(err); });
+		boost::asio::async_write(*mSslSocket, boost::asio::buffer(mWriteQ.front()), mStrand.wrap([this](auto &&err, auto) { cb_write_done(err); }));
 	}
 	else
 #endif
 	{
-		boost::asio::async_write(mSocket, boost::asio::buffer(mWriteQ.front()), [this](auto &&err, auto) { cb_write_done(err); });
+		boost::asio::async_write(mSocket, boost::asio::buffer(mWriteQ.front()), mStrand.wrap([this](auto &&err, auto) { cb_write_done(err); }));
 	}
 }
 
@@ -372,7 +377,7 @@ void ASyncTCP::timeout_start_timer()
 	}
 	timeout_cancel_timer();
 	mTimeoutTimer.expires_from_now(boost::posix_time::seconds(mTimeoutDelay));
-	mTimeoutTimer.async_wait([this](auto &&err) { timeout_handler(err); });
+	mTimeoutTimer.async_wait(mStrand.wrap([this](auto &&err) { timeout_handler(err); }));
 }
 
 void ASyncTCP::timeout_cancel_timer()
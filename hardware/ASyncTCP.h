@@ -8,9 +8,10 @@
 #include <boost/asio/ip/tcp.hpp>	 // for tcp, tcp::endpoint, tcp::s...
 #include <boost/asio/ssl.hpp>		 // for secure sockets
 #include <boost/asio/ssl/stream.hpp>	 // for secure sockets
+#include <atomic>			 // for atomic
 #include <exception>			  // for exception
+#include "ASyncReactor.h"
 
-#define ASYNCTCP_THREAD_NAME "ASyncTCP"
 #define DEFAULT_RECONNECT_TIME 30
 #define DEFAULT_TIMEOUT_TIME 60
 
@@ -46,7 +47,9 @@ class ASyncTCP
 	virtual void OnData(const uint8_t *pData, size_t length) = 0;
 	virtual void OnError(const boost::system::error_code &error) = 0;
 
-	boost::asio::io_service mIos; // protected to allow derived classes to attach timers etc.
+	// Handlers of all instances run on the shared ASyncReactor, serialized per instance by mStrand
+	ASyncStrand mStrand;
+	boost::asio::io_service &mIos{ mStrand.get_io_service() }; // protected to allow derived classes to attach timers etc. (wrap their handlers with mStrand)
 
       private:
 	void cb_resolve_done(const boost::system::error_code &err, boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
@@ -65,6 +68,7 @@ class ASyncTCP
 	void cb_reconnect_start(const boost::system::error_code &error);
 
 	void do_close();
+	void terminated();
 
 	void do_read_start();
 	void cb_read_done(const boost::system::error_code &error, size_t bytes_transferred);
@@ -78,9 +82,9 @@ class ASyncTCP
 
 	bool mIsConnected = false;
 	bool mIsReconnecting = false;
-	bool mIsTerminating = false;
+	std::atomic<bool> mIsTerminating{ false };
+	std::atomic<bool> mIsActive{ false };
 
-	boost::asio::io_service::strand mSendStrand{ mIos };
 	std::deque<std::string> mWriteQ; // we need a write queue to allow concurrent writes
 
 	uint8_t mRxBuffer[1024];
@@ -90,9 +94,6 @@ class ASyncTCP
 	boost::asio::deadline_timer mReconnectTimer{ mIos };
 	boost::asio::deadline_timer mTimeoutTimer{ mIos };
 
-	std::shared_ptr<std::thread> mTcpthread;
-	std::shared_ptr<boost::asio::io_service::work> mTcpwork;
-
 #ifdef WWW_ENABLE_SSL
 	const bool mSecure;
 	boost::asio::ssl::context mContext{ boost::asio::ssl::context::sslv23 };
@@ -62,51 +62,33 @@ void CAccuWeather::Init()
 
 bool CAccuWeather::StartHardware()
 {
-	RequestStart();
-
 	Init();
 
-	//Start worker thread
-	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
-	SetThreadNameInt(m_thread->native_handle());
+	ScheduleHeartbeat();
+	SchedulePoll(1800, 1205, [this] { Do_Poll(); }); //50 free calls a day.. thats not much guy's!
 	m_bIsStarted=true;
 	sOnConnected(this);
-	return (m_thread != nullptr);
+	return true;
 }
 
 bool CAccuWeather::StopHardware()
 {
-	if (m_thread)
-	{
-		RequestStop();
-		m_thread->join();
-		m_thread.reset();
-	}
-    m_bIsStarted=false;
-    return true;
+	StopScheduledTasks();
+	if (m_bIsStarted)
+		Log(LOG_STATUS, "Worker stopped...");
+	m_bIsStarted=false;
+	return true;
 }
 
-void CAccuWeather::Do_Work()
+void CAccuWeather::Do_Poll()
 {
-	int sec_counter = 595;
-	while (!IsStopRequested(1000))
+	if (m_LocationKey.empty())
 	{
-		sec_counter++;
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat = mytime(nullptr);
-		}
-		if (sec_counter % 1800 == 0) //50 free calls a day.. thats not much guy's!
-		{
-			if (m_LocationKey.empty())
-			{
-				m_LocationKey = GetLocationKey();
-				if (m_LocationKey.empty())
-					continue;
-			}
-			GetMeterDetails();
-		}
+		m_LocationKey = GetLocationKey();
+		if (m_LocationKey.empty())
+			return;
 	}
-	Log(LOG_STATUS,"Worker stopped...");
+	GetMeterDetails();
 }
 
 bool CAccuWeather::WriteToHardware(const char* /*pdata*/, const unsigned char /*length*/)
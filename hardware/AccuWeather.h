@@ -14,7 +14,7 @@ class CAccuWeather : public CDomoticzHardwareBase
 	void Init();
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
+	void Do_Poll();
 	void GetMeterDetails();
 	std::string GetLocationKey();
 
@@ -23,5 +23,4 @@ class CAccuWeather : public CDomoticzHardwareBase
 	std::string m_Location;
 	std::string m_LocationKey;
 	std::string m_ForecastURL;
-	std::shared_ptr<std::thread> m_thread;
 };
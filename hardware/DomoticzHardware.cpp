@@ -128,6 +128,26 @@ void CDomoticzHardwareBase::HandleHBCounter(const int iInterval)
 	}
 }
 
+void CDomoticzHardwareBase::SchedulePoll(const int iIntervalSec, const int iFirstDelaySec, const std::function<void()> &func)
+{
+	CHardwareScheduler::Get().Add(this, iIntervalSec * 1000, iFirstDelaySec * 1000, func, &m_SchedulerStats);
+}
+
+void CDomoticzHardwareBase::ScheduleOnce(const int iDelayMs, const std::function<void()> &func)
+{
+	CHardwareScheduler::Get().Add(this, 0, iDelayMs, func, &m_SchedulerStats);
+}
+
+void CDomoticzHardwareBase::ScheduleHeartbeat()
+{
+	SchedulePoll(12, 0, [this] { mytime(&m_LastHeartbeat); });
+}
+
+void CDomoticzHardwareBase::StopScheduledTasks()
+{
+	CHardwareScheduler::Get().Remove(this);
+}
+
 int CDomoticzHardwareBase::SetThreadNameInt(const std::thread::native_handle_type& thread)
 {
 	return SetThreadName(thread, m_Name.c_str());
@@ -366,14 +386,11 @@ std::string CDomoticzHardwareBase::GetTextSensorText(const int NodeID, const int
 	std::string sTmp = std_format("%08X", (NodeID << 8) | ChildID);
 
 	std::string ret;
-	std::vector<std::vector<std::string>> result;
-
-	result = m_sql.safe_query("SELECT sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) AND (Subtype==%d)", m_HwdID, sTmp.c_str(), int(pTypeGeneral),
-				  int(sTypeTextStatus));
-	if (!result.empty())
+	_tDeviceIndexEntry device;
+	if (GetDevice(sTmp, 1, pTypeGeneral, sTypeTextStatus, device))
 	{
 		bExists = true;
-		ret = result[0][0];
+		ret = device.sValue;
 	}
 	return ret;
 }
@@ -464,15 +481,14 @@ float CDomoticzHardwareBase::GetRainSensorValue(const int NodeID, bool& bExists)
 	std::string sIdx = std_format("%d", NodeID & 0xFFFF);
 	int Unit = 0;
 
-	std::vector<std::vector<std::string> > results;
-	results = m_sql.safe_query("SELECT ID,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Unit == %d) AND (Type==%d) AND (Subtype==%d)", m_HwdID, sIdx.c_str(), Unit, int(pTypeRAIN), int(sTypeRAIN3));
-	if (results.empty())
+	_tDeviceIndexEntry device;
+	if (!GetDevice(sIdx, Unit, pTypeRAIN, sTypeRAIN3, device))
 	{
 		bExists = false;
 		return 0.0F;
 	}
 	std::vector<std::string> splitresults;
-	StringSplit(results[0][1], ";", splitresults);
+	StringSplit(device.sValue, ";", splitresults);
 	if (splitresults.size() != 2)
 	{
 		bExists = false;
@@ -487,20 +503,14 @@ bool CDomoticzHardwareBase::GetWindSensorValue(const int NodeID, int& WindDir, f
 	std::string sIdx = std_format("%d", NodeID & 0xFFFF);
 	int Unit = 0;
 
-	std::vector<std::vector<std::string> > results;
-	if (!bHaveWindTemp)
-		results = m_sql.safe_query("SELECT ID,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Unit == %d) AND (Type==%d) AND (Subtype==%d)", m_HwdID, sIdx.c_str(), Unit,
-					   int(pTypeWIND), int(sTypeWINDNoTemp));
-	else
-		results = m_sql.safe_query("SELECT ID,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Unit == %d) AND (Type==%d) AND (Subtype==%d)", m_HwdID, sIdx.c_str(), Unit,
-					   int(pTypeWIND), int(sTypeWIND4));
-	if (results.empty())
+	_tDeviceIndexEntry device;
+	if (!GetDevice(sIdx, Unit, pTypeWIND, (bHaveWindTemp) ? sTypeWIND4 : sTypeWINDNoTemp, device))
 	{
 		bExists = false;
 		return 0.0F;
 	}
 	std::vector<std::string> splitresults;
-	StringSplit(results[0][1], ";", splitresults);
+	StringSplit(device.sValue, ";", splitresults);
 
 	if (splitresults.size() != 6)
 	{
@@ -565,15 +575,14 @@ double CDomoticzHardwareBase::GetKwhMeter(const int NodeID, const int ChildID, b
 	int dID = (NodeID << 8) | ChildID;
 	std::string sTmp = std_format("%08X", dID);
 
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) AND (Subtype==%d)", m_HwdID, sTmp.c_str(), int(pTypeGeneral), int(sTypeKwh));
-	if (result.empty())
+	_tDeviceIndexEntry device;
+	if (!GetDevice(sTmp, 1, pTypeGeneral, sTypeKwh, device))
 	{
 		bExists = false;
 		return 0;
 	}
 	std::vector<std::string> splitresults;
-	StringSplit(result[0][0], ";", splitresults);
+	StringSplit(device.sValue, ";", splitresults);
 	if (splitresults.size() != 2)
 	{
 		bExists = false;
@@ -638,10 +647,8 @@ void CDomoticzHardwareBase::SendSwitchIfNotExists(const int NodeID, const uint8_
 
 	std::string sIdx = std_format("%X%02X%02X%02X", ID1, ID2, ID3, ID4);
 
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT Name,nValue,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Unit == %d) AND (Type==%d) AND (Subtype==%d)", m_HwdID, sIdx.c_str(), ChildID,
-				  int(pTypeLighting2), int(sTypeAC));
-	if (result.empty())
+	_tDeviceIndexEntry device;
+	if (!GetDevice(sIdx, ChildID, pTypeLighting2, sTypeAC, device))
 	{
 		SendSwitch(NodeID, ChildID, BatteryLevel, bOn, Level, defaultname, userName);
 	}
@@ -701,19 +708,17 @@ void CDomoticzHardwareBase::SendSwitch(const int NodeID, const uint8_t ChildID,
 	unsigned char ID4 = (unsigned char)NodeID & 0xFF;
 
 	std::string sIdx = std_format("%X%02X%02X%02X", ID1, ID2, ID3, ID4);
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT Name,nValue,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Unit == %d) AND (Type==%d) AND (Subtype==%d)", m_HwdID, sIdx.c_str(), ChildID,
-				  int(pTypeLighting2), int(sTypeAC));
-	if (!result.empty())
+	_tDeviceIndexEntry device;
+	if (GetDevice(sIdx, ChildID, pTypeLighting2, sTypeAC, device))
 	{
 		//check if we have a change, if not do not update it
-		int nvalue = atoi(result[0][1].c_str());
+		int nvalue = device.nValue;
 		if ((!bOn) && (nvalue == light2_sOff))
 			return;
 		if ((bOn && (nvalue != light2_sOff)))
 		{
 			//Check Level
-			int slevel = atoi(result[0][2].c_str());
+			int slevel = atoi(device.sValue.c_str());
 			if (slevel == level)
 				return;
 		}
@@ -1101,9 +1106,8 @@ void CDomoticzHardwareBase::SendSelectorSwitch(const int NodeID, const uint8_t C
 	_eSwitchType switchtype;
 	switchtype = STYPE_Selector;
 
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT ID, sValue, Options FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%08X') AND (Unit == '%d')", m_HwdID, NodeID, xcmd.unitcode);
-	bool bDoesExists = !result.empty();
+	_tDeviceIndexEntry device;
+	bool bDoesExists = GetDevice(std_format("%08X", NodeID), xcmd.unitcode, pTypeGeneralSwitch, sSwitchTypeSelector, device);
     
 	m_mainworker.PushAndWaitRxMessage(this, (const unsigned char *)&xcmd,  defaultname.c_str(), 255, userName.c_str());  // will create the base switch if not exist
 
@@ -1128,9 +1132,9 @@ void CDomoticzHardwareBase::SendSelectorSwitch(const int NodeID, const uint8_t C
 	else
 	{ 
 		//Check Level (sValue in SQL Query)
-		if (xcmd.level == std::stoi(result[0][1]))
+		if (xcmd.level == std::stoi(device.sValue))
 			return; // no need to uodate
-		result = m_sql.safe_query("UPDATE DeviceStatus SET sValue=%i WHERE (HardwareID==%d) AND (DeviceID=='%08X')", xcmd.level, m_HwdID, NodeID);
+		m_sql.safe_query("UPDATE DeviceStatus SET sValue=%i WHERE (HardwareID==%d) AND (DeviceID=='%08X')", xcmd.level, m_HwdID, NodeID);
 	}
 }
                             
@@ -1248,6 +1252,62 @@ void CDomoticzHardwareBase::CreateBlindSwitch(int NodeID, uint8_t ChildID, _eSwi
 	m_sql.safe_query("UPDATE DeviceStatus SET Name='%q', SwitchType=%d, Used=%d, Options='%q' WHERE (HardwareID == %d) AND (DeviceID=='%08X') AND (Unit == '%d')", defaultName.c_str(), switchtype, (bDeviceUsed ? 1 : 0), options_str.c_str(), m_HwdID, NodeID, ChildID);
 }
 
+bool CDomoticzHardwareBase::GetDevice(const std::string &DeviceID, const uint8_t Unit, const uint8_t Type, const uint8_t SubType, _tDeviceIndexEntry &device)
+{
+	return m_sql.GetDeviceIndexEntry(m_HwdID, DeviceID, Unit, Type, SubType, device);
+}
+
+void CDomoticzHardwareBase::BeginRxBatch()
+{
+	std::lock_guard<std::mutex> l(m_rxbatch_mutex);
+	m_rxbatch_thread = std::this_thread::get_id();
+	m_rxbatch.clear();
+}
+
+void CDomoticzHardwareBase::EndRxBatch()
+{
+	std::vector<_tRxBatchItem> batch;
+	{
+		std::lock_guard<std::mutex> l(m_rxbatch_mutex);
+		if (m_rxbatch_thread != std::this_thread::get_id())
+			return; //no batch started on this thread
+		m_rxbatch_thread = std::thread::id();
+		batch.swap(m_rxbatch);
+	}
+	m_mainworker.PushRxMessageBatch(this, batch);
+}
+
+//Hands what was collected so far to MainWorker and keeps the batch open, used before a message
+//that bypasses the batch so it is not processed ahead of the ones sent before it
+void CDomoticzHardwareBase::FlushRxBatch()
+{
+	std::vector<_tRxBatchItem> batch;
+	{
+		std::lock_guard<std::mutex> l(m_rxbatch_mutex);
+		if (m_rxbatch_thread != std::this_thread::get_id())
+			return;
+		batch.swap(m_rxbatch);
+	}
+	m_mainworker.PushRxMessageBatch(this, batch);
+}
+
+//Called by MainWorker for every received message, returns true when it is part of a batch
+bool CDomoticzHardwareBase::CollectRxBatchItem(const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel, const char *userName)
+{
+	std::lock_guard<std::mutex> l(m_rxbatch_mutex);
+	if (m_rxbatch_thread != std::this_thread::get_id())
+		return false;
+	_tRxBatchItem item;
+	item.RXCommand.assign(pRXCommand, pRXCommand + pRXCommand[0] + 1);
+	if (defaultName != nullptr)
+		item.Name = defaultName;
+	item.BatteryLevel = BatteryLevel;
+	if (userName != nullptr)
+		item.UserName = userName;
+	m_rxbatch.push_back(std::move(item));
+	return true;
+}
+
 /**
  * SendBlindSwitch
  *
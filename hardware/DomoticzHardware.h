@@ -5,6 +5,7 @@
 
 #include "../main/RFXNames.h"
 #include "../main/StoppableTask.h"
+#include "HardwareScheduler.h"
 // type support
 #include <cereal/types/string.hpp>
 #include <cereal/types/memory.hpp>
@@ -13,6 +14,16 @@
 
 enum _eLogLevel : uint32_t;
 enum _eDebugLevel : uint32_t;
+struct _tDeviceIndexEntry;
+
+// A device update collected between BeginRxBatch and EndRxBatch
+struct _tRxBatchItem
+{
+	std::vector<uint8_t> RXCommand;
+	std::string Name;
+	int BatteryLevel;
+	std::string UserName;
+};
 
 // Base class with functions all notification systems should have
 class CDomoticzHardwareBase : public StoppableTask
@@ -74,6 +85,9 @@ class CDomoticzHardwareBase : public StoppableTask
 #endif
 		;
 	uint32_t m_LogLevelEnabled = 7; //bitwise _eLogLevel 7 = LOG_NORM | LOG_STATUS | LOG_ERROR
+
+	// Runs and CPU time of the tasks this hardware ran on the shared scheduler
+	CHardwareScheduler::_tStats m_SchedulerStats;
       protected:
 	virtual bool StartHardware() = 0;
 	virtual bool StopHardware() = 0;
@@ -84,6 +98,14 @@ class CDomoticzHardwareBase : public StoppableTask
 	void StopHeartbeatThread();
 	void HandleHBCounter(int iInterval);
 
+	// Periodic polls and one-shot continuations on the shared hardware scheduler, for drivers
+	// that do not need a thread of their own. Our tasks never run concurrently with each other.
+	// StopScheduledTasks() must be called from StopHardware, it waits for a task that is still running.
+	void SchedulePoll(int iIntervalSec, int iFirstDelaySec, const std::function<void()> &func);
+	void ScheduleOnce(int iDelayMs, const std::function<void()> &func);
+	void ScheduleHeartbeat();
+	void StopScheduledTasks();
+
 	// Sensor Helpers
 	void SendTempSensor(int NodeID, int BatteryLevel, float temperature, const std::string &defaultname, int RssiLevel = 12);
 	void SendHumiditySensor(int NodeID, int BatteryLevel, int humidity, const std::string &defaultname, int RssiLevel = 12);
@@ -138,11 +160,26 @@ class CDomoticzHardwareBase : public StoppableTask
 	void CreateBlindSwitch(int NodeID, uint8_t ChildID, _eSwitchType switchtype, bool bDeviceUsed, bool bReversePosition, bool bReverseState, uint8_t cmnd, uint8_t level, const std::string &defaultName, const std::string &userName, int32_t batteryLevel, uint8_t rssiLevel = 12);
 	void SendBlindSwitch(int NodeID, uint8_t ChildID, uint8_t cmnd, uint8_t level, const std::string &defaultName, const std::string &userName, int32_t batteryLevel, uint8_t rssiLevel = 12);
 
+	// Device updates sent from this thread between these calls (sDecodeRXMessage and the Send* helpers)
+	// are handed to MainWorker as one batch: one transaction and one coalesced UI update.
+	// Helpers that wait for their message to be processed (PushAndWaitRxMessage) flush the batch first.
+	void BeginRxBatch();
+	void EndRxBatch();
+
+	// Looks up one of our own devices, known devices are served from the shared device index without a query
+	bool GetDevice(const std::string &DeviceID, uint8_t Unit, uint8_t Type, uint8_t SubType, _tDeviceIndexEntry &device);
+
 	int m_iHBCounter = { 0 };
 	bool m_bIsStarted = { false };
 
       private:
 	void Do_Heartbeat_Work();
+	bool CollectRxBatchItem(const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName);
+	void FlushRxBatch();
+
+	std::mutex m_rxbatch_mutex;
+	std::thread::id m_rxbatch_thread;
+	std::vector<_tRxBatchItem> m_rxbatch;
 
 	volatile bool m_stopHeartbeatrequested = { false };
 	std::shared_ptr<std::thread> m_Heartbeatthread = { nullptr };
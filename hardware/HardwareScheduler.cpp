@@ -0,0 +1,133 @@
+#include "stdafx.h"
+#include "HardwareScheduler.h"
+#include "../main/Helper.h"
+#include "../main/Logger.h"
+
+CHardwareScheduler::CHardwareScheduler()
+{
+	for (int ii = 0; ii < HWSCHEDULER_WORKERS; ii++)
+	{
+		m_workers.push_back(std::make_shared<std::thread>([this] { Do_Work(); }));
+		SetThreadName(m_workers.back()->native_handle(), HWSCHEDULER_THREAD_NAME);
+	}
+}
+
+CHardwareScheduler::~CHardwareScheduler()
+{
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		m_bStop = true;
+	}
+	m_cond.notify_all();
+	for (auto &worker : m_workers)
+		worker->join();
+	m_workers.clear();
+}
+
+CHardwareScheduler &CHardwareScheduler::Get()
+{
+	static CHardwareScheduler scheduler;
+	return scheduler;
+}
+
+void CHardwareScheduler::Add(const void *owner, const int iIntervalMs, const int iFirstDelayMs, const std::function<void()> &func, _tStats *pStats)
+{
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		if (m_stopping.find(owner) != m_stopping.end())
+			return; // added by the task that is running while its owner is being removed
+		_tTask task;
+		task.id = ++m_next_id;
+		task.owner = owner;
+		task.due = std::chrono::steady_clock::now() + std::chrono::milliseconds(iFirstDelayMs);
+		task.interval = std::chrono::milliseconds(iIntervalMs);
+		task.func = func;
+		task.pStats = pStats;
+		m_tasks.push_back(task);
+	}
+	m_cond.notify_all();
+}
+
+void CHardwareScheduler::Remove(const void *owner)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_tasks.remove_if([owner](const _tTask &task) { return task.owner == owner; });
+	m_cond.notify_all();
+	if (m_busy.find(owner) == m_busy.end())
+		return;
+
+	m_stopping.insert(owner);
+	auto itt = m_running.find(std::this_thread::get_id());
+	if ((itt != m_running.end()) && (itt->second == owner))
+		return; // called from one of its own tasks, Do_Work ends the stopping state when it returns
+	m_cond.wait(lock, [this, owner] { return m_busy.find(owner) == m_busy.end(); });
+	m_stopping.erase(owner);
+}
+
+void CHardwareScheduler::Do_Work()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_bStop)
+	{
+		// the earliest due task of an owner that is not running one already
+		auto next = m_tasks.end();
+		for (auto itt = m_tasks.begin(); itt != m_tasks.end(); ++itt)
+		{
+			if (m_busy.find(itt->owner) != m_busy.end())
+				continue;
+			if ((next == m_tasks.end()) || (itt->due < next->due))
+				next = itt;
+		}
+		if (next == m_tasks.end())
+		{
+			m_cond.wait(lock);
+			continue;
+		}
+		auto now = std::chrono::steady_clock::now();
+		if (next->due > now)
+		{
+			m_cond.wait_until(lock, next->due);
+			continue;
+		}
+
+		const void *owner = next->owner;
+		std::function<void()> func = next->func;
+		_tStats *pStats = next->pStats;
+		if (next->interval.count() == 0)
+			m_tasks.erase(next);
+		else
+		{
+			next->due += next->interval;
+			if (next->due < now)
+				next->due = now + next->interval; // we are late, skip the missed runs
+		}
+		m_busy.insert(owner);
+		m_running[std::this_thread::get_id()] = owner;
+		lock.unlock();
+
+		uint64_t start_us = ThreadCPUTimeUs();
+		try
+		{
+			func();
+		}
+		catch (std::exception &e)
+		{
+			_log.Log(LOG_ERROR, "HWScheduler: Exception in task: %s", e.what());
+		}
+		catch (...)
+		{
+			_log.Log(LOG_ERROR, "HWScheduler: Unknown exception in task");
+		}
+		if (pStats)
+		{
+			pStats->runs++;
+			pStats->cpu_us += ThreadCPUTimeUs() - start_us;
+		}
+
+		lock.lock();
+		m_running.erase(std::this_thread::get_id());
+		m_busy.erase(owner);
+		m_stopping.erase(owner);
+		m_cond.notify_all();
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../main/Noncopyable.h"
+
+#define HWSCHEDULER_THREAD_NAME "HWScheduler"
+#define HWSCHEDULER_WORKERS 4
+
+// Timers and a small worker pool running the periodic polls of hardware drivers,
+// instead of every driver keeping a thread that wakes up each second to count to its interval.
+// Tasks of the same owner never run concurrently, like they did on the owner's own thread.
+class CHardwareScheduler : private domoticz::noncopyable
+{
+      public:
+	struct _tStats
+	{
+		std::atomic<uint64_t> runs{ 0 };
+		std::atomic<uint64_t> cpu_us{ 0 }; // thread CPU time, wall time where the platform has no per thread clock
+	};
+
+	static CHardwareScheduler &Get();
+
+	// Run func every iIntervalMs, the first time after iFirstDelayMs. An interval of 0 runs it once.
+	void Add(const void *owner, int iIntervalMs, int iFirstDelayMs, const std::function<void()> &func, _tStats *pStats);
+	// Remove all tasks of owner and wait for one that is still running, unless called from that task itself.
+	// Until that running task has returned, tasks it adds for owner (a continuation, a new poll) are dropped.
+	void Remove(const void *owner);
+
+      private:
+	CHardwareScheduler();
+	~CHardwareScheduler();
+
+	void Do_Work();
+
+	struct _tTask
+	{
+		uint64_t id;
+		const void *owner;
+		std::chrono::steady_clock::time_point due;
+		std::chrono::milliseconds interval;
+		std::function<void()> func;
+		_tStats *pStats;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::list<_tTask> m_tasks;
+	std::set<const void *> m_busy;
+	std::set<const void *> m_stopping; // removed while one of their tasks was running
+	std::map<std::thread::id, const void *> m_running;
+	uint64_t m_next_id = 0;
+	bool m_bStop = false;
+	std::vector<std::shared_ptr<std::thread>> m_workers;
+};
@@ -50,6 +50,7 @@ std::string ReadFile(std::string filename)
 
 #define Meteorologisk_URL "https://api.met.no/weatherapi/locationforecast/2.0/complete.json"
 #define Meteorologisk_forecast_URL "https://darksky.net/#/f/"
+#define Meteorologisk_Poll_Interval 300
 
 CMeteorologisk::CMeteorologisk(const int ID, const std::string &Location)
 	: m_Location(Location)
@@ -125,63 +126,42 @@ bool CMeteorologisk::StartHardware()
 {
 	Init();
 
-	RequestStart();
+	Log(LOG_STATUS, "Started...");
+	Debug(DEBUG_NORM, "Metereologisk module started with Location parameters Latitude %f, Longitude %f!", m_Lat, m_Lon);
 
-	// Start worker thread
-	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
-	SetThreadNameInt(m_thread->native_handle());
+	ScheduleHeartbeat();
+	SchedulePoll(Meteorologisk_Poll_Interval, 5, [this] { Do_Poll(); });
 	m_bIsStarted = true;
 	sOnConnected(this);
-	return (m_thread != nullptr);
+	return true;
 }
 
 bool CMeteorologisk::StopHardware()
 {
-	if (m_thread)
-	{
-		RequestStop();
-		m_thread->join();
-		m_thread.reset();
-	}
+	StopScheduledTasks();
+	if (m_bIsStarted)
+		Log(LOG_STATUS, "Worker stopped...");
 	m_bIsStarted = false;
 	return true;
 }
 
-#define Meteorologisk_Poll_Interval 300
-
-void CMeteorologisk::Do_Work()
+void CMeteorologisk::Do_Poll()
 {
-	Log(LOG_STATUS, "Started...");
-	Debug(DEBUG_NORM, "Metereologisk module started with Location parameters Latitude %f, Longitude %f!", m_Lat, m_Lon);
-
-	int sec_counter = Meteorologisk_Poll_Interval - 5;
-	while (!IsStopRequested(1000))
+	if (!m_URL.empty())
 	{
-		sec_counter++;
-		if (sec_counter % 12 == 0)
+		try
 		{
-			m_LastHeartbeat = mytime(nullptr);
+			GetMeterDetails();
 		}
-		if (sec_counter % Meteorologisk_Poll_Interval == 0)
+		catch (...)
 		{
-			if (!m_URL.empty())
-			{
-				try
-				{
-					GetMeterDetails();
-				}
-				catch (...)
-				{
-					Log(LOG_ERROR, "Unhandled failure getting/parsing data!");
-				}
-			}
-			else
-			{
-				Log(LOG_STATUS, "Unable to properly run due to missing or incorrect Location parameters (Latitude, Longitude)!");
-			}
+			Log(LOG_ERROR, "Unhandled failure getting/parsing data!");
 		}
 	}
-	Log(LOG_STATUS, "Worker stopped...");
+	else
+	{
+		Log(LOG_STATUS, "Unable to properly run due to missing or incorrect Location parameters (Latitude, Longitude)!");
+	}
 }
 
 bool CMeteorologisk::WriteToHardware(const char * /*pdata*/, const unsigned char /*length*/)
@@ -14,7 +14,7 @@ class CMeteorologisk : public CDomoticzHardwareBase
 	void Init();
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
+	void Do_Poll();
 	void GetMeterDetails();
 
 	std::string m_Location;
@@ -22,5 +22,4 @@ class CMeteorologisk : public CDomoticzHardwareBase
 	std::string m_ForecastURL;
 	double m_Lat = 0;
 	double m_Lon = 0;
-	std::shared_ptr<std::thread> m_thread;
 };
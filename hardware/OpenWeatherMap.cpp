@@ -50,6 +50,7 @@ std::string ReadFile(std::string filename)
 #define OWM_Get_City_Details "https://api.openweathermap.org/data/2.5/weather?"
 #define OWM_icon_URL "https://openweathermap.org/img/wn/"	// for example 10d@4x.png
 #define OWM_forecast_URL "https://openweathermap.org/city/"
+#define OpenWeatherMap_Poll_Interval 300
 
 COpenWeatherMap::COpenWeatherMap(const int ID, const std::string &APIKey, const std::string &Location, const int adddayforecast, const int addhourforecast, const int adddescdev, const int owmforecastscreen) :
 	m_APIKey(APIKey),
@@ -335,52 +336,33 @@ bool COpenWeatherMap::StartHardware()
 		}
 	}
 
-	RequestStart();
-
-	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
-	SetThreadNameInt(m_thread->native_handle());
+	ScheduleHeartbeat();
+	SchedulePoll(OpenWeatherMap_Poll_Interval, 3, [this] { Do_Poll(); });
 	m_bIsStarted=true;
 	sOnConnected(this);
 	Log(LOG_STATUS, "Started");
-	return (m_thread != nullptr);
+	return true;
 }
 
 bool COpenWeatherMap::StopHardware()
 {
-	if (m_thread)
-	{
-		RequestStop();
-		m_thread->join();
-		m_thread.reset();
-	}
-    m_bIsStarted=false;
+	StopScheduledTasks();
+	if (m_bIsStarted)
+		Log(LOG_STATUS, "Worker stopped...");
+	m_bIsStarted=false;
 	return true;
 }
 
-#define OpenWeatherMap_Poll_Interval 300
-
-void COpenWeatherMap::Do_Work()
+void COpenWeatherMap::Do_Poll()
 {
-	int sec_counter = OpenWeatherMap_Poll_Interval - 3;
-	while (!IsStopRequested(1000))
+	try
 	{
-		sec_counter++;
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat = mytime(nullptr);
-		}
-		if (sec_counter % OpenWeatherMap_Poll_Interval == 0)
-		{
-			try
-			{
-				GetMeterDetails();
-			}
-			catch (...)
-			{
-				Log(LOG_ERROR, "Unhandled failure getting/parsing http data!");
-			}
-		}
+		GetMeterDetails();
+	}
+	catch (...)
+	{
+		Log(LOG_ERROR, "Unhandled failure getting/parsing http data!");
 	}
-	Log(LOG_STATUS,"Worker stopped...");
 }
 
 bool COpenWeatherMap::WriteToHardware(const char* /*pdata*/, const unsigned char /*length*/)
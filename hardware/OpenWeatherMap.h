@@ -18,7 +18,7 @@ class COpenWeatherMap : public CDomoticzHardwareBase
       private:
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
+	void Do_Poll();
 	void GetMeterDetails();
 	int GetForecastFromBarometricPressure(float pressure, float temp = -999.9F);
 	std::string GetDayFromUTCtimestamp(uint8_t daynr, const std::string &UTCtimestamp);
@@ -41,5 +41,4 @@ class COpenWeatherMap : public CDomoticzHardwareBase
 	double m_Lat = 0;
 	double m_Lon = 0;
 	uint32_t m_CityID = 0;
-	std::shared_ptr<std::thread> m_thread;
 };
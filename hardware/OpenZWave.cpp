@@ -311,6 +311,11 @@ COpenZWave::~COpenZWave()
 //-----------------------------------------------------------------------------
 COpenZWave::NodeInfo* COpenZWave::GetNodeInfo(const unsigned int homeID, const uint8_t nodeID)
 {
+	NodeInfo *pNode = m_nodeindex[nodeID];
+	if ((pNode == nullptr) || (pNode->homeId == homeID))
+		return pNode;
+
+	//same node id in another home
 	for (auto &node : m_nodes)
 		if ((node.homeId == homeID) && (node.nodeId == nodeID))
 			return &node;
@@ -318,6 +323,23 @@ COpenZWave::NodeInfo* COpenZWave::GetNodeInfo(const unsigned int homeID, const u
 	return nullptr;
 }
 
+//-----------------------------------------------------------------------------
+// <UpdateNodeIndex>
+// Point the node index to the first node in m_nodes with this node id
+//-----------------------------------------------------------------------------
+void COpenZWave::UpdateNodeIndex(const uint8_t nodeID)
+{
+	m_nodeindex[nodeID] = nullptr;
+	for (auto &node : m_nodes)
+	{
+		if (node.nodeId == nodeID)
+		{
+			m_nodeindex[nodeID] = &node;
+			break;
+		}
+	}
+}
+
 std::string COpenZWave::GetNodeStateString(const unsigned int homeID, const uint8_t nodeID)
 {
 	std::string strState = "Unknown";
@@ -511,6 +533,7 @@ void COpenZWave::OnZWaveNotification(OpenZWave::Notification const* _notificatio
 
 		nodeInfo.LastSeen = m_updateTime;
 		m_nodes.push_back(nodeInfo);
+		UpdateNodeIndex(_nodeID);
 		m_LastIncludedNode = _nodeID;
 		m_LastIncludedNodeType = nodeInfo.szType;
 		m_bHaveLastIncludedNodeInfo = !nodeInfo.Product_name.empty();
@@ -530,6 +553,7 @@ void COpenZWave::OnZWaveNotification(OpenZWave::Notification const* _notificatio
 			if ((it->homeId == _homeID) && (it->nodeId == _nodeID))
 			{
 				m_nodes.erase(it);
+				UpdateNodeIndex(_nodeID);
 				//DeleteNode(_homeID, _nodeID);
 				break;
 			}
@@ -542,6 +566,7 @@ void COpenZWave::OnZWaveNotification(OpenZWave::Notification const* _notificatio
 		break;
 	case OpenZWave::Notification::Type_DriverReset:
 		m_nodes.clear();
+		m_nodeindex.fill(nullptr);
 		m_controllerID = _notification->GetHomeId();
 		break;
 	case OpenZWave::Notification::Type_ValueAdded:
@@ -757,6 +782,7 @@ void COpenZWave::OnZWaveNotification(OpenZWave::Notification const* _notificatio
 	case OpenZWave::Notification::Type_DriverFailed:
 		m_initFailed = true;
 		m_nodes.clear();
+		m_nodeindex.fill(nullptr);
 		Log(LOG_ERROR, "Driver Failed!!");
 		break;
 	case OpenZWave::Notification::Type_DriverRemoved:
@@ -909,6 +935,7 @@ bool COpenZWave::OpenSerialConnector()
 	CloseSerialConnector();
 
 	m_nodes.clear();
+	m_nodeindex.fill(nullptr);
 	std::string ConfigPath = szStartupFolder + "Config/";
 	std::string UserPath = ConfigPath;
 	if (szStartupFolder != szUserDataFolder)
@@ -2684,7 +2711,6 @@ void COpenZWave::UpdateValue(NodeInfo* pNode, const OpenZWave::ValueID& vID)
 	std::stringstream sstr;
 	sstr << int(NodeID) << ".instance." << int(vOrgInstance) << ".index." << vOrgIndex << ".commandClasses." << int(commandclass);
 	std::string path = sstr.str();
-	std::string path_plus = path + ".";
 
 	Debug(DEBUG_RECEIVED, "Value_Changed: Node: %d (0x%02x), CommandClass: %s, Label: %s, Instance: %d, Index: %d", NodeID, NodeID, cclassStr(commandclass), vLabel.c_str(),
 	      vID.GetInstance(), vID.GetIndex());
@@ -2870,43 +2896,18 @@ void COpenZWave::UpdateValue(NodeInfo* pNode, const OpenZWave::ValueID& vID)
 		}
 	}
 
+	//path has the GenerateDeviceStringID layout, so it is the m_devices key
 	_tZWaveDevice *pDevice = nullptr;
-	for (auto &m : m_devices)
-	{
-		std::string dstring = m.second.string_id;
-		if (dstring == path) {
-			pDevice = &m.second;
-			break;
-		}
-		else {
-			size_t loc = dstring.find(path_plus);
-			if (loc != std::string::npos)
-			{
-				pDevice = &m.second;
-				break;
-			}
-		}
-	}
+	auto itt = m_devices.find(path);
+	if (itt != m_devices.end())
+		pDevice = &itt->second;
 	if (pDevice == nullptr)
 	{
 		//New device, let's add it
 		AddValue(pNode, vID);
-		for (auto &device : m_devices)
-		{
-			std::string dstring = device.second.string_id;
-			if (dstring == path) {
-				pDevice = &device.second;
-				break;
-			}
-			else {
-				size_t loc = dstring.find(path_plus);
-				if (loc != std::string::npos)
-				{
-					pDevice = &device.second;
-					break;
-				}
-			}
-		}
+		itt = m_devices.find(path);
+		if (itt != m_devices.end())
+			pDevice = &itt->second;
 		if (pDevice == nullptr)
 		{
 			Log(LOG_ERROR, "Value_Changed: Tried adding value, not succeeded!. Node: %d (0x%02x), CommandClass: %s, Label: %s, Instance: %d, Index: %d", NodeID, NodeID, cclassStr(commandclass), vLabel.c_str(), vID.GetInstance(), vID.GetIndex());
@@ -7,6 +7,7 @@
 #include "ZWaveBase.h"
 #include "ASyncSerial.h"
 #include <list>
+#include <array>
 #include "openzwave/control_panel/ozwcp.h"
 
 namespace OpenZWave
@@ -142,6 +143,7 @@ class COpenZWave : public ZWaveBase
 	void NodeQueried(const unsigned int homeID, const uint8_t nodeID);
 	void DeleteNode(const unsigned int homeID, const uint8_t nodeID);
 	void AddNode(const unsigned int homeID, const uint8_t nodeID, const NodeInfo *pNode);
+	void UpdateNodeIndex(const uint8_t nodeID);
 	void EnableNodePoll(const unsigned int homeID, const uint8_t nodeID, const int pollTime);
 	void DisableNodePoll(const unsigned int homeID, const uint8_t nodeID);
 	bool GetValueByCommandClass(const uint8_t nodeID, const uint8_t instanceID, const uint8_t commandClass, OpenZWave::ValueID &nValue);
@@ -173,6 +175,8 @@ class COpenZWave : public ZWaveBase
 	OpenZWave::Manager *m_pManager;
 
 	std::list<NodeInfo> m_nodes;
+	// first m_nodes entry for every node id (list entries do not move), see UpdateNodeIndex
+	std::array<NodeInfo *, 256> m_nodeindex{};
 
 	std::string m_szSerialPort;
 	unsigned int m_controllerID;
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "P1MeterBase.h"
+#include "P1Telegram.h"
 #include "hardwaretypes.h"
 #include "../main/SQLHelper.h"
 #include "../main/localtime_r.h"
@@ -14,142 +15,12 @@
 #include <cryptopp/filters.h>
 */
 
-#define CRC16_ARC	0x8005
-#define CRC16_ARC_REFL	0xA001
-
 #define GCMTagLength 12
 const std::string _szDecodeAdd = "3000112233445566778899AABBCCDDEEFF";
 
-enum class _eP1MatchType {
-	ID = 0,
-	EXCLMARK,
-	STD,
-	DEVTYPE,
-	MBUS,
-	LINE17,
-	LINE18
-};
-
 #define P1MAXTOTALPOWER 55200		// Define Max total Power possible (80A * 3fase * 230V)
 #define P1MAXPHASEPOWER 18400		// Define Max phase Power possible (80A * 3fase * 230V)
 
-#define P1SMID		"/"				// Smart Meter ID. Used to detect start of telegram.
-#define P1VER		"1-3:0.2.8"		// P1 version
-#define P1VERBE		"0-0:96.1.4"	// P1 version + e-MUCS version (Belgium)
-#define P1TS		"0-0:1.0.0"		// Timestamp
-#define P1PUSG		"1-0:1.8."		// total power usage (excluding tariff indicator)
-#define P1PDLV		"1-0:2.8."		// total delivered power (excluding tariff indicator)
-#define P1TIP		"0-0:96.14.0"	// tariff indicator power
-#define P1PUC		"1-0:1.7.0"		// current power usage
-#define P1PDC		"1-0:2.7.0"		// current power delivery
-#define P1NOPF		"0-0:96.7.21"	// Number of power failures in any phases
-#define P1NOLPF		"0-0:96.7.9"	// Number of power failures in any phases
-#define P1NOVSGL1	"1-0:32.32.0"	// Number of voltage sags in phase L1
-#define P1NOVSGL2	"1-0:52.32.0"	// Number of voltage sags in phase L2
-#define P1NOVSGL3	"1-0:72.32.0"	// Number of voltage sags in phase L3
-#define P1NOVSWL1	"1-0:32.36.0"	// Number of voltage swells in phase L1
-#define P1NOVSWL2	"1-0:52.36.0"	// Number of voltage swells in phase L2
-#define P1NOVSWL3	"1-0:72.36.0"	// Number of voltage swells in phase L3
-#define P1VOLTL1	"1-0:32.7.0"	// voltage L1 (DSMRv5)
-#define P1VOLTL2	"1-0:52.7.0"	// voltage L2 (DSMRv5)
-#define P1VOLTL3	"1-0:72.7.0"	// voltage L3 (DSMRv5)
-#define P1AMPEREL1	"1-0:31.7.0"	// amperage L1 (DSMRv5)
-#define P1AMPEREL2	"1-0:51.7.0"	// amperage L2 (DSMRv5)
-#define P1AMPEREL3	"1-0:71.7.0"	// amperage L3 (DSMRv5)
-#define P1POWUSL1	"1-0:21.7.0"	// Power used L1 (DSMRv5)
-#define P1POWUSL2	"1-0:41.7.0"	// Power used L2 (DSMRv5)
-#define P1POWUSL3	"1-0:61.7.0"	// Power used L3 (DSMRv5)
-#define P1POWDLL1	"1-0:22.7.0"	// Power delivered L1 (DSMRv5)
-#define P1POWDLL2	"1-0:42.7.0"	// Power delivered L2 (DSMRv5)
-#define P1POWDLL3	"1-0:62.7.0"	// Power delivered L3 (DSMRv5)
-#define P1GTS		"0-n:24.3.0"	// DSMR2 timestamp gas usage sample
-#define P1GUDSMR2	"("				// DSMR2 gas usage sample
-#define P1MUDSMR4	"0-n:24.2."		// DSMR4 mbus value (excluding 'tariff' indicator)
-#define P1MBTYPE	"0-n:24.1.0"	// M-Bus device type
-#define P1EOT		"!"				// End of telegram.
-
-enum _eP1Type {
-	P1TYPE_SMID = 0,
-	P1TYPE_END,
-	P1TYPE_VERSION,
-	P1TYPE_POWERUSAGE,
-	P1TYPE_POWERDELIV,
-	P1TYPE_USAGECURRENT,
-	P1TYPE_DELIVCURRENT,
-	P1TYPE_NUMPWRFAIL,
-	P1TYPE_NUMLONGPWRFAIL,
-	P1TYPE_NUMVOLTSAGSL1,
-	P1TYPE_NUMVOLTSAGSL2,
-	P1TYPE_NUMVOLTSAGSL3,
-	P1TYPE_NUMVOLTSWELLSL1,
-	P1TYPE_NUMVOLTSWELLSL2,
-	P1TYPE_NUMVOLTSWELLSL3,
-	P1TYPE_VOLTAGEL1,
-	P1TYPE_VOLTAGEL2,
-	P1TYPE_VOLTAGEL3,
-	P1TYPE_AMPERAGEL1,
-	P1TYPE_AMPERAGEL2,
-	P1TYPE_AMPERAGEL3,
-	P1TYPE_POWERUSEL1,
-	P1TYPE_POWERUSEL2,
-	P1TYPE_POWERUSEL3,
-	P1TYPE_POWERDELL1,
-	P1TYPE_POWERDELL2,
-	P1TYPE_POWERDELL3,
-	P1TYPE_MBUSDEVICETYPE,
-	P1TYPE_MBUSUSAGEDSMR4,
-	P1TYPE_GASTIMESTAMP,
-	P1TYPE_GASUSAGE
-};
-
-using P1Match = struct
-{
-	_eP1MatchType matchtype;
-	_eP1Type type;
-	const char* key;
-	const char* topic;
-	uint8_t start;
-	uint8_t width;
-};
-
-constexpr std::array<P1Match, 32> p1_matchlist{
-	{
-		{ _eP1MatchType::ID, P1TYPE_SMID, P1SMID, "", 0, 0 },
-		{ _eP1MatchType::EXCLMARK, P1TYPE_END, P1EOT, "", 0, 0 },
-		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VER, "version", 10, 2 },
-		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VERBE, "versionBE", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSAGE, P1PUSG, "powerusage", 10, 9 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELIV, P1PDLV, "powerdeliv", 10, 9 },
-		{ _eP1MatchType::STD, P1TYPE_USAGECURRENT, P1PUC, "powerusagec", 10, 7 },
-		{ _eP1MatchType::STD, P1TYPE_DELIVCURRENT, P1PDC, "powerdelivc", 10, 7 },
-		{ _eP1MatchType::STD, P1TYPE_NUMPWRFAIL, P1NOPF, "numpwrfail", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMLONGPWRFAIL, P1NOLPF, "numlongpwrfail", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL1, P1NOVSGL1, "numvoltsagsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL2, P1NOVSGL2, "numvoltsagsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL3, P1NOVSGL3, "numvoltsagsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL1, P1NOVSWL1, "numvoltswellsl1", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL2, P1NOVSWL2, "numvoltswellsl2", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL3, P1NOVSWL3, "numvoltswellsl3", 12, 5 },
-		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL1, P1VOLTL1, "voltagel1", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL2, P1VOLTL2, "voltagel2", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL3, P1VOLTL3, "voltagel3", 11, 5 },
-		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL1, P1AMPEREL1, "amperagel1", 11, 3 },
-		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL2, P1AMPEREL2, "amperagel2", 11, 3 },
-		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL3, P1AMPEREL3, "amperagel3", 11, 3 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSEL1, P1POWUSL1, "powerusel1", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSEL2, P1POWUSL2, "powerusel2", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERUSEL3, P1POWUSL3, "powerusel3", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELL1, P1POWDLL1, "powerdell1", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELL2, P1POWDLL2, "powerdell2", 11, 6 },
-		{ _eP1MatchType::STD, P1TYPE_POWERDELL3, P1POWDLL3, "powerdell3", 11, 6 },
-		{ _eP1MatchType::DEVTYPE, P1TYPE_MBUSDEVICETYPE, P1MBTYPE, "mbusdevicetype", 11, 3 },
-		{ _eP1MatchType::MBUS, P1TYPE_MBUSUSAGEDSMR4, P1MUDSMR4, "mbus_meter", 26, 8 },
-		// must keep DEVTYPE, GAS, LINE17 and LINE18 in this order at end of p1_matchlist
-		{ _eP1MatchType::LINE17, P1TYPE_GASTIMESTAMP, P1GTS, "gastimestamp", 11, 12 },
-		{ _eP1MatchType::LINE18, P1TYPE_GASUSAGE, P1GUDSMR2, "gasusage", 1, 9 },
-	}
-};
-
 struct P1MBusType
 {
 	P1MeterBase::P1MBusType type = P1MeterBase::P1MBusType::deviceType_Unknown;
@@ -176,41 +47,6 @@ constexpr std::array<P1MBusType, 8> p1_supported_mbus_list{
 	}
 };
 
-constexpr std::array<uint16_t, 256> p1_crc_16{
-	0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
-	0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
-	0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
-	0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
-	0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
-	0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
-	0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
-	0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
-	0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
-	0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
-	0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
-	0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
-	0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
-	0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
-	0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
-	0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
-	0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
-	0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
-	0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
-	0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
-	0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
-	0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
-	0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
-	0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
-	0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
-	0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
-	0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
-	0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
-	0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
-	0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
-	0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
-	0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
-};
-
 P1MeterBase::P1MeterBase()
 {
 	m_bDisableCRC = true;
@@ -383,616 +219,563 @@ void P1MeterBase::InitP1EncryptionState()
 }
 
 
+const P1Match* P1MeterBase::FindMatch()
+{
+	P1MatchState state;
+	state.bMBusTypeKnown = (m_p1_mbus_type != P1MBusType::deviceType_Unknown);
+	state.p1version = m_p1version;
+	state.linecount = m_linecount;
+	state.gaschannel = m_gasprefix[2];
+	for (const auto& itt : m_mbus_devices)
+		P1SetMBusChannel(state, itt.second.prefix[2]);
+
+	const int idx = P1FindMatch(l_buffer, state);
+	if (idx < 0)
+		return nullptr;
+	const P1Match* t = &P1GetMatch(idx);
+	switch (t->matchtype)
+	{
+	case _eP1MatchType::ID:
+		// start of data, we do not process anything else on this line
+		m_linecount = 1;
+		return nullptr;
+	case _eP1MatchType::EXCLMARK:
+		// end of data
+		l_exclmarkfound = 1;
+		break;
+	case _eP1MatchType::LINE17:
+		m_linecount = 17;
+		break;
+	default:
+		break;
+	}
+	return t;
+}
+
 bool P1MeterBase::MatchLine()
 {
 	try {
-		if ((strlen(l_buffer) < 1) || (l_buffer[0] == 0x0a))
+		if ((l_buffer[0] == 0) || (l_buffer[0] == 0x0a))
 			return true; //null value (startup)
 
-		bool bFound = false;
+		const P1Match* t = FindMatch();
+		if (t == nullptr)
+			return true;
 
-		for (size_t i = 0; i < p1_matchlist.size(); ++i)
+		if (l_exclmarkfound)
 		{
-			if (bFound)
-				break;
-
-			std::string sValue;
-
-			const P1Match* t = &p1_matchlist[i];
-			switch (t->matchtype)
+			m_l1_usage_total += m_powerusel1;
+			m_l2_usage_total += m_powerusel2;
+			m_l3_usage_total += m_powerusel3;
+			m_l1_delivery_total += m_powerdell1;
+			m_l2_delivery_total += m_powerdell2;
+			m_l3_delivery_total += m_powerdell3;
+			m_l1_usage_values++;
+			m_l2_usage_values++;
+			m_l3_usage_values++;
+			m_l1_delivery_values++;
+			m_l2_delivery_values++;
+			m_l3_delivery_values++;
+
+			if (m_p1version == 0)
 			{
-			case _eP1MatchType::ID:
-				// start of data
-				if (strncmp(t->key, l_buffer, strlen(t->key)) == 0)
-				{
-					m_linecount = 1;
-					bFound = true;
+				Log(LOG_STATUS, "Meter is pre DSMR 4.0 - using DSMR 2.2 compatibility");
+				m_p1version = 2;
+			}
+			time_t atime = mytime(nullptr);
+			if (difftime(atime, m_lastUpdateTime) >= m_ratelimit)
+			{
+				BeginRxBatch();
+				sDecodeRXMessage(this, (const unsigned char*)&m_power, "Power", 255, nullptr);
+				if (m_voltagel1 != -1) {
+					SendVoltageSensor(0, 1, 255, m_voltagel1, "Voltage L1");
 				}
-				continue; // we do not process anything else on this line
-				break;
-			case _eP1MatchType::EXCLMARK:
-				// end of data
-				if (strncmp(t->key, l_buffer, strlen(t->key)) == 0)
-				{
-					l_exclmarkfound = 1;
-					bFound = true;
+				if (m_voltagel2 != -1) {
+					SendVoltageSensor(0, 2, 255, m_voltagel2, "Voltage L2");
 				}
-				break;
-			case _eP1MatchType::STD:
-				if (strncmp(t->key, l_buffer, strlen(t->key)) == 0)
-					bFound = true;
-				break;
-			case _eP1MatchType::DEVTYPE:
-				if (m_p1_mbus_type == P1MBusType::deviceType_Unknown)
-				{
-					const char* pValue = t->key + 3;
-					if (strncmp(pValue, l_buffer + 3, strlen(t->key) - 3) == 0)
-						bFound = true;
-					else
-						i += 100; // skip matches with any other m-bus lines - we need to find the M0-Bus channel first
+				if (m_voltagel3 != -1) {
+					SendVoltageSensor(0, 3, 255, m_voltagel3, "Voltage L3");
 				}
-				break;
-			case _eP1MatchType::MBUS:
-				if (strncmp((m_gasprefix + (t->key + 3)).c_str(), l_buffer, strlen(t->key)) == 0)
-				{
-					// verify that 'tariff' indicator is either 1 (Nld) or 3 (Bel)
-					if ((l_buffer[9] & 0xFD) == 0x31)
-						bFound = true;
+				if (m_powerusel1 != -1) {
+					SendWattMeter(0, 1, 255, m_powerusel1, "Usage L1");
 				}
-				else
-				{
-					for (const auto& itt : m_mbus_devices)
-					{
-						if (strncmp((itt.second.prefix + (t->key + 3)).c_str(), l_buffer, strlen(t->key)) == 0)
-						{
-							// verify that 'tariff' indicator is either 1 (Nld) or 3 (Bel)
-							if ((l_buffer[9] & 0xFD) == 0x31)
-								bFound = true;
-						}
-					}
+				if (m_powerusel2 != -1) {
+					SendWattMeter(0, 2, 255, m_powerusel2, "Usage L2");
 				}
-				if (m_p1version >= 4)
-					i += 100; // skip matches with any DSMR v2 gas lines
-				break;
-			case _eP1MatchType::LINE17:
-				if (strncmp((m_gasprefix + (t->key + 3)).c_str(), l_buffer, strlen(t->key)) == 0)
-				{
-					m_linecount = 17;
-					bFound = true;
+				if (m_powerusel3 != -1) {
+					SendWattMeter(0, 3, 255, m_powerusel3, "Usage L3");
 				}
-				break;
-			case _eP1MatchType::LINE18:
-				if ((m_linecount == 18) && (strncmp(t->key, l_buffer, strlen(t->key)) == 0))
-					bFound = true;
-				break;
-			} //switch
 
-			if (!bFound)
-				continue;
+				if (m_powerdell1 != -1) {
+					SendWattMeter(0, 4, 255, m_powerdell1, "Delivery L1");
+				}
+				if (m_powerdell2 != -1) {
+					SendWattMeter(0, 5, 255, m_powerdell2, "Delivery L2");
+				}
+				if (m_powerdell3 != -1) {
+					SendWattMeter(0, 6, 255, m_powerdell3, "Delivery L3");
+				}
 
-			if (l_exclmarkfound)
-			{
-				m_l1_usage_total += m_powerusel1;
-				m_l2_usage_total += m_powerusel2;
-				m_l3_usage_total += m_powerusel3;
-				m_l1_delivery_total += m_powerdell1;
-				m_l2_delivery_total += m_powerdell2;
-				m_l3_delivery_total += m_powerdell3;
-				m_l1_usage_values++;
-				m_l2_usage_values++;
-				m_l3_usage_values++;
-				m_l1_delivery_values++;
-				m_l2_delivery_values++;
-				m_l3_delivery_values++;
+				// create calculated usage/delivery Watt sensors
+				SendWattMeter(0, 7, 255, m_powerusel1 + m_powerusel2 + m_powerusel3, "Actual Usage (L1 + L2 + L3)");
+				SendWattMeter(0, 8, 255, m_powerdell1 + m_powerdell3 + m_powerdell3, "Actual Delivery (L1 + L2 + L3)");
 
-				if (m_p1version == 0)
+				if (m_l1_usage_values > 0)
 				{
-					Log(LOG_STATUS, "Meter is pre DSMR 4.0 - using DSMR 2.2 compatibility");
-					m_p1version = 2;
-				}
-				time_t atime = mytime(nullptr);
-				if (difftime(atime, m_lastUpdateTime) >= m_ratelimit)
-				{
-					sDecodeRXMessage(this, (const unsigned char*)&m_power, "Power", 255, nullptr);
-					if (m_voltagel1 != -1) {
-						SendVoltageSensor(0, 1, 255, m_voltagel1, "Voltage L1");
-					}
-					if (m_voltagel2 != -1) {
-						SendVoltageSensor(0, 2, 255, m_voltagel2, "Voltage L2");
-					}
-					if (m_voltagel3 != -1) {
-						SendVoltageSensor(0, 3, 255, m_voltagel3, "Voltage L3");
-					}
-					if (m_powerusel1 != -1) {
-						SendWattMeter(0, 1, 255, m_powerusel1, "Usage L1");
-					}
-					if (m_powerusel2 != -1) {
-						SendWattMeter(0, 2, 255, m_powerusel2, "Usage L2");
-					}
-					if (m_powerusel3 != -1) {
-						SendWattMeter(0, 3, 255, m_powerusel3, "Usage L3");
-					}
-
-					if (m_powerdell1 != -1) {
-						SendWattMeter(0, 4, 255, m_powerdell1, "Delivery L1");
-					}
-					if (m_powerdell2 != -1) {
-						SendWattMeter(0, 5, 255, m_powerdell2, "Delivery L2");
-					}
-					if (m_powerdell3 != -1) {
-						SendWattMeter(0, 6, 255, m_powerdell3, "Delivery L3");
+#define kWh_Update_Interval 10
+					if (difftime(atime, m_lastUpdateTime) >= kWh_Update_Interval)
+					{
+						double avg_usage_l1 = m_l1_usage_total / double(m_l1_usage_values);
+						double avg_usage_l2 = m_l2_usage_total / double(m_l2_usage_values);
+						double avg_usage_l3 = m_l3_usage_total / double(m_l3_usage_values);
+						double avg_delivery_l1 = m_l1_delivery_total / double(m_l1_delivery_values);
+						double avg_delivery_l2 = m_l2_delivery_total / double(m_l2_delivery_values);
+						double avg_delivery_l3 = m_l3_delivery_total / double(m_l3_delivery_values);
+						m_l1_usage_total = 0;
+						m_l2_usage_total = 0;
+						m_l3_usage_total = 0;
+						m_l1_delivery_total = 0;
+						m_l2_delivery_total = 0;
+						m_l3_delivery_total = 0;
+
+						m_l1_usage_values = 0;
+						m_l2_usage_values = 0;
+						m_l3_usage_values = 0;
+						m_l1_delivery_values = 0;
+						m_l2_delivery_values = 0;
+						m_l3_delivery_values = 0;
+
+						m_l1_usage_cntr += (avg_usage_l1 * kWh_Update_Interval / 3600.0);
+						m_l2_usage_cntr += (avg_usage_l2 * kWh_Update_Interval / 3600.0);
+						m_l3_usage_cntr += (avg_usage_l3 * kWh_Update_Interval / 3600.0);
+
+						m_l1_delivery_cntr += (avg_delivery_l1 * kWh_Update_Interval / 3600.0);
+						m_l2_delivery_cntr += (avg_delivery_l2 * kWh_Update_Interval / 3600.0);
+						m_l3_delivery_cntr += (avg_delivery_l3 * kWh_Update_Interval / 3600.0);
 					}
+					//we use m_powerusel1 instead of avg_usage_l1 to not cause user questions.
+					//when m_ratelimit > 1, the average is not the same as the last value received and avg_usage_l1
+					//is much more accurate
+					SendKwhMeter(0, 1, 255, m_powerusel1, m_l1_usage_cntr * 0.001, "kWh Usage L1 (Calculated)");
+					SendKwhMeter(0, 2, 255, m_powerusel2, m_l2_usage_cntr * 0.001, "kWh Usage L2 (Calculated)");
+					SendKwhMeter(0, 3, 255, m_powerusel3, m_l3_usage_cntr * 0.001, "kWh Usage L3 (Calculated)");
+
+					SendKwhMeter(0, 4, 255, m_powerdell1, m_l1_delivery_cntr * 0.001, "kWh Delivery L1 (Calculated)");
+					SendKwhMeter(0, 5, 255, m_powerdell2, m_l2_delivery_cntr * 0.001, "kWh Delivery L2 (Calculated)");
+					SendKwhMeter(0, 6, 255, m_powerdell3, m_l3_delivery_cntr * 0.001, "kWh Delivery L3 (Calculated)");
+				}
 
-					// create calculated usage/delivery Watt sensors
-					SendWattMeter(0, 7, 255, m_powerusel1 + m_powerusel2 + m_powerusel3, "Actual Usage (L1 + L2 + L3)");
-					SendWattMeter(0, 8, 255, m_powerdell1 + m_powerdell3 + m_powerdell3, "Actual Delivery (L1 + L2 + L3)");
+				if (m_nbr_pwr_failures != -1) {
+					SendTextSensorWhenDifferent(7, m_nbr_pwr_failures, m_last_nbr_pwr_failures, "# Power failures");
+				}
+				if (m_nbr_long_pwr_failures != -1) {
+					SendTextSensorWhenDifferent(8, m_nbr_long_pwr_failures, m_last_nbr_long_pwr_failures, "# Long power failures");
+				}
+				if (m_nbr_volt_sags_l1 > 0) {
+					SendTextSensorWhenDifferent(9, m_nbr_volt_sags_l1, m_last_nbr_volt_sags_l1, "# Voltage sags L1");
+				}
+				if (m_nbr_volt_sags_l2 > 0) {
+					SendTextSensorWhenDifferent(10, m_nbr_volt_sags_l2, m_last_nbr_volt_sags_l2, "# Voltage sags L2");
+				}
+				if (m_nbr_volt_sags_l3 > 0) {
+					SendTextSensorWhenDifferent(11, m_nbr_volt_sags_l3, m_last_nbr_volt_sags_l3, "# Voltage sags L3");
+				}
+				if (m_nbr_volt_swells_l1 > 0) {
+					SendTextSensorWhenDifferent(12, m_nbr_volt_swells_l1, m_last_nbr_volt_swells_l1, "# Voltage swells L1");
+				}
+				if (m_nbr_volt_swells_l2 > 0) {
+					SendTextSensorWhenDifferent(13, m_nbr_volt_swells_l2, m_last_nbr_volt_swells_l2, "# Voltage swells L2");
+				}
+				if (m_nbr_volt_swells_l3 > 0) {
+					SendTextSensorWhenDifferent(14, m_nbr_volt_swells_l3, m_last_nbr_volt_swells_l3, "# Voltage swells L3");
+				}
 
-					if (m_l1_usage_values > 0)
+				if (
+					(m_voltagel1 != -1)
+					&& (m_voltagel2 != -1)
+					&& (m_voltagel3 != -1)
+					)
+				{
+					// The ampere is rounded to whole numbers and therefor not accurate enough
+					// Therefor we calculate this ourselfs I=P/U, I1=(m_power.m_powerusel1/m_voltagel1)
+					float I1 = m_powerusel1 / m_voltagel1;
+					float I2 = m_powerusel2 / m_voltagel2;
+					float I3 = m_powerusel3 / m_voltagel3;
+					SendCurrentSensor(0, 255, I1, I2, I3, "Current L1/L2/L3");
+
+					//Do the same for delivered
+					if (m_powerdell1 || m_powerdell2 || m_powerdell3)
 					{
-#define kWh_Update_Interval 10
-						if (difftime(atime, m_lastUpdateTime) >= kWh_Update_Interval)
-						{
-							double avg_usage_l1 = m_l1_usage_total / double(m_l1_usage_values);
-							double avg_usage_l2 = m_l2_usage_total / double(m_l2_usage_values);
-							double avg_usage_l3 = m_l3_usage_total / double(m_l3_usage_values);
-							double avg_delivery_l1 = m_l1_delivery_total / double(m_l1_delivery_values);
-							double avg_delivery_l2 = m_l2_delivery_total / double(m_l2_delivery_values);
-							double avg_delivery_l3 = m_l3_delivery_total / double(m_l3_delivery_values);
-							m_l1_usage_total = 0;
-							m_l2_usage_total = 0;
-							m_l3_usage_total = 0;
-							m_l1_delivery_total = 0;
-							m_l2_delivery_total = 0;
-							m_l3_delivery_total = 0;
-
-							m_l1_usage_values = 0;
-							m_l2_usage_values = 0;
-							m_l3_usage_values = 0;
-							m_l1_delivery_values = 0;
-							m_l2_delivery_values = 0;
-							m_l3_delivery_values = 0;
-
-							m_l1_usage_cntr += (avg_usage_l1 * kWh_Update_Interval / 3600.0);
-							m_l2_usage_cntr += (avg_usage_l2 * kWh_Update_Interval / 3600.0);
-							m_l3_usage_cntr += (avg_usage_l3 * kWh_Update_Interval / 3600.0);
-
-							m_l1_delivery_cntr += (avg_delivery_l1 * kWh_Update_Interval / 3600.0);
-							m_l2_delivery_cntr += (avg_delivery_l2 * kWh_Update_Interval / 3600.0);
-							m_l3_delivery_cntr += (avg_delivery_l3 * kWh_Update_Interval / 3600.0);
-						}
-						//we use m_powerusel1 instead of avg_usage_l1 to not cause user questions.
-						//when m_ratelimit > 1, the average is not the same as the last value received and avg_usage_l1
-						//is much more accurate
-						SendKwhMeter(0, 1, 255, m_powerusel1, m_l1_usage_cntr * 0.001, "kWh Usage L1 (Calculated)");
-						SendKwhMeter(0, 2, 255, m_powerusel2, m_l2_usage_cntr * 0.001, "kWh Usage L2 (Calculated)");
-						SendKwhMeter(0, 3, 255, m_powerusel3, m_l3_usage_cntr * 0.001, "kWh Usage L3 (Calculated)");
-
-						SendKwhMeter(0, 4, 255, m_powerdell1, m_l1_delivery_cntr * 0.001, "kWh Delivery L1 (Calculated)");
-						SendKwhMeter(0, 5, 255, m_powerdell2, m_l2_delivery_cntr * 0.001, "kWh Delivery L2 (Calculated)");
-						SendKwhMeter(0, 6, 255, m_powerdell3, m_l3_delivery_cntr * 0.001, "kWh Delivery L3 (Calculated)");
-					}
-
-					if (m_nbr_pwr_failures != -1) {
-						SendTextSensorWhenDifferent(7, m_nbr_pwr_failures, m_last_nbr_pwr_failures, "# Power failures");
-					}
-					if (m_nbr_long_pwr_failures != -1) {
-						SendTextSensorWhenDifferent(8, m_nbr_long_pwr_failures, m_last_nbr_long_pwr_failures, "# Long power failures");
-					}
-					if (m_nbr_volt_sags_l1 > 0) {
-						SendTextSensorWhenDifferent(9, m_nbr_volt_sags_l1, m_last_nbr_volt_sags_l1, "# Voltage sags L1");
-					}
-					if (m_nbr_volt_sags_l2 > 0) {
-						SendTextSensorWhenDifferent(10, m_nbr_volt_sags_l2, m_last_nbr_volt_sags_l2, "# Voltage sags L2");
-					}
-					if (m_nbr_volt_sags_l3 > 0) {
-						SendTextSensorWhenDifferent(11, m_nbr_volt_sags_l3, m_last_nbr_volt_sags_l3, "# Voltage sags L3");
-					}
-					if (m_nbr_volt_swells_l1 > 0) {
-						SendTextSensorWhenDifferent(12, m_nbr_volt_swells_l1, m_last_nbr_volt_swells_l1, "# Voltage swells L1");
-					}
-					if (m_nbr_volt_swells_l2 > 0) {
-						SendTextSensorWhenDifferent(13, m_nbr_volt_swells_l2, m_last_nbr_volt_swells_l2, "# Voltage swells L2");
-					}
-					if (m_nbr_volt_swells_l3 > 0) {
-						SendTextSensorWhenDifferent(14, m_nbr_volt_swells_l3, m_last_nbr_volt_swells_l3, "# Voltage swells L3");
+						I1 = m_powerdell1 / m_voltagel1;
+						I2 = m_powerdell2 / m_voltagel2;
+						I3 = m_powerdell3 / m_voltagel3;
+						SendCurrentSensor(1, 255, I1, I2, I3, "Delivery Current L1/L2/L3");
 					}
+				}
 
-					if (
-						(m_voltagel1 != -1)
-						&& (m_voltagel2 != -1)
-						&& (m_voltagel3 != -1)
-						)
+				if ((m_gas.gasusage > 0) && ((m_gas.gasusage != m_lastgasusage) || (difftime(atime, m_lastSharedSendGas) >= 300)))
+				{
+					//only update gas when there is a new value, or 5 minutes are passed
+					if (m_gasclockskew >= 300)
 					{
-						// The ampere is rounded to whole numbers and therefor not accurate enough
-						// Therefor we calculate this ourselfs I=P/U, I1=(m_power.m_powerusel1/m_voltagel1)
-						float I1 = m_powerusel1 / m_voltagel1;
-						float I2 = m_powerusel2 / m_voltagel2;
-						float I3 = m_powerusel3 / m_voltagel3;
-						SendCurrentSensor(0, 255, I1, I2, I3, "Current L1/L2/L3");
-
-						//Do the same for delivered
-						if (m_powerdell1 || m_powerdell2 || m_powerdell3)
-						{
-							I1 = m_powerdell1 / m_voltagel1;
-							I2 = m_powerdell2 / m_voltagel2;
-							I3 = m_powerdell3 / m_voltagel3;
-							SendCurrentSensor(1, 255, I1, I2, I3, "Delivery Current L1/L2/L3");
-						}
+						// just accept it - we cannot sync to our clock
+						m_lastSharedSendGas = atime;
+						m_lastgasusage = m_gas.gasusage;
+						sDecodeRXMessage(this, (const unsigned char*)&m_gas, "Gas", 255, nullptr);
 					}
-
-					if ((m_gas.gasusage > 0) && ((m_gas.gasusage != m_lastgasusage) || (difftime(atime, m_lastSharedSendGas) >= 300)))
+					else if (atime >= m_gasoktime)
 					{
-						//only update gas when there is a new value, or 5 minutes are passed
-						if (m_gasclockskew >= 300)
+						struct tm ltime;
+						localtime_r(&atime, &ltime);
+						char myts[80];
+						sprintf(myts, "%02d%02d%02d%02d%02d%02dW", ltime.tm_year % 100, ltime.tm_mon + 1, ltime.tm_mday, ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
+						if (ltime.tm_isdst)
+							myts[12] = 'S';
+						if ((m_gastimestamp.length() > 13) || (strncmp(myts, m_gastimestamp.c_str(), m_gastimestamp.length()) >= 0))
 						{
-							// just accept it - we cannot sync to our clock
 							m_lastSharedSendGas = atime;
 							m_lastgasusage = m_gas.gasusage;
+							m_gasoktime += 300;
 							sDecodeRXMessage(this, (const unsigned char*)&m_gas, "Gas", 255, nullptr);
 						}
-						else if (atime >= m_gasoktime)
+						else // gas clock is ahead
 						{
-							struct tm ltime;
-							localtime_r(&atime, &ltime);
-							char myts[80];
-							sprintf(myts, "%02d%02d%02d%02d%02d%02dW", ltime.tm_year % 100, ltime.tm_mon + 1, ltime.tm_mday, ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
-							if (ltime.tm_isdst)
-								myts[12] = 'S';
-							if ((m_gastimestamp.length() > 13) || (strncmp(myts, m_gastimestamp.c_str(), m_gastimestamp.length()) >= 0))
+							struct tm gastm;
+							gastm.tm_year = atoi(m_gastimestamp.substr(0, 2).c_str()) + 100;
+							gastm.tm_mon = atoi(m_gastimestamp.substr(2, 2).c_str()) - 1;
+							gastm.tm_mday = atoi(m_gastimestamp.substr(4, 2).c_str());
+							gastm.tm_hour = atoi(m_gastimestamp.substr(6, 2).c_str());
+							gastm.tm_min = atoi(m_gastimestamp.substr(8, 2).c_str());
+							gastm.tm_sec = atoi(m_gastimestamp.substr(10, 2).c_str());
+							if (m_gastimestamp.length() == 12)
+								gastm.tm_isdst = -1;
+							else if (m_gastimestamp[12] == 'W')
+								gastm.tm_isdst = 0;
+							else
+								gastm.tm_isdst = 1;
+
+							time_t gtime = mktime(&gastm);
+							m_gasclockskew = difftime(gtime, atime);
+							if (m_gasclockskew >= 300)
 							{
-								m_lastSharedSendGas = atime;
-								m_lastgasusage = m_gas.gasusage;
-								m_gasoktime += 300;
-								sDecodeRXMessage(this, (const unsigned char*)&m_gas, "Gas", 255, nullptr);
+								Log(LOG_ERROR, "Unable to synchronize to the gas meter clock because it is more than 5 minutes ahead of my time");
 							}
-							else // gas clock is ahead
-							{
-								struct tm gastm;
-								gastm.tm_year = atoi(m_gastimestamp.substr(0, 2).c_str()) + 100;
-								gastm.tm_mon = atoi(m_gastimestamp.substr(2, 2).c_str()) - 1;
-								gastm.tm_mday = atoi(m_gastimestamp.substr(4, 2).c_str());
-								gastm.tm_hour = atoi(m_gastimestamp.substr(6, 2).c_str());
-								gastm.tm_min = atoi(m_gastimestamp.substr(8, 2).c_str());
-								gastm.tm_sec = atoi(m_gastimestamp.substr(10, 2).c_str());
-								if (m_gastimestamp.length() == 12)
-									gastm.tm_isdst = -1;
-								else if (m_gastimestamp[12] == 'W')
-									gastm.tm_isdst = 0;
-								else
-									gastm.tm_isdst = 1;
-
-								time_t gtime = mktime(&gastm);
-								m_gasclockskew = difftime(gtime, atime);
-								if (m_gasclockskew >= 300)
-								{
-									Log(LOG_ERROR, "Unable to synchronize to the gas meter clock because it is more than 5 minutes ahead of my time");
-								}
-								else {
-									m_gasoktime = gtime;
-									Log(LOG_STATUS, "Gas meter clock is %i seconds ahead - wait for my clock to catch up", (int)m_gasclockskew);
-								}
+							else {
+								m_gasoktime = gtime;
+								Log(LOG_STATUS, "Gas meter clock is %i seconds ahead - wait for my clock to catch up", (int)m_gasclockskew);
 							}
 						}
-					} //gas
-					for (auto& itt : m_mbus_devices)
-					{
-						if ((itt.second.usage > 0) && ((itt.second.usage != itt.second.last_usage) || (difftime(atime, m_lastSendMBusDevice) >= 300)))
-						{
-							SendMeterSensor((uint8_t)itt.first, 1, 255, itt.second.usage, itt.second.name);
-							itt.second.last_usage = itt.second.usage;
-							m_lastSendMBusDevice = atime;
-						} //water
 					}
-					m_lastUpdateTime = atime;
-				} //if (difftime(atime, m_lastUpdateTime) >= m_ratelimit)
-				m_linecount = 0;
-				l_exclmarkfound = 0;
-			}
-			else
-			{
-				std::string vString = l_buffer + t->start;
-
-				size_t ePos = vString.find_first_of("*)");
-				if (ePos == std::string::npos)
+				} //gas
+				for (auto& itt : m_mbus_devices)
 				{
-					// invalid message: value not delimited
-					Log(LOG_NORM, "Dismiss incoming - value is not delimited in line \"%s\"", l_buffer);
-					return false;
+					if ((itt.second.usage > 0) && ((itt.second.usage != itt.second.last_usage) || (difftime(atime, m_lastSendMBusDevice) >= 300)))
+					{
+						SendMeterSensor((uint8_t)itt.first, 1, 255, itt.second.usage, itt.second.name);
+						itt.second.last_usage = itt.second.usage;
+						m_lastSendMBusDevice = atime;
+					} //water
 				}
-
-				if (ePos > 0)
-				{
-					sValue = vString.substr(0, ePos);
+				EndRxBatch();
+				m_lastUpdateTime = atime;
+			} //if (difftime(atime, m_lastUpdateTime) >= m_ratelimit)
+			m_linecount = 0;
+			l_exclmarkfound = 0;
+		}
+		else
+		{
+			// the value is parsed in place, only the fields we keep as text are copied
+			const char* pValue = l_buffer + t->start;
+			const size_t ePos = (t->start <= l_bufferpos) ? strcspn(pValue, "*)") : 0;
+			if ((t->start > l_bufferpos) || (pValue[ePos] == 0))
+			{
+				// invalid message: value not delimited
+				Log(LOG_NORM, "Dismiss incoming - value is not delimited in line \"%s\"", l_buffer);
+				return false;
+			}
 #ifdef _DEBUG
-					Log(LOG_NORM, "Key: %s, Value: %s", t->topic, sValue.c_str());
+			if (ePos > 0)
+				Log(LOG_NORM, "Key: %s, Value: %.*s", t->topic, (int)ePos, pValue);
 #endif
-				}
 
-				unsigned long temp_usage = 0;
-				float temp_volt = 0;
-				float temp_ampere = 0;
-				float temp_power = 0;
-				float temp_float = 0;
-				P1MBusType mbus_type = P1MBusType::deviceType_Unknown;
-				uint8_t mbus_channel = 0;
+			unsigned long temp_usage = 0;
+			float temp_volt = 0;
+			float temp_ampere = 0;
+			float temp_power = 0;
+			float temp_float = 0;
+			P1MBusType mbus_type = P1MBusType::deviceType_Unknown;
+			uint8_t mbus_channel = 0;
 
-				switch (t->type)
+			switch (t->type)
+			{
+			case P1TYPE_VERSION:
+				if (m_p1version == 0)
 				{
-				case P1TYPE_VERSION:
-					if (m_p1version == 0)
-					{
-						m_p1version = sValue.at(0) - 0x30;
-						char szVersion[12];
-						if (t->width == 5)
-						{
-							// Belgian meter
-							sprintf(szVersion, "ESMR %c.%c.%c", sValue.at(0), sValue.at(1), sValue.at(2));
-						}
-						else // if (t->width == 2)
-						{
-							// Dutch meter
-							sprintf(szVersion, "ESMR %c.%c", sValue.at(0), sValue.at(1));
-							if (m_p1version < 5)
-								szVersion[0] = 'D';
-						}
-						Log(LOG_STATUS, "Meter reports as %s", szVersion);
-					}
-					break;
-				case P1TYPE_MBUSDEVICETYPE:
-					mbus_type = (P1MBusType)std::stoul(sValue);
-					mbus_channel = l_buffer[2];
-					//Open Metering System Specification 4.3.3 table 2 (Device Types of OMS-Meter)
-					/*
-					* Electricity meter 02h
-					* Gas meter 03h
-					* Heat meter 04h
-					* Warm water meter (30C ... 90C) 06h
-					* Water meter 07h
-					* Heat Cost Allocator 08h
-					* Cooling meter (Volume measured at return temperature: outlet) 0Ah
-					* Cooling meter (Volume measured at flow temperature: inlet) 0Bh
-					* Heat meter (Volume measured at flow temperature: inlet) 0Ch
-					* Combined Heat / Cooling meter 0Dh
-					* Hot water meter (= 90C) 15h
-					* Cold water meter a 16h
-					* Breaker (electricity) 20h
-					* Valve (gas or water) 21h
-					* Waste water meter 28h
-					*/
-					if (mbus_type == P1MBusType::deviceType_Gas)
+					const std::string sValue(pValue, ePos);
+					m_p1version = sValue.at(0) - 0x30;
+					char szVersion[12];
+					if (t->width == 5)
 					{
-						if (m_gasmbuschannel == 0)
-						{
-							m_gasmbuschannel = (char)l_buffer[2];
-							if (m_gasprefix[2] == 'n')
-								Log(LOG_STATUS, "Found gas meter on M-Bus channel %c", m_gasmbuschannel);
-							m_gasprefix[2] = m_gasmbuschannel;
-						}
+						// Belgian meter
+						sprintf(szVersion, "ESMR %c.%c.%c", sValue.at(0), sValue.at(1), sValue.at(2));
 					}
-					else
+					else // if (t->width == 2)
 					{
-						for (const auto& itt : p1_supported_mbus_list)
-						{
-							if (mbus_type == itt.type)
-							{
-								if (m_mbus_devices.find(mbus_type) == m_mbus_devices.end())
-								{
-									//new
-									_tMBusDevice mdevice;
-									mdevice.channel = l_buffer[2] - 0x30;
-									mdevice.name = itt.name;
-									mdevice.prefix[2] = (char)l_buffer[2];
-									m_mbus_devices[mbus_type] = mdevice;
-									Log(LOG_STATUS, "Found '%s' meter on M-Bus channel %c", itt.name, mdevice.channel);
-								}
-							}
-						}
-					}
-					m_p1_mbus_type = mbus_type;
-					m_p1_mbus_channel = l_buffer[2];
-					break;
-				case P1TYPE_POWERUSAGE:
-					temp_usage = (unsigned long)(std::stof(sValue) * 1000.0F);
-					if ((l_buffer[8] & 0xFE) == 0x30)
-					{
-						// map tariff IDs 0 (Lux) and 1 (Bel, Nld) both to powerusage1
-						if (!m_power.powerusage1 || m_p1version >= 4)
-							m_power.powerusage1 = temp_usage;
-						else if (temp_usage - m_power.powerusage1 < P1MAXPHASEPOWER)
-							m_power.powerusage1 = temp_usage;
+						// Dutch meter
+						sprintf(szVersion, "ESMR %c.%c", sValue.at(0), sValue.at(1));
+						if (m_p1version < 5)
+							szVersion[0] = 'D';
 					}
-					else if (l_buffer[8] == 0x32)
-					{
-						if (!m_power.powerusage2 || m_p1version >= 4)
-							m_power.powerusage2 = temp_usage;
-						else if (temp_usage - m_power.powerusage2 < P1MAXPHASEPOWER)
-							m_power.powerusage2 = temp_usage;
-					}
-					break;
-				case P1TYPE_POWERDELIV:
-					temp_usage = (unsigned long)(std::stof(sValue) * 1000.0F);
-					if ((l_buffer[8] & 0xFE) == 0x30)
-					{
-						// map tariff IDs 0 (Lux) and 1 (Bel, Nld) both to powerdeliv1
-						if (!m_power.powerdeliv1 || m_p1version >= 4)
-							m_power.powerdeliv1 = temp_usage;
-						else if (temp_usage - m_power.powerdeliv1 < P1MAXPHASEPOWER)
-							m_power.powerdeliv1 = temp_usage;
-					}
-					else if (l_buffer[8] == 0x32)
-					{
-						if (!m_power.powerdeliv2 || m_p1version >= 4)
-							m_power.powerdeliv2 = temp_usage;
-						else if (temp_usage - m_power.powerdeliv2 < P1MAXPHASEPOWER)
-							m_power.powerdeliv2 = temp_usage;
-					}
-					break;
-				case P1TYPE_USAGECURRENT:
-					temp_usage = (unsigned long)(std::stof(sValue) * 1000.0F); // Watt
-					if (temp_usage < P1MAXTOTALPOWER)
-						m_power.usagecurrent = temp_usage;
-					break;
-				case P1TYPE_DELIVCURRENT:
-					temp_usage = (unsigned long)(std::stof(sValue) * 1000.0F); // Watt;
-					if (temp_usage < P1MAXTOTALPOWER)
-						m_power.delivcurrent = temp_usage;
-					break;
-				case P1TYPE_NUMPWRFAIL:
-					m_nbr_pwr_failures = std::stoi(sValue);
-					break;
-				case P1TYPE_NUMLONGPWRFAIL:
-					m_nbr_long_pwr_failures = std::stoi(sValue);
-					break;
-				case P1TYPE_NUMVOLTSAGSL1:
-					m_nbr_volt_sags_l1 = std::stoi(sValue);
-					break;
-				case P1TYPE_NUMVOLTSAGSL2:
-					m_nbr_volt_sags_l2 = std::stoi(sValue);
-					break;
-				case P1TYPE_NUMVOLTSAGSL3:
-					m_nbr_volt_sags_l3 = std::stoi(sValue);
-					break;
-				case P1TYPE_NUMVOLTSWELLSL1:
-					m_nbr_volt_swells_l1 = std::stoi(sValue);
-					break;
-				case P1TYPE_NUMVOLTSWELLSL2:
-					m_nbr_volt_swells_l2 = std::stoi(sValue);
-					break;
-				case P1TYPE_NUMVOLTSWELLSL3:
-					m_nbr_volt_swells_l3 = std::stoi(sValue);
-					break;
-				case P1TYPE_VOLTAGEL1:
-					temp_volt = std::stof(sValue);
-					if (temp_volt < 300)
-						m_voltagel1 = temp_volt; //Voltage L1;
-					break;
-				case P1TYPE_VOLTAGEL2:
-					temp_volt = std::stof(sValue);
-					if (temp_volt < 300)
-						m_voltagel2 = temp_volt; //Voltage L2;
-					break;
-				case P1TYPE_VOLTAGEL3:
-					temp_volt = std::stof(sValue);
-					if (temp_volt < 300)
-						m_voltagel3 = temp_volt; //Voltage L3;
-					break;
-				case P1TYPE_AMPERAGEL1:
-					temp_ampere = std::stof(sValue);
-					if (temp_ampere < 100)
-					{
-						m_amperagel1 = temp_ampere; //Amperage L1;
-						m_bReceivedAmperage = true;
-					}
-					break;
-				case P1TYPE_AMPERAGEL2:
-					temp_ampere = std::stof(sValue);
-					if (temp_ampere < 100)
-					{
-						m_amperagel2 = temp_ampere; //Amperage L2;
-						m_bReceivedAmperage = true;
-					}
-					break;
-				case P1TYPE_AMPERAGEL3:
-					temp_ampere = std::stof(sValue);
-					if (temp_ampere < 100)
-					{
-						m_amperagel3 = temp_ampere; //Amperage L3;
-						m_bReceivedAmperage = true;
-					}
-					break;
-				case P1TYPE_POWERUSEL1:
-					temp_power = std::stof(sValue) * 1000.0F;
-					if (temp_power < P1MAXPHASEPOWER)
-						m_powerusel1 = temp_power; //Power Used L1;
-					break;
-				case P1TYPE_POWERUSEL2:
-					temp_power = std::stof(sValue) * 1000.0F;
-					if (temp_power < P1MAXPHASEPOWER)
-						m_powerusel2 = temp_power; //Power Used L2;
-					break;
-				case P1TYPE_POWERUSEL3:
-					temp_power = std::stof(sValue) * 1000.0F;
-					if (temp_power < P1MAXPHASEPOWER)
-						m_powerusel3 = temp_power; //Power Used L3;
-					break;
-				case P1TYPE_POWERDELL1:
-					temp_power = std::stof(sValue) * 1000.0F;
-					if (temp_power < P1MAXPHASEPOWER)
-						m_powerdell1 = temp_power; //Power Used L1;
-					break;
-				case P1TYPE_POWERDELL2:
-					temp_power = std::stof(sValue) * 1000.0F;
-					if (temp_power < P1MAXPHASEPOWER)
-						m_powerdell2 = temp_power; //Power Used L2;
-					break;
-				case P1TYPE_POWERDELL3:
-					temp_power = std::stof(sValue) * 1000.0F;
-					if (temp_power < P1MAXPHASEPOWER)
-						m_powerdell3 = temp_power; //Power Used L3;
-					break;
-				case P1TYPE_GASTIMESTAMP:
-					m_gastimestamp = sValue;
-					break;
-				case P1TYPE_GASUSAGE:
-				case P1TYPE_MBUSUSAGEDSMR4:
-					temp_float = std::stof(sValue);
-					temp_usage = (unsigned long)(temp_float * 1000.0F);
-
-					if (
-						(t->type == P1TYPE_GASUSAGE)
-						|| (m_p1_mbus_type == P1MBusType::deviceType_Gas)
-						)
+					Log(LOG_STATUS, "Meter reports as %s", szVersion);
+				}
+				break;
+			case P1TYPE_MBUSDEVICETYPE:
+				mbus_type = (P1MBusType)P1ValueToULong(pValue);
+				mbus_channel = l_buffer[2];
+				//Open Metering System Specification 4.3.3 table 2 (Device Types of OMS-Meter)
+				/*
+				* Electricity meter 02h
+				* Gas meter 03h
+				* Heat meter 04h
+				* Warm water meter (30C ... 90C) 06h
+				* Water meter 07h
+				* Heat Cost Allocator 08h
+				* Cooling meter (Volume measured at return temperature: outlet) 0Ah
+				* Cooling meter (Volume measured at flow temperature: inlet) 0Bh
+				* Heat meter (Volume measured at flow temperature: inlet) 0Ch
+				* Combined Heat / Cooling meter 0Dh
+				* Hot water meter (= 90C) 15h
+				* Cold water meter a 16h
+				* Breaker (electricity) 20h
+				* Valve (gas or water) 21h
+				* Waste water meter 28h
+				*/
+				if (mbus_type == P1MBusType::deviceType_Gas)
+				{
+					if (m_gasmbuschannel == 0)
 					{
-						if (!m_gas.gasusage || m_p1version >= 4)
-							m_gas.gasusage = temp_usage;
-						else if (temp_usage - m_gas.gasusage < 20000)
-							m_gas.gasusage = temp_usage;
+						m_gasmbuschannel = (char)l_buffer[2];
+						if (m_gasprefix[2] == 'n')
+							Log(LOG_STATUS, "Found gas meter on M-Bus channel %c", m_gasmbuschannel);
+						m_gasprefix[2] = m_gasmbuschannel;
 					}
-					else
+				}
+				else
+				{
+					for (const auto& itt : p1_supported_mbus_list)
 					{
-						for (auto& itt : m_mbus_devices)
+						if (mbus_type == itt.type)
 						{
-							if (itt.first == m_p1_mbus_type)
+							if (m_mbus_devices.find(mbus_type) == m_mbus_devices.end())
 							{
-								itt.second.usage = temp_float;
+								//new
+								_tMBusDevice mdevice;
+								mdevice.channel = l_buffer[2] - 0x30;
+								mdevice.name = itt.name;
+								mdevice.prefix[2] = (char)l_buffer[2];
+								m_mbus_devices[mbus_type] = mdevice;
+								Log(LOG_STATUS, "Found '%s' meter on M-Bus channel %c", itt.name, mdevice.channel);
 							}
 						}
 					}
-					break;
 				}
-				if (ePos > 0 && (sValue.size() != ePos))
+				m_p1_mbus_type = mbus_type;
+				m_p1_mbus_channel = l_buffer[2];
+				break;
+			case P1TYPE_POWERUSAGE:
+				temp_usage = (unsigned long)(P1ValueToFloat(pValue) * 1000.0F);
+				if ((l_buffer[8] & 0xFE) == 0x30)
+				{
+					// map tariff IDs 0 (Lux) and 1 (Bel, Nld) both to powerusage1
+					if (!m_power.powerusage1 || m_p1version >= 4)
+						m_power.powerusage1 = temp_usage;
+					else if (temp_usage - m_power.powerusage1 < P1MAXPHASEPOWER)
+						m_power.powerusage1 = temp_usage;
+				}
+				else if (l_buffer[8] == 0x32)
 				{
-					// invalid message: value is not a number
-					Log(LOG_NORM, "Dismiss incoming - value in line \"%s\" is not a number", l_buffer);
-					return false;
+					if (!m_power.powerusage2 || m_p1version >= 4)
+						m_power.powerusage2 = temp_usage;
+					else if (temp_usage - m_power.powerusage2 < P1MAXPHASEPOWER)
+						m_power.powerusage2 = temp_usage;
 				}
-
-				if (t->type == P1TYPE_MBUSUSAGEDSMR4)
+				break;
+			case P1TYPE_POWERDELIV:
+				temp_usage = (unsigned long)(P1ValueToFloat(pValue) * 1000.0F);
+				if ((l_buffer[8] & 0xFE) == 0x30)
+				{
+					// map tariff IDs 0 (Lux) and 1 (Bel, Nld) both to powerdeliv1
+					if (!m_power.powerdeliv1 || m_p1version >= 4)
+						m_power.powerdeliv1 = temp_usage;
+					else if (temp_usage - m_power.powerdeliv1 < P1MAXPHASEPOWER)
+						m_power.powerdeliv1 = temp_usage;
+				}
+				else if (l_buffer[8] == 0x32)
 				{
-					// need to get timestamp from this line as well
-					vString = l_buffer + 11;
-					if (m_p1_mbus_type == P1MBusType::deviceType_Gas)
+					if (!m_power.powerdeliv2 || m_p1version >= 4)
+						m_power.powerdeliv2 = temp_usage;
+					else if (temp_usage - m_power.powerdeliv2 < P1MAXPHASEPOWER)
+						m_power.powerdeliv2 = temp_usage;
+				}
+				break;
+			case P1TYPE_USAGECURRENT:
+				temp_usage = (unsigned long)(P1ValueToFloat(pValue) * 1000.0F); // Watt
+				if (temp_usage < P1MAXTOTALPOWER)
+					m_power.usagecurrent = temp_usage;
+				break;
+			case P1TYPE_DELIVCURRENT:
+				temp_usage = (unsigned long)(P1ValueToFloat(pValue) * 1000.0F); // Watt;
+				if (temp_usage < P1MAXTOTALPOWER)
+					m_power.delivcurrent = temp_usage;
+				break;
+			case P1TYPE_NUMPWRFAIL:
+				m_nbr_pwr_failures = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_NUMLONGPWRFAIL:
+				m_nbr_long_pwr_failures = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_NUMVOLTSAGSL1:
+				m_nbr_volt_sags_l1 = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_NUMVOLTSAGSL2:
+				m_nbr_volt_sags_l2 = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_NUMVOLTSAGSL3:
+				m_nbr_volt_sags_l3 = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_NUMVOLTSWELLSL1:
+				m_nbr_volt_swells_l1 = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_NUMVOLTSWELLSL2:
+				m_nbr_volt_swells_l2 = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_NUMVOLTSWELLSL3:
+				m_nbr_volt_swells_l3 = P1ValueToInt(pValue);
+				break;
+			case P1TYPE_VOLTAGEL1:
+				temp_volt = P1ValueToFloat(pValue);
+				if (temp_volt < 300)
+					m_voltagel1 = temp_volt; //Voltage L1;
+				break;
+			case P1TYPE_VOLTAGEL2:
+				temp_volt = P1ValueToFloat(pValue);
+				if (temp_volt < 300)
+					m_voltagel2 = temp_volt; //Voltage L2;
+				break;
+			case P1TYPE_VOLTAGEL3:
+				temp_volt = P1ValueToFloat(pValue);
+				if (temp_volt < 300)
+					m_voltagel3 = temp_volt; //Voltage L3;
+				break;
+			case P1TYPE_AMPERAGEL1:
+				temp_ampere = P1ValueToFloat(pValue);
+				if (temp_ampere < 100)
+				{
+					m_amperagel1 = temp_ampere; //Amperage L1;
+					m_bReceivedAmperage = true;
+				}
+				break;
+			case P1TYPE_AMPERAGEL2:
+				temp_ampere = P1ValueToFloat(pValue);
+				if (temp_ampere < 100)
+				{
+					m_amperagel2 = temp_ampere; //Amperage L2;
+					m_bReceivedAmperage = true;
+				}
+				break;
+			case P1TYPE_AMPERAGEL3:
+				temp_ampere = P1ValueToFloat(pValue);
+				if (temp_ampere < 100)
+				{
+					m_amperagel3 = temp_ampere; //Amperage L3;
+					m_bReceivedAmperage = true;
+				}
+				break;
+			case P1TYPE_POWERUSEL1:
+				temp_power = P1ValueToFloat(pValue) * 1000.0F;
+				if (temp_power < P1MAXPHASEPOWER)
+					m_powerusel1 = temp_power; //Power Used L1;
+				break;
+			case P1TYPE_POWERUSEL2:
+				temp_power = P1ValueToFloat(pValue) * 1000.0F;
+				if (temp_power < P1MAXPHASEPOWER)
+					m_powerusel2 = temp_power; //Power Used L2;
+				break;
+			case P1TYPE_POWERUSEL3:
+				temp_power = P1ValueToFloat(pValue) * 1000.0F;
+				if (temp_power < P1MAXPHASEPOWER)
+					m_powerusel3 = temp_power; //Power Used L3;
+				break;
+			case P1TYPE_POWERDELL1:
+				temp_power = P1ValueToFloat(pValue) * 1000.0F;
+				if (temp_power < P1MAXPHASEPOWER)
+					m_powerdell1 = temp_power; //Power Used L1;
+				break;
+			case P1TYPE_POWERDELL2:
+				temp_power = P1ValueToFloat(pValue) * 1000.0F;
+				if (temp_power < P1MAXPHASEPOWER)
+					m_powerdell2 = temp_power; //Power Used L2;
+				break;
+			case P1TYPE_POWERDELL3:
+				temp_power = P1ValueToFloat(pValue) * 1000.0F;
+				if (temp_power < P1MAXPHASEPOWER)
+					m_powerdell3 = temp_power; //Power Used L3;
+				break;
+			case P1TYPE_GASTIMESTAMP:
+				m_gastimestamp.assign(pValue, ePos);
+				break;
+			case P1TYPE_GASUSAGE:
+			case P1TYPE_MBUSUSAGEDSMR4:
+				temp_float = P1ValueToFloat(pValue);
+				temp_usage = (unsigned long)(temp_float * 1000.0F);
+
+				if (
+					(t->type == P1TYPE_GASUSAGE)
+					|| (m_p1_mbus_type == P1MBusType::deviceType_Gas)
+					)
+				{
+					if (!m_gas.gasusage || m_p1version >= 4)
+						m_gas.gasusage = temp_usage;
+					else if (temp_usage - m_gas.gasusage < 20000)
+						m_gas.gasusage = temp_usage;
+				}
+				else
+				{
+					for (auto& itt : m_mbus_devices)
 					{
-						m_gastimestamp = vString.substr(0, 13);
+						if (itt.first == m_p1_mbus_type)
+						{
+							itt.second.usage = temp_float;
+						}
+					}
+				}
+				break;
+			}
+			if (t->type == P1TYPE_MBUSUSAGEDSMR4)
+			{
+				// need to get timestamp from this line as well
+				const char* pTimestamp = l_buffer + 11;
+				if (m_p1_mbus_type == P1MBusType::deviceType_Gas)
+				{
+					m_gastimestamp = std::string(pTimestamp, 13);
 #ifdef _DEBUG
-						Log(LOG_NORM, "Key: gastimestamp, Value: %s", m_gastimestamp.c_str());
+					Log(LOG_NORM, "Key: gastimestamp, Value: %s", m_gastimestamp.c_str());
 #endif
-					}
-					else
+				}
+				else
+				{
+					for (auto& itt : m_mbus_devices)
 					{
-						for (auto& itt : m_mbus_devices)
+						if (itt.first == m_p1_mbus_type)
 						{
-							if (itt.first == m_p1_mbus_type)
-							{
-								itt.second.timestamp = vString.substr(0, 13);
+							itt.second.timestamp = std::string(pTimestamp, 13);
 #ifdef _DEBUG
-								Log(LOG_NORM, "Key: %s timestamp value: %s", itt.second.name.c_str(), itt.second.timestamp.c_str());
+							Log(LOG_NORM, "Key: %s timestamp value: %s", itt.second.name.c_str(), itt.second.timestamp.c_str());
 #endif
-							}
 						}
 					}
-					m_p1_mbus_type = P1MBusType::deviceType_Unknown;
 				}
+				m_p1_mbus_type = P1MBusType::deviceType_Unknown;
 			}
 		}
 		return true;
@@ -1046,11 +829,7 @@ bool P1MeterBase::CheckCRC()
 	uint16_t m_crc16 = (uint16_t)strtoul(crc_str, nullptr, 16);
 
 	// calculate CRC
-	uint16_t crc = 0;
-	for (int ii = 0; ii < m_bufferpos; ii++)
-	{
-		crc = (crc >> 8) ^ p1_crc_16[(crc ^ m_buffer[ii]) & 0xFF];
-	}
+	uint16_t crc = P1CRC16(m_buffer, m_bufferpos);
 	if (crc != m_crc16)
 	{
 		Log(LOG_NORM, "Dismiss incoming - CRC failed");
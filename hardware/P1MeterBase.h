@@ -3,6 +3,8 @@
 #include "DomoticzHardware.h"
 #include "hardwaretypes.h"
 
+struct P1Match;
+
 class P1MeterBase : public CDomoticzHardwareBase
 {
 	friend class P1MeterSerial;
@@ -38,6 +40,7 @@ public:
 
 private:
 	void Init();
+	const P1Match* FindMatch();
 	bool MatchLine();
 	void ParseP1Data(const uint8_t *pDataIn, int LenIn, bool disable_crc, int ratelimit);
 
@@ -0,0 +1,255 @@
+#include "stdafx.h"
+#include "P1Telegram.h"
+
+#define CRC16_ARC	0x8005
+#define CRC16_ARC_REFL	0xA001
+
+#define P1_MATCHLIST_SIZE	32
+#define P1_OBIS_HASH_SIZE	128	// buckets in the OBIS lookup index
+#define P1_OBIS_HASH_MULT	6	// chosen so that only codes sharing their "C.D" groups collide
+
+constexpr std::array<P1Match, P1_MATCHLIST_SIZE> p1_matchlist{
+	{
+		{ _eP1MatchType::ID, P1TYPE_SMID, P1SMID, sizeof(P1SMID) - 1, "", 0, 0 },
+		{ _eP1MatchType::EXCLMARK, P1TYPE_END, P1EOT, sizeof(P1EOT) - 1, "", 0, 0 },
+		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VER, sizeof(P1VER) - 1, "version", 10, 2 },
+		{ _eP1MatchType::STD, P1TYPE_VERSION, P1VERBE, sizeof(P1VERBE) - 1, "versionBE", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSAGE, P1PUSG, sizeof(P1PUSG) - 1, "powerusage", 10, 9 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELIV, P1PDLV, sizeof(P1PDLV) - 1, "powerdeliv", 10, 9 },
+		{ _eP1MatchType::STD, P1TYPE_USAGECURRENT, P1PUC, sizeof(P1PUC) - 1, "powerusagec", 10, 7 },
+		{ _eP1MatchType::STD, P1TYPE_DELIVCURRENT, P1PDC, sizeof(P1PDC) - 1, "powerdelivc", 10, 7 },
+		{ _eP1MatchType::STD, P1TYPE_NUMPWRFAIL, P1NOPF, sizeof(P1NOPF) - 1, "numpwrfail", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMLONGPWRFAIL, P1NOLPF, sizeof(P1NOLPF) - 1, "numlongpwrfail", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL1, P1NOVSGL1, sizeof(P1NOVSGL1) - 1, "numvoltsagsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL2, P1NOVSGL2, sizeof(P1NOVSGL2) - 1, "numvoltsagsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSAGSL3, P1NOVSGL3, sizeof(P1NOVSGL3) - 1, "numvoltsagsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL1, P1NOVSWL1, sizeof(P1NOVSWL1) - 1, "numvoltswellsl1", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL2, P1NOVSWL2, sizeof(P1NOVSWL2) - 1, "numvoltswellsl2", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_NUMVOLTSWELLSL3, P1NOVSWL3, sizeof(P1NOVSWL3) - 1, "numvoltswellsl3", 12, 5 },
+		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL1, P1VOLTL1, sizeof(P1VOLTL1) - 1, "voltagel1", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL2, P1VOLTL2, sizeof(P1VOLTL2) - 1, "voltagel2", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_VOLTAGEL3, P1VOLTL3, sizeof(P1VOLTL3) - 1, "voltagel3", 11, 5 },
+		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL1, P1AMPEREL1, sizeof(P1AMPEREL1) - 1, "amperagel1", 11, 3 },
+		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL2, P1AMPEREL2, sizeof(P1AMPEREL2) - 1, "amperagel2", 11, 3 },
+		{ _eP1MatchType::STD, P1TYPE_AMPERAGEL3, P1AMPEREL3, sizeof(P1AMPEREL3) - 1, "amperagel3", 11, 3 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSEL1, P1POWUSL1, sizeof(P1POWUSL1) - 1, "powerusel1", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSEL2, P1POWUSL2, sizeof(P1POWUSL2) - 1, "powerusel2", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERUSEL3, P1POWUSL3, sizeof(P1POWUSL3) - 1, "powerusel3", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELL1, P1POWDLL1, sizeof(P1POWDLL1) - 1, "powerdell1", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELL2, P1POWDLL2, sizeof(P1POWDLL2) - 1, "powerdell2", 11, 6 },
+		{ _eP1MatchType::STD, P1TYPE_POWERDELL3, P1POWDLL3, sizeof(P1POWDLL3) - 1, "powerdell3", 11, 6 },
+		{ _eP1MatchType::DEVTYPE, P1TYPE_MBUSDEVICETYPE, P1MBTYPE, sizeof(P1MBTYPE) - 1, "mbusdevicetype", 11, 3 },
+		{ _eP1MatchType::MBUS, P1TYPE_MBUSUSAGEDSMR4, P1MUDSMR4, sizeof(P1MUDSMR4) - 1, "mbus_meter", 26, 8 },
+		// must keep DEVTYPE, GAS, LINE17 and LINE18 in this order at end of p1_matchlist
+		{ _eP1MatchType::LINE17, P1TYPE_GASTIMESTAMP, P1GTS, sizeof(P1GTS) - 1, "gastimestamp", 11, 12 },
+		{ _eP1MatchType::LINE18, P1TYPE_GASUSAGE, P1GUDSMR2, sizeof(P1GUDSMR2) - 1, "gasusage", 1, 9 },
+	}
+};
+
+static_assert(p1_matchlist[P1MATCH_SMID].matchtype == _eP1MatchType::ID, "P1MATCH_SMID does not point to the ID entry");
+static_assert(p1_matchlist[P1MATCH_EOT].matchtype == _eP1MatchType::EXCLMARK, "P1MATCH_EOT does not point to the EXCLMARK entry");
+static_assert(p1_matchlist[P1MATCH_GASDSMR2].matchtype == _eP1MatchType::LINE18, "P1MATCH_GASDSMR2 does not point to the LINE18 entry");
+
+// Hash of the "C.D" value groups of an "A-B:C.D.E" OBIS code, the same function is used to build
+// the index at compile time (on the keys) and to look up received lines
+constexpr int P1ObisHash(const char* szObis)
+{
+	uint32_t hash = 0;
+	int dots = 0;
+	for (const char* p = szObis + 4; (*p != 0) && (*p != '('); p++)
+	{
+		if ((*p == '.') && (++dots == 2))
+			break;
+		hash = hash * P1_OBIS_HASH_MULT + (uint8_t)*p;
+	}
+	return (int)(hash % P1_OBIS_HASH_SIZE);
+}
+
+struct P1ObisIndex
+{
+	int8_t bucket[P1_OBIS_HASH_SIZE];
+	int8_t next[P1_MATCHLIST_SIZE];
+	int maxchain;
+
+	constexpr P1ObisIndex()
+		: bucket{}
+		, next{}
+		, maxchain(0)
+	{
+		for (int ii = 0; ii < P1_OBIS_HASH_SIZE; ii++)
+			bucket[ii] = -1;
+		// insert back to front so that every chain keeps the p1_matchlist order
+		for (int ii = P1_MATCHLIST_SIZE - 1; ii >= 0; ii--)
+		{
+			next[ii] = -1;
+			const _eP1MatchType mtype = p1_matchlist[ii].matchtype;
+			if ((mtype == _eP1MatchType::ID) || (mtype == _eP1MatchType::EXCLMARK) || (mtype == _eP1MatchType::LINE18))
+				continue; // not an OBIS code
+			const int hash = P1ObisHash(p1_matchlist[ii].key);
+			next[ii] = bucket[hash];
+			bucket[hash] = (int8_t)ii;
+		}
+		for (int ii = 0; ii < P1_OBIS_HASH_SIZE; ii++)
+		{
+			int chain = 0;
+			for (int jj = bucket[ii]; jj >= 0; jj = next[jj])
+				chain++;
+			if (chain > maxchain)
+				maxchain = chain;
+		}
+	}
+};
+
+constexpr P1ObisIndex p1_obis_index;
+// 0-0:96.7.21 and 0-0:96.7.9 share their "C.D" groups, everything else must have a bucket of its own
+static_assert(p1_obis_index.maxchain <= 2, "P1 OBIS index has unexpected collisions, change P1_OBIS_HASH_MULT");
+
+// Slicing-by-8 tables for the reflected CRC16/ARC polynomial, table[0] is the classic byte table
+struct P1CRC16Table
+{
+	uint16_t table[8][256];
+
+	constexpr P1CRC16Table()
+		: table{}
+	{
+		for (int ii = 0; ii < 256; ii++)
+		{
+			uint16_t crc = (uint16_t)ii;
+			for (int jj = 0; jj < 8; jj++)
+				crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ CRC16_ARC_REFL) : (uint16_t)(crc >> 1);
+			table[0][ii] = crc;
+		}
+		for (int kk = 1; kk < 8; kk++)
+		{
+			for (int ii = 0; ii < 256; ii++)
+				table[kk][ii] = (uint16_t)((table[kk - 1][ii] >> 8) ^ table[0][table[kk - 1][ii] & 0xFF]);
+		}
+	}
+};
+
+constexpr P1CRC16Table p1_crc_16;
+static_assert(p1_crc_16.table[0][1] == 0xC0C1, "P1 CRC16 table is not CRC16/ARC");
+
+const P1Match& P1GetMatch(const int idx)
+{
+	return p1_matchlist[idx];
+}
+
+int P1FirstCandidate(const char* szLine)
+{
+	// all OBIS keys in the match list have a single digit A and B group
+	if (szLine[0] == 0 || szLine[1] == 0 || szLine[2] == 0 || szLine[3] != ':')
+		return -1;
+	return p1_obis_index.bucket[P1ObisHash(szLine)];
+}
+
+int P1NextCandidate(const int idx)
+{
+	return p1_obis_index.next[idx];
+}
+
+// The line starts with the "0-n" prefix of the given M-Bus channel
+static bool P1IsMBusPrefix(const char* szLine, const char channel)
+{
+	return (szLine[0] == '0') && (szLine[1] == '-') && (szLine[2] == channel);
+}
+
+int P1FindMatch(const char* szLine, const P1MatchState& state)
+{
+	switch (szLine[0])
+	{
+	case '/':
+		return P1MATCH_SMID;
+	case '!':
+		return P1MATCH_EOT;
+	case '(':
+		// DSMR2 gas usage sample, it follows the gas timestamp of an already identified M-Bus channel
+		if (state.bMBusTypeKnown && (state.p1version < 4) && (state.linecount == 18))
+			return P1MATCH_GASDSMR2;
+		return -1;
+	}
+
+	for (int i = P1FirstCandidate(szLine); i >= 0; i = P1NextCandidate(i))
+	{
+		const P1Match& t = p1_matchlist[i];
+		switch (t.matchtype)
+		{
+		case _eP1MatchType::STD:
+			if (strncmp(t.key, szLine, t.keylen) == 0)
+				return i;
+			break;
+		case _eP1MatchType::DEVTYPE:
+			// we need to find the M-Bus channel first, the channel digit is not compared
+			if ((!state.bMBusTypeKnown) && (strncmp(t.key + 3, szLine + 3, t.keylen - 3) == 0))
+				return i;
+			break;
+		case _eP1MatchType::MBUS:
+			if ((!state.bMBusTypeKnown) || (strncmp(t.key + 3, szLine + 3, t.keylen - 3) != 0))
+				break;
+			// verify that 'tariff' indicator is either 1 (Nld) or 3 (Bel)
+			if ((szLine[9] & 0xFD) != 0x31)
+				break;
+			if (P1IsMBusPrefix(szLine, state.gaschannel))
+				return i;
+			if ((szLine[2] >= '0') && (szLine[2] <= '9') && (state.mbuschannels & (1 << (szLine[2] - '0'))) && (szLine[0] == '0') && (szLine[1] == '-'))
+				return i;
+			break;
+		case _eP1MatchType::LINE17:
+			// DSMR v2 gas lines only
+			if (state.bMBusTypeKnown && (state.p1version < 4)
+				&& P1IsMBusPrefix(szLine, state.gaschannel) && (strncmp(t.key + 3, szLine + 3, t.keylen - 3) == 0))
+				return i;
+			break;
+		default:
+			break;
+		}
+	}
+	return -1;
+}
+
+float P1ValueToFloat(const char* pValue)
+{
+	char* pEnd = nullptr;
+	const float value = strtof(pValue, &pEnd);
+	if (pEnd == pValue)
+		throw std::invalid_argument("stof");
+	return value;
+}
+
+int P1ValueToInt(const char* pValue)
+{
+	char* pEnd = nullptr;
+	const long value = strtol(pValue, &pEnd, 10);
+	if (pEnd == pValue)
+		throw std::invalid_argument("stoi");
+	return (int)value;
+}
+
+unsigned long P1ValueToULong(const char* pValue)
+{
+	char* pEnd = nullptr;
+	const unsigned long value = strtoul(pValue, &pEnd, 10);
+	if (pEnd == pValue)
+		throw std::invalid_argument("stoul");
+	return value;
+}
+
+uint16_t P1CRC16(const uint8_t* pData, size_t Len)
+{
+	const auto& t = p1_crc_16.table;
+	uint16_t crc = 0;
+	// fold eight message bytes per step, the running CRC only overlaps the first two
+	while (Len >= 8)
+	{
+		crc ^= (uint16_t)(pData[0] | (pData[1] << 8));
+		crc = t[7][crc & 0xFF] ^ t[6][crc >> 8] ^ t[5][pData[2]] ^ t[4][pData[3]]
+			^ t[3][pData[4]] ^ t[2][pData[5]] ^ t[1][pData[6]] ^ t[0][pData[7]];
+		pData += 8;
+		Len -= 8;
+	}
+	while (Len-- > 0)
+	{
+		crc = (crc >> 8) ^ t[0][(crc ^ *pData++) & 0xFF];
+	}
+	return crc;
+}
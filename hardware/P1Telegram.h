@@ -0,0 +1,135 @@
+#pragma once
+
+// Stateless P1 (DSMR) telegram helpers: the OBIS match table with its compile time
+// lookup index, value field parsing and the telegram CRC
+
+#define P1SMID		"/"				// Smart Meter ID. Used to detect start of telegram.
+#define P1VER		"1-3:0.2.8"		// P1 version
+#define P1VERBE		"0-0:96.1.4"	// P1 version + e-MUCS version (Belgium)
+#define P1TS		"0-0:1.0.0"		// Timestamp
+#define P1PUSG		"1-0:1.8."		// total power usage (excluding tariff indicator)
+#define P1PDLV		"1-0:2.8."		// total delivered power (excluding tariff indicator)
+#define P1TIP		"0-0:96.14.0"	// tariff indicator power
+#define P1PUC		"1-0:1.7.0"		// current power usage
+#define P1PDC		"1-0:2.7.0"		// current power delivery
+#define P1NOPF		"0-0:96.7.21"	// Number of power failures in any phases
+#define P1NOLPF		"0-0:96.7.9"	// Number of power failures in any phases
+#define P1NOVSGL1	"1-0:32.32.0"	// Number of voltage sags in phase L1
+#define P1NOVSGL2	"1-0:52.32.0"	// Number of voltage sags in phase L2
+#define P1NOVSGL3	"1-0:72.32.0"	// Number of voltage sags in phase L3
+#define P1NOVSWL1	"1-0:32.36.0"	// Number of voltage swells in phase L1
+#define P1NOVSWL2	"1-0:52.36.0"	// Number of voltage swells in phase L2
+#define P1NOVSWL3	"1-0:72.36.0"	// Number of voltage swells in phase L3
+#define P1VOLTL1	"1-0:32.7.0"	// voltage L1 (DSMRv5)
+#define P1VOLTL2	"1-0:52.7.0"	// voltage L2 (DSMRv5)
+#define P1VOLTL3	"1-0:72.7.0"	// voltage L3 (DSMRv5)
+#define P1AMPEREL1	"1-0:31.7.0"	// amperage L1 (DSMRv5)
+#define P1AMPEREL2	"1-0:51.7.0"	// amperage L2 (DSMRv5)
+#define P1AMPEREL3	"1-0:71.7.0"	// amperage L3 (DSMRv5)
+#define P1POWUSL1	"1-0:21.7.0"	// Power used L1 (DSMRv5)
+#define P1POWUSL2	"1-0:41.7.0"	// Power used L2 (DSMRv5)
+#define P1POWUSL3	"1-0:61.7.0"	// Power used L3 (DSMRv5)
+#define P1POWDLL1	"1-0:22.7.0"	// Power delivered L1 (DSMRv5)
+#define P1POWDLL2	"1-0:42.7.0"	// Power delivered L2 (DSMRv5)
+#define P1POWDLL3	"1-0:62.7.0"	// Power delivered L3 (DSMRv5)
+#define P1GTS		"0-n:24.3.0"	// DSMR2 timestamp gas usage sample
+#define P1GUDSMR2	"("				// DSMR2 gas usage sample
+#define P1MUDSMR4	"0-n:24.2."		// DSMR4 mbus value (excluding 'tariff' indicator)
+#define P1MBTYPE	"0-n:24.1.0"	// M-Bus device type
+#define P1EOT		"!"				// End of telegram.
+
+// fixed positions in the match list for the lines that are not OBIS codes
+#define P1MATCH_SMID		0
+#define P1MATCH_EOT			1
+#define P1MATCH_GASDSMR2	31
+
+enum class _eP1MatchType {
+	ID = 0,
+	EXCLMARK,
+	STD,
+	DEVTYPE,
+	MBUS,
+	LINE17,
+	LINE18
+};
+
+enum _eP1Type {
+	P1TYPE_SMID = 0,
+	P1TYPE_END,
+	P1TYPE_VERSION,
+	P1TYPE_POWERUSAGE,
+	P1TYPE_POWERDELIV,
+	P1TYPE_USAGECURRENT,
+	P1TYPE_DELIVCURRENT,
+	P1TYPE_NUMPWRFAIL,
+	P1TYPE_NUMLONGPWRFAIL,
+	P1TYPE_NUMVOLTSAGSL1,
+	P1TYPE_NUMVOLTSAGSL2,
+	P1TYPE_NUMVOLTSAGSL3,
+	P1TYPE_NUMVOLTSWELLSL1,
+	P1TYPE_NUMVOLTSWELLSL2,
+	P1TYPE_NUMVOLTSWELLSL3,
+	P1TYPE_VOLTAGEL1,
+	P1TYPE_VOLTAGEL2,
+	P1TYPE_VOLTAGEL3,
+	P1TYPE_AMPERAGEL1,
+	P1TYPE_AMPERAGEL2,
+	P1TYPE_AMPERAGEL3,
+	P1TYPE_POWERUSEL1,
+	P1TYPE_POWERUSEL2,
+	P1TYPE_POWERUSEL3,
+	P1TYPE_POWERDELL1,
+	P1TYPE_POWERDELL2,
+	P1TYPE_POWERDELL3,
+	P1TYPE_MBUSDEVICETYPE,
+	P1TYPE_MBUSUSAGEDSMR4,
+	P1TYPE_GASTIMESTAMP,
+	P1TYPE_GASUSAGE
+};
+
+struct P1Match
+{
+	_eP1MatchType matchtype;
+	_eP1Type type;
+	const char* key;
+	uint8_t keylen;
+	const char* topic;
+	uint8_t start;
+	uint8_t width;
+};
+
+// Returns the match list entry at position idx
+const P1Match& P1GetMatch(int idx);
+
+// Returns the position of the first match list entry that can match the OBIS code at the start
+// of szLine, or -1. The candidates are found through a hash of the "C.D" value groups of the
+// "A-B:C.D.E" code and still need a full key compare; walk them with P1NextCandidate.
+int P1FirstCandidate(const char* szLine);
+int P1NextCandidate(int idx);
+
+// The part of the telegram parser state that decides which lines can match
+struct P1MatchState
+{
+	bool bMBusTypeKnown = false;	// the device type line of an M-Bus channel was read, its value lines follow
+	int p1version = 0;
+	int linecount = 0;
+	char gaschannel = 'n';			// M-Bus channel digit of the gas meter, 'n' when not found yet
+	uint16_t mbuschannels = 0;		// bit n is set when a device was found on M-Bus channel n
+};
+
+inline void P1SetMBusChannel(P1MatchState& state, const char channel)
+{
+	if ((channel >= '0') && (channel <= '9'))
+		state.mbuschannels |= (uint16_t)(1 << (channel - '0'));
+}
+
+// Returns the match list position for a telegram line, or -1 when the line has to be ignored
+int P1FindMatch(const char* szLine, const P1MatchState& state);
+
+// Parse a value field in place (no copy of the line), these throw like std::stof/std::stoi do
+float P1ValueToFloat(const char* pValue);
+int P1ValueToInt(const char* pValue);
+unsigned long P1ValueToULong(const char* pValue);
+
+// CRC16/ARC as used by DSMR 4.0 and up
+uint16_t P1CRC16(const uint8_t* pData, size_t Len);
@@ -65,46 +65,22 @@ void CVisualCrossing::Init()
 
 bool CVisualCrossing::StartHardware()
 {
-	RequestStart();
-
 	Init();
-	//Start worker thread
-	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
-	SetThreadNameInt(m_thread->native_handle());
+	Log(LOG_STATUS, "Started...");
+	ScheduleHeartbeat();
+	SchedulePoll(300, 10, [this] { GetMeterDetails(); });
 	m_bIsStarted = true;
 	sOnConnected(this);
-	return (m_thread != nullptr);
+	return true;
 }
 
 bool CVisualCrossing::StopHardware()
 {
-	if (m_thread)
-	{
-		RequestStop();
-		m_thread->join();
-		m_thread.reset();
-	}
-    m_bIsStarted = false;
-    return true;
-}
-
-void CVisualCrossing::Do_Work()
-{
-	Log(LOG_STATUS, "Started...");
-
-	int sec_counter = 290;
-	while (!IsStopRequested(1000))
-	{
-		sec_counter++;
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat = mytime(nullptr);
-		}
-		if (sec_counter % 300 == 0)
-		{
-			GetMeterDetails();
-		}
-	}
-	Log(LOG_STATUS,"Worker stopped...");
+	StopScheduledTasks();
+	if (m_bIsStarted)
+		Log(LOG_STATUS, "Worker stopped...");
+	m_bIsStarted = false;
+	return true;
 }
 
 bool CVisualCrossing::WriteToHardware(const char* /*pdata*/, const unsigned char /*length*/)
@@ -14,11 +14,9 @@ class CVisualCrossing : public CDomoticzHardwareBase
 	void Init();
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
 	void GetMeterDetails();
 
       private:
 	std::string m_APIKey;
 	std::string m_Location;
-	std::shared_ptr<std::thread> m_thread;
 };
@@ -141,7 +141,13 @@ void ZWaveBase::InsertDevice(_tZWaveDevice device)
 #endif
 	//insert or update device in internal record
 	device.sequence_number = 1;
-	m_devices[device.string_id] = device;
+	auto ret = m_devices.insert(std::make_pair(device.string_id, device));
+	if (!ret.second)
+	{
+		RemoveDeviceIndex(&ret.first->second);
+		ret.first->second = device;
+	}
+	AddDeviceIndex(&ret.first->second);
 
 	SendSwitchIfNotExists(&device);
 }
@@ -203,46 +209,51 @@ void ZWaveBase::SendSwitchIfNotExists(const _tZWaveDevice* pDevice)
 		// but instead of returning a single result, checks if there is more than one in memory
 		// device satisfying those criteria
 
-		auto itt = m_devices.begin();
-		while (itt != m_devices.end())
+		// Test for two different types when devType == pTypeGeneralSwitch, because ZWaveBase::WriteToHardware
+		// first tries to find a dimmer, if that fails tries a switch. This means you cannot have
+		// one database record with a dimmer and another with a switch, because trying
+		// to control the switch will select the dimmer.
+		// Otherwise, by elimination... devType = pTypeColorSwitch
+		// Subtype depends
+		// ZDTYPE_SWITCH_RGBW -> sTypeColor_RGB_W_Z
+		// ZDTYPE_SWITCH_COLOR -> sTypeColor_RGB_CW_WW_Z
+		// So all ZDTYPE_SWITCH_RGBW must be unique, and all ZDTYPE_SWITCH_COLOR devices must be unique
+		std::vector<_eZWaveDeviceType> vTypes;
+		if (devType == pTypeGeneralSwitch)
+		{
+			vTypes.push_back(ZDTYPE_SWITCH_DIMMER);
+			vTypes.push_back(ZDTYPE_SWITCH_NORMAL);
+		}
+		else
+			vTypes.push_back(pDevice->devType);
+
+		// Node ID1 is not used when searching for switch-like devices, see ID1 = 0; at the start
+		// of this routine
+		const _tZWaveDevice *pMatch = nullptr;
+		for (const auto devTypeMatch : vTypes)
 		{
-			if (
-				// Node ID1 is not used when searching for switch-like devices, see ID1 = 0; at the start
-				// of this routine
-				(itt->second.nodeID == (ID2 << 8) + ID3) &&
-				(itt->second.instanceID == ID4) &&
-				(itt->second.string_id != pDevice->string_id))
+			auto itt = m_devicesindex.find(DeviceIndexKey(ID3, devTypeMatch));
+			if (itt == m_devicesindex.end())
+				continue;
+			for (const auto pIndexed : itt->second)
 			{
-				// itt->second has the same szID as the one we would like to add,
+				// pIndexed has the same szID as the one we would like to add,
 				// but a different string_id. Example: "7.instance.1.index.256.commandClasses.113"
-				// Now we have to check if devType, SubType makes it unique.
-				if (devType == pTypeGeneralSwitch)
+				if ((pIndexed->instanceID == ID4) && (pIndexed->string_id != pDevice->string_id))
 				{
-					// Test for two different types, because ZWaveBase::WriteToHardware first tries
-					// to find a dimmer, if that fails tries a switch. This means you cannot have
-					// one database record with a dimmer and another with a switch, because trying
-					// to control the switch will select the dimmer.
-					if ((itt->second.devType == ZDTYPE_SWITCH_DIMMER) || (itt->second.devType == ZDTYPE_SWITCH_NORMAL))
-						break;
-				}
-				else if (itt->second.devType == pDevice->devType)
-				{
-					// By elimination... devType = pTypeColorSwitch
-					// Subtype depends
-					// ZDTYPE_SWITCH_RGBW -> sTypeColor_RGB_W_Z
-					// ZDTYPE_SWITCH_COLOR -> sTypeColor_RGB_CW_WW_Z
-					// So all ZDTYPE_SWITCH_RGBW must be unique, and all ZDTYPE_SWITCH_COLOR devices must be unique
+					//report the first one in m_devices order
+					if ((pMatch == nullptr) || (pIndexed->string_id < pMatch->string_id))
+						pMatch = pIndexed;
 					break;
 				}
 			}
-			++itt;
 		}
-		if (itt != m_devices.end())
+		if (pMatch != nullptr)
 		{
 			Log(
 				LOG_STATUS,
 				"SendSwitchIfNotExists: Device '%s' (%s) with DeviceID '%s' matches '%s' (%s). Domoticz will use the Dimmer (and hide the Switch).",
-				pDevice->string_id.c_str(), pDevice->label.c_str(), szID, itt->second.string_id.c_str(), itt->second.label.c_str());
+				pDevice->string_id.c_str(), pDevice->label.c_str(), szID, pMatch->string_id.c_str(), pMatch->label.c_str());
 		}
 		return; //Already in the system
 	}
@@ -795,34 +806,55 @@ void ZWaveBase::SendDevice2Domoticz(_tZWaveDevice* pDevice)
 	}
 }
 
+uint32_t ZWaveBase::DeviceIndexKey(const uint8_t nodeID, const _eZWaveDeviceType devType)
+{
+	return (uint32_t(nodeID) << 16) | uint32_t(devType);
+}
+
+void ZWaveBase::AddDeviceIndex(_tZWaveDevice *pDevice)
+{
+	std::vector<_tZWaveDevice *> &vDevices = m_devicesindex[DeviceIndexKey(pDevice->nodeID, pDevice->devType)];
+	auto itt = std::lower_bound(vDevices.begin(), vDevices.end(), pDevice,
+		[](const _tZWaveDevice *a, const _tZWaveDevice *b) { return a->string_id < b->string_id; });
+	vDevices.insert(itt, pDevice);
+}
+
+void ZWaveBase::RemoveDeviceIndex(const _tZWaveDevice *pDevice)
+{
+	auto itt = m_devicesindex.find(DeviceIndexKey(pDevice->nodeID, pDevice->devType));
+	if (itt == m_devicesindex.end())
+		return;
+	auto itt2 = std::find(itt->second.begin(), itt->second.end(), pDevice);
+	if (itt2 != itt->second.end())
+		itt->second.erase(itt2);
+}
+
 ZWaveBase::_tZWaveDevice* ZWaveBase::FindDevice(const uint8_t nodeID, const int instanceID, const _eZWaveDeviceType devType)
 {
-	for (auto &m : m_devices)
+	auto itt = m_devicesindex.find(DeviceIndexKey(nodeID, devType));
+	if (itt == m_devicesindex.end())
+		return nullptr;
+	for (auto pDevice : itt->second)
 	{
-		if (
-			(m.second.nodeID == nodeID)
-			&& ((m.second.instanceID == instanceID) || (instanceID == -1))
-		    && (m.second.devType == devType)
-			)
-		{
-			return &m.second;
-		}
+		if ((pDevice->instanceID == instanceID) || (instanceID == -1))
+			return pDevice;
 	}
 	return nullptr;
 }
 
 ZWaveBase::_tZWaveDevice *ZWaveBase::FindDevice(const uint8_t nodeID, const int instanceID, const uint8_t CommandClassID, const _eZWaveDeviceType devType)
 {
-	for (auto &m : m_devices)
+	auto itt = m_devicesindex.find(DeviceIndexKey(nodeID, devType));
+	if (itt == m_devicesindex.end())
+		return nullptr;
+	for (auto pDevice : itt->second)
 	{
 		if (
-			(m.second.nodeID == nodeID)
-			&& ((m.second.instanceID == instanceID) || (instanceID == -1))
-		    && (m.second.commandClassID == CommandClassID)
-			&& (m.second.devType == devType)
+			((pDevice->instanceID == instanceID) || (instanceID == -1))
+			&& (pDevice->commandClassID == CommandClassID)
 			)
 		{
-			return &m.second;
+			return pDevice;
 		}
 	}
 	return nullptr;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <time.h>
+#include <unordered_map>
 #include "DomoticzHardware.h"
 
 class ZWaveBase : public CDomoticzHardwareBase
@@ -158,6 +159,9 @@ class ZWaveBase : public CDomoticzHardwareBase
 
 	std::string GenerateDeviceStringID(const _tZWaveDevice *pDevice);
 	void InsertDevice(_tZWaveDevice device);
+	static uint32_t DeviceIndexKey(uint8_t nodeID, _eZWaveDeviceType devType);
+	void AddDeviceIndex(_tZWaveDevice *pDevice);
+	void RemoveDeviceIndex(const _tZWaveDevice *pDevice);
 	unsigned char Convert_Battery_To_PercInt(unsigned char level);
 	virtual bool SwitchLight(_tZWaveDevice *pDevice, int instanceID, int value) = 0;
 	virtual bool SwitchColor(uint8_t nodeID, uint8_t instanceID, const std::string &ColorStr) = 0;
@@ -181,5 +185,8 @@ class ZWaveBase : public CDomoticzHardwareBase
 	time_t m_updateTime{ 0 };
 	bool m_bInitState;
 	std::map<std::string, _tZWaveDevice> m_devices;
+	// m_devices entries per (nodeID, devType), every list is kept in m_devices (string_id) order
+	// so lookups return the same device the full map scan used to
+	std::unordered_map<uint32_t, std::vector<_tZWaveDevice *>> m_devicesindex;
 	std::shared_ptr<std::thread> m_thread;
 };
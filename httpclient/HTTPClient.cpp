@@ -334,6 +334,7 @@ bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata,
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postdata.c_str());
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)postdata.size()); // postdata can be binary (compressed)
 		res = curl_easy_perform(curl);
 
 		if (res != CURLE_OK)
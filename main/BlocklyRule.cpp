@@ -0,0 +1,359 @@
+#include "stdafx.h"
+#include "BlocklyRule.h"
+#include <cstring>
+
+namespace
+{
+	constexpr struct
+	{
+		const char *name;
+		CBlocklyRule::_eOperandType type;
+	} blocklyTables[] = {
+		{ "device", CBlocklyRule::OPERAND_DEVICE },
+		{ "variable", CBlocklyRule::OPERAND_VARIABLE },
+		{ "temperaturedevice", CBlocklyRule::OPERAND_TEMPERATURE },
+		{ "dewpointdevice", CBlocklyRule::OPERAND_DEWPOINT },
+		{ "humiditydevice", CBlocklyRule::OPERAND_HUMIDITY },
+		{ "barometerdevice", CBlocklyRule::OPERAND_BAROMETER },
+		{ "utilitydevice", CBlocklyRule::OPERAND_UTILITY },
+		{ "weatherdevice", CBlocklyRule::OPERAND_WEATHER },
+		{ "raindevice", CBlocklyRule::OPERAND_RAIN },
+		{ "rainlasthourdevice", CBlocklyRule::OPERAND_RAINLASTHOUR },
+		{ "uvdevice", CBlocklyRule::OPERAND_UV },
+		{ "winddirdevice", CBlocklyRule::OPERAND_WINDDIR },
+		{ "windspeeddevice", CBlocklyRule::OPERAND_WINDSPEED },
+		{ "windgustdevice", CBlocklyRule::OPERAND_WINDGUST },
+		{ "zwavealarms", CBlocklyRule::OPERAND_ZWAVEALARM },
+	};
+
+	const char *LuaTypeName(const CBlocklyRule::_tValue &value)
+	{
+		switch (value.type)
+		{
+			case CBlocklyRule::_tValue::VALUE_NUMBER:
+				return "number";
+			case CBlocklyRule::_tValue::VALUE_STRING:
+				return "string";
+			default:
+				return "nil";
+		}
+	}
+} // namespace
+
+bool CBlocklyRule::Compile(const std::string &conditions)
+{
+	m_root = _tNode();
+	m_devices.clear();
+	m_variables.clear();
+	m_bTime = false;
+	m_bSecurity = false;
+
+	m_source = conditions;
+	m_pos = 0;
+	std::string token;
+	bool bResult = ParseOr(m_root) && !NextToken(token);
+	m_source.clear();
+	return bResult;
+}
+
+bool CBlocklyRule::NextToken(std::string &token)
+{
+	token.clear();
+	while ((m_pos < m_source.size()) && isspace((unsigned char)m_source[m_pos]))
+		m_pos++;
+	if (m_pos >= m_source.size())
+		return false;
+
+	size_t start = m_pos;
+	char c = m_source[m_pos];
+	if (c == '"')
+	{
+		size_t end = m_source.find('"', m_pos + 1);
+		if (end == std::string::npos)
+			return false;
+		token = m_source.substr(start, end - start + 1);
+		m_pos = end + 1;
+		// escapes are left to Lua
+		return (token.find('\\') == std::string::npos);
+	}
+	if (isdigit((unsigned char)c) || (c == '.') || ((c == '-') && (m_pos + 1 < m_source.size()) && isdigit((unsigned char)m_source[m_pos + 1])))
+	{
+		m_pos++;
+		while (m_pos < m_source.size())
+		{
+			c = m_source[m_pos];
+			if (isdigit((unsigned char)c) || (c == '.') || (c == 'e') || (c == 'E'))
+				m_pos++;
+			else if (((c == '-') || (c == '+')) && ((m_source[m_pos - 1] == 'e') || (m_source[m_pos - 1] == 'E')))
+				m_pos++;
+			else
+				break;
+		}
+	}
+	else if (isalpha((unsigned char)c) || (c == '_') || (c == '@'))
+	{
+		m_pos++;
+		while ((m_pos < m_source.size()) && (isalnum((unsigned char)m_source[m_pos]) || (m_source[m_pos] == '_')))
+			m_pos++;
+	}
+	else if (((c == '=') || (c == '~') || (c == '<') || (c == '>')) && (m_pos + 1 < m_source.size()) && (m_source[m_pos + 1] == '='))
+		m_pos += 2;
+	else
+		m_pos++;
+	token = m_source.substr(start, m_pos - start);
+	return true;
+}
+
+bool CBlocklyRule::PeekToken(std::string &token)
+{
+	size_t pos = m_pos;
+	bool bResult = NextToken(token);
+	m_pos = pos;
+	return bResult;
+}
+
+bool CBlocklyRule::ParseOr(_tNode &node)
+{
+	_tNode child;
+	if (!ParseAnd(child))
+		return false;
+	std::string token;
+	if (!PeekToken(token) || (token != "or"))
+	{
+		node = child;
+		return true;
+	}
+	node.type = NODE_OR;
+	node.children.push_back(child);
+	while (PeekToken(token) && (token == "or"))
+	{
+		NextToken(token);
+		if (!ParseAnd(child))
+			return false;
+		node.children.push_back(child);
+	}
+	return true;
+}
+
+bool CBlocklyRule::ParseAnd(_tNode &node)
+{
+	_tNode child;
+	if (!ParsePrimary(child))
+		return false;
+	std::string token;
+	if (!PeekToken(token) || (token != "and"))
+	{
+		node = child;
+		return true;
+	}
+	node.type = NODE_AND;
+	node.children.push_back(child);
+	while (PeekToken(token) && (token == "and"))
+	{
+		NextToken(token);
+		if (!ParsePrimary(child))
+			return false;
+		node.children.push_back(child);
+	}
+	return true;
+}
+
+bool CBlocklyRule::ParsePrimary(_tNode &node)
+{
+	std::string token;
+	if (!PeekToken(token))
+		return false;
+	if (token == "(")
+	{
+		NextToken(token);
+		if (!ParseOr(node))
+			return false;
+		return NextToken(token) && (token == ")");
+	}
+
+	node.type = NODE_COMPARE;
+	if (!ParseOperand(node.left))
+		return false;
+	if (!NextToken(token))
+		return false;
+	if (token == "==")
+		node.op = OP_EQ;
+	else if (token == "~=")
+		node.op = OP_NEQ;
+	else if (token == "<")
+		node.op = OP_LT;
+	else if (token == ">")
+		node.op = OP_GT;
+	else if (token == "<=")
+		node.op = OP_LTE;
+	else if (token == ">=")
+		node.op = OP_GTE;
+	else
+		return false;
+	return ParseOperand(node.right);
+}
+
+bool CBlocklyRule::ParseOperand(_tOperand &operand)
+{
+	std::string token;
+	if (!NextToken(token))
+		return false;
+
+	if (token[0] == '"')
+	{
+		operand.type = OPERAND_STRING;
+		operand.text = token.substr(1, token.size() - 2);
+		return true;
+	}
+	if (isdigit((unsigned char)token[0]) || (token[0] == '.') || (token[0] == '-'))
+	{
+		char *pEnd = nullptr;
+		operand.type = OPERAND_NUMBER;
+		operand.number = strtod(token.c_str(), &pEnd);
+		return (*pEnd == 0);
+	}
+	if (token == "@Sunrise")
+	{
+		operand.type = OPERAND_SUNRISE;
+		return true;
+	}
+	if (token == "@Sunset")
+	{
+		operand.type = OPERAND_SUNSET;
+		return true;
+	}
+	if ((token == "timeofday") || (token == "weekday"))
+	{
+		operand.type = (token == "timeofday") ? OPERAND_TIMEOFDAY : OPERAND_WEEKDAY;
+		m_bTime = true;
+		return true;
+	}
+	if (token == "securitystatus")
+	{
+		operand.type = OPERAND_SECURITYSTATUS;
+		m_bSecurity = true;
+		return true;
+	}
+
+	for (const auto &table : blocklyTables)
+	{
+		if (token != table.name)
+			continue;
+		std::string sID;
+		if (!NextToken(token) || (token != "[") || !NextToken(sID) || !NextToken(token) || (token != "]"))
+			return false;
+		if (sID.empty() || (sID.find_first_not_of("0123456789") != std::string::npos))
+			return false;
+		operand.type = table.type;
+		operand.id = std::stoull(sID);
+		if (operand.type == OPERAND_VARIABLE)
+			m_variables.insert(operand.id);
+		else
+			m_devices.insert(operand.id);
+		return true;
+	}
+	return false;
+}
+
+bool CBlocklyRule::Evaluate(const value_resolver &resolve, std::string &error) const
+{
+	error.clear();
+	return EvaluateNode(m_root, resolve, error);
+}
+
+bool CBlocklyRule::EvaluateNode(const _tNode &node, const value_resolver &resolve, std::string &error) const
+{
+	if (node.type == NODE_AND)
+	{
+		for (const auto &child : node.children)
+		{
+			if (!EvaluateNode(child, resolve, error))
+				return false;
+		}
+		return true;
+	}
+	if (node.type == NODE_OR)
+	{
+		for (const auto &child : node.children)
+		{
+			if (EvaluateNode(child, resolve, error))
+				return true;
+			if (!error.empty())
+				return false;
+		}
+		return false;
+	}
+
+	_tValue values[2];
+	const _tOperand *operands[2] = { &node.left, &node.right };
+	for (int ii = 0; ii < 2; ii++)
+	{
+		if (operands[ii]->type == OPERAND_NUMBER)
+		{
+			values[ii].type = _tValue::VALUE_NUMBER;
+			values[ii].number = operands[ii]->number;
+		}
+		else if (operands[ii]->type == OPERAND_STRING)
+		{
+			values[ii].type = _tValue::VALUE_STRING;
+			values[ii].text = operands[ii]->text;
+		}
+		else
+			resolve(*operands[ii], values[ii]);
+	}
+	const _tValue &left = values[0];
+	const _tValue &right = values[1];
+
+	if ((node.op == OP_EQ) || (node.op == OP_NEQ))
+	{
+		bool bEqual = (left.type == right.type);
+		if (bEqual && (left.type == _tValue::VALUE_NUMBER))
+			bEqual = (left.number == right.number);
+		else if (bEqual && (left.type == _tValue::VALUE_STRING))
+			bEqual = (left.text == right.text);
+		return (node.op == OP_EQ) ? bEqual : !bEqual;
+	}
+
+	int iCompare;
+	if ((left.type == _tValue::VALUE_NUMBER) && (right.type == _tValue::VALUE_NUMBER))
+		iCompare = (left.number < right.number) ? -1 : ((left.number > right.number) ? 1 : 0);
+	else if ((left.type == _tValue::VALUE_STRING) && (right.type == _tValue::VALUE_STRING))
+		iCompare = strcoll(left.text.c_str(), right.text.c_str());
+	else
+	{
+		error = std::string("attempt to compare ") + LuaTypeName(left) + " with " + LuaTypeName(right);
+		return false;
+	}
+
+	switch (node.op)
+	{
+		case OP_LT:
+			return (iCompare < 0);
+		case OP_GT:
+			return (iCompare > 0);
+		case OP_LTE:
+			return (iCompare <= 0);
+		default:
+			return (iCompare >= 0);
+	}
+}
+
+bool CBlocklyRule::DependsOnDevice(const uint64_t id) const
+{
+	return (m_devices.find(id) != m_devices.end());
+}
+
+bool CBlocklyRule::DependsOnVariable(const uint64_t id) const
+{
+	return (m_variables.find(id) != m_variables.end());
+}
+
+bool CBlocklyRule::DependsOnTime() const
+{
+	return m_bTime;
+}
+
+bool CBlocklyRule::DependsOnSecurity() const
+{
+	return m_bSecurity;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+// A Blockly event condition compiled into a predicate tree.
+// The editor stores conditions as Lua expressions of a small, fixed shape
+// (comparisons joined by and/or), those are evaluated here directly against
+// the device states without a Lua state. Conditions outside that shape do not
+// compile and are left to the Lua interpreter.
+class CBlocklyRule
+{
+      public:
+	enum _eOperandType
+	{
+		OPERAND_NUMBER = 0,
+		OPERAND_STRING,
+		OPERAND_DEVICE,		 // device[id], the nValueWording of the device
+		OPERAND_VARIABLE,	 // variable[id]
+		OPERAND_TEMPERATURE,	 // temperaturedevice[id]
+		OPERAND_DEWPOINT,	 // dewpointdevice[id]
+		OPERAND_HUMIDITY,	 // humiditydevice[id]
+		OPERAND_BAROMETER,	 // barometerdevice[id]
+		OPERAND_UTILITY,	 // utilitydevice[id]
+		OPERAND_WEATHER,	 // weatherdevice[id]
+		OPERAND_RAIN,		 // raindevice[id]
+		OPERAND_RAINLASTHOUR,	 // rainlasthourdevice[id]
+		OPERAND_UV,		 // uvdevice[id]
+		OPERAND_WINDDIR,	 // winddirdevice[id]
+		OPERAND_WINDSPEED,	 // windspeeddevice[id]
+		OPERAND_WINDGUST,	 // windgustdevice[id]
+		OPERAND_ZWAVEALARM,	 // zwavealarms[id]
+		OPERAND_TIMEOFDAY,	 // minutes since midnight
+		OPERAND_WEEKDAY,	 // 1 = sunday
+		OPERAND_SECURITYSTATUS,
+		OPERAND_SUNRISE,	 // @Sunrise, in minutes
+		OPERAND_SUNSET,		 // @Sunset, in minutes
+	};
+
+	struct _tOperand
+	{
+		_eOperandType type = OPERAND_NUMBER;
+		double number = 0;
+		std::string text;
+		uint64_t id = 0;
+	};
+
+	// Value of an operand, with the Lua semantics of a missing table entry being nil
+	struct _tValue
+	{
+		enum _eType
+		{
+			VALUE_NIL = 0,
+			VALUE_NUMBER,
+			VALUE_STRING
+		} type = VALUE_NIL;
+		double number = 0;
+		std::string text;
+	};
+	typedef std::function<void(const _tOperand &operand, _tValue &value)> value_resolver;
+
+	// False when the conditions can not be handled natively
+	bool Compile(const std::string &conditions);
+	// On a comparison the Lua interpreter would have failed on the result is false and error is set
+	bool Evaluate(const value_resolver &resolve, std::string &error) const;
+
+	// Dependencies, for selecting the rules an event can trigger
+	bool DependsOnDevice(uint64_t id) const;
+	bool DependsOnVariable(uint64_t id) const;
+	bool DependsOnTime() const;
+	bool DependsOnSecurity() const;
+
+      private:
+	enum _eNodeType
+	{
+		NODE_AND = 0,
+		NODE_OR,
+		NODE_COMPARE
+	};
+	enum _eCompareOp
+	{
+		OP_EQ = 0,
+		OP_NEQ,
+		OP_LT,
+		OP_GT,
+		OP_LTE,
+		OP_GTE
+	};
+
+	struct _tNode
+	{
+		_eNodeType type = NODE_COMPARE;
+		_eCompareOp op = OP_EQ;
+		_tOperand left;
+		_tOperand right;
+		std::vector<_tNode> children;
+	};
+
+	bool ParseOr(_tNode &node);
+	bool ParseAnd(_tNode &node);
+	bool ParsePrimary(_tNode &node);
+	bool ParseOperand(_tOperand &operand);
+	bool NextToken(std::string &token);
+	bool PeekToken(std::string &token);
+	bool EvaluateNode(const _tNode &node, const value_resolver &resolve, std::string &error) const;
+
+	_tNode m_root;
+	std::set<uint64_t> m_devices;
+	std::set<uint64_t> m_variables;
+	bool m_bTime = false;
+	bool m_bSecurity = false;
+
+	// parser state, only used while compiling
+	std::string m_source;
+	size_t m_pos = 0;
+};
@@ -384,6 +384,22 @@ bool CCameraHandler::EmailCameraSnapshot(const std::string &CamIdx, const std::s
 //Webserver helpers
 namespace http {
 	namespace server {
+		// Sends the snapshot from the buffer it was taken in, instead of copying it into the reply
+		static void SetSnapshotReply(reply& rep, std::vector<unsigned char>& camimage)
+		{
+			auto image = std::make_shared<std::vector<unsigned char>>();
+			image->swap(camimage);
+			auto offset = std::make_shared<size_t>(0);
+			reply::set_stream(&rep, [image, offset](std::string& chunk) {
+				size_t len = std::min<size_t>(image->size() - *offset, 16 * 1024);
+				chunk.append(reinterpret_cast<const char*>(image->data()) + *offset, len);
+				*offset += len;
+				return (*offset < image->size());
+			});
+			reply::add_header(&rep, "Content-Length", std::to_string(image->size()));
+			reply::add_header_attachment(&rep, "snapshot.jpg");
+		}
+
 		void CWebServer::RType_Cameras(WebEmSession & session, const request& req, Json::Value &root)
 		{
 			if (session.rights < 2)
@@ -459,8 +475,7 @@ namespace http {
 					return;
 				}
 			}
-			reply::set_content(&rep, camimage.begin(), camimage.end());
-			reply::add_header_attachment(&rep, "snapshot.jpg");
+			SetSnapshotReply(rep, camimage);
 		}
 
 		void CWebServer::GetCameraSnapshot(WebEmSession & session, const request& req, reply & rep)
@@ -474,8 +489,7 @@ namespace http {
 			if (!m_mainworker.m_cameras.TakeSnapshot(idx, camimage)) {
 				return;
 			}
-			reply::set_content(&rep, camimage.begin(), camimage.end());
-			reply::add_header_attachment(&rep, "snapshot.jpg");
+			SetSnapshotReply(rep, camimage);
 		}
 
 		void CWebServer::Cmd_AddCamera(WebEmSession & session, const request& req, Json::Value &root)
@@ -22,6 +22,7 @@
 #include "../main/json_helper.h"
 #include "../main/NotificationSystem.h"
 #include "../main/LuaTable.h"
+#include <chrono>
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
@@ -45,6 +46,25 @@ extern http::server::CWebServerHelper m_webservers;
 #endif
 
 // Helper table for Blockly and SQL name mapping
+// Lua scripts are stopped after LUA_MAX_INSTRUCTIONS instructions or LUA_MAX_CPU_MS of CPU time,
+// the budget is checked every LUA_HOOK_INSTRUCTIONS instructions.
+#define LUA_HOOK_INSTRUCTIONS 100000
+#define LUA_MAX_INSTRUCTIONS 10000000
+#define LUA_MAX_CPU_MS 10000
+// A script still running after LUA_MAX_WALL_SEC is left behind so its worker can continue
+#define LUA_MAX_WALL_SEC 10
+
+namespace
+{
+	struct _tLuaBudget
+	{
+		uint64_t cpuStartUs;
+		int64_t instructions;
+	};
+	// set by luaThread for the script it runs, the count hook fires on the same thread
+	thread_local _tLuaBudget *tl_luaBudget = nullptr;
+} // namespace
+
 const std::string CEventSystem::m_szReason[] =
 {
 	"device",			// 0
@@ -153,6 +173,7 @@ void CEventSystem::StartEventSystem()
 	Plugins::PythonEventsInitialize(szUserDataFolder);
 #endif
 
+	m_luaWorkers.Start(LUAWORKERS_COUNT);
 	m_thread = std::make_shared<std::thread>([this] { Do_Work(); });
 	SetThreadName(m_thread->native_handle(), "EventSystem");
 	m_eventqueuethread = std::make_shared<std::thread>([this] { EventQueueThread(); });
@@ -172,6 +193,7 @@ void CEventSystem::StopEventSystem()
 		m_eventqueuethread->join();
 		m_eventqueuethread.reset();
 	}
+	m_luaWorkers.Stop();
 	if (m_thread)
 	{
 		m_thread->join();
@@ -198,6 +220,7 @@ void CEventSystem::LoadEvents()
 	std::string dzv_Dir;
 	CdzVents* dzvents = CdzVents::GetInstance();
 	dzvents->m_bdzVentsExist = false;
+	dzvents->RequestReload();
 
 #ifdef WIN32
 	m_lua_Dir = szUserDataFolder + "scripts\\lua\\";
@@ -246,6 +269,14 @@ void CEventSystem::LoadEvents()
 			eitem.Actions = sd[3];
 			eitem.EventStatus = atoi(sd[4].c_str());
 			eitem.SequenceNo = atoi(sd[5].c_str());
+			if (eitem.Interpreter == "Blockly")
+			{
+				auto rule = std::make_shared<CBlocklyRule>();
+				if (rule->Compile(eitem.Conditions))
+					eitem.BlocklyRule = rule;
+				else
+					_log.Debug(DEBUG_EVENTSYSTEM, "EventSystem: Blockly event %s evaluated by Lua", eitem.Name.c_str());
+			}
 			m_events.push_back(eitem);
 		}
 	}
@@ -306,6 +337,7 @@ void CEventSystem::LoadEvents()
 
 void CEventSystem::Do_Work()
 {
+	m_sql.SetThreadReadPool(true);
 #ifdef ENABLE_PYTHON
 #ifdef WIN32
 	m_python_Dir = szUserDataFolder + "scripts\\python\\";
@@ -1178,6 +1210,8 @@ bool CEventSystem::Update(const Notification::_eType type, const Notification::_
 		std::vector<_tEventQueue> items;
 		items.push_back(item);
 		EvaluateEvent(items);
+		if (!m_luaWorkers.WaitIdle(LUA_MAX_WALL_SEC * 1000))
+			_log.Log(LOG_ERROR, "EventSystem: Scripts still running at shutdown");
 	}
 	return true;
 }
@@ -1390,17 +1424,48 @@ void CEventSystem::UnlockEventQueueThread()
 	m_eventqueue.push(item);
 }
 
+// Queued events are evaluated in batches, one EvaluateEvent call per batch.
+// A batch starts with the first item popped and is evaluated once the batch window
+// (EventSystemBatchWindow, milliseconds) has passed and the queue is empty, or when it
+// holds EventSystemBatchSize items. With a window of 0 a batch is evaluated as soon as
+// the queue is momentarily empty.
+// Items are evaluated in the order they were queued. When a device or scene/group is
+// updated again while it is still in the batch, the batch is evaluated first so every
+// update is seen; with EventSystemDebounce the newer update replaces the pending one
+// instead, keeping the position of the first and the values of the latest.
 void CEventSystem::EventQueueThread()
 {
 	_log.Log(LOG_STATUS, "EventSystem: Queue thread started...");
+	m_sql.SetThreadReadPool(true);
 	_tEventQueue item;
 	std::vector<_tEventQueue> items;
+	std::chrono::steady_clock::time_point batchEnd;
 
 	while (!m_TaskQueue.IsStopRequested(0))
 	{
-		bool hasPopped = m_eventqueue.timed_wait_and_pop<std::chrono::duration<int> >(item, std::chrono::duration<int>(5)); // timeout after 5 sec
+		const size_t iBatchSize = (size_t)std::max(m_sql.m_EventSystemBatchSize, 1);
+		const bool bDebounce = m_sql.m_bEventSystemDebounce;
+
+		bool hasPopped;
+		if (items.empty())
+			hasPopped = m_eventqueue.timed_wait_and_pop<std::chrono::duration<int> >(item, std::chrono::duration<int>(5)); // timeout after 5 sec
+		else
+		{
+			auto now = std::chrono::steady_clock::now();
+			if (now < batchEnd)
+				hasPopped = m_eventqueue.timed_wait_and_pop(item, batchEnd - now);
+			else
+				hasPopped = m_eventqueue.try_pop(item);
+		}
 		if (!hasPopped)
+		{
+			if (!items.empty())
+			{
+				EvaluateEvent(items);
+				items.clear();
+			}
 			continue;
+		}
 
 		if (m_TaskQueue.IsStopRequested(0))
 			break;
@@ -1408,17 +1473,34 @@ void CEventSystem::EventQueueThread()
 		//_log.Log(LOG_STATUS, "EventSystem: \n reason => %d\n id => %" PRIu64 "\n devname => %s\n nValue => %d\n sValue => %s\n nValueWording => %s\n lastUpdate => %s\n lastLevel => %d\n",
 			//item.reason, item.id, item.devname.c_str(), item.nValue, item.sValue.c_str(), item.nValueWording.c_str(), item.lastUpdate.c_str(), item.lastLevel);
 #endif
-		for (const auto &i : items)
+		bool bMerged = false;
+		if (item.reason <= REASON_SCENEGROUP)
 		{
-			if (i.id == item.id && i.reason <= REASON_SCENEGROUP && i.reason == item.reason)
+			for (auto &i : items)
 			{
-				EvaluateEvent(items);
-				items.clear();
-				break;
+				if (i.id == item.id && i.reason == item.reason)
+				{
+					if (bDebounce)
+					{
+						i = item;
+						bMerged = true;
+					}
+					else
+					{
+						EvaluateEvent(items);
+						items.clear();
+					}
+					break;
+				}
 			}
 		}
+		if (bMerged)
+			continue;
+
+		if (items.empty())
+			batchEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_sql.m_EventSystemBatchWindow);
 		items.push_back(item);
-		if (!m_eventqueue.empty())
+		if (items.size() < iBatchSize)
 			continue;
 
 		EvaluateEvent(items);
@@ -1535,6 +1617,7 @@ void CEventSystem::EvaluateEvent(const std::vector<_tEventQueue> &items)
 #ifdef ENABLE_PYTHON
 	std::vector<std::string> FileEntriesPython;
 	DirectoryListing(FileEntriesPython, m_python_Dir, false, true);
+	std::vector<std::pair<_tEventQueue, std::string>> pythonScripts;
 #endif
 
 	if (!m_sql.m_bDisableDzVentsSystem)
@@ -1604,30 +1687,22 @@ void CEventSystem::EvaluateEvent(const std::vector<_tEventQueue> &items)
 		}
 
 #ifdef ENABLE_PYTHON
-		boost::unique_lock<boost::shared_mutex> uservariablesMutexLock(m_uservariablesMutex);
-		try
+		for (const auto &filename : FileEntriesPython)
 		{
-			for (const auto &filename : FileEntriesPython)
+			if (filename.length() > 3 &&
+				filename.compare(filename.length() - 3, 3, ".py") == 0 &&
+				filename.find("_demo.py") == std::string::npos)
 			{
-				if (filename.length() > 3 &&
-					filename.compare(filename.length() - 3, 3, ".py") == 0 &&
-					filename.find("_demo.py") == std::string::npos)
+				if ((item.reason == REASON_DEVICE && filename.find("_device_") != std::string::npos)
+				    || (item.reason == REASON_TIME && filename.find("_time_") != std::string::npos)
+				    || (item.reason == REASON_SECURITY && filename.find("_security_") != std::string::npos)
+				    || (item.reason == REASON_USERVARIABLE && filename.find("_variable_") != std::string::npos))
 				{
-					if ((item.reason == REASON_DEVICE && filename.find("_device_") != std::string::npos)
-					    || (item.reason == REASON_TIME && filename.find("_time_") != std::string::npos)
-					    || (item.reason == REASON_SECURITY && filename.find("_security_") != std::string::npos)
-					    || (item.reason == REASON_USERVARIABLE && filename.find("_variable_") != std::string::npos))
-					{
-						EvaluatePython(item, m_python_Dir + filename, "");
-					}
+					pythonScripts.emplace_back(item, m_python_Dir + filename);
 				}
-				// else _log.Log(LOG_STATUS,"EventSystem: ignore file not .py or is demo file: %s", filename.c_str());
 			}
+			// else _log.Log(LOG_STATUS,"EventSystem: ignore file not .py or is demo file: %s", filename.c_str());
 		}
-		catch (...)
-		{
-		}
-		uservariablesMutexLock.unlock();
 
 		// Notify plugin system of security events if a plugin owns a Security Panel
 		if (item.reason == REASON_SECURITY)
@@ -1648,6 +1723,21 @@ void CEventSystem::EvaluateEvent(const std::vector<_tEventQueue> &items)
 #endif
 		EvaluateDatabaseEvents(item);
 	}
+
+#ifdef ENABLE_PYTHON
+	// the Python file scripts of the whole batch run in one interpreter session
+	if (!pythonScripts.empty())
+	{
+		boost::unique_lock<boost::shared_mutex> uservariablesMutexLock(m_uservariablesMutex);
+		try
+		{
+			EvaluatePython(pythonScripts);
+		}
+		catch (...)
+		{
+		}
+	}
+#endif
 }
 
 lua_State *CEventSystem::CreateBlocklyLuaState()
@@ -1876,10 +1966,175 @@ lua_State *CEventSystem::ParseBlocklyLua(lua_State *lua_state, const _tEventItem
 	return lua_state;
 }
 
+bool CEventSystem::BlocklyRuleTriggered(const CBlocklyRule &rule, const _tEventQueue &item)
+{
+	switch (item.reason)
+	{
+		case REASON_DEVICE:
+			return (item.id > 0) && rule.DependsOnDevice(item.id);
+		case REASON_SECURITY:
+			return rule.DependsOnSecurity();
+		case REASON_TIME:
+			// time rules will only run when time or date based criteria are found
+			return rule.DependsOnTime();
+		case REASON_USERVARIABLE:
+			return (item.id > 0) && rule.DependsOnVariable(item.id);
+		default:
+			return false;
+	}
+}
+
+void CEventSystem::EvaluateBlocklyRule(const _tEventItem &event, const CBlocklyRule::value_resolver &resolve)
+{
+	std::string error;
+	if (event.BlocklyRule->Evaluate(resolve, error))
+	{
+		if (m_sql.m_bLogEventScriptTrigger)
+			_log.Log(LOG_NORM, "EventSystem: Event triggered: %s", event.Name.c_str());
+		parseBlocklyActions(event);
+	}
+	else if (!error.empty())
+	{
+		_log.Log(LOG_ERROR, "EventSystem: Blockly rule error, Name: %s => %s", event.Name.c_str(), error.c_str());
+	}
+}
+
+void CEventSystem::GetBlocklyValue(const CBlocklyRule::_tOperand &operand, CBlocklyRule::_tValue &value, bool &bMeasurementStates)
+{
+	value.type = CBlocklyRule::_tValue::VALUE_NIL;
+	switch (operand.type)
+	{
+		case CBlocklyRule::OPERAND_DEVICE:
+		{
+			boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+			auto itt = m_devicestates.find(operand.id);
+			if (itt != m_devicestates.end())
+			{
+				value.type = CBlocklyRule::_tValue::VALUE_STRING;
+				value.text = itt->second.nValueWording;
+			}
+			return;
+		}
+		case CBlocklyRule::OPERAND_VARIABLE:
+		{
+			boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(m_uservariablesMutex);
+			auto itt = m_uservariables.find(operand.id);
+			if (itt == m_uservariables.end())
+				return;
+			if (itt->second.variableType == 0)
+			{
+				//Integer
+				value.type = CBlocklyRule::_tValue::VALUE_NUMBER;
+				value.number = atoi(itt->second.variableValue.c_str());
+			}
+			else if (itt->second.variableType == 1)
+			{
+				//Float
+				value.type = CBlocklyRule::_tValue::VALUE_NUMBER;
+				value.number = atof(itt->second.variableValue.c_str());
+			}
+			else
+			{
+				//String,Date,Time
+				value.type = CBlocklyRule::_tValue::VALUE_STRING;
+				value.text = itt->second.variableValue;
+			}
+			return;
+		}
+		case CBlocklyRule::OPERAND_TIMEOFDAY:
+		case CBlocklyRule::OPERAND_WEEKDAY:
+		{
+			time_t now = mytime(nullptr);
+			struct tm ltime;
+			localtime_r(&now, &ltime);
+			value.type = CBlocklyRule::_tValue::VALUE_NUMBER;
+			value.number = (operand.type == CBlocklyRule::OPERAND_TIMEOFDAY) ? (ltime.tm_hour * 60) + ltime.tm_min : ltime.tm_wday + 1;
+			return;
+		}
+		case CBlocklyRule::OPERAND_SECURITYSTATUS:
+			value.type = CBlocklyRule::_tValue::VALUE_NUMBER;
+			value.number = m_SecStatus;
+			return;
+		case CBlocklyRule::OPERAND_SUNRISE:
+		case CBlocklyRule::OPERAND_SUNSET:
+			value.type = CBlocklyRule::_tValue::VALUE_NUMBER;
+			value.number = getSunRiseSunSetMinutes((operand.type == CBlocklyRule::OPERAND_SUNRISE) ? "Sunrise" : "Sunset");
+			return;
+		default:
+			break;
+	}
+
+	// Measurements, derived from the device states once per evaluation of the events
+	std::lock_guard<std::mutex> measurementStatesMutexLock(m_measurementStatesMutex);
+	if (!bMeasurementStates)
+	{
+		GetCurrentMeasurementStates();
+		bMeasurementStates = true;
+	}
+
+	auto lookup = [&](const auto &values) {
+		auto itt = values.find(operand.id);
+		if (itt != values.end())
+		{
+			value.type = CBlocklyRule::_tValue::VALUE_NUMBER;
+			value.number = itt->second;
+		}
+	};
+	switch (operand.type)
+	{
+		case CBlocklyRule::OPERAND_TEMPERATURE:
+			lookup(m_tempValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_DEWPOINT:
+			lookup(m_dewValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_HUMIDITY:
+			lookup(m_humValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_BAROMETER:
+			lookup(m_baroValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_UTILITY:
+			lookup(m_utilityValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_WEATHER:
+			lookup(m_weatherValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_RAIN:
+			lookup(m_rainValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_RAINLASTHOUR:
+			lookup(m_rainLastHourValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_UV:
+			lookup(m_uvValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_WINDDIR:
+			lookup(m_winddirValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_WINDSPEED:
+			lookup(m_windspeedValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_WINDGUST:
+			lookup(m_windgustValuesByID);
+			break;
+		case CBlocklyRule::OPERAND_ZWAVEALARM:
+			lookup(m_zwaveAlarmValuesByID);
+			break;
+		default:
+			break;
+	}
+}
+
 void CEventSystem::EvaluateDatabaseEvents(const _tEventQueue &item)
 {
 	lua_State *lua_state = nullptr;
 
+	bool bMeasurementStates = false;
+	CBlocklyRule::value_resolver blocklyValue = [this, &bMeasurementStates](const CBlocklyRule::_tOperand &operand, CBlocklyRule::_tValue &value) {
+		GetBlocklyValue(operand, value, bMeasurementStates);
+	};
+
 	boost::shared_lock<boost::shared_mutex> eventsMutexLock(m_eventsMutex);
 	try
 	{
@@ -1890,7 +2145,12 @@ void CEventSystem::EvaluateDatabaseEvents(const _tEventQueue &item)
 
 			if (eventInScope && eventActive)
 			{
-				if (event.Interpreter == "Blockly")
+				if ((event.Interpreter == "Blockly") && event.BlocklyRule)
+				{
+					if (BlocklyRuleTriggered(*event.BlocklyRule, item))
+						EvaluateBlocklyRule(event, blocklyValue);
+				}
+				else if (event.Interpreter == "Blockly")
 				{
 					std::size_t found = std::string::npos;
 					if ((item.reason == REASON_DEVICE) && (item.id > 0))
@@ -2606,17 +2866,52 @@ bool CEventSystem::PythonScheduleEvent(const std::string &ID, const std::string
 	return ScheduleEvent(ID, Action, eventName);
 }
 
+size_t CEventSystem::GetDeviceStateCount()
+{
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+	return m_devicestates.size();
+}
+
+bool CEventSystem::GetDeviceState(const uint64_t ulDevID, _tDeviceStatus &state)
+{
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+	auto itt = m_devicestates.find(ulDevID);
+	if (itt == m_devicestates.end())
+		return false;
+	state = itt->second;
+	return true;
+}
+
+void CEventSystem::GetDeviceStateNames(std::vector<std::pair<std::string, uint64_t>> &names)
+{
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
+	names.clear();
+	names.reserve(m_devicestates.size());
+	for (const auto &state : m_devicestates)
+		names.emplace_back(state.second.deviceName, state.first);
+}
+
 void CEventSystem::EvaluatePython(const _tEventQueue &item, const std::string &filename, const std::string &PyString)
 {
 	//_log.Log(LOG_NORM, "EventSystem: Already scheduled this event, skipping");
 	// _log.Log(LOG_STATUS, "EventSystem: script %s trigger, file: %s, script: %s, deviceName: %s" , reason.c_str(), filename.c_str(), PyString.c_str(), devname.c_str());
 
-	Plugins::PythonEventsProcessPython(m_szReason[item.reason], filename, PyString, item.id, m_devicestates, m_uservariables, getSunRiseSunSetMinutes("Sunrise"),
-		getSunRiseSunSetMinutes("Sunset"));
+	std::vector<Plugins::_tPythonEvent> events;
+	events.push_back({ m_szReason[item.reason], filename, PyString, item.id });
+	Plugins::PythonEventsProcessPython(events, m_uservariables, getSunRiseSunSetMinutes("Sunrise"), getSunRiseSunSetMinutes("Sunset"));
 
 	//Py_Finalize();
 }
 
+void CEventSystem::EvaluatePython(const std::vector<std::pair<_tEventQueue, std::string>> &scripts)
+{
+	std::vector<Plugins::_tPythonEvent> events;
+	events.reserve(scripts.size());
+	for (const auto &script : scripts)
+		events.push_back({ m_szReason[script.first.reason], script.second, "", script.first.id });
+	Plugins::PythonEventsProcessPython(events, m_uservariables, getSunRiseSunSetMinutes("Sunrise"), getSunRiseSunSetMinutes("Sunset"));
+}
+
 #endif // ENABLE_PYTHON
 
 void CEventSystem::ExportDeviceStatesToLua(lua_State *lua_state, const _tEventQueue &item)
@@ -3017,29 +3312,51 @@ void CEventSystem::EvaluateLua(const _tEventQueue &item, const std::string &file
 
 void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std::string &filename, const std::string &LuaString)
 {
-	std::lock_guard<std::mutex> l(luaMutex);
-
-	lua_State *lua_state;
-	lua_state = luaL_newstate();
+	// Scripts run on the worker pool. dzVents has a single runtime state so all of its runs share one key,
+	// other scripts are ordered per trigger so updates of one device are handled in sequence.
+	CdzVents* dzvents = CdzVents::GetInstance();
+	std::string key;
+	if (LuaString.empty() && filename == dzvents->m_runtimeDir + "dzVents.lua")
+		key = "dzVents";
+	else
+		key = std_format("%d_%" PRIu64, items[0].reason, items[0].id);
+	m_luaWorkers.Post(key, [this, items, filename, LuaString] { ExecuteLua(items, filename, LuaString); });
+}
 
-	// load Lua libraries
-	static const luaL_Reg lualibs[] = {
-		{ "base", luaopen_base },     { "io", luaopen_io },	{ "table", luaopen_table },
-		{ "string", luaopen_string }, { "math", luaopen_math }, { nullptr, nullptr },
-	};
+void CEventSystem::ExecuteLua(const std::vector<_tEventQueue> &items, const std::string &filename, const std::string &LuaString)
+{
+	CdzVents* dzvents = CdzVents::GetInstance();
+	const bool bdzVents = (!m_sql.m_bDisableDzVentsSystem && LuaString.empty() && filename == dzvents->m_runtimeDir + "dzVents.lua");
 
-	const luaL_Reg *lib = lualibs;
-	for (; lib->func != nullptr; lib++)
+	// dzVents keeps its runtime loaded between triggers
+	lua_State *lua_state = (bdzVents) ? dzvents->AcquireLuaState() : nullptr;
+	const bool bNewState = (lua_state == nullptr);
+	if (bNewState)
 	{
-		lib->func(lua_state);
-		lua_settop(lua_state, 0);
-	}
+		lua_state = luaL_newstate();
+
+		// load Lua libraries
+		static const luaL_Reg lualibs[] = {
+			{ "base", luaopen_base },     { "io", luaopen_io },	{ "table", luaopen_table },
+			{ "string", luaopen_string }, { "math", luaopen_math }, { nullptr, nullptr },
+		};
+
+		const luaL_Reg *lib = lualibs;
+		for (; lib->func != nullptr; lib++)
+		{
+			lib->func(lua_state);
+			lua_settop(lua_state, 0);
+		}
 
-	lua_pushcfunction(lua_state, l_domoticz_applyJsonPath);
-	lua_setglobal(lua_state, "domoticz_applyJsonPath");
+		lua_pushcfunction(lua_state, l_domoticz_applyJsonPath);
+		lua_setglobal(lua_state, "domoticz_applyJsonPath");
 
-	lua_pushcfunction(lua_state, l_domoticz_applyXPath);
-	lua_setglobal(lua_state, "domoticz_applyXPath");
+		lua_pushcfunction(lua_state, l_domoticz_applyXPath);
+		lua_setglobal(lua_state, "domoticz_applyXPath");
+
+		if (bdzVents)
+			dzvents->AdoptLuaState(lua_state);
+	}
 
 #ifdef _DEBUG
 	_log.Log(LOG_STATUS, "EventSystem: script %s trigger (%s)", m_szReason[items[0].reason].c_str(), filename.c_str());
@@ -3101,28 +3418,31 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 
 	int secstatus = 0;
 	m_sql.GetPreferencesVar("SecStatus", secstatus);
-	CdzVents* dzvents = CdzVents::GetInstance();
-	if (!m_sql.m_bDisableDzVentsSystem && filename == dzvents->m_runtimeDir + "dzVents.lua")
+	if (bdzVents)
 		dzvents->EvaluateDzVents(lua_state, items, secstatus);
 	else
 		EvaluateLuaClassic(lua_state, items[0], secstatus);
 
 	int status = 0;
-	if (LuaString.length() == 0)
+	if (bdzVents)
+		status = dzvents->LoadRuntime(lua_state, filename);
+	else if (LuaString.length() == 0)
 		status = luaL_loadfile(lua_state, filename.c_str());
 	else
 		status = luaL_loadstring(lua_state, LuaString.c_str());
 
 	if (status == 0)
 	{
-		lua_sethook(lua_state, luaStop, LUA_MASKCOUNT, 10000000);
+		lua_sethook(lua_state, luaStop, LUA_MASKCOUNT, LUA_HOOK_INSTRUCTIONS);
 
-		boost::thread aluaThread([this, lua_state, filename] { luaThread(lua_state, filename); });
+		boost::thread aluaThread([this, lua_state, filename, bdzVents] { luaThread(lua_state, filename, bdzVents); });
 		SetThreadName(aluaThread.native_handle(), "luaThread");
 
-		if (!aluaThread.timed_join(boost::posix_time::seconds(10)))
+		if (!aluaThread.timed_join(boost::posix_time::seconds(LUA_MAX_WALL_SEC)))
 		{
-			_log.Log(LOG_ERROR, "EventSystem: Warning!, lua script %s has been running for more than 10 seconds", filename.c_str());
+			_log.Log(LOG_ERROR, "EventSystem: Warning!, lua script %s has been running for more than %d seconds", filename.c_str(), LUA_MAX_WALL_SEC);
+			if (bdzVents)
+				dzvents->DetachLuaState(lua_state);
 		}
 		else
 		{
@@ -3132,7 +3452,10 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 	else
 	{
 		report_errors(lua_state, status, filename);
-		lua_close(lua_state);
+		if (bdzVents)
+			dzvents->ReleaseLuaState(lua_state, status);
+		else
+			lua_close(lua_state);
 		return;
 	}
 
@@ -3168,8 +3491,12 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 	*/
 }
 
-void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename)
+void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename, const bool bdzVents)
 {
+	auto tStart = std::chrono::steady_clock::now();
+	_tLuaBudget budget{ ThreadCPUTimeUs(), 0 };
+	tl_luaBudget = &budget;
+
 	int status;
 	status = lua_pcall(lua_state, 0, LUA_MULTRET, 0);
 	report_errors(lua_state, status, filename);
@@ -3195,18 +3522,32 @@ void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename)
 			_log.Log(LOG_STATUS, "EventSystem: Script event triggered: %s", filename.c_str());
 	}
 
-	lua_close(lua_state);
+	tl_luaBudget = nullptr;
+	_log.Debug(DEBUG_EVENTSYSTEM, "EventSystem: %s finished in %d ms (cpu %d ms)", filename.c_str(),
+		   (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tStart).count(),
+		   (int)((ThreadCPUTimeUs() - budget.cpuStartUs) / 1000));
 
+	if (bdzVents)
+		CdzVents::GetInstance()->ReleaseLuaState(lua_state, status);
+	else
+		lua_close(lua_state);
 }
 
 void CEventSystem::luaStop(lua_State *L, lua_Debug *ar)
 {
-	if (ar->event == LUA_HOOKCOUNT)
+	if ((ar->event != LUA_HOOKCOUNT) || (tl_luaBudget == nullptr))
+		return;
+
+	tl_luaBudget->instructions += LUA_HOOK_INSTRUCTIONS;
+	if (tl_luaBudget->instructions >= LUA_MAX_INSTRUCTIONS)
 	{
-		(void)ar;  /* unused arg. */
 		lua_sethook(L, nullptr, 0, 0);
 		luaL_error(L, "Lua script execution exceeds maximum number of lines");
-		lua_close(L);
+	}
+	if (ThreadCPUTimeUs() - tl_luaBudget->cpuStartUs >= (uint64_t)LUA_MAX_CPU_MS * 1000)
+	{
+		lua_sethook(L, nullptr, 0, 0);
+		luaL_error(L, "Lua script execution exceeds maximum CPU time of %d ms", LUA_MAX_CPU_MS);
 	}
 }
 
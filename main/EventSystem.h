@@ -5,7 +5,9 @@
 
 #include "../httpclient/HTTPClient.h"
 
+#include "BlocklyRule.h"
 #include "LuaCommon.h"
+#include "LuaWorkerPool.h"
 #include "concurrent_queue.h"
 #include "StoppableTask.h"
 #include "NotificationObserver.h"
@@ -26,7 +28,7 @@ class CEventSystem : public CLuaCommon, StoppableTask, CNotificationObserver
 		std::string Actions;
 		int SequenceNo;
 		int EventStatus;
-
+		std::shared_ptr<CBlocklyRule> BlocklyRule; // compiled Conditions, nullptr when they need Lua
 	};
 
 	struct _tActionParseResults
@@ -133,6 +135,10 @@ public:
 	bool UpdateSceneGroup(uint64_t ulDevID, int nValue, const std::string &lastUpdate);
 	void UpdateUserVariable(uint64_t ulDevID, const std::string &varValue, const std::string &lastUpdate);
 	bool PythonScheduleEvent(const std::string &ID, const std::string &Action, const std::string &eventName);
+	// Single entry access to the device state store, used by the Python events device mapping
+	size_t GetDeviceStateCount();
+	bool GetDeviceState(uint64_t ulDevID, _tDeviceStatus &state);
+	void GetDeviceStateNames(std::vector<std::pair<std::string, uint64_t>> &names);
 	bool GetEventTrigger(uint64_t ulDevID, _eReason reason, bool bEventTrigger);
 	void SetEventTrigger(uint64_t ulDevID, _eReason reason, float fDelayTime);
 	bool CustomCommand(uint64_t idx, const std::string &sCommand);
@@ -193,7 +199,7 @@ private:
 	boost::shared_mutex m_scenesgroupsMutex;
 	boost::shared_mutex m_eventtriggerMutex;
 	std::mutex m_measurementStatesMutex;
-	std::mutex luaMutex;
+	CLuaWorkerPool m_luaWorkers;
 	std::shared_ptr<std::thread> m_thread;
 	std::shared_ptr<std::thread> m_eventqueuethread;
 	StoppableTask m_TaskQueue;
@@ -213,15 +219,20 @@ private:
 	void EvaluateEvent(const std::vector<_tEventQueue> &items);
 	void EvaluateDatabaseEvents(const _tEventQueue &item);
 	lua_State *ParseBlocklyLua(lua_State *lua_state, const _tEventItem &item);
+	bool BlocklyRuleTriggered(const CBlocklyRule &rule, const _tEventQueue &item);
+	void EvaluateBlocklyRule(const _tEventItem &event, const CBlocklyRule::value_resolver &resolve);
+	void GetBlocklyValue(const CBlocklyRule::_tOperand &operand, CBlocklyRule::_tValue &value, bool &bMeasurementStates);
 	bool parseBlocklyActions(const _tEventItem &item);
 	std::string ProcessVariableArgument(const std::string &Argument);
 #ifdef ENABLE_PYTHON
 	std::string m_python_Dir;
 	void EvaluatePython(const _tEventQueue &item, const std::string &filename, const std::string &PyString);
+	void EvaluatePython(const std::vector<std::pair<_tEventQueue, std::string>> &scripts);
 #endif
 	void EvaluateLua(const _tEventQueue &item, const std::string &filename, const std::string &LuaString);
 	void EvaluateLua(const std::vector<_tEventQueue> &items, const std::string &filename, const std::string &LuaString);
-	void luaThread(lua_State *lua_state, const std::string &filename);
+	void ExecuteLua(const std::vector<_tEventQueue> &items, const std::string &filename, const std::string &LuaString);
+	void luaThread(lua_State *lua_state, const std::string &filename, const bool bdzVents);
 	static void luaStop(lua_State *L, lua_Debug *ar);
 	std::string nValueToWording(uint8_t dType, uint8_t dSubType, _eSwitchType switchtype, int nValue, const std::string &sValue, const std::map<std::string, std::string> &options);
 	static int l_domoticz_print(lua_State* lua_state);
@@ -9,6 +9,8 @@
 #include "../hardware/plugins/Plugins.h"
 
 #include <fstream>
+#include <iterator>
+#include <sys/stat.h>
 
 #ifdef ENABLE_PYTHON
 
@@ -41,8 +43,217 @@ namespace Plugins
 		return 0;
 	}
 
-	// Module methods
+	// DomoticzEvents.Devices, a read-only mapping of device name to PDevice backed by the event system device states.
+	// Device objects are only built for the names a script actually looks up.
+	typedef struct
+	{
+		PyObject_HEAD
+	} PDeviceMap;
+
+	PyObject *pDeviceMapType;
+	PyObject *m_pKeyError = nullptr;
+	std::map<std::string, uint64_t> m_DeviceNames;
+
+	static PyObject *DeviceObject(const CEventSystem::_tDeviceStatus &sitem)
+	{
+		PyNewRef nrArgList = Py_BuildValue("(isiiisiss)", static_cast<int>(sitem.ID),
+			sitem.deviceName.c_str(),
+			sitem.devType,
+			sitem.subType,
+			sitem.switchtype,
+			sitem.sValue.c_str(),
+			sitem.nValue,
+			sitem.nValueWording.c_str(),
+			sitem.lastUpdate.c_str());
+		if (!nrArgList)
+		{
+			_log.Log(LOG_ERROR, "Python EventSystem: Building device argument list failed for key %s.", sitem.deviceName.c_str());
+			return nullptr;
+		}
+		PyObject *pDevice = PyObject_CallObject((PyObject*)pDeviceType, nrArgList);
+		if (!pDevice)
+		{
+			_log.Log(LOG_ERROR, "Python EventSystem: Event Device object creation failed for key %s.", sitem.deviceName.c_str());
+		}
+		return pDevice;
+	}
 
+	static void RefreshDeviceNames()
+	{
+		std::vector<std::pair<std::string, uint64_t>> names;
+		m_mainworker.m_eventsystem.GetDeviceStateNames(names);
+		m_DeviceNames.clear();
+		for (const auto &name : names)
+			m_DeviceNames[name.first] = name.second;
+	}
+
+	static bool FindDevice(const std::string &name, CEventSystem::_tDeviceStatus &sitem)
+	{
+		auto itt = m_DeviceNames.find(name);
+		if ((itt != m_DeviceNames.end()) && m_mainworker.m_eventsystem.GetDeviceState(itt->second, sitem) && (sitem.deviceName == name))
+			return true;
+
+		// unknown name or the device was renamed or removed since the index was built
+		RefreshDeviceNames();
+		itt = m_DeviceNames.find(name);
+		return (itt != m_DeviceNames.end()) && m_mainworker.m_eventsystem.GetDeviceState(itt->second, sitem);
+	}
+
+	static Py_ssize_t PDeviceMap_length(PyObject *self)
+	{
+		return (Py_ssize_t)m_mainworker.m_eventsystem.GetDeviceStateCount();
+	}
+
+	static PyObject *PDeviceMap_subscript(PyObject *self, PyObject *key)
+	{
+		const char *name = PyUnicode_AsUTF8(key);
+		if (!name)
+			return nullptr;
+
+		CEventSystem::_tDeviceStatus sitem;
+		if (!FindDevice(name, sitem))
+		{
+			if (!m_pKeyError)
+			{
+				PyNewRef pBuiltins = PyImport_ImportModule("builtins");
+				if (pBuiltins)
+					m_pKeyError = PyObject_GetAttrString(pBuiltins, "KeyError");
+			}
+			if (m_pKeyError)
+				PyErr_SetString(m_pKeyError, name);
+			return nullptr;
+		}
+		return DeviceObject(sitem);
+	}
+
+	static int PDeviceMap_contains(PyObject *self, PyObject *key)
+	{
+		const char *name = PyUnicode_AsUTF8(key);
+		if (!name)
+		{
+			PyErr_Clear();
+			return 0;
+		}
+		CEventSystem::_tDeviceStatus sitem;
+		return FindDevice(name, sitem) ? 1 : 0;
+	}
+
+	static PyObject *PDeviceMap_keys(PyObject *self, PyObject *args)
+	{
+		RefreshDeviceNames();
+		PyObject *pList = PyList_New(0);
+		if (!pList)
+			return nullptr;
+		for (const auto &name : m_DeviceNames)
+		{
+			PyNewRef pKey = PyUnicode_FromString(name.first.c_str());
+			PyList_Append(pList, pKey);
+		}
+		return pList;
+	}
+
+	static PyObject *PDeviceMap_values(PyObject *self, PyObject *args)
+	{
+		RefreshDeviceNames();
+		PyObject *pList = PyList_New(0);
+		if (!pList)
+			return nullptr;
+		CEventSystem::_tDeviceStatus sitem;
+		for (const auto &name : m_DeviceNames)
+		{
+			if (!m_mainworker.m_eventsystem.GetDeviceState(name.second, sitem))
+				continue;
+			PyNewRef pDevice = DeviceObject(sitem);
+			if (pDevice)
+				PyList_Append(pList, pDevice);
+		}
+		return pList;
+	}
+
+	static PyObject *PDeviceMap_items(PyObject *self, PyObject *args)
+	{
+		RefreshDeviceNames();
+		PyObject *pList = PyList_New(0);
+		if (!pList)
+			return nullptr;
+		CEventSystem::_tDeviceStatus sitem;
+		for (const auto &name : m_DeviceNames)
+		{
+			if (!m_mainworker.m_eventsystem.GetDeviceState(name.second, sitem))
+				continue;
+			PyNewRef pDevice = DeviceObject(sitem);
+			if (!pDevice)
+				continue;
+			PyNewRef pItem = Py_BuildValue("(sO)", name.first.c_str(), (PyObject*)pDevice);
+			if (pItem)
+				PyList_Append(pList, pItem);
+		}
+		return pList;
+	}
+
+	static PyObject *PDeviceMap_get(PyObject *self, PyObject *args)
+	{
+		char *name;
+		PyObject *pDefault = nullptr;
+		if (!PyArg_ParseTuple(args, "s|O", &name, &pDefault))
+			return nullptr;
+
+		CEventSystem::_tDeviceStatus sitem;
+		if (FindDevice(name, sitem))
+			return DeviceObject(sitem);
+		if (!pDefault)
+			pDefault = Py_None;
+		Py_INCREF(pDefault);
+		return pDefault;
+	}
+
+	static PyObject *PDeviceMap_iter(PyObject *self)
+	{
+		PyNewRef pKeys = PDeviceMap_keys(self, nullptr);
+		if (!pKeys)
+			return nullptr;
+		return PyObject_GetIter(pKeys);
+	}
+
+	static void PDeviceMap_dealloc(PyObject *self)
+	{
+		PyObject *pType = PyObject_Type(self);
+		freefunc pFree = (freefunc)PyType_GetSlot((PyTypeObject *)pType, Py_tp_free);
+		pFree(self);
+		Py_XDECREF(pType);
+	}
+
+	static PyMethodDef PDeviceMap_methods[] = {
+		{ "keys", (PyCFunction)PDeviceMap_keys, METH_NOARGS, "Names of all devices." },
+		{ "values", (PyCFunction)PDeviceMap_values, METH_NOARGS, "All devices." },
+		{ "items", (PyCFunction)PDeviceMap_items, METH_NOARGS, "(name, device) pairs of all devices." },
+		{ "get", (PyCFunction)PDeviceMap_get, METH_VARARGS, "Device by name, default when there is no such device." },
+		{ nullptr, nullptr, 0, nullptr } };
+
+	// Compiled event scripts, recompiled when the file (or the web editor source) changes
+	struct _tCompiledScript
+	{
+		PyObject *pCode = nullptr;
+		time_t mtime = 0;
+		int64_t size = 0;
+		size_t hash = 0;
+	};
+	std::map<std::string, _tCompiledScript> m_CompiledScripts;
+	PyObject *m_pStdErrRedirectCode = nullptr;
+
+	void ClearCompiledScripts()
+	{
+		for (auto &script : m_CompiledScripts)
+			Py_XDECREF(script.second.pCode);
+		m_CompiledScripts.clear();
+		Py_XDECREF(m_pStdErrRedirectCode);
+		m_pStdErrRedirectCode = nullptr;
+		Py_XDECREF(m_pKeyError);
+		m_pKeyError = nullptr;
+		m_DeviceNames.clear();
+	}
+
+	// Module methods
 	static PyObject *PyDomoticz_EventsLog(PyObject *self, PyObject *args)
 	{
 		PyBorrowedRef	pArg(args);
@@ -149,6 +360,26 @@ namespace Plugins
 
 		PyModule_AddObject(pModule, "PDevice", pDeviceType);	// PyModule_AddObject steals a reference
 
+		PyType_Slot PDeviceMapSlots[] = {
+			{ Py_tp_doc, (void*)"Devices by name" },
+			{ Py_tp_dealloc, (void*)PDeviceMap_dealloc },
+			{ Py_tp_iter, (void*)PDeviceMap_iter },
+			{ Py_tp_methods, PDeviceMap_methods },
+			{ Py_mp_length, (void*)PDeviceMap_length },
+			{ Py_mp_subscript, (void*)PDeviceMap_subscript },
+			{ Py_sq_contains, (void*)PDeviceMap_contains },
+			{ 0, nullptr },
+		};
+		PyType_Spec DeviceMapSpec = { "DomoticzEvents.DeviceMap", sizeof(PDeviceMap), 0, Py_TPFLAGS_DEFAULT, PDeviceMapSlots };
+
+		pDeviceMapType = PyType_FromSpec(&DeviceMapSpec);
+		if (PyType_Ready((PyTypeObject*)pDeviceMapType) < 0)
+		{
+			_log.Log(LOG_ERROR, "Python EventSystem: Unable to ready 'DeviceMap objects'.");
+		}
+
+		PyModule_AddObject(pModule, "DeviceMap", pDeviceMapType);
+
 		return pModule;
 	}
 
@@ -208,6 +439,7 @@ namespace Plugins
 		if (m_PyInterpreter)
 		{
 			PyEval_RestoreThread((PyThreadState *)m_PyInterpreter);
+			ClearCompiledScripts();
 			if (Plugins::Py_IsInitialized())
 				Py_EndInterpreter((PyThreadState *)m_PyInterpreter);
 			m_PyInterpreter = nullptr;
@@ -306,9 +538,58 @@ namespace Plugins
 		PyErr_Clear();
 	}
 
-	void PythonEventsProcessPython(const std::string& reason, const std::string& filename, const std::string& PyString,
-		const uint64_t DeviceID, std::map<uint64_t, CEventSystem::_tDeviceStatus> deviceStates,
-		std::map<uint64_t, CEventSystem::_tUserVariable> userVariables, int intSunRise, int intSunSet)
+	// Returns a borrowed reference to the compiled script, nullptr when it could not be read or compiled
+	PyObject *GetCompiledScript(const _tPythonEvent &event)
+	{
+		_tCompiledScript &script = m_CompiledScripts[event.filename];
+		std::string sSource;
+		if (!event.PyString.empty())
+		{
+			// Python-string from WebEditor
+			size_t hash = std::hash<std::string>()(event.PyString);
+			if (script.pCode && (script.hash == hash))
+				return script.pCode;
+			script.hash = hash;
+			sSource = event.PyString;
+		}
+		else
+		{
+			// Script-file
+			struct stat st;
+			if (stat(event.filename.c_str(), &st) != 0)
+			{
+				_log.Log(LOG_ERROR, "EventSystem: Failed to open python script file '%s'", event.filename.c_str());
+				return nullptr;
+			}
+			if (script.pCode && (script.mtime == st.st_mtime) && (script.size == (int64_t)st.st_size))
+				return script.pCode;
+
+			std::ifstream PythonScriptFile(event.filename.c_str());
+			if (!PythonScriptFile.is_open())
+			{
+				_log.Log(LOG_ERROR, "EventSystem: Failed to open python script file '%s'", event.filename.c_str());
+				return nullptr;
+			}
+			sSource.assign(std::istreambuf_iterator<char>(PythonScriptFile), std::istreambuf_iterator<char>());
+			PythonScriptFile.close();
+			script.mtime = st.st_mtime;
+			script.size = (int64_t)st.st_size;
+		}
+
+		Py_XDECREF(script.pCode);
+		script.pCode = Py_CompileString(sSource.c_str(), event.filename.c_str(), Py_file_input);
+		if (!script.pCode)
+		{
+			if (!event.PyString.empty())
+				_log.Log(LOG_ERROR, "EventSystem: Failed to compile python '%s' event script '%s'", event.reason.c_str(), event.filename.c_str());
+			else
+				_log.Log(LOG_ERROR, "EventSystem: Failed to compile python '%s' event script file '%s'", event.reason.c_str(), event.filename.c_str());
+		}
+		return script.pCode;
+	}
+
+	void PythonEventsProcessPython(const std::vector<_tPythonEvent> &events, const std::map<uint64_t, CEventSystem::_tUserVariable> &userVariables, int intSunRise,
+				       int intSunSet)
 	{
 		if (!m_ModuleInitialized)
 		{
@@ -347,62 +628,16 @@ namespace Plugins
 				}
 			}
 
-
-			PyNewRef	pStrVal = PyUnicode_FromString(deviceStates[DeviceID].deviceName.c_str());
-			if (PyDict_SetItemString(pModuleDict, "changed_device_name", pStrVal) == -1)
-			{
-				_log.Log(LOG_ERROR, "Python EventSystem: Failed to set changed_device_name.");
-				return;
-			}
-
-			PyNewRef	pDeviceDict = PyDict_New();
-			if (PyDict_SetItemString(pModuleDict, "Devices", pDeviceDict) == -1)
+			// Devices reads from the event system device states on access instead of being a copy of all of them
+			PyBorrowedRef	pDevices = PyDict_GetItemString(pModuleDict, "Devices");
+			if (!pDevices || !PyObject_IsInstance(pDevices, pDeviceMapType))
 			{
-				_log.Log(LOG_ERROR, "Python EventSystem: Failed to add Device dictionary.");
-				PyEval_SaveThread();
-				return;
-			}
-
-			for (auto it_type = deviceStates.begin(); it_type != deviceStates.end(); ++it_type)
-			{
-				CEventSystem::_tDeviceStatus sitem = it_type->second;
-
-				PyNewRef nrArgList = Py_BuildValue("(isiiisiss)", static_cast<int>(sitem.ID),
-					sitem.deviceName.c_str(),
-					sitem.devType,
-					sitem.subType,
-					sitem.switchtype,
-					sitem.sValue.c_str(),
-					sitem.nValue,
-					sitem.nValueWording.c_str(),
-					sitem.lastUpdate.c_str());
-				if (!nrArgList)
+				PyNewRef	pDeviceMap = PyType_GenericAlloc((PyTypeObject*)pDeviceMapType, 0);
+				if (!pDeviceMap || (PyDict_SetItemString(pModuleDict, "Devices", pDeviceMap) == -1))
 				{
-					_log.Log(LOG_ERROR, "Python EventSystem: Building device argument list failed for key %s.", sitem.deviceName.c_str());
-					continue;
-				}
-				PyNewRef pDevice = PyObject_CallObject((PyObject*)pDeviceType, nrArgList);
-				if (!pDevice)
-				{
-					_log.Log(LOG_ERROR, "Python EventSystem: Event Device object creation failed for key %s.", sitem.deviceName.c_str());
-					continue;
-				}
-
-				if (sitem.ID == DeviceID)
-				{
-					if (PyDict_SetItemString(pModuleDict, "changed_device", (PyObject*)pDevice) == -1)
-					{
-						_log.Log(LOG_ERROR,
-							"Python EventSystem: Failed to add device '%s' as changed_device.",
-							sitem.deviceName.c_str());
-					}
-				}
-
-				PyNewRef	pKey = PyUnicode_FromString(sitem.deviceName.c_str());
-				if (PyDict_SetItem(pDeviceDict, pKey, (PyObject*)pDevice) == -1)
-				{
-					_log.Log(LOG_ERROR, "Python EventSystem: Failed to add device '%s' to device dictionary.",
-						sitem.deviceName.c_str());
+					_log.Log(LOG_ERROR, "Python EventSystem: Failed to add Device mapping.");
+					PyEval_SaveThread();
+					return;
 				}
 			}
 
@@ -465,124 +700,112 @@ namespace Plugins
 				return;
 			}
 
-			for (auto it_var = userVariables.begin(); it_var != userVariables.end(); ++it_var)
+			for (const auto &var : userVariables)
 			{
-				CEventSystem::_tUserVariable uvitem = it_var->second;
-				PyDict_SetItemString(userVariablesDict, uvitem.variableName.c_str(),
-					PyUnicode_FromString(uvitem.variableValue.c_str()));
+				PyNewRef	pValue = PyUnicode_FromString(var.second.variableValue.c_str());
+				PyDict_SetItemString(userVariablesDict, var.second.variableName.c_str(), pValue);
 			}
 
 			// Add __main__ module
 			PyBorrowedRef	pMainModule = PyImport_AddModule("__main__");
 			PyBorrowedRef	global_dict = PyModule_GetDict(pMainModule);
-			PyNewRef		local_dict = PyDict_New();
 
-			// Override sys.stderr
+			for (const auto &event : events)
 			{
-				PyNewRef	pCode = Py_CompileString("import sys\nclass StdErrRedirect:\n    def __init__(self):\n        "
-					"self.buffer = ''\n    def write(self, "
-					"msg):\n        self.buffer += msg\nstdErrRedirect = "
-					"StdErrRedirect()\nsys.stderr = stdErrRedirect\n",
-					filename.c_str(), Py_file_input);
-				if (pCode)
+				CEventSystem::_tDeviceStatus sitem;
+				bool bDeviceFound = m_mainworker.m_eventsystem.GetDeviceState(event.DeviceID, sitem);
+
+				PyNewRef	pStrVal = PyUnicode_FromString(bDeviceFound ? sitem.deviceName.c_str() : "");
+				if (PyDict_SetItemString(pModuleDict, "changed_device_name", pStrVal) == -1)
 				{
-					PyNewRef	pEval = PyEval_EvalCode(pCode, global_dict, local_dict);
+					_log.Log(LOG_ERROR, "Python EventSystem: Failed to set changed_device_name.");
+					continue;
 				}
-				else
+
+				// None when the device is not found, so the one of the previous event does not linger
+				PyNewRef pDevice;
+				if (bDeviceFound)
 				{
-					_log.Log(LOG_ERROR, "EventSystem: Failed to compile stderror redirection for event script '%s'", reason.c_str());
+					pDevice = DeviceObject(sitem);
+					if (!pDevice)
+						_log.Log(LOG_ERROR, "Python EventSystem: Failed to add device '%s' as changed_device.", sitem.deviceName.c_str());
+				}
+				if (PyDict_SetItemString(pModuleDict, "changed_device", pDevice ? (PyObject *)pDevice : Py_None) == -1)
+				{
+					_log.Log(LOG_ERROR, "Python EventSystem: Failed to set changed_device.");
 				}
-			}
 
-			if (!PyErr_Occurred() && (PyString.length() > 0))
-			{
-				// Python-string from WebEditor
-				PyNewRef	pCode = Py_CompileString(PyString.c_str(), filename.c_str(), Py_file_input);
-				if (pCode)
+				PyNewRef	local_dict = PyDict_New();
+
+				// Override sys.stderr
+				if (!m_pStdErrRedirectCode)
 				{
-					PyNewRef	pEval = PyEval_EvalCode(pCode, global_dict, local_dict);
+					m_pStdErrRedirectCode = Py_CompileString("import sys\nclass StdErrRedirect:\n    def __init__(self):\n        "
+						"self.buffer = ''\n    def write(self, "
+						"msg):\n        self.buffer += msg\nstdErrRedirect = "
+						"StdErrRedirect()\nsys.stderr = stdErrRedirect\n",
+						"<domoticz>", Py_file_input);
 				}
-				else
+				if (m_pStdErrRedirectCode)
 				{
-					_log.Log(LOG_ERROR, "EventSystem: Failed to compile python '%s' event script '%s'", reason.c_str(), filename.c_str());
+					PyNewRef	pEval = PyEval_EvalCode(m_pStdErrRedirectCode, global_dict, local_dict);
 				}
-			}
-			else
-			{
-				// Script-file
-				std::ifstream PythonScriptFile(filename.c_str());
-				if (PythonScriptFile.is_open())
+				else
 				{
-					char	PyLine[256];
-					std::string	PyString;
-					while (PythonScriptFile.getline(PyLine, sizeof(PyLine), '\n'))
-					{
-						PyString.append(PyLine);
-						PyString += '\n';
-					}
-					PythonScriptFile.close();
+					_log.Log(LOG_ERROR, "EventSystem: Failed to compile stderror redirection for event script '%s'", event.reason.c_str());
+				}
 
-					PyNewRef	pCode = Py_CompileString(PyString.c_str(), filename.c_str(), Py_file_input);
+				if (!PyErr_Occurred())
+				{
+					PyObject *pCode = GetCompiledScript(event);
 					if (pCode)
 					{
 						PyNewRef	pEval = PyEval_EvalCode(pCode, global_dict, local_dict);
 					}
-					else
-					{
-						_log.Log(LOG_ERROR, "EventSystem: Failed to compile python '%s' event script file '%s'", reason.c_str(), filename.c_str());
-					}
 				}
-				else
+
+				// Log any exceptions
+				if (PyErr_Occurred())
 				{
-					_log.Log(LOG_ERROR, "EventSystem: Failed to open python script file '%s'", filename.c_str());
+					LogPythonException();
 				}
-			}
 
-			// Log any exceptions
-			if (PyErr_Occurred())
-			{
-				LogPythonException();
-			}
-
-			// Get message from stderr redirect
-			std::string logString;
-			if (PyObject_HasAttrString(pModule, "stdErrRedirect"))
-			{
-				PyNewRef	stdErrRedirect = PyObject_GetAttrString(pModule, "stdErrRedirect");
-				if (PyObject_HasAttrString(stdErrRedirect, "buffer"))
+				// Get message from stderr redirect
+				std::string logString;
+				if (PyObject_HasAttrString(pModule, "stdErrRedirect"))
 				{
-					PyNewRef	logBuffer = PyObject_GetAttrString(stdErrRedirect, "buffer");
-					PyNewRef	logBytes = PyUnicode_AsUTF8String(logBuffer);
-					if (logBytes)
+					PyNewRef	stdErrRedirect = PyObject_GetAttrString(pModule, "stdErrRedirect");
+					if (PyObject_HasAttrString(stdErrRedirect, "buffer"))
 					{
-						logString.append(PyBytes_AsString(logBytes));
+						PyNewRef	logBuffer = PyObject_GetAttrString(stdErrRedirect, "buffer");
+						PyNewRef	logBytes = PyUnicode_AsUTF8String(logBuffer);
+						if (logBytes)
+						{
+							logString.append(PyBytes_AsString(logBytes));
+						}
 					}
 				}
-			}
 
-			// Check if there were some errors written to stderr
-			if (logString.length() > 0)
-			{
-				// Print error source
-				_log.Log(LOG_ERROR, "EventSystem: Failed to execute python event script \"%s\"", filename.c_str());
-
-				// Loop over all lines of the error message
-				std::size_t lineBreakPos;
-				while ((lineBreakPos = logString.find('\n')) != std::string::npos)
+				// Check if there were some errors written to stderr
+				if (logString.length() > 0)
 				{
-					// Print line
-					_log.Log(LOG_ERROR, "EventSystem: %s", logString.substr(0, lineBreakPos).c_str());
+					// Print error source
+					_log.Log(LOG_ERROR, "EventSystem: Failed to execute python event script \"%s\"", event.filename.c_str());
 
-					// Remove line from buffer
-					logString = logString.substr(lineBreakPos + 1);
+					// Loop over all lines of the error message
+					std::size_t lineBreakPos;
+					while ((lineBreakPos = logString.find('\n')) != std::string::npos)
+					{
+						// Print line
+						_log.Log(LOG_ERROR, "EventSystem: %s", logString.substr(0, lineBreakPos).c_str());
+
+						// Remove line from buffer
+						logString = logString.substr(lineBreakPos + 1);
+					}
 				}
 			}
 
 			// Empty dictionaries to free memory
-			if (pDeviceDict.IsDict())
-			{
-				PyDict_Clear(pDeviceDict);
-			}
 			if (userVariablesDict.IsDict())
 			{
 				PyDict_Clear(userVariablesDict);
@@ -12,11 +12,18 @@
         static PyObject*    PyDomoticz_EventsLog(PyObject *self, PyObject *args);
         static PyObject*	PyDomoticz_EventsCommand(PyObject *self, PyObject *args);
 
+	struct _tPythonEvent
+	{
+		std::string reason;
+		std::string filename;
+		std::string PyString; // script from the web editor, empty for script files
+		uint64_t DeviceID;
+	};
+
 	PyObject *PythonEventsGetModule();
 	bool PythonEventsInitialize(const std::string &szUserDataFolder);
 	bool PythonEventsStop();
-	void PythonEventsProcessPython(const std::string &reason, const std::string &filename, const std::string &PyString, uint64_t DeviceID,
-				       std::map<uint64_t, CEventSystem::_tDeviceStatus> m_devicestates, std::map<uint64_t, CEventSystem::_tUserVariable> m_uservariables, int intSunRise,
+	void PythonEventsProcessPython(const std::vector<_tPythonEvent> &events, const std::map<uint64_t, CEventSystem::_tUserVariable> &userVariables, int intSunRise,
 				       int intSunSet);
     } // namespace Plugins
 #endif
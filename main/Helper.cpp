@@ -1266,6 +1266,17 @@ uint32_t SystemUptime()
 #endif
 }
 
+// CPU time used by the calling thread in microseconds, wall time where the platform has no per thread clock
+uint64_t ThreadCPUTimeUs()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+		return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // True random number generator (source: http://www.azillionmonkeys.com/qed/random.html)
 static struct
 {
@@ -127,6 +127,7 @@ int timeval_subtract (struct timeval *result, struct timeval *x, struct timeval
 
 bool IsArgumentSecure(const std::string &arg);
 uint32_t SystemUptime();
+uint64_t ThreadCPUTimeUs();
 int GenerateRandomNumber(int range);
 int GetDirFilesRecursive(const std::string &DirPath, std::map<std::string, int> &_Files);
 
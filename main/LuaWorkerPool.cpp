@@ -0,0 +1,91 @@
+#include "stdafx.h"
+#include "LuaWorkerPool.h"
+#include "Helper.h"
+#include "Logger.h"
+
+CLuaWorkerPool::~CLuaWorkerPool()
+{
+	Stop();
+}
+
+void CLuaWorkerPool::Start(const int iWorkers)
+{
+	Stop();
+	std::lock_guard<std::mutex> l(m_mutex);
+	m_bStop = false;
+	for (int ii = 0; ii < iWorkers; ii++)
+	{
+		m_workers.push_back(std::make_shared<std::thread>([this] { Do_Work(); }));
+		SetThreadName(m_workers.back()->native_handle(), LUAWORKERS_THREAD_NAME);
+	}
+}
+
+void CLuaWorkerPool::Stop()
+{
+	std::vector<std::shared_ptr<std::thread>> workers;
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		m_bStop = true;
+		m_jobs.clear();
+		workers.swap(m_workers);
+	}
+	m_cond.notify_all();
+	for (auto &worker : workers)
+		worker->join();
+}
+
+void CLuaWorkerPool::Post(const std::string &key, const std::function<void()> &job)
+{
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		if (m_workers.empty())
+			return;
+		m_jobs.push_back({ key, job });
+	}
+	m_cond.notify_all();
+}
+
+bool CLuaWorkerPool::WaitIdle(const int iTimeoutMs)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_cond.wait_for(lock, std::chrono::milliseconds(iTimeoutMs), [this] { return m_jobs.empty() && m_busy.empty(); });
+}
+
+void CLuaWorkerPool::Do_Work()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_bStop)
+	{
+		// the oldest job whose key is not running already
+		auto next = m_jobs.begin();
+		while ((next != m_jobs.end()) && (m_busy.find(next->key) != m_busy.end()))
+			++next;
+		if (next == m_jobs.end())
+		{
+			m_cond.wait(lock);
+			continue;
+		}
+
+		_tJob job = std::move(*next);
+		m_jobs.erase(next);
+		m_busy.insert(job.key);
+		lock.unlock();
+
+		try
+		{
+			job.func();
+		}
+		catch (std::exception &e)
+		{
+			_log.Log(LOG_ERROR, "EventSystem: Exception in script worker: %s", e.what());
+		}
+		catch (...)
+		{
+			_log.Log(LOG_ERROR, "EventSystem: Unknown exception in script worker");
+		}
+
+		lock.lock();
+		m_busy.erase(job.key);
+		m_cond.notify_all();
+	}
+}
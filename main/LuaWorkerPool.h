@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Noncopyable.h"
+
+#define LUAWORKERS_THREAD_NAME "EventLuaWorker"
+#define LUAWORKERS_COUNT 4
+
+// A small pool of threads running event scripts concurrently.
+// Jobs posted with the same key run one at a time in the order they were posted,
+// so the scripts triggered by one device still see its updates in sequence.
+class CLuaWorkerPool : private domoticz::noncopyable
+{
+      public:
+	CLuaWorkerPool() = default;
+	~CLuaWorkerPool();
+
+	void Start(int iWorkers);
+	// Pending jobs are dropped, running ones are waited for
+	void Stop();
+	void Post(const std::string &key, const std::function<void()> &job);
+	// Wait until no job is pending or running, false on timeout
+	bool WaitIdle(int iTimeoutMs);
+
+      private:
+	void Do_Work();
+
+	struct _tJob
+	{
+		std::string key;
+		std::function<void()> func;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::list<_tJob> m_jobs;
+	std::set<std::string> m_busy;
+	bool m_bStop = false;
+	std::vector<std::shared_ptr<std::thread>> m_workers;
+};
@@ -48,13 +48,137 @@ const char* findTableID1ID2(const _STR_TABLE_ID1_ID2* t, const unsigned long id1
 	return "Unknown";
 }
 
+// Lookup index over a constant STR_TABLE_SINGLE, built at compile time. For every id it holds the
+// position of the first matching entry so a lookup is a direct array access instead of a table
+// scan. Like findTableIDSingle1/2 the table ends at the first entry without str1 (resp. str2).
+struct STR_INDEX_SINGLE
+{
+	const STR_TABLE_SINGLE* table;
+	uint8_t pos1[256];
+	uint8_t pos2[256];
+
+	template <size_t N>
+	constexpr explicit STR_INDEX_SINGLE(const STR_TABLE_SINGLE (&t)[N])
+		: table(t)
+		, pos1{}
+		, pos2{}
+	{
+		if (N >= 0xFF)
+			throw std::out_of_range("table too large for STR_INDEX_SINGLE");
+		for (int ii = 0; ii < 256; ii++)
+		{
+			pos1[ii] = 0xFF;
+			pos2[ii] = 0xFF;
+		}
+		for (size_t ii = 0; (ii < N) && (t[ii].str1 != nullptr); ii++)
+		{
+			if (t[ii].id > 0xFF)
+				throw std::out_of_range("table id too large for STR_INDEX_SINGLE");
+			if (pos1[t[ii].id] == 0xFF)
+				pos1[t[ii].id] = (uint8_t)ii;
+		}
+		for (size_t ii = 0; (ii < N) && (t[ii].str2 != nullptr); ii++)
+		{
+			if (t[ii].id > 0xFF)
+				throw std::out_of_range("table id too large for STR_INDEX_SINGLE");
+			if (pos2[t[ii].id] == 0xFF)
+				pos2[t[ii].id] = (uint8_t)ii;
+		}
+	}
+
+	const char* Find1(const unsigned long id) const
+	{
+		if ((id > 0xFF) || (pos1[id] == 0xFF))
+			return "Unknown";
+		return table[pos1[id]].str1;
+	}
+
+	const char* Find2(const unsigned long id) const
+	{
+		if ((id > 0xFF) || (pos2[id] == 0xFF))
+			return "Unknown";
+		return table[pos2[id]].str2;
+	}
+};
+
+// Lookup index over a constant STR_TABLE_ID1_ID2, built at compile time. The entries are stable
+// sorted on (id1, id2) and the start of every id1 range is stored, so a lookup is a direct access
+// on id1 followed by a binary search on id2 that still returns the first matching table entry.
+template <size_t N>
+struct STR_INDEX_ID1_ID2
+{
+	const STR_TABLE_ID1_ID2* table;
+	uint16_t sorted[N];
+	uint16_t id1start[257];
+
+	constexpr explicit STR_INDEX_ID1_ID2(const STR_TABLE_ID1_ID2 (&t)[N])
+		: table(t)
+		, sorted{}
+		, id1start{}
+	{
+		size_t count = 0;
+		while ((count < N) && (t[count].str1 != nullptr))
+		{
+			if ((t[count].id1 > 0xFF) || (t[count].id2 > 0xFF))
+				throw std::out_of_range("table id too large for STR_INDEX_ID1_ID2");
+			count++;
+		}
+		// insertion sort, the tables are mostly grouped on id1 already
+		for (size_t ii = 0; ii < count; ii++)
+		{
+			const unsigned long key = (t[ii].id1 << 8) | t[ii].id2;
+			size_t jj = ii;
+			while ((jj > 0) && (((t[sorted[jj - 1]].id1 << 8) | t[sorted[jj - 1]].id2) > key))
+			{
+				sorted[jj] = sorted[jj - 1];
+				jj--;
+			}
+			sorted[jj] = (uint16_t)ii;
+		}
+		size_t pos = 0;
+		for (unsigned long id1 = 0; id1 < 256; id1++)
+		{
+			while ((pos < count) && (t[sorted[pos]].id1 < id1))
+				pos++;
+			id1start[id1] = (uint16_t)pos;
+		}
+		id1start[256] = (uint16_t)count;
+	}
+
+	const char* Find(const unsigned long id1, const unsigned long id2) const
+	{
+		if ((id1 > 0xFF) || (id2 > 0xFF))
+			return "Unknown";
+		size_t lo = id1start[id1];
+		size_t hi = id1start[id1 + 1];
+		while (lo < hi)
+		{
+			const size_t mid = (lo + hi) / 2;
+			if (table[sorted[mid]].id2 < id2)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if ((lo < id1start[id1 + 1]) && (table[sorted[lo]].id2 == id2))
+			return table[sorted[lo]].str1;
+		return "Unknown";
+	}
+};
+
+template <size_t N>
+constexpr STR_INDEX_ID1_ID2<N> MakeTableIndex(const STR_TABLE_ID1_ID2 (&t)[N])
+{
+	return STR_INDEX_ID1_ID2<N>(t);
+}
+
 const char* RFX_Humidity_Status_Desc(const unsigned char status)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ humstat_normal, "Normal" }, { humstat_comfort, "Comfortable" }, { humstat_dry, "Dry" }, { humstat_wet, "Wet" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, status);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(status);
 }
 
 unsigned char Get_Humidity_Level(const unsigned char hlevel)
@@ -70,7 +194,7 @@ unsigned char Get_Humidity_Level(const unsigned char hlevel)
 
 const char* Security_Status_Desc(const unsigned char status)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ sStatusNormal, "Normal" },
 		{ sStatusNormalDelayed, "Normal Delayed" },
 		{ sStatusAlarm, "Alarm" },
@@ -100,12 +224,13 @@ const char* Security_Status_Desc(const unsigned char status)
 		{ sStatusNoMotionTamper, "No Motion + Tamper" },
 		{ 0, nullptr },
 	};
-	return findTableIDSingle1(Table, status);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(status);
 }
 
 const char* Timer_Type_Desc(const int tType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ TTYPE_BEFORESUNRISE, "Before Sunrise" },
 		{ TTYPE_AFTERSUNRISE, "After Sunrise" },
 		{ TTYPE_ONTIME, "On Time" },
@@ -136,21 +261,23 @@ const char* Timer_Type_Desc(const int tType)
 		{ TTYPE_AFTERASTTWEND, "After Astronomical Twilight End" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, tType);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(tType);
 }
 
 const char* Timer_Cmd_Desc(const int tType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ TCMD_ON, "On" },
 		{ TCMD_OFF, "Off" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, tType);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(tType);
 }
 
 //ID, Long description, short description
-static const STR_TABLE_SINGLE HardwareTypeTable[] = {
+static constexpr STR_TABLE_SINGLE HardwareTypeTable[] = {
 	{ HTYPE_RFXtrx315, "RFXCOM - RFXtrx315 USB 315MHz Transceiver", "RFXCOM" },
 	{ HTYPE_RFXtrx433, "RFXCOM - RFXtrx433 USB 433.92MHz Transceiver", "RFXCOM" },
 	{ HTYPE_RFXLAN, "RFXCOM - RFXtrx shared over LAN interface", "RFXCOM" },
@@ -281,20 +408,21 @@ static const STR_TABLE_SINGLE HardwareTypeTable[] = {
 	{ HTYPE_RFLINKMQTT, "RFLink Gateway MQTT",	"RFLink" },
 	{ 0, nullptr, nullptr },
 };
+static constexpr STR_INDEX_SINGLE HardwareTypeIndex(HardwareTypeTable);
 
 const char* Hardware_Type_Desc(int hType)
 {
-	return findTableIDSingle1(HardwareTypeTable, hType);
+	return HardwareTypeIndex.Find1(hType);
 }
 
 const char* Hardware_Short_Desc(int hType)
 {
-	return findTableIDSingle2(HardwareTypeTable, hType);
+	return HardwareTypeIndex.Find2(hType);
 }
 
 const char* Switch_Type_Desc(const _eSwitchType sType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ STYPE_OnOff, "On/Off" },
 		{ STYPE_Doorbell, "Doorbell" },
 		{ STYPE_Contact, "Contact" },
@@ -317,12 +445,13 @@ const char* Switch_Type_Desc(const _eSwitchType sType)
 		{ STYPE_BlindsPercentageWithStop, "Blinds + Stop" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, sType);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(sType);
 }
 
 const char* Meter_Type_Desc(const _eMeterType sType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ MTYPE_ENERGY, "Energy" },
 		{ MTYPE_GAS, "Gas" },
 		{ MTYPE_WATER, "Water" },
@@ -331,12 +460,13 @@ const char* Meter_Type_Desc(const _eMeterType sType)
 		{ MTYPE_TIME, "Time" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, sType);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(sType);
 }
 
 const char* Notification_Type_Desc(const int nType, const unsigned char snum)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ NTYPE_TEMPERATURE, "Temperature", "T" },
 		{ NTYPE_HUMIDITY, "Humidity", "H" },
 		{ NTYPE_RAIN, "Rain", "R" },
@@ -367,14 +497,15 @@ const char* Notification_Type_Desc(const int nType, const unsigned char snum)
 		{ NTYPE_LASTUPDATE, "Last Update", "J" },
 		{ 0, nullptr, nullptr },
 	};
+	static constexpr STR_INDEX_SINGLE Index(Table);
 	if (snum == 0)
-		return findTableIDSingle1(Table, nType);
-	return findTableIDSingle2(Table, nType);
+		return Index.Find1(nType);
+	return Index.Find2(nType);
 }
 
 const char* Notification_Type_Label(const int nType)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ NTYPE_TEMPERATURE, "degrees" },
 		{ NTYPE_HUMIDITY, "%" },
 		{ NTYPE_RAIN, "mm" },
@@ -405,21 +536,23 @@ const char* Notification_Type_Label(const int nType)
 		{ NTYPE_LASTUPDATE, "minutes" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, nType);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(nType);
 }
 
 const char* RFX_Forecast_Desc(const unsigned char Forecast)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ baroForecastNoInfo, "No Info" }, { baroForecastSunny, "Sunny" }, { baroForecastPartlyCloudy, "Partly Cloudy" },
 		{ baroForecastCloudy, "Cloudy" },  { baroForecastRain, "Rain" },   { 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, Forecast);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(Forecast);
 }
 
 const char* RFX_WSForecast_Desc(const unsigned char Forecast)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ wsbaroforecast_heavy_snow, "Heavy Snow" },
 		{ wsbaroforecast_snow, "Snow" },
 		{ wsbaroforecast_heavy_rain, "Heavy Rain" },
@@ -432,12 +565,13 @@ const char* RFX_WSForecast_Desc(const unsigned char Forecast)
 		{ wsbaroforecast_stable, "Stable" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, Forecast);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(Forecast);
 }
 
 const char* BMP_Forecast_Desc(const unsigned char Forecast)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ bmpbaroforecast_stable, "Stable" },
 		{ bmpbaroforecast_sunny, "Sunny" },
 		{ bmpbaroforecast_cloudy, "Cloudy" },
@@ -447,12 +581,13 @@ const char* BMP_Forecast_Desc(const unsigned char Forecast)
 		{ bmpbaroforecast_rain, "Cloudy/Rain" },
 		{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, Forecast);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(Forecast);
 }
 
 const char* RFX_Type_Desc(const unsigned char i, const unsigned char snum)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ pTypeInterfaceControl, "Interface Control", "unknown" },
 		{ pTypeInterfaceMessage, "Interface Message", "unknown" },
 		{ pTypeRecXmitMessage, "Receiver/Transmitter Message", "unknown" },
@@ -545,15 +680,16 @@ const char* RFX_Type_Desc(const unsigned char i, const unsigned char snum)
 		{ pTypeHunter, "Hunter", "Hunter" },
 		{ 0, nullptr, nullptr },
 	};
+	static constexpr STR_INDEX_SINGLE Index(Table);
 	if (snum == 1)
-		return findTableIDSingle1(Table, i);
+		return Index.Find1(i);
 
-	return findTableIDSingle2(Table, i);
+	return Index.Find2(i);
 }
 
 const char* RFX_Type_SubType_Desc(const unsigned char dType, const unsigned char sType)
 {
-	static const STR_TABLE_ID1_ID2 Table[] = {
+	static constexpr STR_TABLE_ID1_ID2 Table[] = {
 		{ pTypeTEMP, sTypeTEMP1, "THR128/138, THC138" },
 		{ pTypeTEMP, sTypeTEMP2, "THC238/268, THN132, THWR288, THRN122, THN122, AW129/131" },
 		{ pTypeTEMP, sTypeTEMP3, "THWR800" },
@@ -968,27 +1104,35 @@ const char* RFX_Type_SubType_Desc(const unsigned char dType, const unsigned char
 		{ pTypeGeneralSwitch, sSwitchTypeV2Phoenix, "V2Phoenix" },
 		{ 0, 0, nullptr },
 	};
-	return findTableID1ID2(Table, dType, sType);
+	static constexpr auto Index = MakeTableIndex(Table);
+	return Index.Find(dType, sType);
+}
+
+_tRFXTypeDesc RFX_Type_Descriptor(const unsigned char dType, const unsigned char sType)
+{
+	return { RFX_Type_Desc(dType, 1), RFX_Type_Desc(dType, 2), RFX_Type_SubType_Desc(dType, sType) };
 }
 
 const char* Media_Player_States(const _eMediaStatus Status)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ MSTAT_OFF, "Off" },		{ MSTAT_ON, "On" },	      { MSTAT_PAUSED, "Paused" },
 		{ MSTAT_STOPPED, "Stopped" },	{ MSTAT_VIDEO, "Video" },     { MSTAT_AUDIO, "Audio" },
 		{ MSTAT_PHOTO, "Photo" },	{ MSTAT_PLAYING, "Playing" }, { MSTAT_DISCONNECTED, "Disconnected" },
 		{ MSTAT_SLEEPING, "Sleeping" }, { MSTAT_UNKNOWN, "Unknown" }, { 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, Status);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(Status);
 }
 
 const char* ZWave_Clock_Days(const unsigned char Day)
 {
-	static const STR_TABLE_SINGLE Table[] = {
+	static constexpr STR_TABLE_SINGLE Table[] = {
 		{ 0, "Monday" }, { 1, "Tuesday" },  { 2, "Wednesday" }, { 3, "Thursday" },
 		{ 4, "Friday" }, { 5, "Saturday" }, { 6, "Sunday" },	{ 0, nullptr, nullptr },
 	};
-	return findTableIDSingle1(Table, Day);
+	static constexpr STR_INDEX_SINGLE Index(Table);
+	return Index.Find1(Day);
 }
 /*
 const char *ZWave_Thermostat_Modes[] =
@@ -261,6 +261,15 @@ enum _eNotificationTypes
 
 const char* RFX_Type_Desc(unsigned char i, unsigned char snum);
 const char* RFX_Type_SubType_Desc(unsigned char dType, unsigned char sType);
+
+struct _tRFXTypeDesc
+{
+	const char* Type;		// RFX_Type_Desc(dType, 1)
+	const char* TypeImg;	// RFX_Type_Desc(dType, 2)
+	const char* SubType;	// RFX_Type_SubType_Desc(dType, sType)
+};
+_tRFXTypeDesc RFX_Type_Descriptor(unsigned char dType, unsigned char sType);
+
 unsigned char Get_Humidity_Level(unsigned char hlevel);
 const char* RFX_Humidity_Status_Desc(unsigned char status);
 const char* Switch_Type_Desc(_eSwitchType sType);
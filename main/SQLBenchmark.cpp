@@ -0,0 +1,181 @@
+#include "stdafx.h"
+#include "SQLBenchmark.h"
+#include "Helper.h"
+#include "Logger.h"
+#include "SQLHelper.h"
+#include "WebServer.h"
+#include "json_helper.h"
+#include "../hardware/hardwaretypes.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+#define SQLBENCH_UPDATE_ROUNDS 5
+#define SQLBENCH_GRAPH_DEVICES 10
+
+CSQLBenchmark::CSQLBenchmark(const int Devices, const int Days)
+	: m_Devices(Devices)
+	, m_Days(Days)
+	, m_HardwareID(0)
+{
+}
+
+void CSQLBenchmark::Measure(const std::string &szName, const int Repeat, const std::function<void(int)> &Func)
+{
+	std::vector<double> samples;
+	for (int ii = 0; ii < Repeat; ii++)
+	{
+		auto tStart = std::chrono::steady_clock::now();
+		Func(ii);
+		samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count());
+	}
+	m_results.emplace_back(szName, samples);
+}
+
+//Half of the devices are temperature sensors, the other half counters. Every device gets m_Days of
+//5 minute short log and one calendar row per day, generated inside sqlite
+void CSQLBenchmark::GenerateDatabase()
+{
+	m_sql.safe_query("INSERT INTO Hardware (Name, Enabled, Type, Address, Port, Username, Password, Mode1, Mode2, Mode3, Mode4, Mode5, Mode6) VALUES ('SQL benchmark',0, %d,'',1,'','',0,0,0,0,0,0)",
+			 HTYPE_Dummy);
+	auto result = m_sql.safe_query("SELECT MAX(ID) FROM Hardware");
+	if (result.empty())
+		return;
+	m_HardwareID = atoi(result[0][0].c_str());
+
+	bool bTransaction = m_sql.BeginTransaction();
+	for (int ii = 0; ii < m_Devices; ii++)
+	{
+		bool bTemp = ((ii % 2) == 0);
+		m_sql.safe_query("INSERT INTO DeviceStatus (HardwareID, DeviceID, Unit, Name, Used, Type, SubType, SignalLevel, BatteryLevel, nValue, sValue) "
+				 "VALUES (%d, '%04X', 1, '%q %d', 1, %d, %d, 12, 255, 0, '%q')",
+				 m_HardwareID, ii + 1, bTemp ? "Temperature" : "Counter", ii + 1, bTemp ? pTypeTEMP : pTypeRFXMeter, bTemp ? sTypeTEMP1 : sTypeRFXMeterCount,
+				 bTemp ? "20.5" : "1000000");
+		result = m_sql.safe_query("SELECT MAX(ID) FROM DeviceStatus");
+		if (!result.empty())
+			(bTemp ? m_TempDevices : m_CounterDevices).push_back(std::stoull(result[0][0]));
+	}
+
+	const int ShortLogRows = m_Days * 288;
+	m_sql.safe_query("WITH RECURSIVE t(n) AS (SELECT 0 UNION ALL SELECT n+1 FROM t WHERE n < %d) "
+			 "INSERT INTO Temperature (DeviceRowID, Temperature, Humidity, Date) "
+			 "SELECT d.ID, 15.0 + ((d.ID + n) %% 100) / 10.0, 50, datetime('now', 'localtime', '-' || (n * 5) || ' minutes') FROM DeviceStatus d, t "
+			 "WHERE (d.HardwareID == %d) AND (d.Type == %d)",
+			 ShortLogRows - 1, m_HardwareID, pTypeTEMP);
+	m_sql.safe_query("WITH RECURSIVE t(n) AS (SELECT 1 UNION ALL SELECT n+1 FROM t WHERE n < %d) "
+			 "INSERT INTO Temperature_Calendar (DeviceRowID, Temp_Min, Temp_Max, Temp_Avg, Humidity, Date) "
+			 "SELECT d.ID, 15.0, 25.0, 20.0, 50, date('now', 'localtime', '-' || n || ' days') FROM DeviceStatus d, t "
+			 "WHERE (d.HardwareID == %d) AND (d.Type == %d)",
+			 m_Days, m_HardwareID, pTypeTEMP);
+	m_sql.safe_query("WITH RECURSIVE t(n) AS (SELECT 0 UNION ALL SELECT n+1 FROM t WHERE n < %d) "
+			 "INSERT INTO Meter (DeviceRowID, Value, Usage, Date) "
+			 "SELECT d.ID, 1000000 - (n * 10), 120, datetime('now', 'localtime', '-' || (n * 5) || ' minutes') FROM DeviceStatus d, t "
+			 "WHERE (d.HardwareID == %d) AND (d.Type == %d)",
+			 ShortLogRows - 1, m_HardwareID, pTypeRFXMeter);
+	m_sql.safe_query("WITH RECURSIVE t(n) AS (SELECT 1 UNION ALL SELECT n+1 FROM t WHERE n < %d) "
+			 "INSERT INTO Meter_Calendar (DeviceRowID, Value, Counter, Date) "
+			 "SELECT d.ID, 2880, 1000000 - (n * 2880), date('now', 'localtime', '-' || n || ' days') FROM DeviceStatus d, t "
+			 "WHERE (d.HardwareID == %d) AND (d.Type == %d)",
+			 m_Days, m_HardwareID, pTypeRFXMeter);
+	if (bTransaction)
+		m_sql.CommitTransaction();
+}
+
+bool CSQLBenchmark::Run(const std::string &szOutputFile)
+{
+	if ((m_Devices < 2) || (m_Days < 1))
+	{
+		_log.Log(LOG_ERROR, "SQLBench: need at least 2 devices and 1 day");
+		return false;
+	}
+	_log.Log(LOG_STATUS, "SQLBench: generating %d devices with %d days of history...", m_Devices, m_Days);
+	Measure("GenerateDatabase", 1, [this](int) { GenerateDatabase(); });
+	if (m_HardwareID == 0)
+		return false;
+
+	Measure("UpdateValueInt", SQLBENCH_UPDATE_ROUNDS * m_Devices, [this](const int ii) {
+		const int iDevice = ii % m_Devices;
+		const bool bTemp = ((iDevice % 2) == 0);
+		std::string devname;
+		std::string szID = std_format("%04X", iDevice + 1);
+		std::string sValue = bTemp ? std_format("%.1f", 20.0 + (ii % 50) / 10.0) : std::to_string(1000000 + ii * 10);
+		m_sql.UpdateValueInt(m_HardwareID, szID.c_str(), 1, bTemp ? pTypeTEMP : pTypeRFXMeter, bTemp ? sTypeTEMP1 : sTypeRFXMeterCount, 12, 255, 0, sValue.c_str(), devname, false,
+				     "SQLBench");
+	});
+	Measure("UpdateMeter", 3, [](int) { m_sql.UpdateMeter(); });
+	Measure("UpdateTemperatureLog", 3, [](int) { m_sql.UpdateTemperatureLog(); });
+	Measure("AddCalendarUpdateMeter", 3, [](int) { m_sql.AddCalendarUpdateMeter(); });
+	Measure("AddCalendarTemperature", 3, [](int) { m_sql.AddCalendarTemperature(); });
+	//the first run removes everything older than the 5 minute history
+	Measure("CleanupShortLog", 2, [](int) { m_sql.CleanupShortLog(); });
+
+	auto pWebServer = std::make_shared<http::server::CWebServer>();
+	Measure("GetJSonDevices", 5, [&pWebServer](int) {
+		Json::Value root;
+		pWebServer->GetJSonDevices(root, "all", "", "Name", "", "", "", true, true, false, 0, "");
+	});
+
+	http::server::WebEmSession session;
+	session.rights = 2;
+	const std::vector<std::string> ranges = { "day", "month", "year" };
+	for (const auto &range : ranges)
+	{
+		const int nGraphDevices = std::min<int>(SQLBENCH_GRAPH_DEVICES, (int)m_TempDevices.size());
+		Measure("RType_HandleGraph/temp/" + range, nGraphDevices, [&](const int ii) {
+			http::server::request req;
+			req.parameters.insert(std::make_pair("idx", std::to_string(m_TempDevices[ii])));
+			req.parameters.insert(std::make_pair("sensor", "temp"));
+			req.parameters.insert(std::make_pair("range", range));
+			Json::Value root;
+			pWebServer->RType_HandleGraph(session, req, root);
+		});
+		const int nCounterGraphDevices = std::min<int>(SQLBENCH_GRAPH_DEVICES, (int)m_CounterDevices.size());
+		Measure("RType_HandleGraph/counter/" + range, nCounterGraphDevices, [&](const int ii) {
+			http::server::request req;
+			req.parameters.insert(std::make_pair("idx", std::to_string(m_CounterDevices[ii])));
+			req.parameters.insert(std::make_pair("sensor", "counter"));
+			req.parameters.insert(std::make_pair("range", range));
+			Json::Value root;
+			pWebServer->RType_HandleGraph(session, req, root);
+		});
+	}
+
+	Json::Value root;
+	root["devices"] = m_Devices;
+	root["days"] = m_Days;
+	for (auto &itt : m_results)
+	{
+		std::vector<double> &samples = itt.second;
+		if (samples.empty())
+			continue;
+		double total = 0;
+		for (const auto sample : samples)
+			total += sample;
+		std::sort(samples.begin(), samples.end());
+		Json::Value &entry = root["results"][itt.first];
+		entry["count"] = (int)samples.size();
+		entry["total_ms"] = total;
+		entry["p50_ms"] = samples[samples.size() / 2];
+		entry["p90_ms"] = samples[std::min(samples.size() - 1, samples.size() * 9 / 10)];
+		entry["max_ms"] = samples.back();
+	}
+
+	std::string szResult = JSonToFormatString(root);
+	if (szOutputFile.empty())
+	{
+		_log.Log(LOG_STATUS, "SQLBench: results:\n%s", szResult.c_str());
+		return true;
+	}
+	std::ofstream outfile(szOutputFile.c_str());
+	if (!outfile.is_open())
+	{
+		_log.Log(LOG_ERROR, "SQLBench: cannot write %s", szOutputFile.c_str());
+		return false;
+	}
+	outfile << szResult << "\n";
+	_log.Log(LOG_STATUS, "SQLBench: results written to %s", szOutputFile.c_str());
+	return true;
+}
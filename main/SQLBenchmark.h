@@ -0,0 +1,24 @@
+#pragma once
+
+#include <functional>
+
+// Fills an empty database with a synthetic installation (temperature sensors and counters with
+// short log and calendar history) and times the CSQLHelper/CWebServer paths that grow with it.
+class CSQLBenchmark
+{
+      public:
+	CSQLBenchmark(int Devices, int Days);
+	// Writes the results as JSON to szOutputFile, or to the log when szOutputFile is empty
+	bool Run(const std::string &szOutputFile);
+
+      private:
+	void GenerateDatabase();
+	void Measure(const std::string &szName, int Repeat, const std::function<void(int)> &Func);
+
+	int m_Devices;
+	int m_Days;
+	int m_HardwareID;
+	std::vector<uint64_t> m_TempDevices;
+	std::vector<uint64_t> m_CounterDevices;
+	std::vector<std::pair<std::string, std::vector<double>>> m_results; // ms per call
+};
@@ -45,10 +45,28 @@
 #define DEFAULT_ADMINUSER "admin"
 #define DEFAULT_ADMINPWD "domoticz"
 
+#define SQL_READPOOL_SIZE 4
+#define SQL_BACKUP_STEP_PAGES 64	// pages copied per backup step
+#define SQL_BACKUP_STEP_SLEEP 5		// ms between backup steps
+
 extern http::server::CWebServerHelper m_webservers;
 extern std::string szWWWFolder;
 extern std::string szAppVersion;
 
+// Values UpdateValueInt is writing to a DeviceStatus row, the update hook applies them to the device index
+struct _tDeviceIndexPendingWrite
+{
+	uint64_t ID;
+	int nValue;
+	const char *sValue;
+	const char *LastUpdate;
+};
+static thread_local const _tDeviceIndexPendingWrite *pDeviceIndexPendingWrite = nullptr;
+// Set while UpdateValueInt writes only the value columns of a DeviceStatus row, the update hook keeps the notification metadata
+static thread_local bool bThreadValueWrite = false;
+static thread_local uint64_t iThreadStatementTime = 0;
+static thread_local bool bThreadReadPool = false;
+
 constexpr auto sqlCreateDeviceStatus =
 "CREATE TABLE IF NOT EXISTS [DeviceStatus] ("
 "[ID] INTEGER PRIMARY KEY, "
@@ -676,6 +694,11 @@ CSQLHelper::CSQLHelper()
 {
 	m_LastSwitchRowID = 0;
 	m_dbase = nullptr;
+	m_transaction_thread = std::thread::id();
+	m_bStatementProfiling = false;
+	m_bReadPool = false;
+	m_readpool_cursors = 0;
+	m_readpool_generation = 0;
 	m_sensortimeoutcounter = 0;
 	m_bAcceptNewHardware = true;
 	m_bAllowWidgetOrdering = true;
@@ -693,6 +716,20 @@ CSQLHelper::CSQLHelper()
 	m_bShortLogAddOnlyNewValues = false;
 	m_bPreviousAcceptNewHardware = false;
 	m_bLogEventScriptTrigger = false;
+	m_EventSystemBatchSize = 100;
+	m_EventSystemBatchWindow = 0;
+	m_bEventSystemDebounce = false;
+	m_todaycounters_generation = 0;
+	m_deviceindex_generation = 0;
+
+	sOnPreferenceChanged.connect([this](const std::string &Key) {
+		if (Key == "MaxElectricPower")
+		{
+			int nValue = 6000;
+			GetPreferencesVar("MaxElectricPower", nValue);
+			m_max_kwh_usage = (nValue < 1) ? 6000 : nValue;
+		}
+	});
 
 	SetDatabaseName("domoticz.db");
 }
@@ -719,6 +756,13 @@ bool CSQLHelper::OpenDatabase()
 	sqlite3_exec(m_dbase, "PRAGMA foreign_keys = ON", nullptr, nullptr, nullptr);
 	sqlite3_exec(m_dbase, "PRAGMA busy_timeout = 1000", nullptr, nullptr, nullptr);
 
+	ClearDeviceIndex();
+	sqlite3_update_hook(m_dbase, DeviceStatusUpdateHook, this);
+	sqlite3_rollback_hook(m_dbase, DeviceStatusRollbackHook, this);
+
+	//read from the database until the upgrades are done
+	ClearPreferences();
+
 	std::vector<std::vector<std::string> > result = query("SELECT name FROM sqlite_master WHERE type='table' AND name='DeviceStatus'");
 	bool bNewInstall = (result.empty());
 	int dbversion = 0;
@@ -3150,6 +3194,9 @@ bool CSQLHelper::OpenDatabase()
 		safe_query("UPDATE Preferences SET sValue ='' WHERE LENGTH(sValue) > 1000");
 	}
 
+	//from here on preferences are read from memory
+	LoadPreferences();
+
 	// Check if the default admin User password has been changed
 	result = safe_query("SELECT Password FROM Users WHERE Username='%s'", base64_encode(DEFAULT_ADMINUSER).c_str());
 	if (!result.empty())
@@ -3489,6 +3536,30 @@ bool CSQLHelper::OpenDatabase()
 	}
 	m_bLogEventScriptTrigger = (nValue != 0);
 
+	nValue = 100;
+	if ((!GetPreferencesVar("EventSystemBatchSize", nValue)) || (nValue < 1))
+	{
+		UpdatePreferencesVar("EventSystemBatchSize", 100);
+		nValue = 100;
+	}
+	m_EventSystemBatchSize = nValue;
+
+	nValue = 0;
+	if (!GetPreferencesVar("EventSystemBatchWindow", nValue))
+	{
+		UpdatePreferencesVar("EventSystemBatchWindow", 0);
+		nValue = 0;
+	}
+	m_EventSystemBatchWindow = nValue;
+
+	nValue = 0;
+	if (!GetPreferencesVar("EventSystemDebounce", nValue))
+	{
+		UpdatePreferencesVar("EventSystemDebounce", 0);
+		nValue = 0;
+	}
+	m_bEventSystemDebounce = (nValue != 0);
+
 	if ((!GetPreferencesVar("WebTheme", sValue)) || (sValue.empty()))
 	{
 		UpdatePreferencesVar("WebTheme", "default");
@@ -3604,6 +3675,8 @@ bool CSQLHelper::OpenDatabase()
 	//Update version in database
 	UpdatePreferencesVar("Domoticz_Version", szAppVersion);
 
+	OpenReadPool();
+
 	//Start background thread
 	if (!StartThread())
 		return false;
@@ -3612,7 +3685,10 @@ bool CSQLHelper::OpenDatabase()
 
 void CSQLHelper::CloseDatabase()
 {
-	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	ClearPreferences();
+	ClearDeviceIndex();
+	CloseReadPool();
+	std::unique_lock<std::mutex> l(LockConnection());
 	if (m_dbase != nullptr)
 	{
 		OptimizeDatabase(m_dbase);
@@ -4320,7 +4396,7 @@ bool CSQLHelper::safe_UpdateBlobInTableWithID(const std::string& Table, const st
 	if (!m_dbase)
 		return false;
 
-	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	std::unique_lock<std::mutex> l(LockConnection());
 
 	sqlite3_stmt *stmt = nullptr;
 	char* zQuery = sqlite3_mprintf("UPDATE %q SET %q = ? WHERE ID=%q", Table.c_str(), Column.c_str(), sID.c_str());
@@ -4409,6 +4485,62 @@ std::vector<std::vector<std::string>> CSQLHelper::safe_query(const char *fmt, ..
 	return results;
 }
 
+std::vector<std::vector<std::string>> CSQLHelper::safe_queryWriter(const char *fmt, ...)
+{
+	std::vector<std::vector<std::string>> results;
+	if (!m_dbase)
+		return results;
+	va_list args;
+	va_start(args, fmt);
+	char *zQuery = sqlite3_vmprintf(fmt, args);
+	va_end(args);
+	if (!zQuery)
+	{
+		_log.Log(LOG_ERROR, "SQL: Out of memory, or invalid printf!....");
+		return results;
+	}
+	{
+		std::unique_lock<std::mutex> l(LockConnection());
+		results = queryConnection(m_dbase, zQuery);
+	}
+	sqlite3_free(zQuery);
+	return results;
+}
+
+std::shared_ptr<CSQLCursor> CSQLHelper::safe_cursor(const char *fmt, ...)
+{
+	std::shared_ptr<CSQLCursor> cursor(new CSQLCursor(this));
+	if (!m_dbase)
+	{
+		_log.Log(LOG_ERROR, "Database not open!!...Check your user rights!..");
+		return cursor;
+	}
+	va_list args;
+	va_start(args, fmt);
+	char *zQuery = sqlite3_vmprintf(fmt, args);
+	va_end(args);
+	if (!zQuery)
+	{
+		_log.Log(LOG_ERROR, "SQL: Out of memory, or invalid printf!....");
+		return cursor;
+	}
+	cursor->m_szQuery = zQuery;
+	sqlite3_free(zQuery);
+
+	if ((bThreadReadPool) && (m_transaction_thread != std::this_thread::get_id()))
+		cursor->m_pReader = DetachReader(cursor->m_generation);
+	if (cursor->m_pReader != nullptr)
+	{
+		_log.Debug(DEBUG_SQL, "Query:%s", cursor->m_szQuery.c_str());
+		if (sqlite3_prepare_v2(cursor->m_pReader, cursor->m_szQuery.c_str(), -1, &cursor->m_statement, nullptr) == SQLITE_OK)
+			return cursor;
+		cursor->Close();
+		return cursor;
+	}
+	cursor->m_rows = query(cursor->m_szQuery);
+	return cursor;
+}
+
 std::vector<std::vector<std::string> > CSQLHelper::query(const std::string& szQuery)
 {
 	if (!m_dbase)
@@ -4417,12 +4549,26 @@ std::vector<std::vector<std::string> > CSQLHelper::query(const std::string& szQu
 		std::vector<std::vector<std::string> > results;
 		return results;
 	}
-	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	if (bThreadReadPool)
+	{
+		sqlite3 *pReader = AcquireReader(szQuery);
+		if (pReader != nullptr)
+		{
+			std::vector<std::vector<std::string>> results = queryConnection(pReader, szQuery);
+			ReleaseReader(pReader);
+			return results;
+		}
+	}
+	std::unique_lock<std::mutex> l(LockConnection());
+	return queryConnection(m_dbase, szQuery);
+}
 
+std::vector<std::vector<std::string>> CSQLHelper::queryConnection(sqlite3 *pDB, const std::string &szQuery)
+{
 	sqlite3_stmt* statement;
 	std::vector<std::vector<std::string> > results;
     _log.Debug(DEBUG_SQL, "Query:%s", szQuery.c_str());
-	if (sqlite3_prepare_v2(m_dbase, szQuery.c_str(), -1, &statement, nullptr) == SQLITE_OK)
+	if (sqlite3_prepare_v2(pDB, szQuery.c_str(), -1, &statement, nullptr) == SQLITE_OK)
 	{
 		int cols = sqlite3_column_count(statement);
 		while (true)
@@ -4452,7 +4598,7 @@ std::vector<std::vector<std::string> > CSQLHelper::query(const std::string& szQu
 		sqlite3_finalize(statement);
 	}
 
-	std::string error = sqlite3_errmsg(m_dbase);
+	std::string error = sqlite3_errmsg(pDB);
 	if (error != "not an error")
 		_log.Log(LOG_ERROR, "SQL Query(\"%s\") : %s", szQuery.c_str(), error.c_str());
 	return results;
@@ -4484,7 +4630,7 @@ std::vector<std::vector<std::string> > CSQLHelper::queryBlob(const std::string&
 		std::vector<std::vector<std::string> > results;
 		return results;
 	}
-	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	std::unique_lock<std::mutex> l(LockConnection());
 
 	sqlite3_stmt* statement;
 	std::vector<std::vector<std::string> > results;
@@ -5104,8 +5250,8 @@ uint64_t CSQLHelper::UpdateValueInt(
 	_eSwitchType stype = STYPE_OnOff;
 
 	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ID, Name, Used, SwitchType, nValue, sValue, LastUpdate, Options FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)", HardwareID, ID, unit, devType, subType);
-	if (result.empty())
+	_tDeviceIndexEntry device;
+	if (!GetDeviceIndexEntry(HardwareID, ID, unit, devType, subType, device))
 	{
 		//Insert
 		ulID = InsertDevice(HardwareID, ID, unit, devType, subType, 0, nValue, sValue, devname, signallevel, batterylevel);
@@ -5129,14 +5275,16 @@ uint64_t CSQLHelper::UpdateValueInt(
 	else
 	{
 		//Update
-		ulID = std::stoull(result[0][0]);
-		std::string sOption = result[0][7];
-		auto options = BuildDeviceOptions(sOption);
-		devname = result[0][1];
-		bDeviceUsed = atoi(result[0][2].c_str()) != 0;
-		stype = (_eSwitchType)atoi(result[0][3].c_str());
-		nValueBeforeUpdate = atoi(result[0][4].c_str());
-		sValueBeforeUpdate = result[0][5];
+		ulID = device.ID;
+		auto options = BuildDeviceOptions(device.Options);
+		devname = device.Name;
+		bDeviceUsed = device.Used;
+		stype = (_eSwitchType)device.SwitchType;
+		nValueBeforeUpdate = device.nValue;
+		sValueBeforeUpdate = device.sValue;
+
+		if (m_mainworker.CoalesceRxUpdate(ulID, device.Options, devType, subType, nValue, sValue, nValueBeforeUpdate, sValueBeforeUpdate))
+			return -1; //held back, the latest value is written when the coalescing interval has passed
 
 		std::string sLastUpdate = TimeToString(nullptr, TF_DateTime);
 
@@ -5146,7 +5294,7 @@ uint64_t CSQLHelper::UpdateValueInt(
 		{
             double intervalSeconds;
             struct tm ntime;
-			std::string sLastUpdate = result[0][6];
+			std::string sLastUpdate = device.LastUpdate;
 
 			time_t now = time(nullptr);
 			struct tm ltime;
@@ -5187,6 +5335,7 @@ uint64_t CSQLHelper::UpdateValueInt(
 		//~ use different update queries based on the device type
 		if (devType == pTypeGeneral && subType == sTypeCounterIncremental)
 		{
+			bThreadValueWrite = true;
 			result = safe_query(
 				"UPDATE DeviceStatus SET SignalLevel=%d, BatteryLevel=%d, nValue= nValue + %d, sValue= sValue + '%q', LastUpdate='%q' "
 				"WHERE (ID = %" PRIu64 ")",
@@ -5194,6 +5343,7 @@ uint64_t CSQLHelper::UpdateValueInt(
 				nValue, sValue,
 				sLastUpdate.c_str(),
 				ulID);
+			bThreadValueWrite = false;
 		}
 		else
 		{
@@ -5293,6 +5443,9 @@ uint64_t CSQLHelper::UpdateValueInt(
 				}
 			}
 
+			_tDeviceIndexPendingWrite pendingwrite = { ulID, nValue, sValue, sLastUpdate.c_str() };
+			pDeviceIndexPendingWrite = &pendingwrite;
+			bThreadValueWrite = true;
 			result = safe_query(
 				"UPDATE DeviceStatus SET SignalLevel=%d, BatteryLevel=%d, nValue=%d, sValue='%q', LastUpdate='%q' "
 				"WHERE (ID = %" PRIu64 ")",
@@ -5300,6 +5453,8 @@ uint64_t CSQLHelper::UpdateValueInt(
 				nValue, sValue,
 				sLastUpdate.c_str(),
 				ulID);
+			pDeviceIndexPendingWrite = nullptr;
+			bThreadValueWrite = false;
 		}
 	}
 
@@ -5710,21 +5865,28 @@ void CSQLHelper::UpdatePreferencesVar(const std::string& Key, const int nValue,
 	if (!m_dbase)
 		return;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ROWID FROM Preferences WHERE (Key='%q')",
-		Key.c_str());
-	if (result.empty())
-	{
-		//Insert
-		result = safe_query("INSERT INTO Preferences (Key, nValue, sValue) VALUES ('%q', %d,'%q')",
-			Key.c_str(), nValue, sValue.c_str());
-	}
-	else
 	{
-		//Update
-		result = safe_query("UPDATE Preferences SET Key='%q', nValue=%d, sValue='%q' WHERE (ROWID = '%q')",
-			Key.c_str(), nValue, sValue.c_str(), result[0][0].c_str());
+		//keep the database and the cache in the same order
+		std::lock_guard<std::mutex> l(m_preferences_mutex);
+		std::vector<std::vector<std::string> > result;
+		result = safe_query("SELECT ROWID FROM Preferences WHERE (Key='%q')",
+			Key.c_str());
+		if (result.empty())
+		{
+			//Insert
+			result = safe_query("INSERT INTO Preferences (Key, nValue, sValue) VALUES ('%q', %d,'%q')",
+				Key.c_str(), nValue, sValue.c_str());
+		}
+		else
+		{
+			//Update
+			result = safe_query("UPDATE Preferences SET Key='%q', nValue=%d, sValue='%q' WHERE (ROWID = '%q')",
+				Key.c_str(), nValue, sValue.c_str(), result[0][0].c_str());
+		}
+		_tPreferenceVar pvar = { nValue, sValue };
+		SetPreferencesCache(Key, &pvar);
 	}
+	sOnPreferenceChanged(Key);
 }
 
 bool CSQLHelper::GetPreferencesVar(const std::string& Key, std::string& sValue)
@@ -5732,6 +5894,16 @@ bool CSQLHelper::GetPreferencesVar(const std::string& Key, std::string& sValue)
 	if (!m_dbase)
 		return false;
 
+	auto preferences = std::atomic_load(&m_preferences);
+	if (preferences)
+	{
+		auto itt = preferences->find(Key);
+		if (itt == preferences->end())
+			return false;
+		sValue = itt->second.sValue;
+		return true;
+	}
+
 	std::vector<std::vector<std::string> > result;
 	result = safe_query("SELECT sValue FROM Preferences WHERE (Key='%q')",
 		Key.c_str());
@@ -5758,6 +5930,17 @@ bool CSQLHelper::GetPreferencesVar(const std::string& Key, int& nValue, std::str
 	if (!m_dbase)
 		return false;
 
+	auto preferences = std::atomic_load(&m_preferences);
+	if (preferences)
+	{
+		auto itt = preferences->find(Key);
+		if (itt == preferences->end())
+			return false;
+		nValue = itt->second.nValue;
+		sValue = itt->second.sValue;
+		return true;
+	}
+
 	std::vector<std::vector<std::string> > result;
 	result = safe_query("SELECT nValue, sValue FROM Preferences WHERE (Key='%q')",
 		Key.c_str());
@@ -5784,10 +5967,51 @@ void CSQLHelper::DeletePreferencesVar(const std::string& Key)
 	//if found, delete
 	if (GetPreferencesVar(Key, sValue) == true)
 	{
-		safe_query("DELETE FROM Preferences WHERE (Key='%q')", Key.c_str());
+		{
+			std::lock_guard<std::mutex> l(m_preferences_mutex);
+			safe_query("DELETE FROM Preferences WHERE (Key='%q')", Key.c_str());
+			SetPreferencesCache(Key, nullptr);
+		}
+		sOnPreferenceChanged(Key);
 	}
 }
 
+//Loads the Preferences table in memory, GetPreferencesVar only reads this snapshot after this
+void CSQLHelper::LoadPreferences()
+{
+	auto preferences = std::make_shared<_tPreferencesMap>();
+	std::lock_guard<std::mutex> l(m_preferences_mutex);
+	auto result = safe_query("SELECT Key, nValue, sValue FROM Preferences");
+	for (const auto &sd : result)
+	{
+		_tPreferenceVar &pvar = (*preferences)[sd[0]];
+		pvar.nValue = atoi(sd[1].c_str());
+		pvar.sValue = sd[2];
+	}
+	std::atomic_store(&m_preferences, std::shared_ptr<const _tPreferencesMap>(preferences));
+}
+
+void CSQLHelper::ClearPreferences()
+{
+	std::lock_guard<std::mutex> l(m_preferences_mutex);
+	std::atomic_store(&m_preferences, std::shared_ptr<const _tPreferencesMap>());
+}
+
+//Replaces the snapshot with a copy that has Key updated (or removed when pVar is null),
+//m_preferences_mutex should be locked by the caller
+void CSQLHelper::SetPreferencesCache(const std::string &Key, const _tPreferenceVar *pVar)
+{
+	auto preferences = std::atomic_load(&m_preferences);
+	if (!preferences)
+		return; //not loaded yet
+	auto newpreferences = std::make_shared<_tPreferencesMap>(*preferences);
+	if (pVar)
+		(*newpreferences)[Key] = *pVar;
+	else
+		newpreferences->erase(Key);
+	std::atomic_store(&m_preferences, std::shared_ptr<const _tPreferencesMap>(newpreferences));
+}
+
 int CSQLHelper::GetLastBackupNo(const char* Key, int& nValue)
 {
 	if (!m_dbase)
@@ -6197,6 +6421,8 @@ void CSQLHelper::UpdateRainLog()
 				total,
 				rate
 			);
+			const double values[2] = { atof(std_format("%.2f", total).c_str()), double(rate) };
+			AddTodayCounterValues(TCTABLE_RAIN, ID, values);
 		}
 	}
 }
@@ -6436,6 +6662,8 @@ bool CSQLHelper::UpdateCalendarMeter(
 				);
 			}
 		}
+		//the date can be anything, let the today counter be read again
+		ClearTodayCounters(DeviceRowID);
 	}
 	else
 	{
@@ -6783,6 +7011,8 @@ void CSQLHelper::UpdateMeter()
 				MeterValue,
 				MeterUsage
 			);
+			const double value = double(MeterValue);
+			AddTodayCounterValues(TCTABLE_METER, ID, &value);
 		}
 	}
 }
@@ -6914,6 +7144,8 @@ void CSQLHelper::UpdateMultiMeter()
 				value5,
 				value6
 			);
+			const double values[6] = { double(value1), double(value2), double(value3), double(value4), double(value5), double(value6) };
+			AddTodayCounterValues(TCTABLE_MULTIMETER, ID, values);
 		}
 	}
 }
@@ -7397,6 +7629,8 @@ void CSQLHelper::AddCalendarUpdateMeter()
 						sd[0].c_str(),
 						sd[1].c_str()
 						);
+					const double value = atof(sd[0].c_str());
+					AddTodayCounterValues(TCTABLE_METER, ID, &value);
 					//also send this to Influx as this can be used as start counter of today()
 					m_influxpush.DoInfluxPush(ID, true);
 				}
@@ -7819,9 +8053,502 @@ void CSQLHelper::ClearShortLog()
 	query("DELETE FROM MultiMeter");
 	query("DELETE FROM Percentage");
 	query("DELETE FROM Fan");
+	ClearTodayCounters();
 	VacuumDatabase();
 }
 
+bool CSQLHelper::GetDeviceIndexEntry(const int HardwareID, const std::string &DeviceID, const unsigned char unit, const unsigned char devType, const unsigned char subType, _tDeviceIndexEntry &entry)
+{
+	if (!m_dbase)
+		return false;
+
+	_tDeviceIndexKey key = { HardwareID, DeviceID, unit, devType, subType };
+	_tDeviceIndexShard &shard = m_deviceindex[_tDeviceIndexKeyHash()(key) % DEVICE_INDEX_SHARDS];
+	{
+		std::lock_guard<std::mutex> l(shard.mutex);
+		auto itt = shard.devices.find(key);
+		if (itt != shard.devices.end())
+		{
+			entry = itt->second;
+			return true;
+		}
+	}
+
+	uint64_t generation = m_deviceindex_generation;
+	auto result = safe_queryWriter("SELECT ID, Name, Used, SwitchType, nValue, sValue, LastUpdate, Options FROM DeviceStatus WHERE (HardwareID=%d AND DeviceID='%q' AND Unit=%d AND Type=%d AND SubType=%d)",
+		HardwareID, DeviceID.c_str(), unit, devType, subType);
+	if (result.empty())
+		return false;
+	entry.ID = std::stoull(result[0][0]);
+	entry.Name = result[0][1];
+	entry.Used = atoi(result[0][2].c_str()) != 0;
+	entry.SwitchType = atoi(result[0][3].c_str());
+	entry.nValue = atoi(result[0][4].c_str());
+	entry.sValue = result[0][5];
+	entry.LastUpdate = result[0][6];
+	entry.Options = result[0][7];
+
+	std::lock_guard<std::mutex> l(shard.mutex);
+	if (generation == m_deviceindex_generation) //no DeviceStatus row changed while we were reading
+	{
+		shard.devices[key] = entry;
+		shard.rows[entry.ID] = key;
+	}
+	return true;
+}
+
+bool CSQLHelper::BeginTransaction()
+{
+	if (!m_dbase)
+		return false;
+	std::unique_lock<std::mutex> l(LockConnection());
+	if ((m_transaction_thread != std::thread::id()) || (!sqlite3_get_autocommit(m_dbase)))
+		return false; //already inside a transaction
+	if (sqlite3_exec(m_dbase, "SAVEPOINT batch", nullptr, nullptr, nullptr) != SQLITE_OK)
+		return false;
+	m_transaction_thread = std::this_thread::get_id();
+	return true;
+}
+
+void CSQLHelper::CommitTransaction()
+{
+	if (!m_dbase)
+		return;
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	if (m_transaction_thread != std::this_thread::get_id())
+		return;
+	m_transaction_thread = std::thread::id();
+	if (!sqlite3_get_autocommit(m_dbase))
+		sqlite3_exec(m_dbase, "RELEASE batch", nullptr, nullptr, nullptr);
+}
+
+//Locks the main connection for a statement of the calling thread. While another thread owns the
+//transaction of BeginTransaction, what it wrote so far is committed first: our statements must not
+//end up in its transaction, and we must not read its uncommitted rows. The owner starts a new
+//savepoint for its next statement, so the rest of its batch is grouped again.
+std::unique_lock<std::mutex> CSQLHelper::LockConnection()
+{
+	std::unique_lock<std::mutex> l(m_sqlQueryMutex);
+	std::thread::id owner = m_transaction_thread;
+	if ((owner == std::thread::id()) || (m_dbase == nullptr))
+		return l;
+	bool bOpen = !sqlite3_get_autocommit(m_dbase);
+	if (owner != std::this_thread::get_id())
+	{
+		if (bOpen)
+			sqlite3_exec(m_dbase, "RELEASE batch", nullptr, nullptr, nullptr);
+	}
+	else if (!bOpen)
+		sqlite3_exec(m_dbase, "SAVEPOINT batch", nullptr, nullptr, nullptr);
+	return l;
+}
+
+void CSQLHelper::SetStatementProfiling(const bool bEnable)
+{
+	if (!m_dbase)
+		return;
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	std::lock_guard<std::mutex> l2(m_readpool_mutex);
+	m_bStatementProfiling = bEnable;
+	if (bEnable)
+		sqlite3_trace_v2(m_dbase, SQLITE_TRACE_PROFILE, StatementProfileCallback, this);
+	else
+		sqlite3_trace_v2(m_dbase, 0, nullptr, nullptr);
+	for (auto pReader : m_readpool)
+	{
+		if (bEnable)
+			sqlite3_trace_v2(pReader, SQLITE_TRACE_PROFILE, StatementProfileCallback, this);
+		else
+			sqlite3_trace_v2(pReader, 0, nullptr, nullptr);
+	}
+}
+
+uint64_t CSQLHelper::GetThreadStatementTime()
+{
+	return iThreadStatementTime;
+}
+
+void CSQLHelper::SetThreadReadPool(const bool bEnable)
+{
+	bThreadReadPool = bEnable;
+}
+
+//Read-only connections only see committed data, which needs WAL mode to not block the writer.
+//They are opened when first needed
+void CSQLHelper::OpenReadPool()
+{
+	std::vector<std::vector<std::string>> result = query("PRAGMA journal_mode");
+	std::lock_guard<std::mutex> l(m_readpool_mutex);
+	m_bReadPool = ((!result.empty()) && (result[0][0] == "wal"));
+}
+
+void CSQLHelper::CloseReadPool()
+{
+	std::unique_lock<std::mutex> l(m_readpool_mutex);
+	m_bReadPool = false;
+	m_readpool_generation++;
+	m_readpool_cond.notify_all();
+	//wait for the queries that are still running on a reader
+	m_readpool_cond.wait(l, [this] { return m_readpool_free.size() == m_readpool.size(); });
+	for (auto pReader : m_readpool)
+		sqlite3_close(pReader);
+	m_readpool.clear();
+	m_readpool_free.clear();
+}
+
+//Opens a read-only connection (with m_readpool_mutex locked), nullptr when that fails
+sqlite3 *CSQLHelper::OpenReader()
+{
+	sqlite3 *pReader = nullptr;
+	if (sqlite3_open_v2(m_dbase_name.c_str(), &pReader, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+	{
+		_log.Log(LOG_ERROR, "SQL: Could not open read-only connection: %s (using the main connection)", sqlite3_errmsg(pReader));
+		sqlite3_close(pReader);
+		return nullptr;
+	}
+	sqlite3_exec(pReader, "PRAGMA busy_timeout = 1000", nullptr, nullptr, nullptr);
+	if (m_bStatementProfiling)
+		sqlite3_trace_v2(pReader, SQLITE_TRACE_PROFILE, StatementProfileCallback, this);
+	return pReader;
+}
+
+//Returns a read-only connection for szQuery, or nullptr when it has to run on the writer
+sqlite3 *CSQLHelper::AcquireReader(const std::string &szQuery)
+{
+	//plain SELECTs only, and not the ones asking about the last statement of the writer
+	size_t pos = szQuery.find_first_not_of(" \t\r\n");
+	if ((pos == std::string::npos) || (szQuery.compare(pos, 6, "SELECT") != 0))
+		return nullptr;
+	if ((szQuery.find("changes()") != std::string::npos) || (szQuery.find("last_insert_rowid") != std::string::npos))
+		return nullptr;
+	//the owner of the transaction expects to read its own changes, the others only see committed ones
+	if (m_transaction_thread == std::this_thread::get_id())
+		return nullptr;
+
+	std::unique_lock<std::mutex> l(m_readpool_mutex);
+	while (m_bReadPool && m_readpool_free.empty())
+	{
+		if (m_readpool.size() < SQL_READPOOL_SIZE)
+		{
+			sqlite3 *pReader = OpenReader();
+			if (pReader == nullptr)
+			{
+				m_bReadPool = false;
+				m_readpool_cond.notify_all();
+				return nullptr;
+			}
+			m_readpool.push_back(pReader);
+			return pReader;
+		}
+		m_readpool_cond.wait(l);
+	}
+	if (!m_bReadPool)
+		return nullptr;
+	sqlite3 *pReader = m_readpool_free.back();
+	m_readpool_free.pop_back();
+	return pReader;
+}
+
+void CSQLHelper::ReleaseReader(sqlite3 *pReader)
+{
+	std::lock_guard<std::mutex> l(m_readpool_mutex);
+	m_readpool_free.push_back(pReader);
+	m_readpool_cond.notify_all();
+}
+
+//Takes a read-only connection out of the pool for a cursor, a slow cursor then never holds up the
+//queries waiting for a reader or CloseReadPool. nullptr when the cursor has to fetch its rows at once
+sqlite3 *CSQLHelper::DetachReader(uint32_t &generation)
+{
+	std::lock_guard<std::mutex> l(m_readpool_mutex);
+	if ((!m_bReadPool) || (m_readpool_cursors >= SQL_READPOOL_SIZE))
+		return nullptr;
+	sqlite3 *pReader = nullptr;
+	if (!m_readpool_free.empty())
+	{
+		pReader = m_readpool_free.back();
+		m_readpool_free.pop_back();
+		m_readpool.erase(std::find(m_readpool.begin(), m_readpool.end(), pReader));
+	}
+	else
+	{
+		pReader = OpenReader();
+		if (pReader == nullptr)
+			return nullptr;
+	}
+	m_readpool_cursors++;
+	generation = m_readpool_generation;
+	return pReader;
+}
+
+//Gives the connection of a cursor back to the pool, or closes it when the pool is full or has been closed meanwhile
+void CSQLHelper::AttachReader(sqlite3 *pReader, const uint32_t generation)
+{
+	std::lock_guard<std::mutex> l(m_readpool_mutex);
+	m_readpool_cursors--;
+	if ((m_bReadPool) && (generation == m_readpool_generation) && (m_readpool.size() < SQL_READPOOL_SIZE))
+	{
+		m_readpool.push_back(pReader);
+		m_readpool_free.push_back(pReader);
+		m_readpool_cond.notify_all();
+		return;
+	}
+	sqlite3_close(pReader);
+}
+
+CSQLCursor::CSQLCursor(CSQLHelper *pHelper)
+	: m_pHelper(pHelper)
+{
+}
+
+CSQLCursor::~CSQLCursor()
+{
+	Close();
+}
+
+void CSQLCursor::Close()
+{
+	if (m_pReader == nullptr)
+		return;
+	if (m_statement != nullptr)
+	{
+		sqlite3_finalize(m_statement);
+		m_statement = nullptr;
+	}
+	std::string error = sqlite3_errmsg(m_pReader);
+	if (error != "not an error")
+		_log.Log(LOG_ERROR, "SQL Query(\"%s\") : %s", m_szQuery.c_str(), error.c_str());
+	m_pHelper->AttachReader(m_pReader, m_generation);
+	m_pReader = nullptr;
+}
+
+bool CSQLCursor::Step(std::vector<std::string> &row)
+{
+	if (m_statement == nullptr)
+	{
+		if (m_iRow >= m_rows.size())
+			return false;
+		row = std::move(m_rows[m_iRow++]);
+		return true;
+	}
+	//the database is being closed or restored
+	if (m_generation != m_pHelper->m_readpool_generation)
+	{
+		Close();
+		return false;
+	}
+	const int cols = sqlite3_column_count(m_statement);
+	while (sqlite3_step(m_statement) == SQLITE_ROW)
+	{
+		row.clear();
+		for (int col = 0; col < cols; col++)
+		{
+			char *value = (char *)sqlite3_column_text(m_statement, col);
+			if ((value == nullptr) && (col == 0))
+				break;
+			if (value == nullptr)
+				row.push_back(std::string("")); //insert empty string
+			else
+				row.push_back(value);
+		}
+		if (!row.empty())
+			return true;
+	}
+	Close();
+	return false;
+}
+
+//Called by sqlite in the thread that ran the statement, pTime points to the run time in nanoseconds
+int CSQLHelper::StatementProfileCallback(const unsigned int uType, void * /*pUser*/, void * /*pStatement*/, void *pTime)
+{
+	if (uType == SQLITE_TRACE_PROFILE)
+		iThreadStatementTime += (uint64_t)*static_cast<sqlite3_int64 *>(pTime);
+	return 0;
+}
+
+void CSQLHelper::ClearDeviceIndex()
+{
+	m_deviceindex_generation++;
+	for (auto &shard : m_deviceindex)
+	{
+		std::lock_guard<std::mutex> l(shard.mutex);
+		shard.devices.clear();
+		shard.rows.clear();
+	}
+}
+
+//Called (with m_sqlQueryMutex locked) for every inserted, updated or deleted DeviceStatus row
+void CSQLHelper::OnDeviceStatusChanged(const int op, const uint64_t DeviceRowID)
+{
+	m_deviceindex_generation++;
+
+	const _tDeviceIndexPendingWrite *pWrite = pDeviceIndexPendingWrite;
+	if ((op != SQLITE_UPDATE) || (pWrite == nullptr) || (pWrite->ID != DeviceRowID))
+		pWrite = nullptr;
+
+	//Keep the value cache of the push targets in line with every write, not only those of UpdateValue
+	if (pWrite != nullptr)
+		CBasePush::SetDeviceValue(DeviceRowID, pWrite->nValue, pWrite->sValue);
+	else
+		CBasePush::InvalidateDevice(DeviceRowID, false);
+	//SwitchType, Options and CustomImage are also written by the web server and hardware drivers directly
+	if (!bThreadValueWrite)
+		m_notifications.InvalidateDeviceMeta(DeviceRowID);
+
+	for (auto &shard : m_deviceindex)
+	{
+		std::lock_guard<std::mutex> l(shard.mutex);
+		auto itt = shard.rows.find(DeviceRowID);
+		if (itt == shard.rows.end())
+			continue;
+		auto ittDevice = shard.devices.find(itt->second);
+		if (ittDevice != shard.devices.end())
+		{
+			if (pWrite != nullptr)
+			{
+				ittDevice->second.nValue = pWrite->nValue;
+				ittDevice->second.sValue = pWrite->sValue;
+				ittDevice->second.LastUpdate = pWrite->LastUpdate;
+				return;
+			}
+			shard.devices.erase(ittDevice);
+		}
+		shard.rows.erase(itt);
+		return;
+	}
+}
+
+void CSQLHelper::DeviceStatusUpdateHook(void *pUser, const int op, const char * /*szDatabase*/, const char *szTable, const long long rowid)
+{
+	if (strcmp(szTable, "DeviceStatus") != 0)
+		return;
+	static_cast<CSQLHelper *>(pUser)->OnDeviceStatusChanged(op, (uint64_t)rowid);
+}
+
+void CSQLHelper::DeviceStatusRollbackHook(void *pUser)
+{
+	static_cast<CSQLHelper *>(pUser)->ClearDeviceIndex();
+}
+
+static const struct
+{
+	const char *szTable;
+	int nValues;
+	const char *szColumns[TODAY_COUNTER_VALUES];
+} TodayCounterTables[TCTABLE_COUNT] = {
+	{ "Meter", 1, { "Value" } },
+	{ "Rain", 2, { "Total", "Rate" } },
+	{ "MultiMeter", 6, { "Value1", "Value2", "Value3", "Value4", "Value5", "Value6" } },
+};
+
+//Reads the first/min/max/last values of today from the short log once, after that they are
+//kept up to date by AddTodayCounterValues when the short log is written
+bool CSQLHelper::GetTodayCounter(const _eTodayCounterTable table, const uint64_t DeviceRowID, _tTodayCounter &counter)
+{
+	std::string szDate = TimeToString(nullptr, TF_Date);
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> l(m_todaycounters_mutex);
+		auto itt = m_todaycounters[table].find(DeviceRowID);
+		if ((itt != m_todaycounters[table].end()) && (itt->second.Date == szDate))
+		{
+			counter = itt->second;
+			return counter.HaveValues;
+		}
+		generation = m_todaycounters_generation;
+	}
+
+	const auto &tdef = TodayCounterTables[table];
+	std::string szColumns, szMinMax;
+	for (int ii = 0; ii < tdef.nValues; ii++)
+	{
+		szColumns += std::string((ii > 0) ? ", " : "") + tdef.szColumns[ii];
+		szMinMax += std::string((ii > 0) ? ", " : "") + "MIN(" + tdef.szColumns[ii] + ")";
+	}
+	for (int ii = 0; ii < tdef.nValues; ii++)
+		szMinMax += std::string(", MAX(") + tdef.szColumns[ii] + ")";
+
+	counter = _tTodayCounter();
+	counter.Date = szDate;
+	counter.HaveValues = false;
+
+	//on the main connection, the short log can be written (and the generation bumped) before it is committed
+	std::vector<std::vector<std::string> > result, result2, result3;
+	result = safe_queryWriter("SELECT %s FROM %s WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')", szMinMax.c_str(), tdef.szTable, DeviceRowID, szDate.c_str());
+	if (!result.empty())
+	{
+		result2 = safe_queryWriter("SELECT %s FROM %s WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q') ORDER BY Date LIMIT 1", szColumns.c_str(), tdef.szTable, DeviceRowID, szDate.c_str());
+		result3 = safe_queryWriter("SELECT %s FROM %s WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q') ORDER BY ROWID DESC LIMIT 1", szColumns.c_str(), tdef.szTable, DeviceRowID, szDate.c_str());
+		if (!result2.empty() && !result3.empty())
+		{
+			counter.HaveValues = true;
+			for (int ii = 0; ii < tdef.nValues; ii++)
+			{
+				counter.Min[ii] = atof(result[0][ii].c_str());
+				counter.Max[ii] = atof(result[0][tdef.nValues + ii].c_str());
+				counter.First[ii] = atof(result2[0][ii].c_str());
+				counter.Last[ii] = atof(result3[0][ii].c_str());
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> l(m_todaycounters_mutex);
+	//only keep it when the short log was not written (or cleared) while we were reading it
+	if (generation == m_todaycounters_generation)
+		m_todaycounters[table][DeviceRowID] = counter;
+	return counter.HaveValues;
+}
+
+void CSQLHelper::AddTodayCounterValues(const _eTodayCounterTable table, const uint64_t DeviceRowID, const double *values)
+{
+	std::string szDate = TimeToString(nullptr, TF_Date);
+	std::lock_guard<std::mutex> l(m_todaycounters_mutex);
+	m_todaycounters_generation++;
+	auto itt = m_todaycounters[table].find(DeviceRowID);
+	if (itt == m_todaycounters[table].end())
+		return; //not read yet
+	_tTodayCounter &counter = itt->second;
+	if (counter.Date != szDate)
+	{
+		//new day, read again on first use
+		m_todaycounters[table].erase(itt);
+		return;
+	}
+	for (int ii = 0; ii < TodayCounterTables[table].nValues; ii++)
+	{
+		double value = values[ii];
+		if (!counter.HaveValues)
+		{
+			counter.First[ii] = counter.Min[ii] = counter.Max[ii] = value;
+		}
+		else
+		{
+			if (value < counter.Min[ii])
+				counter.Min[ii] = value;
+			if (value > counter.Max[ii])
+				counter.Max[ii] = value;
+		}
+		counter.Last[ii] = value;
+	}
+	counter.HaveValues = true;
+}
+
+void CSQLHelper::ClearTodayCounters(const uint64_t DeviceRowID)
+{
+	std::lock_guard<std::mutex> l(m_todaycounters_mutex);
+	m_todaycounters_generation++;
+	for (auto &tcounters : m_todaycounters)
+		tcounters.erase(DeviceRowID);
+}
+
+void CSQLHelper::ClearTodayCounters()
+{
+	std::lock_guard<std::mutex> l(m_todaycounters_mutex);
+	m_todaycounters_generation++;
+	for (auto &tcounters : m_todaycounters)
+		tcounters.clear();
+}
+
 void CSQLHelper::VacuumDatabase()
 {
 	query("VACUUM");
@@ -7906,10 +8633,10 @@ void CSQLHelper::DeleteDevices(const std::string& idx)
 #endif
 	{
 		//Avoid mutex deadlock here
-		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+		std::unique_lock<std::mutex> l(LockConnection());
 
 		char* errorMessage;
-		sqlite3_exec(m_dbase, "BEGIN TRANSACTION", nullptr, nullptr, &errorMessage);
+		sqlite3_exec(m_dbase, "SAVEPOINT deletedevices", nullptr, nullptr, &errorMessage);
 
 		for (const auto &str : _idx)
 		{
@@ -7941,13 +8668,17 @@ void CSQLHelper::DeleteDevices(const std::string& idx)
 						str.c_str());
 			safe_exec_no_return("DELETE FROM SharedDevices WHERE (DeviceRowID== '%q')", str.c_str());
 			safe_exec_no_return("DELETE FROM PushLink WHERE (DeviceRowID== '%q')", str.c_str());
-			//notify eventsystem device is no longer present
+			//notify eventsystem and push links device is no longer present
 			uint64_t ullidx = std::stoull(str);
+			CBasePush::InvalidateDevice(ullidx);
+			m_notifications.InvalidateDeviceMeta(ullidx);
+			ClearTodayCounters(ullidx);
+			m_mainworker.ClearRxCoalesce(ullidx);
 			m_mainworker.m_eventsystem.RemoveSingleState(ullidx, m_mainworker.m_eventsystem.REASON_DEVICE);
 			//and now delete all records in the DeviceStatus table itself
 			safe_exec_no_return("DELETE FROM DeviceStatus WHERE (ID == '%q')", str.c_str());
 		}
-		sqlite3_exec(m_dbase, "COMMIT TRANSACTION", nullptr, nullptr, &errorMessage);
+		sqlite3_exec(m_dbase, "RELEASE deletedevices", nullptr, nullptr, &errorMessage);
 	}
 #ifdef ENABLE_PYTHON
 	for (const auto& it : removeddevices)
@@ -7978,10 +8709,10 @@ void CSQLHelper::DeleteScenes(const std::string& idx)
 		return;
 	{
 		//Avoid mutex deadlock here
-		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+		std::unique_lock<std::mutex> l(LockConnection());
 
 		char* errorMessage;
-		sqlite3_exec(m_dbase, "BEGIN TRANSACTION", nullptr, nullptr, &errorMessage);
+		sqlite3_exec(m_dbase, "SAVEPOINT deletescenes", nullptr, nullptr, &errorMessage);
 
 		for (const auto &str : _idx)
 		{
@@ -7993,7 +8724,7 @@ void CSQLHelper::DeleteScenes(const std::string& idx)
 			m_mainworker.m_eventsystem.RemoveSingleState(ullidx, m_mainworker.m_eventsystem.REASON_SCENEGROUP);
 		}
 
-		sqlite3_exec(m_dbase, "COMMIT TRANSACTION", nullptr, nullptr, &errorMessage);
+		sqlite3_exec(m_dbase, "RELEASE deletescenes", nullptr, nullptr, &errorMessage);
 	}
 
 	m_notifications.ReloadNotifications();
@@ -8173,6 +8904,7 @@ void CSQLHelper::DeleteDateRange(const char *ID, const std::string &fromDate, co
 		safe_query("DELETE FROM %q WHERE (DeviceRowID=='%q') AND (Date>='%q') AND (Date<='%q')", historyTable.c_str(), ID, fromDate.c_str(), toDate.c_str() );
 		_log.Debug(DEBUG_NORM, "CSQLHelper::DeleteDateRange; delete from %s with idx: %s and Date >= %s and date <= %s " , historyTable.c_str(), std::string(ID).c_str(), fromDate.c_str(), toDate.c_str() );
 	}
+	ClearTodayCounters(std::strtoull(ID, nullptr, 10));
 }
 
 void CSQLHelper::DeleteDataPoint(const char* ID, const std::string& Date)
@@ -8300,6 +9032,7 @@ bool CSQLHelper::RestoreDatabase(const std::string& dbase)
 	StopThread();
 
 	//stop database
+	CloseReadPool();
 	sqlite3_close(m_dbase);
 	m_dbase = nullptr;
 	std::ofstream outfile2;
@@ -8341,11 +9074,7 @@ bool CSQLHelper::BackupDatabase(const std::string& OutputFile)
 	if (!m_dbase)
 		return false; //database not open!
 
-	//First cleanup the database
 	OptimizeDatabase(m_dbase);
-	VacuumDatabase();
-
-	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
 
 	int rc;					 // Function return code
 	sqlite3* pFile;			 // Database connection opened on zFilename
@@ -8354,24 +9083,54 @@ bool CSQLHelper::BackupDatabase(const std::string& OutputFile)
 	// Open the database file identified by zFilename.
 	rc = sqlite3_open(OutputFile.c_str(), &pFile);
 	if (rc != SQLITE_OK)
+	{
+		sqlite3_close(pFile);
 		return false;
+	}
+
+	//In WAL mode copy from a read transaction on a connection of its own. That is one snapshot for
+	//the whole backup, and the writer is never blocked by it
+	sqlite3 *pSnapshot = nullptr;
+	std::vector<std::vector<std::string>> result = query("PRAGMA journal_mode");
+	if ((!result.empty()) && (result[0][0] == "wal"))
+	{
+		{
+			//move what is in the WAL to the database file first, without waiting for readers
+			std::unique_lock<std::mutex> l(LockConnection());
+			sqlite3_wal_checkpoint_v2(m_dbase, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+		}
+		if ((sqlite3_open_v2(m_dbase_name.c_str(), &pSnapshot, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+		    || (sqlite3_exec(pSnapshot, "BEGIN; SELECT COUNT(*) FROM sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK))
+		{
+			sqlite3_close(pSnapshot);
+			pSnapshot = nullptr;
+		}
+	}
 
 	// Open the sqlite3_backup object used to accomplish the transfer
-	pBackup = sqlite3_backup_init(pFile, "main", m_dbase, "main");
+	pBackup = sqlite3_backup_init(pFile, "main", (pSnapshot != nullptr) ? pSnapshot : m_dbase, "main");
 
 	time_t startTime = time(nullptr);
 
 	if (pBackup)
 	{
-		// Each iteration of this loop copies 5 database pages from database
-		// pDb to the backup database.
+		// Copy a few pages per step and give the writer room in between. Without a snapshot the
+		// main connection is the source and its own writes are applied to the backup as we go.
 		do {
-			rc = sqlite3_backup_step(pBackup, 256);
-			//xProgress(  sqlite3_backup_remaining(pBackup), sqlite3_backup_pagecount(pBackup) );
-			if( rc==SQLITE_BUSY || rc==SQLITE_LOCKED ){
-			  sqlite3_sleep(250);
+			if (pSnapshot != nullptr)
+				rc = sqlite3_backup_step(pBackup, SQL_BACKUP_STEP_PAGES);
+			else
+			{
+				std::unique_lock<std::mutex> l(LockConnection());
+				rc = sqlite3_backup_step(pBackup, SQL_BACKUP_STEP_PAGES);
 			}
-			if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+			if (rc == SQLITE_OK)
+			{
+				sqlite3_sleep(SQL_BACKUP_STEP_SLEEP);
+			}
+			else if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED)
+			{
+				sqlite3_sleep(250);
 				time_t actTime = time(nullptr);
 				if (actTime - startTime > 2 * 60)
 				{
@@ -8385,7 +9144,15 @@ bool CSQLHelper::BackupDatabase(const std::string& OutputFile)
 		/* Release resources allocated by backup_init(). */
 		sqlite3_backup_finish(pBackup);
 	}
+	if (pSnapshot != nullptr)
+	{
+		sqlite3_exec(pSnapshot, "COMMIT", nullptr, nullptr, nullptr);
+		sqlite3_close(pSnapshot);
+	}
 	rc = sqlite3_errcode(pFile);
+	//Compact the copy, instead of the live database
+	if (rc == SQLITE_OK)
+		sqlite3_exec(pFile, "VACUUM", nullptr, nullptr, nullptr);
 	// Close the database connection opened on database file zFilename
 	// and return the result of this function.
 	sqlite3_close(pFile);
@@ -9265,6 +10032,7 @@ void CSQLHelper::UpdateDeviceValue(const char* FieldName, const float Value, con
 void CSQLHelper::UpdateDeviceName(const std::string& Idx, const std::string& Name)
 {
 	safe_query("UPDATE DeviceStatus SET Name='%q', LastUpdate='%q' WHERE (ID == %s )", Name.c_str(), TimeToString(nullptr, TF_DateTime).c_str(), Idx.c_str());
+	CBasePush::InvalidateDevice(std::strtoull(Idx.c_str(), nullptr, 10));
 	SendUpdateInt(Idx);
 }
 
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <boost/signals2.hpp>
 #include "RFXNames.h"
 #include "../hardware/hardwaretypes.h"
 #include "Helper.h"
@@ -64,6 +69,74 @@ enum _eTaskItemType
 	TITEM_CUSTOM_EVENT,
 };
 
+enum _eTodayCounterTable
+{
+	TCTABLE_METER = 0,
+	TCTABLE_RAIN,
+	TCTABLE_MULTIMETER,
+	TCTABLE_COUNT
+};
+
+#define TODAY_COUNTER_VALUES 6 // Value1..Value6 of the MultiMeter table
+
+// First/min/max/last values a device wrote to its short log table since local midnight
+struct _tTodayCounter
+{
+	std::string Date; // YYYY-MM-DD these values belong to
+	bool HaveValues;  // false when the device has no short log rows today
+	double First[TODAY_COUNTER_VALUES];
+	double Min[TODAY_COUNTER_VALUES];
+	double Max[TODAY_COUNTER_VALUES];
+	double Last[TODAY_COUNTER_VALUES];
+};
+
+#define DEVICE_INDEX_SHARDS 16
+
+// Identity of a device as used by the hardware drivers
+struct _tDeviceIndexKey
+{
+	int HardwareID;
+	std::string DeviceID;
+	uint8_t Unit;
+	uint8_t Type;
+	uint8_t SubType;
+
+	bool operator==(const _tDeviceIndexKey &other) const
+	{
+		return (HardwareID == other.HardwareID) && (Unit == other.Unit) && (Type == other.Type) && (SubType == other.SubType) && (DeviceID == other.DeviceID);
+	}
+};
+
+struct _tDeviceIndexKeyHash
+{
+	size_t operator()(const _tDeviceIndexKey &key) const
+	{
+		size_t hash = std::hash<std::string>()(key.DeviceID);
+		hash ^= (size_t)key.HardwareID * 0x9E3779B1 + ((size_t)key.Unit << 16) + ((size_t)key.Type << 8) + key.SubType;
+		return hash;
+	}
+};
+
+// DeviceStatus columns of a device, as last read from or written to the database
+struct _tDeviceIndexEntry
+{
+	uint64_t ID;
+	std::string Name;
+	bool Used;
+	int SwitchType;
+	int nValue;
+	std::string sValue;
+	std::string LastUpdate;
+	std::string Options;
+};
+
+struct _tPreferenceVar
+{
+	int nValue;
+	std::string sValue;
+};
+typedef std::unordered_map<std::string, _tPreferenceVar> _tPreferencesMap;
+
 struct _tTaskItem
 {
 	_eTaskItemType _ItemType;
@@ -342,6 +415,33 @@ class CSQLStatement
 	~CSQLStatement();
 };
 
+class CSQLBenchmark;
+class CSQLHelper;
+
+// Steps through the rows of a SELECT one at a time, for results that do not have to be held in memory at once
+// (streamed web replies). It keeps a read-only connection of its own until the last row or until it is destroyed,
+// without the read pool the whole result is fetched at the start.
+class CSQLCursor
+{
+      public:
+	~CSQLCursor();
+	// Returns the next row in row (rows starting with NULL are skipped, like safe_query does), false at the end
+	bool Step(std::vector<std::string> &row);
+
+      private:
+	friend class CSQLHelper;
+	explicit CSQLCursor(CSQLHelper *pHelper);
+	void Close();
+
+	CSQLHelper *m_pHelper;
+	sqlite3 *m_pReader = nullptr;
+	sqlite3_stmt *m_statement = nullptr;
+	uint32_t m_generation = 0;
+	std::string m_szQuery;
+	std::vector<std::vector<std::string>> m_rows; // without a reader
+	size_t m_iRow = 0;
+};
+
 class CSQLHelper : public StoppableTask
 {
       public:
@@ -443,6 +543,12 @@ class CSQLHelper : public StoppableTask
 	int execute_sql(const std::string &sSQL, std::vector<std::string> *pValues, bool bLogError);
 	std::vector<std::vector<std::string>> safe_query(const char *fmt, ...);
 	std::vector<std::vector<std::string>> safe_queryBlob(const char *fmt, ...);
+	// Always runs on the main connection, for SELECTs that fill a cache invalidated by the DeviceStatus
+	// update hook: a read-only connection could still return the row of before a write that the hook
+	// has already seen, which would then be cached as current
+	std::vector<std::vector<std::string>> safe_queryWriter(const char *fmt, ...);
+	// Like safe_query, but the rows are read while the caller steps through them
+	std::shared_ptr<CSQLCursor> safe_cursor(const char *fmt, ...);
 	void safe_exec_no_return(const char *fmt, ...);
 	bool safe_UpdateBlobInTableWithID(const std::string &Table, const std::string &Column, const std::string &sID, const std::string &BlobData);
 	bool DoesColumnExistsInTable(const std::string &columnname, const std::string &tablename);
@@ -475,6 +581,32 @@ class CSQLHelper : public StoppableTask
 
 	float GetCounterDivider(int metertype, int dType, float DefaultValue);
 
+	// Today's short log values of a device (Meter: Value, Rain: Total/Rate, MultiMeter: Value1..6)
+	// without a database lookup once the device has been seen today
+	bool GetTodayCounter(_eTodayCounterTable table, uint64_t DeviceRowID, _tTodayCounter &counter);
+	void ClearTodayCounters(uint64_t DeviceRowID);
+	void ClearTodayCounters();
+
+	// Looks up a device by (HardwareID, DeviceID, Unit, Type, SubType), known devices are served from memory.
+	// Any change to a DeviceStatus row drops it from the index (through the sqlite update hook).
+	bool GetDeviceIndexEntry(int HardwareID, const std::string &DeviceID, unsigned char unit, unsigned char devType, unsigned char subType, _tDeviceIndexEntry &entry);
+
+	// Groups the statements that follow of the calling thread in one transaction (a savepoint), returns
+	// false when a transaction was already active (the caller should not commit then).
+	// Statements of other threads never run inside it: the part done so far is committed first.
+	bool BeginTransaction();
+	void CommitTransaction();
+
+	// Adds up the execution time of every statement per thread, used to measure the RX pipeline
+	void SetStatementProfiling(bool bEnable);
+	// Nanoseconds the calling thread spent in sqlite statements while profiling was enabled
+	static uint64_t GetThreadStatementTime();
+
+	// Lets the SELECTs of the calling thread run on a pool of read-only connections (WAL mode only),
+	// so they do not wait for (or block) the writer. The thread that owns the transaction of
+	// BeginTransaction keeps using the writer, so it reads back its own changes.
+	static void SetThreadReadPool(bool bEnable);
+
       public:
 	std::string m_LastSwitchID; // for learning command
 	std::string m_UniqueID;
@@ -497,14 +629,34 @@ class CSQLHelper : public StoppableTask
 	bool m_bShortLogAddOnlyNewValues;
 	bool m_bLogEventScriptTrigger;
 	bool m_bDisableDzVentsSystem;
+	int m_EventSystemBatchSize;
+	int m_EventSystemBatchWindow;
+	bool m_bEventSystemDebounce;
 	double m_max_kwh_usage;
 
+	// Fired after a preference has been updated or deleted (with the Key)
+	boost::signals2::signal<void(const std::string &Key)> sOnPreferenceChanged;
+
       private:
+	friend class CSQLBenchmark;
+	friend class CSQLCursor;
+
 	std::mutex m_executeThreadMutex;
 	std::mutex m_sqlQueryMutex;
+	std::atomic<std::thread::id> m_transaction_thread; // owner of the BeginTransaction transaction
 	sqlite3 *m_dbase;
 	std::string m_dbase_name;
 	std::string m_journal_mode;
+	bool m_bStatementProfiling;
+
+	std::mutex m_readpool_mutex;
+	std::condition_variable m_readpool_cond;
+	std::vector<sqlite3 *> m_readpool;	// every open read-only connection
+	std::vector<sqlite3 *> m_readpool_free;
+	bool m_bReadPool;
+	int m_readpool_cursors; // connections taken out of the pool by a CSQLCursor
+	std::atomic<uint32_t> m_readpool_generation; // changes when the pool is closed
+
 	unsigned char m_sensortimeoutcounter;
 	std::map<uint64_t, int> m_timeoutlastsend;
 	std::map<uint64_t, int> m_batterylowlastsend;
@@ -512,6 +664,22 @@ class CSQLHelper : public StoppableTask
 	float m_iAcceptHardwareTimerCounter;
 	bool m_bPreviousAcceptNewHardware;
 
+	std::mutex m_preferences_mutex; // serializes writers, readers use the current snapshot
+	std::shared_ptr<const _tPreferencesMap> m_preferences;
+
+	struct _tDeviceIndexShard
+	{
+		std::mutex mutex;
+		std::unordered_map<_tDeviceIndexKey, _tDeviceIndexEntry, _tDeviceIndexKeyHash> devices;
+		std::unordered_map<uint64_t, _tDeviceIndexKey> rows; // DeviceStatus ID -> key
+	};
+	_tDeviceIndexShard m_deviceindex[DEVICE_INDEX_SHARDS];
+	std::atomic<uint64_t> m_deviceindex_generation;
+
+	std::mutex m_todaycounters_mutex;
+	std::unordered_map<uint64_t, _tTodayCounter> m_todaycounters[TCTABLE_COUNT];
+	uint64_t m_todaycounters_generation;
+
 	std::vector<_tTaskItem> m_background_task_queue;
 	std::shared_ptr<std::thread> m_thread;
 	std::mutex m_background_task_mutex;
@@ -563,8 +731,26 @@ class CSQLHelper : public StoppableTask
 	bool CheckDateTimeSQL(const std::string &sDateTime);
 	bool CheckTime(const std::string &sTime);
 	void SendUpdateInt(const std::string& Idx);
+	void LoadPreferences();
+	void ClearPreferences();
+	void SetPreferencesCache(const std::string &Key, const _tPreferenceVar *pVar);
+	void ClearDeviceIndex();
+	std::unique_lock<std::mutex> LockConnection();
+	void OnDeviceStatusChanged(int op, uint64_t DeviceRowID);
+	static void DeviceStatusUpdateHook(void *pUser, int op, const char *szDatabase, const char *szTable, long long rowid);
+	static void DeviceStatusRollbackHook(void *pUser);
+	static int StatementProfileCallback(unsigned int uType, void *pUser, void *pStatement, void *pTime);
+	void OpenReadPool();
+	void CloseReadPool();
+	sqlite3 *OpenReader();
+	sqlite3 *AcquireReader(const std::string &szQuery);
+	void ReleaseReader(sqlite3 *pReader);
+	sqlite3 *DetachReader(uint32_t &generation);
+	void AttachReader(sqlite3 *pReader, uint32_t generation);
+	void AddTodayCounterValues(_eTodayCounterTable table, uint64_t DeviceRowID, const double *values);
 
 	std::vector<std::vector<std::string>> query(const std::string &szQuery);
+	std::vector<std::vector<std::string>> queryConnection(sqlite3 *pDB, const std::string &szQuery);
 	std::vector<std::vector<std::string>> queryBlob(const std::string &szQuery);
 };
 
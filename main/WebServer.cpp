@@ -74,6 +74,8 @@
 
 #define round(a) (int)(a + .5)
 
+#define JSON_STREAM_BLOCK_SIZE (16 * 1024) // streamed JSON replies are handed to the connection in blocks of about this size
+
 extern std::string szStartupFolder;
 extern std::string szUserDataFolder;
 extern std::string szWWWFolder;
@@ -112,6 +114,7 @@ namespace http
 {
 	namespace server
 	{
+		extern time_t last_write_time(const std::string& path);
 
 		CWebServer::CWebServer()
 		{
@@ -131,6 +134,7 @@ namespace http
 
 		void CWebServer::Do_Work()
 		{
+			m_sql.SetThreadReadPool(true);
 			bool exception_thrown = false;
 			while (!m_bDoStop)
 			{
@@ -413,7 +417,7 @@ namespace http
 				"getuptime", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetUptime(session, req, root); }, true);
 
 			RegisterCommandCode("storesettings", [this](auto&& session, auto&& req, auto&& root) { Cmd_PostSettings(session, req, root); });
-			RegisterCommandCode("getlog", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetLog(session, req, root); });
+			RegisterCommandStream("getlog", [this](auto&& session, auto&& req) { return Cmd_GetLog(session, req); });
 			RegisterCommandCode("clearlog", [this](auto&& session, auto&& req, auto&& root) { Cmd_ClearLog(session, req, root); });
 			RegisterCommandCode("gethardwaretypes", [this](auto&& session, auto&& req, auto&& root) { Cmd_GetHardwareTypes(session, req, root); });
 			RegisterCommandCode("addhardware", [this](auto&& session, auto&& req, auto&& root) { Cmd_AddHardware(session, req, root); });
@@ -610,16 +614,16 @@ namespace http
 
 			RegisterCommandCode("tellstickApplySettings", [this](auto&& session, auto&& req, auto&& root) { Cmd_TellstickApplySettings(session, req, root); });
 
-			RegisterRType("graph", [this](auto&& session, auto&& req, auto&& root) { RType_HandleGraph(session, req, root); });
-			RegisterRType("lightlog", [this](auto&& session, auto&& req, auto&& root) { RType_LightLog(session, req, root); });
-			RegisterRType("textlog", [this](auto&& session, auto&& req, auto&& root) { RType_TextLog(session, req, root); });
+			RegisterRTypeStream("graph", [this](auto&& session, auto&& req) { return RType_HandleGraphStream(session, req); });
+			RegisterRTypeStream("lightlog", [this](auto&& session, auto&& req) { return RType_LightLog(session, req); });
+			RegisterRTypeStream("textlog", [this](auto&& session, auto&& req) { return RType_TextLog(session, req); });
 			RegisterRType("scenelog", [this](auto&& session, auto&& req, auto&& root) { RType_SceneLog(session, req, root); });
 			RegisterRType("rclientslog", [this](auto&& session, auto&& req, auto&& root) { RType_RemoteWebClientsLog(session, req, root); });
 			RegisterRType("settings", [this](auto&& session, auto&& req, auto&& root) { RType_Settings(session, req, root); });
 			RegisterRType("events", [this](auto&& session, auto&& req, auto&& root) { RType_Events(session, req, root); });
 
 			RegisterRType("hardware", [this](auto&& session, auto&& req, auto&& root) { RType_Hardware(session, req, root); });
-			RegisterRType("devices", [this](auto&& session, auto&& req, auto&& root) { RType_Devices(session, req, root); });
+			RegisterRTypeStream("devices", [this](auto&& session, auto&& req) { return RType_Devices(session, req); });
 			RegisterRType("deletedevice", [this](auto&& session, auto&& req, auto&& root) { RType_DeleteDevice(session, req, root); });
 			RegisterRType("cameras", [this](auto&& session, auto&& req, auto&& root) { RType_Cameras(session, req, root); });
 			RegisterRType("cameras_user", [this](auto&& session, auto&& req, auto&& root) { RType_CamerasUser(session, req, root); });
@@ -808,6 +812,16 @@ namespace http
 			m_webrtypes.insert(std::pair<std::string, webserver_response_function>(std::string(idname), ResponseFunction));
 		}
 
+		void CWebServer::RegisterRTypeStream(const char* idname, const webserver_stream_function& ResponseFunction)
+		{
+			m_webrtypes_stream.insert(std::pair<std::string, webserver_stream_function>(std::string(idname), ResponseFunction));
+		}
+
+		void CWebServer::RegisterCommandStream(const char* idname, const webserver_stream_function& ResponseFunction)
+		{
+			m_webcommands_stream.insert(std::pair<std::string, webserver_stream_function>(std::string(idname), ResponseFunction));
+		}
+
 		void CWebServer::HandleRType(const std::string& rtype, WebEmSession& session, const request& req, Json::Value& root)
 		{
 			auto pf = m_webrtypes.find(rtype);
@@ -817,12 +831,142 @@ namespace http
 			}
 		}
 
+		// Streams root as an object with a "result" array that next fills one row at a time (false after the last row),
+		// like the Json::Value handlers the result is left out when there are no rows. A result already in root is sent
+		// the same way, a row at a time.
+		CWebServer::json_stream_step CWebServer::JSonStreamResult(const Json::Value& root, const std::function<bool(Json::Value& row)>& next)
+		{
+			struct _tResultStream
+			{
+				Json::Value root;
+				std::vector<std::string> members;
+				size_t iMember = 0;
+				std::function<bool(Json::Value& row)> next;
+				Json::Value result; // a result that was already in root
+				Json::ArrayIndex iResult = 0;
+				Json::Value row;
+				bool bHaveRow = false;
+				bool bInResult = false;
+			};
+			auto stream = std::make_shared<_tResultStream>();
+			stream->root = root;
+			stream->next = next;
+			if ((stream->root.isMember("result")) && (stream->root["result"].isArray()))
+			{
+				stream->root.removeMember("result", &stream->result);
+				stream->next = [stream = stream.get()](Json::Value& row) {
+					if (stream->iResult >= stream->result.size())
+						return false;
+					row.swap(stream->result[stream->iResult]);
+					stream->iResult++;
+					return true;
+				};
+				stream->bInResult = true; // even when it is empty
+			}
+			stream->members = stream->root.getMemberNames(); // sorted, like the keys in toStyledString
+
+			int iState = 0;
+			return [stream, iState](CJSonStreamWriter& writer) mutable {
+				switch (iState)
+				{
+				case 0:
+					// the members in front of the result
+					writer.BeginObject();
+					while ((stream->iMember < stream->members.size()) && (stream->members[stream->iMember] < "result"))
+					{
+						writer.Key(stream->members[stream->iMember].c_str());
+						writer.Value(stream->root[stream->members[stream->iMember]]);
+						stream->iMember++;
+					}
+					if (stream->next)
+						stream->bHaveRow = stream->next(stream->row);
+					if ((stream->bHaveRow) || (stream->bInResult))
+					{
+						writer.Key("result");
+						writer.BeginArray();
+						stream->bInResult = true;
+					}
+					iState = 1;
+					return true;
+				case 1:
+					if (stream->bHaveRow)
+					{
+						writer.Value(stream->row);
+						stream->row = Json::Value();
+						stream->bHaveRow = stream->next(stream->row);
+						return true;
+					}
+					if (stream->bInResult)
+						writer.EndArray();
+					stream->next = nullptr;
+					stream->result = Json::Value();
+					while (stream->iMember < stream->members.size())
+					{
+						writer.Key(stream->members[stream->iMember].c_str());
+						writer.Value(stream->root[stream->members[stream->iMember]]);
+						stream->iMember++;
+					}
+					writer.EndObject();
+					iState = 2;
+					return false;
+				default:
+					return false;
+				}
+			};
+		}
+
 		void CWebServer::GetJSonPage(WebEmSession& session, const request& req, reply& rep)
 		{
+			std::string rtype = request::findValue(&req, "type");
+			webserver_stream_function pfStream;
+			if (rtype == "command")
+			{
+				auto pf = m_webcommands_stream.find(request::findValue(&req, "param"));
+				if (pf != m_webcommands_stream.end())
+					pfStream = pf->second;
+			}
+			else
+			{
+				auto pf = m_webrtypes_stream.find(rtype);
+				if (pf != m_webrtypes_stream.end())
+					pfStream = pf->second;
+			}
+			if (pfStream)
+			{
+				struct _tJSonStream
+				{
+					std::string buffer;
+					CJSonStreamWriter writer{ buffer };
+					json_stream_step step;
+					std::string jcallback;
+					bool bStarted = false;
+				};
+				auto stream = std::make_shared<_tJSonStream>();
+				stream->step = pfStream(session, req);
+				stream->jcallback = request::findValue(&req, "jsoncallback");
+				reply::set_stream(&rep, [stream](std::string &chunk) {
+					if (!stream->bStarted)
+					{
+						stream->bStarted = true;
+						if (!stream->jcallback.empty())
+							chunk = "var data=";
+					}
+					bool bMore = true;
+					while ((bMore) && (stream->buffer.size() < JSON_STREAM_BLOCK_SIZE))
+						bMore = stream->step(stream->writer);
+					if (!bMore)
+						stream->writer.Finish();
+					stream->writer.TakeOutput(chunk);
+					if ((!bMore) && (!stream->jcallback.empty()))
+						chunk += '\n' + stream->jcallback + "(data);";
+					return bMore;
+				});
+				return;
+			}
+
 			Json::Value root;
 			root["status"] = "ERR";
 
-			std::string rtype = request::findValue(&req, "type");
 			if (rtype == "command")
 			{
 				std::string cparam = request::findValue(&req, "param");
@@ -2087,8 +2231,9 @@ namespace http
 			m_sql.DeleteHardware(idx);
 		}
 
-		void CWebServer::Cmd_GetLog(WebEmSession& session, const request& req, Json::Value& root)
+		CWebServer::json_stream_step CWebServer::Cmd_GetLog(WebEmSession& session, const request& req)
 		{
+			Json::Value root;
 			root["status"] = "OK";
 			root["title"] = "GetLog";
 
@@ -2107,20 +2252,22 @@ namespace http
 				lLevel = (_eLogLevel)atoi(sloglevel.c_str());
 			}
 
-			std::list<CLogger::_tLogLineStruct> logmessages = _log.GetLog(lLevel);
-			int ii = 0;
-			for (const auto& msg : logmessages)
+			// LastLogTime is written before the result, the messages are converted while they are sent
+			auto logmessages = std::make_shared<std::list<CLogger::_tLogLineStruct>>(_log.GetLog(lLevel, lastlogtime));
+			if (!logmessages->empty())
 			{
-				if (msg.logtime > lastlogtime)
-				{
-					std::stringstream szLogTime;
-					szLogTime << msg.logtime;
-					root["LastLogTime"] = szLogTime.str();
-					root["result"][ii]["level"] = static_cast<int>(msg.level);
-					root["result"][ii]["message"] = msg.logmessage;
-					ii++;
-				}
+				std::stringstream szLogTime;
+				szLogTime << logmessages->back().logtime;
+				root["LastLogTime"] = szLogTime.str();
 			}
+			return JSonStreamResult(root, [logmessages](Json::Value& row) {
+				if (logmessages->empty())
+					return false;
+				row["level"] = static_cast<int>(logmessages->front().level);
+				row["message"] = logmessages->front().logmessage;
+				logmessages->pop_front();
+				return true;
+			});
 		}
 
 		void CWebServer::Cmd_ClearLog(WebEmSession& session, const request& req, Json::Value& root)
@@ -8294,6 +8441,23 @@ namespace http
 				m_sql.UpdatePreferencesVar("EventSystemLogFullURL", (int)m_sql.m_bEnableEventSystemFullURLLog);
 				cntSettings++;
 
+				int EventSystemBatchSize = atoi(request::findValue(&req, "EventSystemBatchSize").c_str());
+				if (EventSystemBatchSize < 1)
+					EventSystemBatchSize = 100;
+				m_sql.m_EventSystemBatchSize = EventSystemBatchSize;
+				m_sql.UpdatePreferencesVar("EventSystemBatchSize", EventSystemBatchSize); cntSettings++;
+
+				int EventSystemBatchWindow = atoi(request::findValue(&req, "EventSystemBatchWindow").c_str());
+				if (EventSystemBatchWindow < 0)
+					EventSystemBatchWindow = 0;
+				else if (EventSystemBatchWindow > 5000)
+					EventSystemBatchWindow = 5000;
+				m_sql.m_EventSystemBatchWindow = EventSystemBatchWindow;
+				m_sql.UpdatePreferencesVar("EventSystemBatchWindow", EventSystemBatchWindow); cntSettings++;
+
+				m_sql.m_bEventSystemDebounce = (request::findValue(&req, "EventSystemDebounce") == "on");
+				m_sql.UpdatePreferencesVar("EventSystemDebounce", m_sql.m_bEventSystemDebounce ? 1 : 0); cntSettings++;
+
 				rnOldvalue = 0;
 				m_sql.GetPreferencesVar("DisableDzVentsSystem", rnOldvalue);
 				std::string DisableDzVentsSystem = request::findValue(&req, "DisableDzVentsSystem");
@@ -8413,25 +8577,103 @@ namespace http
 			std::string Mode2; // Used to flag DimmerType as relative for some old LimitLessLight type bulbs
 		} tHardwareList;
 
+		// What GetJSonDevices needs to go from one row to the next, so the list can also be sent while it is read
+		struct CWebServer::_tDeviceListState
+		{
+			std::string rused;
+			std::string rfilter;
+			std::string planID;
+			bool bDisplayHidden = false;
+			bool bDisplayDisabled = false;
+			bool bFetchFavorites = false;
+
+			time_t now = 0;
+			struct tm tm1;
+			struct tm tLastUpdate;
+			time_t iLastUpdate = 0;
+			int SensorTimeOut = 60;
+			unsigned char tempsign = 'C';
+			std::map<int, _tHardwareListInt> _hardwareNames;
+			std::set<std::string> _HiddenDevices;
+			bool bAllowDeviceToBeHidden = false;
+
+			std::shared_ptr<CSQLCursor> scenes;
+			std::shared_ptr<CSQLCursor> devices;
+			Json::Value pending; // the last entry, the next row can still add a plan to it
+			bool bHavePending = false;
+		};
+
 		void CWebServer::GetJSonDevices(Json::Value& root, const std::string& rused, const std::string& rfilter, const std::string& order, const std::string& rowid, const std::string& planID,
 			const std::string& floorID, const bool bDisplayHidden, const bool bDisplayDisabled, const bool bFetchFavorites, const time_t LastUpdate,
 			const std::string& username, const std::string& hardwareid)
+		{
+			_tDeviceListState state;
+			OpenJSonDevices(state, root, rused, rfilter, order, rowid, planID, floorID, bDisplayHidden, bDisplayDisabled, bFetchFavorites, LastUpdate, username, hardwareid);
+			Json::Value item;
+			int ii = 0;
+			while (NextJSonDevice(state, item))
+				root["result"][ii++].swap(item);
+		}
+
+		// Returns the next entry of the list in item, false after the last one
+		bool CWebServer::NextJSonDevice(_tDeviceListState& state, Json::Value& item)
+		{
+			std::vector<std::string> sd;
+			while (true)
+			{
+				Json::Value row;
+				Json::Value* prev = (state.bHavePending) ? &state.pending : nullptr;
+				bool bNewEntry;
+				if ((state.scenes) && (state.scenes->Step(sd)))
+					bNewEntry = GetJSonSceneRow(state, sd, row, prev);
+				else if ((state.devices) && (state.devices->Step(sd)))
+					bNewEntry = GetJSonDeviceRow(state, sd, row, prev);
+				else
+					break;
+				if (!bNewEntry)
+					continue;
+				if (!state.bHavePending)
+				{
+					state.pending.swap(row);
+					state.bHavePending = true;
+					continue;
+				}
+				item.swap(state.pending);
+				state.pending.swap(row);
+				return true;
+			}
+			if (!state.bHavePending)
+				return false;
+			item.swap(state.pending);
+			state.pending = Json::Value();
+			state.bHavePending = false;
+			return true;
+		}
+
+		// Everything GetJSonDevices does in front of the first entry: the members before the result go in root,
+		// the scenes and devices to list are selected in state
+		void CWebServer::OpenJSonDevices(_tDeviceListState& state, Json::Value& root, const std::string& rused, const std::string& rfilter, const std::string& order, const std::string& rowid, const std::string& planID,
+			const std::string& floorID, const bool bDisplayHidden, const bool bDisplayDisabled, const bool bFetchFavorites, const time_t LastUpdate,
+			const std::string& username, const std::string& hardwareid)
 		{
 			std::vector<std::vector<std::string>> result;
 
-			time_t now = mytime(nullptr);
-			struct tm tm1;
-			localtime_r(&now, &tm1);
-			struct tm tLastUpdate;
-			localtime_r(&now, &tLastUpdate);
+			state.rused = rused;
+			state.rfilter = rfilter;
+			state.planID = planID;
+			state.bDisplayHidden = bDisplayHidden;
+			state.bDisplayDisabled = bDisplayDisabled;
+			state.bFetchFavorites = bFetchFavorites;
 
-			const time_t iLastUpdate = LastUpdate - 1;
+			state.now = mytime(nullptr);
+			localtime_r(&state.now, &state.tm1);
+			localtime_r(&state.now, &state.tLastUpdate);
 
-			int SensorTimeOut = 60;
-			m_sql.GetPreferencesVar("SensorTimeout", SensorTimeOut);
+			state.iLastUpdate = LastUpdate - 1;
+
+			m_sql.GetPreferencesVar("SensorTimeout", state.SensorTimeOut);
 
 			// Get All Hardware ID's/Names, need them later
-			std::map<int, _tHardwareListInt> _hardwareNames;
 			result = m_sql.safe_query("SELECT ID, Name, Enabled, Type, Mode1, Mode2 FROM Hardware");
 			if (!result.empty())
 			{
@@ -8456,11 +8698,11 @@ namespace http
 #endif
 					tlist.Mode1 = sd[4];
 					tlist.Mode2 = sd[5];
-					_hardwareNames[ID] = tlist;
+					state._hardwareNames[ID] = tlist;
 				}
 			}
 
-			root["ActTime"] = static_cast<int>(now);
+			root["ActTime"] = static_cast<int>(state.now);
 
 			char szTmp[300];
 
@@ -8471,7 +8713,7 @@ namespace http
 				if (strarray.size() == 10)
 				{
 					// strftime(szTmp, 80, "%b %d %Y %X", &tm1);
-					strftime(szTmp, 80, "%Y-%m-%d %X", &tm1);
+					strftime(szTmp, 80, "%Y-%m-%d %X", &state.tm1);
 					root["ServerTime"] = szTmp;
 					root["Sunrise"] = strarray[0];
 					root["Sunset"] = strarray[1];
@@ -8506,7 +8748,7 @@ namespace http
 				sprintf(szOrderBy, "A.[Order],A.%s ASC", order.c_str());
 			}
 
-			unsigned char tempsign = m_sql.m_tempsign[0];
+			state.tempsign = m_sql.m_tempsign[0];
 
 			bool bHaveUser = false;
 			int iUser = -1;
@@ -8531,30 +8773,27 @@ namespace http
 				}
 			}
 
-			std::set<std::string> _HiddenDevices;
-			bool bAllowDeviceToBeHidden = false;
 
-			int ii = 0;
 			if (rfilter == "all")
 			{
 				if ((bShowScenes) && ((rused == "all") || (rused == "true")))
 				{
 					// add scenes
 					if (!rowid.empty())
-						result = m_sql.safe_query("SELECT A.ID, A.Name, A.nValue, A.LastUpdate, A.Favorite, A.SceneType,"
+						state.scenes = m_sql.safe_cursor("SELECT A.ID, A.Name, A.nValue, A.LastUpdate, A.Favorite, A.SceneType,"
 							" A.Protected, B.XOffset, B.YOffset, B.PlanID, A.Description"
 							" FROM Scenes as A"
 							" LEFT OUTER JOIN DeviceToPlansMap as B ON (B.DeviceRowID==a.ID) AND (B.DevSceneType==1)"
 							" WHERE (A.ID=='%q')",
 							rowid.c_str());
 					else if ((!planID.empty()) && (planID != "0"))
-						result = m_sql.safe_query("SELECT A.ID, A.Name, A.nValue, A.LastUpdate, A.Favorite, A.SceneType,"
+						state.scenes = m_sql.safe_cursor("SELECT A.ID, A.Name, A.nValue, A.LastUpdate, A.Favorite, A.SceneType,"
 							" A.Protected, B.XOffset, B.YOffset, B.PlanID, A.Description"
 							" FROM Scenes as A, DeviceToPlansMap as B WHERE (B.PlanID=='%q')"
 							" AND (B.DeviceRowID==a.ID) AND (B.DevSceneType==1) ORDER BY B.[Order]",
 							planID.c_str());
 					else if ((!floorID.empty()) && (floorID != "0"))
-						result = m_sql.safe_query("SELECT A.ID, A.Name, A.nValue, A.LastUpdate, A.Favorite, A.SceneType,"
+						state.scenes = m_sql.safe_cursor("SELECT A.ID, A.Name, A.nValue, A.LastUpdate, A.Favorite, A.SceneType,"
 							" A.Protected, B.XOffset, B.YOffset, B.PlanID, A.Description"
 							" FROM Scenes as A, DeviceToPlansMap as B, Plans as C"
 							" WHERE (C.FloorplanID=='%q') AND (C.ID==B.PlanID) AND (B.DeviceRowID==a.ID)"
@@ -8568,109 +8807,18 @@ namespace http
 							" LEFT OUTER JOIN DeviceToPlansMap as B ON (B.DeviceRowID==a.ID) AND (B.DevSceneType==1)"
 							" ORDER BY ");
 						szQuery += szOrderBy;
-						result = m_sql.safe_query(szQuery.c_str(), order.c_str());
-					}
-
-					if (!result.empty())
-					{
-						for (const auto& sd : result)
-						{
-							unsigned char favorite = atoi(sd[4].c_str());
-							// Check if we only want favorite devices
-							if ((bFetchFavorites) && (!favorite))
-								continue;
-
-							std::string sLastUpdate = sd[3];
-
-							if (iLastUpdate != 0)
-							{
-								time_t cLastUpdate;
-								ParseSQLdatetime(cLastUpdate, tLastUpdate, sLastUpdate, tm1.tm_isdst);
-								if (cLastUpdate <= iLastUpdate)
-									continue;
-							}
-
-							int nValue = atoi(sd[2].c_str());
-
-							unsigned char scenetype = atoi(sd[5].c_str());
-							int iProtected = atoi(sd[6].c_str());
-
-							std::string sSceneName = sd[1];
-							if (!bDisplayHidden && sSceneName[0] == '$')
-							{
-								continue;
-							}
-
-							if (scenetype == 0)
-							{
-								root["result"][ii]["Type"] = "Scene";
-								root["result"][ii]["TypeImg"] = "scene";
-								root["result"][ii]["Image"] = "Push";
-							}
-							else
-							{
-								root["result"][ii]["Type"] = "Group";
-								root["result"][ii]["TypeImg"] = "group";
-							}
-
-							// has this scene/group already been seen, now with different plan?
-							// assume results are ordered such that same device is adjacent
-							// if the idx and the Type are equal (type to prevent matching against Scene with same idx)
-							std::string thisIdx = sd[0];
-
-							if ((ii > 0) && thisIdx == root["result"][ii - 1]["idx"].asString())
-							{
-								std::string typeOfThisOne = root["result"][ii]["Type"].asString();
-								if (typeOfThisOne == root["result"][ii - 1]["Type"].asString())
-								{
-									root["result"][ii - 1]["PlanIDs"].append(atoi(sd[9].c_str()));
-									continue;
-								}
-							}
-
-							root["result"][ii]["idx"] = sd[0];
-							root["result"][ii]["Name"] = sSceneName;
-							root["result"][ii]["Description"] = sd[10];
-							root["result"][ii]["Favorite"] = favorite;
-							root["result"][ii]["Protected"] = (iProtected != 0);
-							root["result"][ii]["LastUpdate"] = sLastUpdate;
-							root["result"][ii]["PlanID"] = sd[9].c_str();
-							Json::Value jsonArray;
-							jsonArray.append(atoi(sd[9].c_str()));
-							root["result"][ii]["PlanIDs"] = jsonArray;
-
-							if (nValue == 0)
-								root["result"][ii]["Status"] = "Off";
-							else if (nValue == 1)
-								root["result"][ii]["Status"] = "On";
-							else
-								root["result"][ii]["Status"] = "Mixed";
-							root["result"][ii]["Data"] = root["result"][ii]["Status"];
-							uint64_t camIDX = m_mainworker.m_cameras.IsDevSceneInCamera(1, sd[0]);
-							root["result"][ii]["UsedByCamera"] = (camIDX != 0) ? true : false;
-							if (camIDX != 0)
-							{
-								std::stringstream scidx;
-								scidx << camIDX;
-								root["result"][ii]["CameraIdx"] = scidx.str();
-								root["result"][ii]["CameraAspect"] = m_mainworker.m_cameras.GetCameraAspectRatio(scidx.str());
-							}
-							root["result"][ii]["XOffset"] = atoi(sd[7].c_str());
-							root["result"][ii]["YOffset"] = atoi(sd[8].c_str());
-							ii++;
-						}
+						state.scenes = m_sql.safe_cursor(szQuery.c_str(), order.c_str());
 					}
 				}
 			}
 
-			char szData[320];
 			if (totUserDevices == 0)
 			{
 				// All
 				if (!rowid.empty())
 				{
 					//_log.Log(LOG_STATUS, "Getting device with id: %s", rowid.c_str());
-					result = m_sql.safe_query("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used, A.Type, A.SubType,"
+					state.devices = m_sql.safe_cursor("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used, A.Type, A.SubType,"
 						" A.SignalLevel, A.BatteryLevel, A.nValue, A.sValue,"
 						" A.LastUpdate, A.Favorite, A.SwitchType, A.HardwareID,"
 						" A.AddjValue, A.AddjMulti, A.AddjValue2, A.AddjMulti2,"
@@ -8682,7 +8830,7 @@ namespace http
 						rowid.c_str());
 				}
 				else if ((!planID.empty()) && (planID != "0"))
-					result = m_sql.safe_query("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
+					state.devices = m_sql.safe_cursor("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
 						" A.Type, A.SubType, A.SignalLevel, A.BatteryLevel,"
 						" A.nValue, A.sValue, A.LastUpdate, A.Favorite,"
 						" A.SwitchType, A.HardwareID, A.AddjValue,"
@@ -8696,7 +8844,7 @@ namespace http
 						" AND (B.DevSceneType==0) ORDER BY B.[Order]",
 						planID.c_str());
 				else if ((!floorID.empty()) && (floorID != "0"))
-					result = m_sql.safe_query("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
+					state.devices = m_sql.safe_cursor("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
 						" A.Type, A.SubType, A.SignalLevel, A.BatteryLevel,"
 						" A.nValue, A.sValue, A.LastUpdate, A.Favorite,"
 						" A.SwitchType, A.HardwareID, A.AddjValue,"
@@ -8725,11 +8873,11 @@ namespace http
 							{
 								for (const auto& r : result)
 								{
-									_HiddenDevices.insert(r[0]);
+									state._HiddenDevices.insert(r[0]);
 								}
 							}
 						}
-						bAllowDeviceToBeHidden = true;
+						state.bAllowDeviceToBeHidden = true;
 					}
 
 					if (order.empty() || (!isAlpha))
@@ -8753,7 +8901,7 @@ namespace http
 							"WHERE (A.HardwareID == %q) "
 							"ORDER BY ");
 						szQuery += szOrderBy;
-						result = m_sql.safe_query(szQuery.c_str(), hardwareid.c_str(), order.c_str());
+						state.devices = m_sql.safe_cursor(szQuery.c_str(), hardwareid.c_str(), order.c_str());
 					}
 					else
 					{
@@ -8768,7 +8916,7 @@ namespace http
 							"ON (B.DeviceRowID==a.ID) AND (B.DevSceneType==0) "
 							"ORDER BY ");
 						szQuery += szOrderBy;
-						result = m_sql.safe_query(szQuery.c_str(), order.c_str());
+						state.devices = m_sql.safe_cursor(szQuery.c_str(), order.c_str());
 					}
 				}
 			}
@@ -8782,7 +8930,7 @@ namespace http
 				if (!rowid.empty())
 				{
 					//_log.Log(LOG_STATUS, "Getting device with id: %s for user %lu", rowid.c_str(), m_users[iUser].ID);
-					result = m_sql.safe_query("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
+					state.devices = m_sql.safe_cursor("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
 						" A.Type, A.SubType, A.SignalLevel, A.BatteryLevel,"
 						" A.nValue, A.sValue, A.LastUpdate, B.Favorite,"
 						" A.SwitchType, A.HardwareID, A.AddjValue,"
@@ -8797,7 +8945,7 @@ namespace http
 						m_users[iUser].ID, rowid.c_str());
 				}
 				else if ((!planID.empty()) && (planID != "0"))
-					result = m_sql.safe_query("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
+					state.devices = m_sql.safe_cursor("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
 						" A.Type, A.SubType, A.SignalLevel, A.BatteryLevel,"
 						" A.nValue, A.sValue, A.LastUpdate, B.Favorite,"
 						" A.SwitchType, A.HardwareID, A.AddjValue,"
@@ -8813,7 +8961,7 @@ namespace http
 						"AND (B.SharedUserID==%lu) ORDER BY C.[Order]",
 						planID.c_str(), m_users[iUser].ID);
 				else if ((!floorID.empty()) && (floorID != "0"))
-					result = m_sql.safe_query("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
+					state.devices = m_sql.safe_cursor("SELECT A.ID, A.DeviceID, A.Unit, A.Name, A.Used,"
 						" A.Type, A.SubType, A.SignalLevel, A.BatteryLevel,"
 						" A.nValue, A.sValue, A.LastUpdate, B.Favorite,"
 						" A.SwitchType, A.HardwareID, A.AddjValue,"
@@ -8842,11 +8990,11 @@ namespace http
 							{
 								for (const auto& r : result)
 								{
-									_HiddenDevices.insert(r[0]);
+									state._HiddenDevices.insert(r[0]);
 								}
 							}
 						}
-						bAllowDeviceToBeHidden = true;
+						state.bAllowDeviceToBeHidden = true;
 					}
 
 					if (order.empty() || (!isAlpha))
@@ -8872,841 +9020,1046 @@ namespace http
 						"WHERE (B.DeviceRowID==A.ID)"
 						" AND (B.SharedUserID==%lu) ORDER BY ");
 					szQuery += szOrderBy;
-					result = m_sql.safe_query(szQuery.c_str(), m_users[iUser].ID, order.c_str());
+					state.devices = m_sql.safe_cursor(szQuery.c_str(), m_users[iUser].ID, order.c_str());
 				}
 			}
+		}
 
-			if (result.empty())
-				return;
+		// Adds the scene or group of row sd to item, returns false when it is not listed or only adds a plan to the previous entry
+		bool CWebServer::GetJSonSceneRow(_tDeviceListState& state, const std::vector<std::string>& sd, Json::Value& item, Json::Value* prev)
+		{
+			unsigned char favorite = atoi(sd[4].c_str());
+			// Check if we only want favorite devices
+			if ((state.bFetchFavorites) && (!favorite))
+				return false;
 
-			for (const auto& sd : result)
+			std::string sLastUpdate = sd[3];
+
+			if (state.iLastUpdate != 0)
 			{
-				try
+				time_t cLastUpdate;
+				ParseSQLdatetime(cLastUpdate, state.tLastUpdate, sLastUpdate, state.tm1.tm_isdst);
+				if (cLastUpdate <= state.iLastUpdate)
+					return false;
+			}
+
+			int nValue = atoi(sd[2].c_str());
+
+			unsigned char scenetype = atoi(sd[5].c_str());
+			int iProtected = atoi(sd[6].c_str());
+
+			std::string sSceneName = sd[1];
+			if (!state.bDisplayHidden && sSceneName[0] == '$')
+			{
+				return false;
+			}
+
+			if (scenetype == 0)
+			{
+				item["Type"] = "Scene";
+				item["TypeImg"] = "scene";
+				item["Image"] = "Push";
+			}
+			else
+			{
+				item["Type"] = "Group";
+				item["TypeImg"] = "group";
+			}
+
+			// has this scene/group already been seen, now with different plan?
+			// assume results are ordered such that same device is adjacent
+			// if the idx and the Type are equal (type to prevent matching against Scene with same idx)
+			std::string thisIdx = sd[0];
+
+			if ((prev != nullptr) && thisIdx == (*prev)["idx"].asString())
+			{
+				std::string typeOfThisOne = item["Type"].asString();
+				if (typeOfThisOne == (*prev)["Type"].asString())
+				{
+					(*prev)["PlanIDs"].append(atoi(sd[9].c_str()));
+					return false;
+				}
+			}
+
+			item["idx"] = sd[0];
+			item["Name"] = sSceneName;
+			item["Description"] = sd[10];
+			item["Favorite"] = favorite;
+			item["Protected"] = (iProtected != 0);
+			item["LastUpdate"] = sLastUpdate;
+			item["PlanID"] = sd[9].c_str();
+			Json::Value jsonArray;
+			jsonArray.append(atoi(sd[9].c_str()));
+			item["PlanIDs"] = jsonArray;
+
+			if (nValue == 0)
+				item["Status"] = "Off";
+			else if (nValue == 1)
+				item["Status"] = "On";
+			else
+				item["Status"] = "Mixed";
+			item["Data"] = item["Status"];
+			uint64_t camIDX = m_mainworker.m_cameras.IsDevSceneInCamera(1, sd[0]);
+			item["UsedByCamera"] = (camIDX != 0) ? true : false;
+			if (camIDX != 0)
+			{
+				std::stringstream scidx;
+				scidx << camIDX;
+				item["CameraIdx"] = scidx.str();
+				item["CameraAspect"] = m_mainworker.m_cameras.GetCameraAspectRatio(scidx.str());
+			}
+			item["XOffset"] = atoi(sd[7].c_str());
+			item["YOffset"] = atoi(sd[8].c_str());
+			return true;
+		}
+
+		// Adds the device of row sd to item, returns false when it is not listed or only adds a plan to the previous entry
+		bool CWebServer::GetJSonDeviceRow(_tDeviceListState& state, const std::vector<std::string>& sd, Json::Value& item, Json::Value* prev)
+		{
+			char szTmp[300];
+			char szData[320];
+			try
+			{
+				unsigned char favorite = atoi(sd[12].c_str());
+				bool bIsInPlan = !state.planID.empty() && (state.planID != "0");
+
+				// Check if we only want favorite devices
+				if (!bIsInPlan)
 				{
-					unsigned char favorite = atoi(sd[12].c_str());
-					bool bIsInPlan = !planID.empty() && (planID != "0");
+					if ((state.bFetchFavorites) && (!favorite))
+						return false;
+				}
+
+				std::string sDeviceName = sd[3];
 
-					// Check if we only want favorite devices
-					if (!bIsInPlan)
+				if (!state.bDisplayHidden)
+				{
+					if (state._HiddenDevices.find(sd[0]) != state._HiddenDevices.end())
+						return false;
+					if (sDeviceName[0] == '$')
 					{
-						if ((bFetchFavorites) && (!favorite))
-							continue;
+						if (state.bAllowDeviceToBeHidden)
+							return false;
+						if (!state.planID.empty())
+							sDeviceName = sDeviceName.substr(1);
 					}
+				}
+				int hardwareID = atoi(sd[14].c_str());
+				auto hItt = state._hardwareNames.find(hardwareID);
+				bool bIsHardwareDisabled = true;
+				if (hItt != state._hardwareNames.end())
+				{
+					// ignore sensors where the hardware is disabled
+					if ((!state.bDisplayDisabled) && (!(*hItt).second.Enabled))
+						return false;
+					bIsHardwareDisabled = !(*hItt).second.Enabled;
+				}
 
-					std::string sDeviceName = sd[3];
+				unsigned int dType = atoi(sd[5].c_str());
+				unsigned int dSubType = atoi(sd[6].c_str());
+				unsigned int used = atoi(sd[4].c_str());
+				int nValue = atoi(sd[9].c_str());
+				std::string sValue = sd[10];
+				std::string sLastUpdate = sd[11];
+				if (sLastUpdate.size() > 19)
+					sLastUpdate = sLastUpdate.substr(0, 19);
 
-					if (!bDisplayHidden)
+				if (state.iLastUpdate != 0)
+				{
+					time_t cLastUpdate;
+					ParseSQLdatetime(cLastUpdate, state.tLastUpdate, sLastUpdate, state.tm1.tm_isdst);
+					if (cLastUpdate <= state.iLastUpdate)
+						return false;
+				}
+
+				_eSwitchType switchtype = (_eSwitchType)atoi(sd[13].c_str());
+				_eMeterType metertype = (_eMeterType)switchtype;
+				double AddjValue = atof(sd[15].c_str());
+				double AddjMulti = atof(sd[16].c_str());
+				double AddjValue2 = atof(sd[17].c_str());
+				double AddjMulti2 = atof(sd[18].c_str());
+				int LastLevel = atoi(sd[19].c_str());
+				int CustomImage = atoi(sd[20].c_str());
+				std::string strParam1 = base64_encode(sd[21]);
+				std::string strParam2 = base64_encode(sd[22]);
+				int iProtected = atoi(sd[23].c_str());
+
+				std::string Description = sd[27];
+				std::string sOptions = sd[28];
+				std::string sColor = sd[29];
+				std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(sOptions);
+
+				struct tm ntime;
+				time_t checktime;
+				ParseSQLdatetime(checktime, ntime, sLastUpdate, state.tm1.tm_isdst);
+				bool bHaveTimeout = (state.now - checktime >= state.SensorTimeOut * 60);
+
+				if (dType == pTypeTEMP_RAIN)
+					return false; // dont want you for now
+
+				if ((state.rused == "true") && (!used))
+					return false;
+
+				if ((state.rused == "false") && (used))
+					return false;
+				if (!state.rfilter.empty())
+				{
+					if (state.rfilter == "light")
 					{
-						if (_HiddenDevices.find(sd[0]) != _HiddenDevices.end())
-							continue;
-						if (sDeviceName[0] == '$')
-						{
-							if (bAllowDeviceToBeHidden)
-								continue;
-							if (!planID.empty())
-								sDeviceName = sDeviceName.substr(1);
-						}
+						if ((dType != pTypeLighting1) && (dType != pTypeLighting2) && (dType != pTypeLighting3) && (dType != pTypeLighting4) &&
+							(dType != pTypeLighting5) && (dType != pTypeLighting6) && (dType != pTypeFan) && (dType != pTypeColorSwitch) && (dType != pTypeSecurity1) &&
+							(dType != pTypeSecurity2) && (dType != pTypeEvohome) && (dType != pTypeEvohomeRelay) && (dType != pTypeCurtain) && (dType != pTypeBlinds) &&
+							(dType != pTypeRFY) && (dType != pTypeChime) && (dType != pTypeThermostat2) && (dType != pTypeThermostat3) && (dType != pTypeThermostat4) &&
+							(dType != pTypeRemote) && (dType != pTypeGeneralSwitch) && (dType != pTypeHomeConfort) && (dType != pTypeChime) && (dType != pTypeFS20) &&
+							(!((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXStatus))) &&
+							(!((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator))) && (dType != pTypeHunter))
+							return false;
 					}
-					int hardwareID = atoi(sd[14].c_str());
-					auto hItt = _hardwareNames.find(hardwareID);
-					bool bIsHardwareDisabled = true;
-					if (hItt != _hardwareNames.end())
+					else if (state.rfilter == "temp")
 					{
-						// ignore sensors where the hardware is disabled
-						if ((!bDisplayDisabled) && (!(*hItt).second.Enabled))
-							continue;
-						bIsHardwareDisabled = !(*hItt).second.Enabled;
+						if ((dType != pTypeTEMP) && (dType != pTypeHUM) && (dType != pTypeTEMP_HUM) && (dType != pTypeTEMP_HUM_BARO) && (dType != pTypeTEMP_BARO) &&
+							(dType != pTypeEvohomeZone) && (dType != pTypeEvohomeWater) && (!((dType == pTypeWIND) && (dSubType == sTypeWIND4))) &&
+							(!((dType == pTypeUV) && (dSubType == sTypeUV3))) && (!((dType == pTypeGeneral) && (dSubType == sTypeSystemTemp))) &&
+							(dType != pTypeThermostat1) && (!((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorTemp))) && (dType != pTypeRego6XXTemp))
+							return false;
+					}
+					else if (state.rfilter == "weather")
+					{
+						if ((dType != pTypeWIND) && (dType != pTypeRAIN) && (dType != pTypeTEMP_HUM_BARO) && (dType != pTypeTEMP_BARO) && (dType != pTypeUV) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeVisibility))) && (!((dType == pTypeGeneral) && (dSubType == sTypeBaro))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))))
+							return false;
+					}
+					else if (state.rfilter == "utility")
+					{
+						if ((dType != pTypeRFXMeter) && (!((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorAD))) &&
+							(!((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorVolt))) && (!((dType == pTypeGeneral) && (dSubType == sTypeVoltage))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeCurrent))) && (!((dType == pTypeGeneral) && (dSubType == sTypeTextStatus))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeAlert))) && (!((dType == pTypeGeneral) && (dSubType == sTypePressure))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeSoilMoisture))) && (!((dType == pTypeGeneral) && (dSubType == sTypeLeafWetness))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypePercentage))) && (!((dType == pTypeGeneral) && (dSubType == sTypeWaterflow))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeCustom))) && (!((dType == pTypeGeneral) && (dSubType == sTypeFan))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))) && (!((dType == pTypeGeneral) && (dSubType == sTypeZWaveClock))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeZWaveThermostatMode))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeZWaveThermostatFanMode))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeZWaveThermostatOperatingState))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeDistance))) && (!((dType == pTypeGeneral) && (dSubType == sTypeCounterIncremental))) &&
+							(!((dType == pTypeGeneral) && (dSubType == sTypeManagedCounter))) && (!((dType == pTypeGeneral) && (dSubType == sTypeKwh))) &&
+							(dType != pTypeCURRENT) && (dType != pTypeCURRENTENERGY) && (dType != pTypeENERGY) && (dType != pTypePOWER) && (dType != pTypeP1Power) &&
+							(dType != pTypeP1Gas) && (dType != pTypeYouLess) && (dType != pTypeAirQuality) && (dType != pTypeLux) && (dType != pTypeUsage) &&
+							(!((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXCounter))) &&
+							(!((dType == pTypeThermostat) && (dSubType == sTypeThermSetpoint))) && (dType != pTypeWEIGHT) &&
+							(!((dType == pTypeRadiator1) && (dSubType == sTypeSmartwares))))
+							return false;
 					}
+					else if (state.rfilter == "wind")
+					{
+						if ((dType != pTypeWIND))
+							return false;
+					}
+					else if (state.rfilter == "rain")
+					{
+						if ((dType != pTypeRAIN))
+							return false;
+					}
+					else if (state.rfilter == "uv")
+					{
+						if ((dType != pTypeUV))
+							return false;
+					}
+					else if (state.rfilter == "baro")
+					{
+						if ((dType != pTypeTEMP_HUM_BARO) && (dType != pTypeTEMP_BARO))
+							return false;
+					}
+					else if (state.rfilter == "zwavealarms")
+					{
+						if (!((dType == pTypeGeneral) && (dSubType == sTypeZWaveAlarm)))
+							return false;
+					}
+				}
 
-					unsigned int dType = atoi(sd[5].c_str());
-					unsigned int dSubType = atoi(sd[6].c_str());
-					unsigned int used = atoi(sd[4].c_str());
-					int nValue = atoi(sd[9].c_str());
-					std::string sValue = sd[10];
-					std::string sLastUpdate = sd[11];
-					if (sLastUpdate.size() > 19)
-						sLastUpdate = sLastUpdate.substr(0, 19);
+				// has this device already been seen, now with different plan?
+				// assume results are ordered such that same device is adjacent
+				// if the idx and the Type are equal (type to prevent matching against Scene with same idx)
+				std::string thisIdx = sd[0];
+				const int devIdx = atoi(thisIdx.c_str());
 
-					if (iLastUpdate != 0)
+				if ((prev != nullptr) && thisIdx == (*prev)["idx"].asString())
+				{
+					std::string typeOfThisOne = RFX_Type_Desc(dType, 1);
+					if (typeOfThisOne == (*prev)["Type"].asString())
 					{
-						time_t cLastUpdate;
-						ParseSQLdatetime(cLastUpdate, tLastUpdate, sLastUpdate, tm1.tm_isdst);
-						if (cLastUpdate <= iLastUpdate)
-							continue;
+						(*prev)["PlanIDs"].append(atoi(sd[26].c_str()));
+						return false;
 					}
+				}
 
-					_eSwitchType switchtype = (_eSwitchType)atoi(sd[13].c_str());
-					_eMeterType metertype = (_eMeterType)switchtype;
-					double AddjValue = atof(sd[15].c_str());
-					double AddjMulti = atof(sd[16].c_str());
-					double AddjValue2 = atof(sd[17].c_str());
-					double AddjMulti2 = atof(sd[18].c_str());
-					int LastLevel = atoi(sd[19].c_str());
-					int CustomImage = atoi(sd[20].c_str());
-					std::string strParam1 = base64_encode(sd[21]);
-					std::string strParam2 = base64_encode(sd[22]);
-					int iProtected = atoi(sd[23].c_str());
-
-					std::string Description = sd[27];
-					std::string sOptions = sd[28];
-					std::string sColor = sd[29];
-					std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(sOptions);
-
-					struct tm ntime;
-					time_t checktime;
-					ParseSQLdatetime(checktime, ntime, sLastUpdate, tm1.tm_isdst);
-					bool bHaveTimeout = (now - checktime >= SensorTimeOut * 60);
-
-					if (dType == pTypeTEMP_RAIN)
-						continue; // dont want you for now
-
-					if ((rused == "true") && (!used))
-						continue;
+				item["HardwareID"] = hardwareID;
+				if (state._hardwareNames.find(hardwareID) == state._hardwareNames.end())
+				{
+					item["HardwareName"] = "Unknown?";
+					item["HardwareTypeVal"] = 0;
+					item["HardwareType"] = "Unknown?";
+				}
+				else
+				{
+					item["HardwareName"] = state._hardwareNames[hardwareID].Name;
+					item["HardwareTypeVal"] = state._hardwareNames[hardwareID].HardwareTypeVal;
+					item["HardwareType"] = state._hardwareNames[hardwareID].HardwareType;
+				}
+				item["HardwareDisabled"] = bIsHardwareDisabled;
 
-					if ((rused == "false") && (used))
-						continue;
-					if (!rfilter.empty())
+				item["idx"] = sd[0];
+				item["Protected"] = (iProtected != 0);
+
+				CDomoticzHardwareBase* pHardware = m_mainworker.GetHardware(hardwareID);
+				if (pHardware != nullptr)
+				{
+					if (pHardware->HwdType == HTYPE_SolarEdgeAPI)
 					{
-						if (rfilter == "light")
-						{
-							if ((dType != pTypeLighting1) && (dType != pTypeLighting2) && (dType != pTypeLighting3) && (dType != pTypeLighting4) &&
-								(dType != pTypeLighting5) && (dType != pTypeLighting6) && (dType != pTypeFan) && (dType != pTypeColorSwitch) && (dType != pTypeSecurity1) &&
-								(dType != pTypeSecurity2) && (dType != pTypeEvohome) && (dType != pTypeEvohomeRelay) && (dType != pTypeCurtain) && (dType != pTypeBlinds) &&
-								(dType != pTypeRFY) && (dType != pTypeChime) && (dType != pTypeThermostat2) && (dType != pTypeThermostat3) && (dType != pTypeThermostat4) &&
-								(dType != pTypeRemote) && (dType != pTypeGeneralSwitch) && (dType != pTypeHomeConfort) && (dType != pTypeChime) && (dType != pTypeFS20) &&
-								(!((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXStatus))) &&
-								(!((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator))) && (dType != pTypeHunter))
-								continue;
-						}
-						else if (rfilter == "temp")
-						{
-							if ((dType != pTypeTEMP) && (dType != pTypeHUM) && (dType != pTypeTEMP_HUM) && (dType != pTypeTEMP_HUM_BARO) && (dType != pTypeTEMP_BARO) &&
-								(dType != pTypeEvohomeZone) && (dType != pTypeEvohomeWater) && (!((dType == pTypeWIND) && (dSubType == sTypeWIND4))) &&
-								(!((dType == pTypeUV) && (dSubType == sTypeUV3))) && (!((dType == pTypeGeneral) && (dSubType == sTypeSystemTemp))) &&
-								(dType != pTypeThermostat1) && (!((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorTemp))) && (dType != pTypeRego6XXTemp))
-								continue;
-						}
-						else if (rfilter == "weather")
-						{
-							if ((dType != pTypeWIND) && (dType != pTypeRAIN) && (dType != pTypeTEMP_HUM_BARO) && (dType != pTypeTEMP_BARO) && (dType != pTypeUV) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeVisibility))) && (!((dType == pTypeGeneral) && (dSubType == sTypeBaro))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeSolarRadiation))))
-								continue;
-						}
-						else if (rfilter == "utility")
+						int seSensorTimeOut = 60 * 24 * 60;
+						bHaveTimeout = (state.now - checktime >= seSensorTimeOut * 60);
+					}
+					else if (pHardware->HwdType == HTYPE_Wunderground)
+					{
+						CWunderground* pWHardware = dynamic_cast<CWunderground*>(pHardware);
+						std::string forecast_url = pWHardware->GetForecastURL();
+						if (!forecast_url.empty())
 						{
-							if ((dType != pTypeRFXMeter) && (!((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorAD))) &&
-								(!((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorVolt))) && (!((dType == pTypeGeneral) && (dSubType == sTypeVoltage))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeCurrent))) && (!((dType == pTypeGeneral) && (dSubType == sTypeTextStatus))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeAlert))) && (!((dType == pTypeGeneral) && (dSubType == sTypePressure))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeSoilMoisture))) && (!((dType == pTypeGeneral) && (dSubType == sTypeLeafWetness))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypePercentage))) && (!((dType == pTypeGeneral) && (dSubType == sTypeWaterflow))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeCustom))) && (!((dType == pTypeGeneral) && (dSubType == sTypeFan))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeSoundLevel))) && (!((dType == pTypeGeneral) && (dSubType == sTypeZWaveClock))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeZWaveThermostatMode))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeZWaveThermostatFanMode))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeZWaveThermostatOperatingState))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeDistance))) && (!((dType == pTypeGeneral) && (dSubType == sTypeCounterIncremental))) &&
-								(!((dType == pTypeGeneral) && (dSubType == sTypeManagedCounter))) && (!((dType == pTypeGeneral) && (dSubType == sTypeKwh))) &&
-								(dType != pTypeCURRENT) && (dType != pTypeCURRENTENERGY) && (dType != pTypeENERGY) && (dType != pTypePOWER) && (dType != pTypeP1Power) &&
-								(dType != pTypeP1Gas) && (dType != pTypeYouLess) && (dType != pTypeAirQuality) && (dType != pTypeLux) && (dType != pTypeUsage) &&
-								(!((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXCounter))) &&
-								(!((dType == pTypeThermostat) && (dSubType == sTypeThermSetpoint))) && (dType != pTypeWEIGHT) &&
-								(!((dType == pTypeRadiator1) && (dSubType == sTypeSmartwares))))
-								continue;
+							item["forecast_url"] = base64_encode(forecast_url);
 						}
-						else if (rfilter == "wind")
+					}
+					else if (pHardware->HwdType == HTYPE_DarkSky)
+					{
+						CDarkSky* pWHardware = dynamic_cast<CDarkSky*>(pHardware);
+						std::string forecast_url = pWHardware->GetForecastURL();
+						if (!forecast_url.empty())
 						{
-							if ((dType != pTypeWIND))
-								continue;
+							item["forecast_url"] = base64_encode(forecast_url);
 						}
-						else if (rfilter == "rain")
+					}
+					else if (pHardware->HwdType == HTYPE_VisualCrossing)
+					{
+						CVisualCrossing* pWHardware = dynamic_cast<CVisualCrossing*>(pHardware);
+						std::string forecast_url = pWHardware->GetForecastURL();
+						if (!forecast_url.empty())
 						{
-							if ((dType != pTypeRAIN))
-								continue;
+							item["forecast_url"] = base64_encode(forecast_url);
 						}
-						else if (rfilter == "uv")
+					}
+					else if (pHardware->HwdType == HTYPE_AccuWeather)
+					{
+						CAccuWeather* pWHardware = dynamic_cast<CAccuWeather*>(pHardware);
+						std::string forecast_url = pWHardware->GetForecastURL();
+						if (!forecast_url.empty())
 						{
-							if ((dType != pTypeUV))
-								continue;
+							item["forecast_url"] = base64_encode(forecast_url);
 						}
-						else if (rfilter == "baro")
+					}
+					else if (pHardware->HwdType == HTYPE_OpenWeatherMap)
+					{
+						COpenWeatherMap* pWHardware = dynamic_cast<COpenWeatherMap*>(pHardware);
+						std::string forecast_url = pWHardware->GetForecastURL();
+						if (!forecast_url.empty())
 						{
-							if ((dType != pTypeTEMP_HUM_BARO) && (dType != pTypeTEMP_BARO))
-								continue;
+							item["forecast_url"] = base64_encode(forecast_url);
 						}
-						else if (rfilter == "zwavealarms")
+					}
+					else if (pHardware->HwdType == HTYPE_BuienRadar)
+					{
+						CBuienRadar* pWHardware = dynamic_cast<CBuienRadar*>(pHardware);
+						std::string forecast_url = pWHardware->GetForecastURL();
+						if (!forecast_url.empty())
 						{
-							if (!((dType == pTypeGeneral) && (dSubType == sTypeZWaveAlarm)))
-								continue;
+							item["forecast_url"] = base64_encode(forecast_url);
 						}
 					}
-
-					// has this device already been seen, now with different plan?
-					// assume results are ordered such that same device is adjacent
-					// if the idx and the Type are equal (type to prevent matching against Scene with same idx)
-					std::string thisIdx = sd[0];
-					const int devIdx = atoi(thisIdx.c_str());
-
-					if ((ii > 0) && thisIdx == root["result"][ii - 1]["idx"].asString())
+					else if (pHardware->HwdType == HTYPE_Meteorologisk)
 					{
-						std::string typeOfThisOne = RFX_Type_Desc(dType, 1);
-						if (typeOfThisOne == root["result"][ii - 1]["Type"].asString())
+						CMeteorologisk* pWHardware = dynamic_cast<CMeteorologisk*>(pHardware);
+						std::string forecast_url = pWHardware->GetForecastURL();
+						if (!forecast_url.empty())
 						{
-							root["result"][ii - 1]["PlanIDs"].append(atoi(sd[26].c_str()));
-							continue;
+							item["forecast_url"] = base64_encode(forecast_url);
 						}
 					}
+				}
 
-					root["result"][ii]["HardwareID"] = hardwareID;
-					if (_hardwareNames.find(hardwareID) == _hardwareNames.end())
+				if ((pHardware != nullptr) && (pHardware->HwdType == HTYPE_PythonPlugin))
+				{
+					// Device ID special formatting should not be applied to Python plugins
+					item["ID"] = sd[1];
+				}
+				else
+				{
+					if ((dType == pTypeTEMP) || (dType == pTypeTEMP_BARO) || (dType == pTypeTEMP_HUM) || (dType == pTypeTEMP_HUM_BARO) || (dType == pTypeBARO) ||
+						(dType == pTypeHUM) || (dType == pTypeWIND) || (dType == pTypeRAIN) || (dType == pTypeUV) || (dType == pTypeCURRENT) ||
+						(dType == pTypeCURRENTENERGY) || (dType == pTypeENERGY) || (dType == pTypeRFXMeter) || (dType == pTypeAirQuality) || (dType == pTypeRFXSensor) ||
+						(dType == pTypeP1Power) || (dType == pTypeP1Gas))
 					{
-						root["result"][ii]["HardwareName"] = "Unknown?";
-						root["result"][ii]["HardwareTypeVal"] = 0;
-						root["result"][ii]["HardwareType"] = "Unknown?";
+						item["ID"] = is_number(sd[1]) ? std_format("%04X", (unsigned int)atoi(sd[1].c_str())) : sd[1];
 					}
 					else
 					{
-						root["result"][ii]["HardwareName"] = _hardwareNames[hardwareID].Name;
-						root["result"][ii]["HardwareTypeVal"] = _hardwareNames[hardwareID].HardwareTypeVal;
-						root["result"][ii]["HardwareType"] = _hardwareNames[hardwareID].HardwareType;
+						item["ID"] = sd[1];
 					}
-					root["result"][ii]["HardwareDisabled"] = bIsHardwareDisabled;
+				}
 
-					root["result"][ii]["idx"] = sd[0];
-					root["result"][ii]["Protected"] = (iProtected != 0);
+				item["Unit"] = atoi(sd[2].c_str());
+				const _tRFXTypeDesc typeDesc = RFX_Type_Descriptor(dType, dSubType);
+				item["Type"] = typeDesc.Type;
+				item["SubType"] = typeDesc.SubType;
+				item["TypeImg"] = typeDesc.TypeImg;
+				item["Name"] = sDeviceName;
+				item["Description"] = Description;
+				item["Used"] = used;
+				item["Favorite"] = favorite;
+
+				int iSignalLevel = atoi(sd[7].c_str());
+				if (iSignalLevel < 12)
+					item["SignalLevel"] = iSignalLevel;
+				else
+					item["SignalLevel"] = "-";
+				item["BatteryLevel"] = atoi(sd[8].c_str());
+				item["LastUpdate"] = sLastUpdate;
+
+				item["CustomImage"] = CustomImage;
+
+				if (CustomImage != 0)
+				{
+					auto ittIcon = m_custom_light_icons_lookup.find(CustomImage);
+					if (ittIcon != m_custom_light_icons_lookup.end())
+					{
+						item["CustomImage"] = CustomImage;
+						item["Image"] = m_custom_light_icons[ittIcon->second].RootFile;
+					}
+					else
+					{
+						CustomImage = 0;
+						item["CustomImage"] = CustomImage;
+					}
+				}
+
+				item["XOffset"] = sd[24].c_str();
+				item["YOffset"] = sd[25].c_str();
+				item["PlanID"] = sd[26].c_str();
+				Json::Value jsonArray;
+				jsonArray.append(atoi(sd[26].c_str()));
+				item["PlanIDs"] = jsonArray;
+				item["AddjValue"] = AddjValue;
+				item["AddjMulti"] = AddjMulti;
+				item["AddjValue2"] = AddjValue2;
+				item["AddjMulti2"] = AddjMulti2;
+
+				std::stringstream s_data;
+				s_data << int(nValue) << ", " << sValue;
+				item["Data"] = s_data.str();
+
+				item["Notifications"] = (m_notifications.HasNotifications(sd[0]) == true) ? "true" : "false";
+				item["ShowNotifications"] = true;
+
+				bool bHasTimers = false;
+
+				if (
+					(dType == pTypeLighting1)
+					|| (dType == pTypeLighting2)
+					|| (dType == pTypeLighting3)
+					|| (dType == pTypeLighting4)
+					|| (dType == pTypeLighting5)
+					|| (dType == pTypeLighting6)
+					|| (dType == pTypeFan)
+					|| (dType == pTypeColorSwitch)
+					|| (dType == pTypeCurtain)
+					|| (dType == pTypeBlinds)
+					|| (dType == pTypeRFY)
+					|| (dType == pTypeChime)
+					|| (dType == pTypeThermostat2)
+					|| (dType == pTypeThermostat3)
+					|| (dType == pTypeThermostat4)
+					|| (dType == pTypeRemote)
+					|| (dType == pTypeGeneralSwitch)
+					|| (dType == pTypeHomeConfort)
+					|| (dType == pTypeFS20)
+					|| ((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator))
+					|| ((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXStatus))
+					|| (dType == pTypeHunter))
+				{
+					// add light details
+					bHasTimers = m_sql.HasTimers(sd[0]);
 
-					CDomoticzHardwareBase* pHardware = m_mainworker.GetHardware(hardwareID);
+					bHaveTimeout = false;
+#ifdef WITH_OPENZWAVE
 					if (pHardware != nullptr)
 					{
-						if (pHardware->HwdType == HTYPE_SolarEdgeAPI)
+						if (pHardware->HwdType == HTYPE_OpenZWave)
 						{
-							int seSensorTimeOut = 60 * 24 * 60;
-							bHaveTimeout = (now - checktime >= seSensorTimeOut * 60);
+							COpenZWave* pZWave = dynamic_cast<COpenZWave*>(pHardware);
+							unsigned long ID;
+							std::stringstream s_strid;
+							s_strid << std::hex << sd[1];
+							s_strid >> ID;
+							int nodeID = (ID & 0x0000FF00) >> 8;
+							bHaveTimeout = pZWave->HasNodeFailed(nodeID);
 						}
-						else if (pHardware->HwdType == HTYPE_Wunderground)
-						{
-							CWunderground* pWHardware = dynamic_cast<CWunderground*>(pHardware);
-							std::string forecast_url = pWHardware->GetForecastURL();
-							if (!forecast_url.empty())
-							{
-								root["result"][ii]["forecast_url"] = base64_encode(forecast_url);
-							}
-						}
-						else if (pHardware->HwdType == HTYPE_DarkSky)
-						{
-							CDarkSky* pWHardware = dynamic_cast<CDarkSky*>(pHardware);
-							std::string forecast_url = pWHardware->GetForecastURL();
-							if (!forecast_url.empty())
-							{
-								root["result"][ii]["forecast_url"] = base64_encode(forecast_url);
-							}
-						}
-						else if (pHardware->HwdType == HTYPE_VisualCrossing)
-						{
-							CVisualCrossing* pWHardware = dynamic_cast<CVisualCrossing*>(pHardware);
-							std::string forecast_url = pWHardware->GetForecastURL();
-							if (!forecast_url.empty())
-							{
-								root["result"][ii]["forecast_url"] = base64_encode(forecast_url);
-							}
-						}
-						else if (pHardware->HwdType == HTYPE_AccuWeather)
-						{
-							CAccuWeather* pWHardware = dynamic_cast<CAccuWeather*>(pHardware);
-							std::string forecast_url = pWHardware->GetForecastURL();
-							if (!forecast_url.empty())
-							{
-								root["result"][ii]["forecast_url"] = base64_encode(forecast_url);
-							}
-						}
-						else if (pHardware->HwdType == HTYPE_OpenWeatherMap)
-						{
-							COpenWeatherMap* pWHardware = dynamic_cast<COpenWeatherMap*>(pHardware);
-							std::string forecast_url = pWHardware->GetForecastURL();
-							if (!forecast_url.empty())
-							{
-								root["result"][ii]["forecast_url"] = base64_encode(forecast_url);
-							}
-						}
-						else if (pHardware->HwdType == HTYPE_BuienRadar)
-						{
-							CBuienRadar* pWHardware = dynamic_cast<CBuienRadar*>(pHardware);
-							std::string forecast_url = pWHardware->GetForecastURL();
-							if (!forecast_url.empty())
+					}
+#endif
+					item["HaveTimeout"] = bHaveTimeout;
+
+					std::string lstatus;
+					int llevel = 0;
+					bool bHaveDimmer = false;
+					bool bHaveGroupCmd = false;
+					int maxDimLevel = 0;
+
+					GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+
+					item["Status"] = lstatus;
+					item["StrParam1"] = strParam1;
+					item["StrParam2"] = strParam2;
+
+					if (!CustomImage)
+						item["Image"] = "Light";
+
+					if (switchtype == STYPE_Dimmer)
+					{
+						item["Level"] = LastLevel;
+						int iLevel = round((float(maxDimLevel) / 100.0F) * LastLevel);
+						item["LevelInt"] = iLevel;
+						if ((dType == pTypeColorSwitch) || (dType == pTypeLighting5 && dSubType == sTypeTRC02) ||
+							(dType == pTypeLighting5 && dSubType == sTypeTRC02_2) || (dType == pTypeGeneralSwitch && dSubType == sSwitchTypeTRC02) ||
+							(dType == pTypeGeneralSwitch && dSubType == sSwitchTypeTRC02_2))
+						{
+							_tColor color(sColor);
+							std::string jsonColor = color.toJSONString();
+							item["Color"] = jsonColor;
+							llevel = LastLevel;
+							if (lstatus == "Set Level" || lstatus == "Set Color")
 							{
-								root["result"][ii]["forecast_url"] = base64_encode(forecast_url);
+								sprintf(szTmp, "Set Level: %d %%", LastLevel);
+								item["Status"] = szTmp;
 							}
 						}
-						else if (pHardware->HwdType == HTYPE_Meteorologisk)
+					}
+					else
+					{
+						item["Level"] = llevel;
+						item["LevelInt"] = atoi(sValue.c_str());
+					}
+					item["HaveDimmer"] = bHaveDimmer;
+					std::string DimmerType = "none";
+					if (switchtype == STYPE_Dimmer)
+					{
+						DimmerType = "abs";
+						if (state._hardwareNames.find(hardwareID) != state._hardwareNames.end())
 						{
-							CMeteorologisk* pWHardware = dynamic_cast<CMeteorologisk*>(pHardware);
-							std::string forecast_url = pWHardware->GetForecastURL();
-							if (!forecast_url.empty())
+							// Milight V4/V5 bridges do not support absolute dimming for RGB or CW_WW lights
+							if (state._hardwareNames[hardwareID].HardwareTypeVal == HTYPE_LimitlessLights &&
+								atoi(state._hardwareNames[hardwareID].Mode2.c_str()) != CLimitLess::LBTYPE_V6 &&
+								(atoi(state._hardwareNames[hardwareID].Mode1.c_str()) == sTypeColor_RGB ||
+									atoi(state._hardwareNames[hardwareID].Mode1.c_str()) == sTypeColor_White ||
+									atoi(state._hardwareNames[hardwareID].Mode1.c_str()) == sTypeColor_CW_WW))
 							{
-								root["result"][ii]["forecast_url"] = base64_encode(forecast_url);
+								DimmerType = "rel";
 							}
 						}
 					}
+					item["DimmerType"] = DimmerType;
+					item["MaxDimLevel"] = maxDimLevel;
+					item["HaveGroupCmd"] = bHaveGroupCmd;
+					item["SwitchType"] = Switch_Type_Desc(switchtype);
+					item["SwitchTypeVal"] = switchtype;
+					uint64_t camIDX = m_mainworker.m_cameras.IsDevSceneInCamera(0, sd[0]);
+					item["UsedByCamera"] = (camIDX != 0) ? true : false;
+					if (camIDX != 0)
+					{
+						std::stringstream scidx;
+						scidx << camIDX;
+						item["CameraIdx"] = scidx.str();
+						item["CameraAspect"] = m_mainworker.m_cameras.GetCameraAspectRatio(scidx.str());
+					}
+
+					bool bIsSubDevice = false;
+					std::vector<std::vector<std::string>> resultSD;
+					resultSD = m_sql.safe_query("SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q')", sd[0].c_str());
+					bIsSubDevice = (!resultSD.empty());
+
+					item["IsSubDevice"] = bIsSubDevice;
 
-					if ((pHardware != nullptr) && (pHardware->HwdType == HTYPE_PythonPlugin))
+					std::string openStatus = "Open";
+					std::string closedStatus = "Closed";
+					if (switchtype == STYPE_Doorbell)
 					{
-						// Device ID special formatting should not be applied to Python plugins
-						root["result"][ii]["ID"] = sd[1];
+						item["TypeImg"] = "doorbell";
+						item["Status"] = ""; //"Pressed";
 					}
-					else
+					else if (switchtype == STYPE_DoorContact)
 					{
-						if ((dType == pTypeTEMP) || (dType == pTypeTEMP_BARO) || (dType == pTypeTEMP_HUM) || (dType == pTypeTEMP_HUM_BARO) || (dType == pTypeBARO) ||
-							(dType == pTypeHUM) || (dType == pTypeWIND) || (dType == pTypeRAIN) || (dType == pTypeUV) || (dType == pTypeCURRENT) ||
-							(dType == pTypeCURRENTENERGY) || (dType == pTypeENERGY) || (dType == pTypeRFXMeter) || (dType == pTypeAirQuality) || (dType == pTypeRFXSensor) ||
-							(dType == pTypeP1Power) || (dType == pTypeP1Gas))
+						if (!CustomImage)
+							item["Image"] = "Door";
+						item["TypeImg"] = "door";
+						bool bIsOn = IsLightSwitchOn(lstatus);
+						item["InternalState"] = (bIsOn == true) ? "Open" : "Closed";
+						if (bIsOn)
 						{
-							root["result"][ii]["ID"] = is_number(sd[1]) ? std_format("%04X", (unsigned int)atoi(sd[1].c_str())) : sd[1];
+							lstatus = "Open";
 						}
 						else
 						{
-							root["result"][ii]["ID"] = sd[1];
+							lstatus = "Closed";
 						}
+						item["Status"] = lstatus;
 					}
-
-					root["result"][ii]["Unit"] = atoi(sd[2].c_str());
-					root["result"][ii]["Type"] = RFX_Type_Desc(dType, 1);
-					root["result"][ii]["SubType"] = RFX_Type_SubType_Desc(dType, dSubType);
-					root["result"][ii]["TypeImg"] = RFX_Type_Desc(dType, 2);
-					root["result"][ii]["Name"] = sDeviceName;
-					root["result"][ii]["Description"] = Description;
-					root["result"][ii]["Used"] = used;
-					root["result"][ii]["Favorite"] = favorite;
-
-					int iSignalLevel = atoi(sd[7].c_str());
-					if (iSignalLevel < 12)
-						root["result"][ii]["SignalLevel"] = iSignalLevel;
-					else
-						root["result"][ii]["SignalLevel"] = "-";
-					root["result"][ii]["BatteryLevel"] = atoi(sd[8].c_str());
-					root["result"][ii]["LastUpdate"] = sLastUpdate;
-
-					root["result"][ii]["CustomImage"] = CustomImage;
-
-					if (CustomImage != 0)
+					else if (switchtype == STYPE_DoorLock)
 					{
-						auto ittIcon = m_custom_light_icons_lookup.find(CustomImage);
-						if (ittIcon != m_custom_light_icons_lookup.end())
+						if (!CustomImage)
+							item["Image"] = "Door";
+						item["TypeImg"] = "door";
+						bool bIsOn = IsLightSwitchOn(lstatus);
+						item["InternalState"] = (bIsOn == true) ? "Locked" : "Unlocked";
+						if (bIsOn)
 						{
-							root["result"][ii]["CustomImage"] = CustomImage;
-							root["result"][ii]["Image"] = m_custom_light_icons[ittIcon->second].RootFile;
+							lstatus = "Locked";
 						}
 						else
 						{
-							CustomImage = 0;
-							root["result"][ii]["CustomImage"] = CustomImage;
+							lstatus = "Unlocked";
 						}
+						item["Status"] = lstatus;
 					}
-
-					root["result"][ii]["XOffset"] = sd[24].c_str();
-					root["result"][ii]["YOffset"] = sd[25].c_str();
-					root["result"][ii]["PlanID"] = sd[26].c_str();
-					Json::Value jsonArray;
-					jsonArray.append(atoi(sd[26].c_str()));
-					root["result"][ii]["PlanIDs"] = jsonArray;
-					root["result"][ii]["AddjValue"] = AddjValue;
-					root["result"][ii]["AddjMulti"] = AddjMulti;
-					root["result"][ii]["AddjValue2"] = AddjValue2;
-					root["result"][ii]["AddjMulti2"] = AddjMulti2;
-
-					std::stringstream s_data;
-					s_data << int(nValue) << ", " << sValue;
-					root["result"][ii]["Data"] = s_data.str();
-
-					root["result"][ii]["Notifications"] = (m_notifications.HasNotifications(sd[0]) == true) ? "true" : "false";
-					root["result"][ii]["ShowNotifications"] = true;
-
-					bool bHasTimers = false;
-
-					if (
-						(dType == pTypeLighting1)
-						|| (dType == pTypeLighting2)
-						|| (dType == pTypeLighting3)
-						|| (dType == pTypeLighting4)
-						|| (dType == pTypeLighting5)
-						|| (dType == pTypeLighting6)
-						|| (dType == pTypeFan)
-						|| (dType == pTypeColorSwitch)
-						|| (dType == pTypeCurtain)
-						|| (dType == pTypeBlinds)
-						|| (dType == pTypeRFY)
-						|| (dType == pTypeChime)
-						|| (dType == pTypeThermostat2)
-						|| (dType == pTypeThermostat3)
-						|| (dType == pTypeThermostat4)
-						|| (dType == pTypeRemote)
-						|| (dType == pTypeGeneralSwitch)
-						|| (dType == pTypeHomeConfort)
-						|| (dType == pTypeFS20)
-						|| ((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator))
-						|| ((dType == pTypeRego6XXValue) && (dSubType == sTypeRego6XXStatus))
-						|| (dType == pTypeHunter))
-					{
-						// add light details
-						bHasTimers = m_sql.HasTimers(sd[0]);
-
-						bHaveTimeout = false;
-#ifdef WITH_OPENZWAVE
-						if (pHardware != nullptr)
+					else if (switchtype == STYPE_DoorLockInverted)
+					{
+						if (!CustomImage)
+							item["Image"] = "Door";
+						item["TypeImg"] = "door";
+						bool bIsOn = IsLightSwitchOn(lstatus);
+						item["InternalState"] = (bIsOn == true) ? "Unlocked" : "Locked";
+						if (bIsOn)
 						{
-							if (pHardware->HwdType == HTYPE_OpenZWave)
-							{
-								COpenZWave* pZWave = dynamic_cast<COpenZWave*>(pHardware);
-								unsigned long ID;
-								std::stringstream s_strid;
-								s_strid << std::hex << sd[1];
-								s_strid >> ID;
-								int nodeID = (ID & 0x0000FF00) >> 8;
-								bHaveTimeout = pZWave->HasNodeFailed(nodeID);
-							}
+							lstatus = "Unlocked";
 						}
-#endif
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-
-						std::string lstatus;
-						int llevel = 0;
-						bool bHaveDimmer = false;
-						bool bHaveGroupCmd = false;
-						int maxDimLevel = 0;
-
-						GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
-
-						root["result"][ii]["Status"] = lstatus;
-						root["result"][ii]["StrParam1"] = strParam1;
-						root["result"][ii]["StrParam2"] = strParam2;
-
+						else
+						{
+							lstatus = "Locked";
+						}
+						item["Status"] = lstatus;
+					}
+					else if (switchtype == STYPE_PushOn)
+					{
 						if (!CustomImage)
-							root["result"][ii]["Image"] = "Light";
-
-						if (switchtype == STYPE_Dimmer)
+							item["Image"] = "Push";
+						item["TypeImg"] = "push";
+						item["Status"] = "";
+						item["InternalState"] = (IsLightSwitchOn(lstatus) == true) ? "On" : "Off";
+					}
+					else if (switchtype == STYPE_PushOff)
+					{
+						if (!CustomImage)
+							item["Image"] = "Push";
+						item["TypeImg"] = "push";
+						item["Status"] = "";
+						item["TypeImg"] = "pushoff";
+					}
+					else if (switchtype == STYPE_X10Siren)
+						item["TypeImg"] = "siren";
+					else if (switchtype == STYPE_SMOKEDETECTOR)
+					{
+						item["TypeImg"] = "smoke";
+						item["SwitchTypeVal"] = STYPE_SMOKEDETECTOR;
+						item["SwitchType"] = Switch_Type_Desc(STYPE_SMOKEDETECTOR);
+					}
+					else if (switchtype == STYPE_Contact)
+					{
+						if (!CustomImage)
+							item["Image"] = "Contact";
+						item["TypeImg"] = "contact";
+						bool bIsOn = IsLightSwitchOn(lstatus);
+						if (bIsOn)
 						{
-							root["result"][ii]["Level"] = LastLevel;
-							int iLevel = round((float(maxDimLevel) / 100.0F) * LastLevel);
-							root["result"][ii]["LevelInt"] = iLevel;
-							if ((dType == pTypeColorSwitch) || (dType == pTypeLighting5 && dSubType == sTypeTRC02) ||
-								(dType == pTypeLighting5 && dSubType == sTypeTRC02_2) || (dType == pTypeGeneralSwitch && dSubType == sSwitchTypeTRC02) ||
-								(dType == pTypeGeneralSwitch && dSubType == sSwitchTypeTRC02_2))
-							{
-								_tColor color(sColor);
-								std::string jsonColor = color.toJSONString();
-								root["result"][ii]["Color"] = jsonColor;
-								llevel = LastLevel;
-								if (lstatus == "Set Level" || lstatus == "Set Color")
-								{
-									sprintf(szTmp, "Set Level: %d %%", LastLevel);
-									root["result"][ii]["Status"] = szTmp;
-								}
-							}
+							lstatus = "Open";
 						}
 						else
 						{
-							root["result"][ii]["Level"] = llevel;
-							root["result"][ii]["LevelInt"] = atoi(sValue.c_str());
+							lstatus = "Closed";
 						}
-						root["result"][ii]["HaveDimmer"] = bHaveDimmer;
-						std::string DimmerType = "none";
-						if (switchtype == STYPE_Dimmer)
+						item["Status"] = lstatus;
+					}
+					else if (switchtype == STYPE_Media)
+					{
+						if ((pHardware != nullptr) && (pHardware->HwdType == HTYPE_LogitechMediaServer))
+							item["TypeImg"] = "LogitechMediaServer";
+						else
+							item["TypeImg"] = "Media";
+						item["Status"] = Media_Player_States((_eMediaStatus)nValue);
+						lstatus = sValue;
+					}
+					else if (
+						(switchtype == STYPE_Blinds)
+						|| (switchtype == STYPE_BlindsPercentage)
+						|| (switchtype == STYPE_BlindsPercentageWithStop)
+						|| (switchtype == STYPE_VenetianBlindsUS)
+						|| (switchtype == STYPE_VenetianBlindsEU)
+						)
+					{
+						item["Image"] = "blinds";
+						item["TypeImg"] = "blinds";
+
+						if (lstatus == "Close inline relay")
 						{
-							DimmerType = "abs";
-							if (_hardwareNames.find(hardwareID) != _hardwareNames.end())
-							{
-								// Milight V4/V5 bridges do not support absolute dimming for RGB or CW_WW lights
-								if (_hardwareNames[hardwareID].HardwareTypeVal == HTYPE_LimitlessLights &&
-									atoi(_hardwareNames[hardwareID].Mode2.c_str()) != CLimitLess::LBTYPE_V6 &&
-									(atoi(_hardwareNames[hardwareID].Mode1.c_str()) == sTypeColor_RGB ||
-										atoi(_hardwareNames[hardwareID].Mode1.c_str()) == sTypeColor_White ||
-										atoi(_hardwareNames[hardwareID].Mode1.c_str()) == sTypeColor_CW_WW))
-								{
-									DimmerType = "rel";
-								}
-							}
+							lstatus = "Close";
 						}
-						root["result"][ii]["DimmerType"] = DimmerType;
-						root["result"][ii]["MaxDimLevel"] = maxDimLevel;
-						root["result"][ii]["HaveGroupCmd"] = bHaveGroupCmd;
-						root["result"][ii]["SwitchType"] = Switch_Type_Desc(switchtype);
-						root["result"][ii]["SwitchTypeVal"] = switchtype;
-						uint64_t camIDX = m_mainworker.m_cameras.IsDevSceneInCamera(0, sd[0]);
-						root["result"][ii]["UsedByCamera"] = (camIDX != 0) ? true : false;
-						if (camIDX != 0)
+						else if (lstatus == "Open inline relay")
 						{
-							std::stringstream scidx;
-							scidx << camIDX;
-							root["result"][ii]["CameraIdx"] = scidx.str();
-							root["result"][ii]["CameraAspect"] = m_mainworker.m_cameras.GetCameraAspectRatio(scidx.str());
+							lstatus = "Open";
+						}
+						else if (lstatus == "Stop inline relay")
+						{
+							lstatus = "Stop";
 						}
 
-						bool bIsSubDevice = false;
-						std::vector<std::vector<std::string>> resultSD;
-						resultSD = m_sql.safe_query("SELECT ID FROM LightSubDevices WHERE (DeviceRowID=='%q')", sd[0].c_str());
-						bIsSubDevice = (!resultSD.empty());
+						bool bReverseState = false;
+						bool bReversePosition = false;
 
-						root["result"][ii]["IsSubDevice"] = bIsSubDevice;
+						auto itt = options.find("ReverseState");
+						if (itt != options.end())
+							bReverseState = (itt->second == "true");
+						itt = options.find("ReversePosition");
+						if (itt != options.end())
+							bReversePosition = (itt->second == "true");
 
-						std::string openStatus = "Open";
-						std::string closedStatus = "Closed";
-						if (switchtype == STYPE_Doorbell)
+						if (bReversePosition)
 						{
-							root["result"][ii]["TypeImg"] = "doorbell";
-							root["result"][ii]["Status"] = ""; //"Pressed";
+							LastLevel = 100 - LastLevel;
+							if (lstatus.find("Set Level") == 0)
+								lstatus = std_format("Set Level: %d %%", LastLevel);
 						}
-						else if (switchtype == STYPE_DoorContact)
+
+						if (bReverseState)
 						{
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Door";
-							root["result"][ii]["TypeImg"] = "door";
-							bool bIsOn = IsLightSwitchOn(lstatus);
-							root["result"][ii]["InternalState"] = (bIsOn == true) ? "Open" : "Closed";
-							if (bIsOn)
-							{
+							if (lstatus == "Open")
+								lstatus = "Close";
+							else if (lstatus == "Close")
 								lstatus = "Open";
-							}
-							else
-							{
-								lstatus = "Closed";
-							}
-							root["result"][ii]["Status"] = lstatus;
-						}
-						else if (switchtype == STYPE_DoorLock)
-						{
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Door";
-							root["result"][ii]["TypeImg"] = "door";
-							bool bIsOn = IsLightSwitchOn(lstatus);
-							root["result"][ii]["InternalState"] = (bIsOn == true) ? "Locked" : "Unlocked";
-							if (bIsOn)
-							{
-								lstatus = "Locked";
-							}
-							else
-							{
-								lstatus = "Unlocked";
-							}
-							root["result"][ii]["Status"] = lstatus;
 						}
-						else if (switchtype == STYPE_DoorLockInverted)
+
+
+						if (lstatus == "Close")
 						{
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Door";
-							root["result"][ii]["TypeImg"] = "door";
-							bool bIsOn = IsLightSwitchOn(lstatus);
-							root["result"][ii]["InternalState"] = (bIsOn == true) ? "Unlocked" : "Locked";
-							if (bIsOn)
-							{
-								lstatus = "Unlocked";
-							}
-							else
-							{
-								lstatus = "Locked";
-							}
-							root["result"][ii]["Status"] = lstatus;
+							lstatus = closedStatus;
 						}
-						else if (switchtype == STYPE_PushOn)
+						else if (lstatus == "Open")
 						{
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Push";
-							root["result"][ii]["TypeImg"] = "push";
-							root["result"][ii]["Status"] = "";
-							root["result"][ii]["InternalState"] = (IsLightSwitchOn(lstatus) == true) ? "On" : "Off";
+							lstatus = openStatus;
 						}
-						else if (switchtype == STYPE_PushOff)
+						else if (lstatus == "Stop")
 						{
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Push";
-							root["result"][ii]["TypeImg"] = "push";
-							root["result"][ii]["Status"] = "";
-							root["result"][ii]["TypeImg"] = "pushoff";
+							lstatus = "Stopped";
 						}
-						else if (switchtype == STYPE_X10Siren)
-							root["result"][ii]["TypeImg"] = "siren";
-						else if (switchtype == STYPE_SMOKEDETECTOR)
+						item["Status"] = lstatus;
+
+						item["Level"] = LastLevel;
+						int iLevel = round((float(maxDimLevel) / 100.0F) * LastLevel);
+						item["LevelInt"] = iLevel;
+
+						item["ReverseState"] = bReverseState;
+						item["ReversePosition"] = bReversePosition;
+					}
+					else if (switchtype == STYPE_Dimmer)
+					{
+						item["TypeImg"] = "dimmer";
+					}
+					else if (switchtype == STYPE_Motion)
+					{
+						item["TypeImg"] = "motion";
+					}
+					else if (switchtype == STYPE_Selector)
+					{
+						std::string selectorStyle = options["SelectorStyle"];
+						std::string levelOffHidden = options["LevelOffHidden"];
+						std::string levelNames = options["LevelNames"];
+						std::string levelActions = options["LevelActions"];
+						if (selectorStyle.empty())
 						{
-							root["result"][ii]["TypeImg"] = "smoke";
-							root["result"][ii]["SwitchTypeVal"] = STYPE_SMOKEDETECTOR;
-							root["result"][ii]["SwitchType"] = Switch_Type_Desc(STYPE_SMOKEDETECTOR);
+							selectorStyle.assign("0"); // default is 'button set'
 						}
-						else if (switchtype == STYPE_Contact)
+						if (levelOffHidden.empty())
 						{
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Contact";
-							root["result"][ii]["TypeImg"] = "contact";
-							bool bIsOn = IsLightSwitchOn(lstatus);
-							if (bIsOn)
-							{
-								lstatus = "Open";
-							}
-							else
-							{
-								lstatus = "Closed";
-							}
-							root["result"][ii]["Status"] = lstatus;
+							levelOffHidden.assign("false"); // default is 'not hidden'
 						}
-						else if (switchtype == STYPE_Media)
+						if (levelNames.empty())
 						{
-							if ((pHardware != nullptr) && (pHardware->HwdType == HTYPE_LogitechMediaServer))
-								root["result"][ii]["TypeImg"] = "LogitechMediaServer";
-							else
-								root["result"][ii]["TypeImg"] = "Media";
-							root["result"][ii]["Status"] = Media_Player_States((_eMediaStatus)nValue);
-							lstatus = sValue;
+							levelNames.assign("Off"); // default is Off only
 						}
-						else if (
-							(switchtype == STYPE_Blinds)
-							|| (switchtype == STYPE_BlindsPercentage)
-							|| (switchtype == STYPE_BlindsPercentageWithStop)
-							|| (switchtype == STYPE_VenetianBlindsUS)
-							|| (switchtype == STYPE_VenetianBlindsEU)
-							)
-						{
-							root["result"][ii]["Image"] = "blinds";
-							root["result"][ii]["TypeImg"] = "blinds";
+						item["TypeImg"] = "Light";
+						item["SelectorStyle"] = atoi(selectorStyle.c_str());
+						item["LevelOffHidden"] = (levelOffHidden == "true");
+						item["LevelNames"] = base64_encode(levelNames);
+						item["LevelActions"] = base64_encode(levelActions);
+					}
+					item["Data"] = lstatus;
+				}
+				else if (dType == pTypeSecurity1)
+				{
+					std::string lstatus;
+					int llevel = 0;
+					bool bHaveDimmer = false;
+					bool bHaveGroupCmd = false;
+					int maxDimLevel = 0;
 
-							if (lstatus == "Close inline relay")
-							{
-								lstatus = "Close";
-							}
-							else if (lstatus == "Open inline relay")
-							{
-								lstatus = "Open";
-							}
-							else if (lstatus == "Stop inline relay")
-							{
-								lstatus = "Stop";
-							}
+					GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
 
-							bool bReverseState = false;
-							bool bReversePosition = false;
+					item["Status"] = lstatus;
+					item["HaveDimmer"] = bHaveDimmer;
+					item["MaxDimLevel"] = maxDimLevel;
+					item["HaveGroupCmd"] = bHaveGroupCmd;
+					item["SwitchType"] = "Security";
+					item["SwitchTypeVal"] = switchtype; // was 0?;
+					item["TypeImg"] = "security";
+					item["StrParam1"] = strParam1;
+					item["StrParam2"] = strParam2;
+					item["Protected"] = (iProtected != 0);
 
-							auto itt = options.find("ReverseState");
-							if (itt != options.end())
-								bReverseState = (itt->second == "true");
-							itt = options.find("ReversePosition");
-							if (itt != options.end())
-								bReversePosition = (itt->second == "true");
+					if ((dSubType == sTypeKD101) || (dSubType == sTypeSA30) || (dSubType == sTypeRM174RF) || (switchtype == STYPE_SMOKEDETECTOR))
+					{
+						item["SwitchTypeVal"] = STYPE_SMOKEDETECTOR;
+						item["TypeImg"] = "smoke";
+						item["SwitchType"] = Switch_Type_Desc(STYPE_SMOKEDETECTOR);
+					}
+					item["Data"] = lstatus;
+					item["HaveTimeout"] = false;
+				}
+				else if (dType == pTypeSecurity2)
+				{
+					std::string lstatus;
+					int llevel = 0;
+					bool bHaveDimmer = false;
+					bool bHaveGroupCmd = false;
+					int maxDimLevel = 0;
 
-							if (bReversePosition)
-							{
-								LastLevel = 100 - LastLevel;
-								if (lstatus.find("Set Level") == 0)
-									lstatus = std_format("Set Level: %d %%", LastLevel);
-							}
+					GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
 
-							if (bReverseState)
-							{
-								if (lstatus == "Open")
-									lstatus = "Close";
-								else if (lstatus == "Close")
-									lstatus = "Open";
-							}
+					item["Status"] = lstatus;
+					item["HaveDimmer"] = bHaveDimmer;
+					item["MaxDimLevel"] = maxDimLevel;
+					item["HaveGroupCmd"] = bHaveGroupCmd;
+					item["SwitchType"] = "Security";
+					item["SwitchTypeVal"] = switchtype; // was 0?;
+					item["TypeImg"] = "security";
+					item["StrParam1"] = strParam1;
+					item["StrParam2"] = strParam2;
+					item["Protected"] = (iProtected != 0);
+					item["Data"] = lstatus;
+					item["HaveTimeout"] = false;
+				}
+				else if (dType == pTypeEvohome || dType == pTypeEvohomeRelay)
+				{
+					std::string lstatus;
+					int llevel = 0;
+					bool bHaveDimmer = false;
+					bool bHaveGroupCmd = false;
+					int maxDimLevel = 0;
 
+					GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
 
-							if (lstatus == "Close")
-							{
-								lstatus = closedStatus;
-							}
-							else if (lstatus == "Open")
-							{
-								lstatus = openStatus;
-							}
-							else if (lstatus == "Stop")
-							{
-								lstatus = "Stopped";
-							}
-							root["result"][ii]["Status"] = lstatus;
+					item["Status"] = lstatus;
+					item["HaveDimmer"] = bHaveDimmer;
+					item["MaxDimLevel"] = maxDimLevel;
+					item["HaveGroupCmd"] = bHaveGroupCmd;
+					item["SwitchType"] = "evohome";
+					item["SwitchTypeVal"] = switchtype; // was 0?;
+					item["TypeImg"] = "override_mini";
+					item["StrParam1"] = strParam1;
+					item["StrParam2"] = strParam2;
+					item["Protected"] = (iProtected != 0);
+
+					item["Data"] = lstatus;
+					item["HaveTimeout"] = false;
+
+					if (dType == pTypeEvohomeRelay)
+					{
+						item["SwitchType"] = "TPI";
+						item["Level"] = llevel;
+						item["LevelInt"] = atoi(sValue.c_str());
+						if (item["Unit"].asInt() > 100)
+							item["Protected"] = true;
 
-							root["result"][ii]["Level"] = LastLevel;
-							int iLevel = round((float(maxDimLevel) / 100.0F) * LastLevel);
-							root["result"][ii]["LevelInt"] = iLevel;
+						sprintf(szData, "%s: %d", lstatus.c_str(), atoi(sValue.c_str()));
+						item["Data"] = szData;
+					}
+				}
+				else if ((dType == pTypeEvohomeZone) || (dType == pTypeEvohomeWater))
+				{
+					item["HaveTimeout"] = bHaveTimeout;
+					item["TypeImg"] = "override_mini";
 
-							root["result"][ii]["ReverseState"] = bReverseState;
-							root["result"][ii]["ReversePosition"] = bReversePosition;
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() >= 3)
+					{
+						int i = 0;
+						double tempCelcius = atof(strarray[i++].c_str());
+						double temp = ConvertTemperature(tempCelcius, state.tempsign);
+						double tempSetPoint;
+						item["Temp"] = temp;
+						if (dType == pTypeEvohomeWater && (strarray[i] == "Off" || strarray[i] == "On"))
+						{
+							item["State"] = strarray[i++];
 						}
-						else if (switchtype == STYPE_Dimmer)
+						else
 						{
-							root["result"][ii]["TypeImg"] = "dimmer";
+							tempCelcius = atof(strarray[i++].c_str());
+							tempSetPoint = ConvertTemperature(tempCelcius, state.tempsign);
+							item["SetPoint"] = tempSetPoint;
 						}
-						else if (switchtype == STYPE_Motion)
+
+						std::string strstatus = strarray[i++];
+						item["Status"] = strstatus;
+
+						if ((dType == pTypeEvohomeZone || dType == pTypeEvohomeWater) && strarray.size() >= 4)
 						{
-							root["result"][ii]["TypeImg"] = "motion";
+							item["Until"] = strarray[i++];
 						}
-						else if (switchtype == STYPE_Selector)
+						if (dType == pTypeEvohomeZone)
 						{
-							std::string selectorStyle = options["SelectorStyle"];
-							std::string levelOffHidden = options["LevelOffHidden"];
-							std::string levelNames = options["LevelNames"];
-							std::string levelActions = options["LevelActions"];
-							if (selectorStyle.empty())
-							{
-								selectorStyle.assign("0"); // default is 'button set'
-							}
-							if (levelOffHidden.empty())
-							{
-								levelOffHidden.assign("false"); // default is 'not hidden'
-							}
-							if (levelNames.empty())
-							{
-								levelNames.assign("Off"); // default is Off only
-							}
-							root["result"][ii]["TypeImg"] = "Light";
-							root["result"][ii]["SelectorStyle"] = atoi(selectorStyle.c_str());
-							root["result"][ii]["LevelOffHidden"] = (levelOffHidden == "true");
-							root["result"][ii]["LevelNames"] = base64_encode(levelNames);
-							root["result"][ii]["LevelActions"] = base64_encode(levelActions);
+							if (tempCelcius == 325.1)
+								sprintf(szTmp, "Off");
+							else
+								sprintf(szTmp, "%.1f %c", tempSetPoint, state.tempsign);
+							if (strarray.size() >= 4)
+								sprintf(szData, "%.1f %c, (%s), %s until %s", temp, state.tempsign, szTmp, strstatus.c_str(), strarray[3].c_str());
+							else
+								sprintf(szData, "%.1f %c, (%s), %s", temp, state.tempsign, szTmp, strstatus.c_str());
 						}
-						root["result"][ii]["Data"] = lstatus;
+						else if (strarray.size() >= 4)
+							sprintf(szData, "%.1f %c, %s, %s until %s", temp, state.tempsign, strarray[1].c_str(), strstatus.c_str(), strarray[3].c_str());
+						else
+							sprintf(szData, "%.1f %c, %s, %s", temp, state.tempsign, strarray[1].c_str(), strstatus.c_str());
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
 					}
-					else if (dType == pTypeSecurity1)
+				}
+				else if ((dType == pTypeTEMP) || (dType == pTypeRego6XXTemp))
+				{
+					double tvalue = ConvertTemperature(atof(sValue.c_str()), state.tempsign);
+					item["Temp"] = tvalue;
+					sprintf(szData, "%.1f %c", tvalue, state.tempsign);
+					item["Data"] = szData;
+					item["HaveTimeout"] = bHaveTimeout;
+
+					_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
+					uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
+					if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
 					{
-						std::string lstatus;
-						int llevel = 0;
-						bool bHaveDimmer = false;
-						bool bHaveGroupCmd = false;
-						int maxDimLevel = 0;
+						tstate = m_mainworker.m_trend_calculator[tID].m_state;
+					}
+					item["trend"] = (int)tstate;
+				}
+				else if (dType == pTypeThermostat1)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 4)
+					{
+						double tvalue = ConvertTemperature(atof(strarray[0].c_str()), state.tempsign);
+						item["Temp"] = tvalue;
+						sprintf(szData, "%.1f %c", tvalue, state.tempsign);
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+					}
+				}
+				else if ((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorTemp))
+				{
+					double tvalue = ConvertTemperature(atof(sValue.c_str()), state.tempsign);
+					item["Temp"] = tvalue;
+					sprintf(szData, "%.1f %c", tvalue, state.tempsign);
+					item["Data"] = szData;
+					item["TypeImg"] = "temperature";
+					item["HaveTimeout"] = bHaveTimeout;
+					_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
+					uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
+					if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
+					{
+						tstate = m_mainworker.m_trend_calculator[tID].m_state;
+					}
+					item["trend"] = (int)tstate;
+				}
+				else if (dType == pTypeHUM)
+				{
+					item["Humidity"] = nValue;
+					item["HumidityStatus"] = RFX_Humidity_Status_Desc(atoi(sValue.c_str()));
+					sprintf(szData, "Humidity %d %%", nValue);
+					item["Data"] = szData;
+					item["HaveTimeout"] = bHaveTimeout;
+				}
+				else if (dType == pTypeTEMP_HUM)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 3)
+					{
+						double tempCelcius = atof(strarray[0].c_str());
+						double temp = ConvertTemperature(tempCelcius, state.tempsign);
+						int humidity = atoi(strarray[1].c_str());
 
-						GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+						item["Temp"] = temp;
+						item["Humidity"] = humidity;
+						item["HumidityStatus"] = RFX_Humidity_Status_Desc(atoi(strarray[2].c_str()));
+						sprintf(szData, "%.1f %c, %d %%", temp, state.tempsign, atoi(strarray[1].c_str()));
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+
+						// Calculate dew point
 
-						root["result"][ii]["Status"] = lstatus;
-						root["result"][ii]["HaveDimmer"] = bHaveDimmer;
-						root["result"][ii]["MaxDimLevel"] = maxDimLevel;
-						root["result"][ii]["HaveGroupCmd"] = bHaveGroupCmd;
-						root["result"][ii]["SwitchType"] = "Security";
-						root["result"][ii]["SwitchTypeVal"] = switchtype; // was 0?;
-						root["result"][ii]["TypeImg"] = "security";
-						root["result"][ii]["StrParam1"] = strParam1;
-						root["result"][ii]["StrParam2"] = strParam2;
-						root["result"][ii]["Protected"] = (iProtected != 0);
-
-						if ((dSubType == sTypeKD101) || (dSubType == sTypeSA30) || (dSubType == sTypeRM174RF) || (switchtype == STYPE_SMOKEDETECTOR))
+						sprintf(szTmp, "%.2f", ConvertTemperature(CalculateDewPoint(tempCelcius, humidity), state.tempsign));
+						item["DewPoint"] = szTmp;
+
+						_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
+						uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
+						if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
 						{
-							root["result"][ii]["SwitchTypeVal"] = STYPE_SMOKEDETECTOR;
-							root["result"][ii]["TypeImg"] = "smoke";
-							root["result"][ii]["SwitchType"] = Switch_Type_Desc(STYPE_SMOKEDETECTOR);
+							tstate = m_mainworker.m_trend_calculator[tID].m_state;
 						}
-						root["result"][ii]["Data"] = lstatus;
-						root["result"][ii]["HaveTimeout"] = false;
+						item["trend"] = (int)tstate;
 					}
-					else if (dType == pTypeSecurity2)
-					{
-						std::string lstatus;
-						int llevel = 0;
-						bool bHaveDimmer = false;
-						bool bHaveGroupCmd = false;
-						int maxDimLevel = 0;
-
-						GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
-
-						root["result"][ii]["Status"] = lstatus;
-						root["result"][ii]["HaveDimmer"] = bHaveDimmer;
-						root["result"][ii]["MaxDimLevel"] = maxDimLevel;
-						root["result"][ii]["HaveGroupCmd"] = bHaveGroupCmd;
-						root["result"][ii]["SwitchType"] = "Security";
-						root["result"][ii]["SwitchTypeVal"] = switchtype; // was 0?;
-						root["result"][ii]["TypeImg"] = "security";
-						root["result"][ii]["StrParam1"] = strParam1;
-						root["result"][ii]["StrParam2"] = strParam2;
-						root["result"][ii]["Protected"] = (iProtected != 0);
-						root["result"][ii]["Data"] = lstatus;
-						root["result"][ii]["HaveTimeout"] = false;
-					}
-					else if (dType == pTypeEvohome || dType == pTypeEvohomeRelay)
+				}
+				else if (dType == pTypeTEMP_HUM_BARO)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 5)
 					{
-						std::string lstatus;
-						int llevel = 0;
-						bool bHaveDimmer = false;
-						bool bHaveGroupCmd = false;
-						int maxDimLevel = 0;
+						double tempCelcius = atof(strarray[0].c_str());
+						double temp = ConvertTemperature(tempCelcius, state.tempsign);
+						int humidity = atoi(strarray[1].c_str());
 
-						GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+						item["Temp"] = temp;
+						item["Humidity"] = humidity;
+						item["HumidityStatus"] = RFX_Humidity_Status_Desc(atoi(strarray[2].c_str()));
+						item["Forecast"] = atoi(strarray[4].c_str());
 
-						root["result"][ii]["Status"] = lstatus;
-						root["result"][ii]["HaveDimmer"] = bHaveDimmer;
-						root["result"][ii]["MaxDimLevel"] = maxDimLevel;
-						root["result"][ii]["HaveGroupCmd"] = bHaveGroupCmd;
-						root["result"][ii]["SwitchType"] = "evohome";
-						root["result"][ii]["SwitchTypeVal"] = switchtype; // was 0?;
-						root["result"][ii]["TypeImg"] = "override_mini";
-						root["result"][ii]["StrParam1"] = strParam1;
-						root["result"][ii]["StrParam2"] = strParam2;
-						root["result"][ii]["Protected"] = (iProtected != 0);
-
-						root["result"][ii]["Data"] = lstatus;
-						root["result"][ii]["HaveTimeout"] = false;
-
-						if (dType == pTypeEvohomeRelay)
+						sprintf(szTmp, "%.2f", ConvertTemperature(CalculateDewPoint(tempCelcius, humidity), state.tempsign));
+						item["DewPoint"] = szTmp;
+
+						if (dSubType == sTypeTHBFloat)
 						{
-							root["result"][ii]["SwitchType"] = "TPI";
-							root["result"][ii]["Level"] = llevel;
-							root["result"][ii]["LevelInt"] = atoi(sValue.c_str());
-							if (root["result"][ii]["Unit"].asInt() > 100)
-								root["result"][ii]["Protected"] = true;
-
-							sprintf(szData, "%s: %d", lstatus.c_str(), atoi(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
+							item["Barometer"] = atof(strarray[3].c_str());
+							item["ForecastStr"] = RFX_WSForecast_Desc(atoi(strarray[4].c_str()));
 						}
-					}
-					else if ((dType == pTypeEvohomeZone) || (dType == pTypeEvohomeWater))
-					{
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-						root["result"][ii]["TypeImg"] = "override_mini";
-
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() >= 3)
+						else
 						{
-							int i = 0;
-							double tempCelcius = atof(strarray[i++].c_str());
-							double temp = ConvertTemperature(tempCelcius, tempsign);
-							double tempSetPoint;
-							root["result"][ii]["Temp"] = temp;
-							if (dType == pTypeEvohomeWater && (strarray[i] == "Off" || strarray[i] == "On"))
-							{
-								root["result"][ii]["State"] = strarray[i++];
-							}
-							else
-							{
-								tempCelcius = atof(strarray[i++].c_str());
-								tempSetPoint = ConvertTemperature(tempCelcius, tempsign);
-								root["result"][ii]["SetPoint"] = tempSetPoint;
-							}
-
-							std::string strstatus = strarray[i++];
-							root["result"][ii]["Status"] = strstatus;
-
-							if ((dType == pTypeEvohomeZone || dType == pTypeEvohomeWater) && strarray.size() >= 4)
-							{
-								root["result"][ii]["Until"] = strarray[i++];
-							}
-							if (dType == pTypeEvohomeZone)
-							{
-								if (tempCelcius == 325.1)
-									sprintf(szTmp, "Off");
-								else
-									sprintf(szTmp, "%.1f %c", tempSetPoint, tempsign);
-								if (strarray.size() >= 4)
-									sprintf(szData, "%.1f %c, (%s), %s until %s", temp, tempsign, szTmp, strstatus.c_str(), strarray[3].c_str());
-								else
-									sprintf(szData, "%.1f %c, (%s), %s", temp, tempsign, szTmp, strstatus.c_str());
-							}
-							else if (strarray.size() >= 4)
-								sprintf(szData, "%.1f %c, %s, %s until %s", temp, tempsign, strarray[1].c_str(), strstatus.c_str(), strarray[3].c_str());
-							else
-								sprintf(szData, "%.1f %c, %s, %s", temp, tempsign, strarray[1].c_str(), strstatus.c_str());
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+							item["Barometer"] = atoi(strarray[3].c_str());
+							item["ForecastStr"] = RFX_Forecast_Desc(atoi(strarray[4].c_str()));
 						}
-					}
-					else if ((dType == pTypeTEMP) || (dType == pTypeRego6XXTemp))
-					{
-						double tvalue = ConvertTemperature(atof(sValue.c_str()), tempsign);
-						root["result"][ii]["Temp"] = tvalue;
-						sprintf(szData, "%.1f %c", tvalue, tempsign);
-						root["result"][ii]["Data"] = szData;
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+						if (dSubType == sTypeTHBFloat)
+						{
+							sprintf(szData, "%.1f %c, %d %%, %.1f hPa", temp, state.tempsign, atoi(strarray[1].c_str()), atof(strarray[3].c_str()));
+						}
+						else
+						{
+							sprintf(szData, "%.1f %c, %d %%, %d hPa", temp, state.tempsign, atoi(strarray[1].c_str()), atoi(strarray[3].c_str()));
+						}
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
 
 						_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
 						uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
@@ -9714,66 +10067,49 @@ namespace http
 						{
 							tstate = m_mainworker.m_trend_calculator[tID].m_state;
 						}
-						root["result"][ii]["trend"] = (int)tstate;
-					}
-					else if (dType == pTypeThermostat1)
-					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 4)
-						{
-							double tvalue = ConvertTemperature(atof(strarray[0].c_str()), tempsign);
-							root["result"][ii]["Temp"] = tvalue;
-							sprintf(szData, "%.1f %c", tvalue, tempsign);
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-						}
+						item["trend"] = (int)tstate;
 					}
-					else if ((dType == pTypeRFXSensor) && (dSubType == sTypeRFXSensorTemp))
+				}
+				else if (dType == pTypeTEMP_BARO)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() >= 3)
 					{
-						double tvalue = ConvertTemperature(atof(sValue.c_str()), tempsign);
-						root["result"][ii]["Temp"] = tvalue;
-						sprintf(szData, "%.1f %c", tvalue, tempsign);
-						root["result"][ii]["Data"] = szData;
-						root["result"][ii]["TypeImg"] = "temperature";
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+						double tvalue = ConvertTemperature(atof(strarray[0].c_str()), state.tempsign);
+						item["Temp"] = tvalue;
+						int forecast = atoi(strarray[2].c_str());
+						item["Forecast"] = forecast;
+						item["ForecastStr"] = BMP_Forecast_Desc(forecast);
+						item["Barometer"] = atof(strarray[1].c_str());
+
+						sprintf(szData, "%.1f %c, %.1f hPa", tvalue, state.tempsign, atof(strarray[1].c_str()));
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+
 						_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
 						uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
 						if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
 						{
 							tstate = m_mainworker.m_trend_calculator[tID].m_state;
 						}
-						root["result"][ii]["trend"] = (int)tstate;
+						item["trend"] = (int)tstate;
 					}
-					else if (dType == pTypeHUM)
-					{
-						root["result"][ii]["Humidity"] = nValue;
-						root["result"][ii]["HumidityStatus"] = RFX_Humidity_Status_Desc(atoi(sValue.c_str()));
-						sprintf(szData, "Humidity %d %%", nValue);
-						root["result"][ii]["Data"] = szData;
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-					}
-					else if (dType == pTypeTEMP_HUM)
+				}
+				else if (dType == pTypeUV)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 2)
 					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 3)
+						float UVI = static_cast<float>(atof(strarray[0].c_str()));
+						item["UVI"] = strarray[0];
+						if (dSubType == sTypeUV3)
 						{
-							double tempCelcius = atof(strarray[0].c_str());
-							double temp = ConvertTemperature(tempCelcius, tempsign);
-							int humidity = atoi(strarray[1].c_str());
+							double tvalue = ConvertTemperature(atof(strarray[1].c_str()), state.tempsign);
 
-							root["result"][ii]["Temp"] = temp;
-							root["result"][ii]["Humidity"] = humidity;
-							root["result"][ii]["HumidityStatus"] = RFX_Humidity_Status_Desc(atoi(strarray[2].c_str()));
-							sprintf(szData, "%.1f %c, %d %%", temp, tempsign, atoi(strarray[1].c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-
-							// Calculate dew point
-
-							sprintf(szTmp, "%.2f", ConvertTemperature(CalculateDewPoint(tempCelcius, humidity), tempsign));
-							root["result"][ii]["DewPoint"] = szTmp;
+							item["Temp"] = tvalue;
+							sprintf(szData, "%.1f UVI, %.1f&deg; %c", UVI, tvalue, state.tempsign);
 
 							_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
 							uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
@@ -9781,73 +10117,63 @@ namespace http
 							{
 								tstate = m_mainworker.m_trend_calculator[tID].m_state;
 							}
-							root["result"][ii]["trend"] = (int)tstate;
+							item["trend"] = (int)tstate;
+						}
+						else
+						{
+							sprintf(szData, "%.1f UVI", UVI);
 						}
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
 					}
-					else if (dType == pTypeTEMP_HUM_BARO)
+				}
+				else if (dType == pTypeWIND)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 6)
 					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 5)
-						{
-							double tempCelcius = atof(strarray[0].c_str());
-							double temp = ConvertTemperature(tempCelcius, tempsign);
-							int humidity = atoi(strarray[1].c_str());
-
-							root["result"][ii]["Temp"] = temp;
-							root["result"][ii]["Humidity"] = humidity;
-							root["result"][ii]["HumidityStatus"] = RFX_Humidity_Status_Desc(atoi(strarray[2].c_str()));
-							root["result"][ii]["Forecast"] = atoi(strarray[4].c_str());
-
-							sprintf(szTmp, "%.2f", ConvertTemperature(CalculateDewPoint(tempCelcius, humidity), tempsign));
-							root["result"][ii]["DewPoint"] = szTmp;
+						item["Direction"] = atof(strarray[0].c_str());
+						item["DirectionStr"] = strarray[1];
 
-							if (dSubType == sTypeTHBFloat)
+						if (dSubType != sTypeWIND5)
+						{
+							int intSpeed = atoi(strarray[2].c_str());
+							if (m_sql.m_windunit != WINDUNIT_Beaufort)
 							{
-								root["result"][ii]["Barometer"] = atof(strarray[3].c_str());
-								root["result"][ii]["ForecastStr"] = RFX_WSForecast_Desc(atoi(strarray[4].c_str()));
+								sprintf(szTmp, "%.1f", float(intSpeed) * m_sql.m_windscale);
 							}
 							else
 							{
-								root["result"][ii]["Barometer"] = atoi(strarray[3].c_str());
-								root["result"][ii]["ForecastStr"] = RFX_Forecast_Desc(atoi(strarray[4].c_str()));
+								float windms = float(intSpeed) * 0.1F;
+								sprintf(szTmp, "%d", MStoBeaufort(windms));
 							}
-							if (dSubType == sTypeTHBFloat)
+							item["Speed"] = szTmp;
+						}
+
+						// if (dSubType!=sTypeWIND6) //problem in RFXCOM firmware? gust=speed?
+						{
+							int intGust = atoi(strarray[3].c_str());
+							if (m_sql.m_windunit != WINDUNIT_Beaufort)
 							{
-								sprintf(szData, "%.1f %c, %d %%, %.1f hPa", temp, tempsign, atoi(strarray[1].c_str()), atof(strarray[3].c_str()));
+								sprintf(szTmp, "%.1f", float(intGust) * m_sql.m_windscale);
 							}
 							else
 							{
-								sprintf(szData, "%.1f %c, %d %%, %d hPa", temp, tempsign, atoi(strarray[1].c_str()), atoi(strarray[3].c_str()));
+								float gustms = float(intGust) * 0.1F;
+								sprintf(szTmp, "%d", MStoBeaufort(gustms));
 							}
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-
-							_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
-							uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
-							if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
-							{
-								tstate = m_mainworker.m_trend_calculator[tID].m_state;
-							}
-							root["result"][ii]["trend"] = (int)tstate;
+							item["Gust"] = szTmp;
 						}
-					}
-					else if (dType == pTypeTEMP_BARO)
-					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() >= 3)
+						if ((dSubType == sTypeWIND4) || (dSubType == sTypeWINDNoTemp))
 						{
-							double tvalue = ConvertTemperature(atof(strarray[0].c_str()), tempsign);
-							root["result"][ii]["Temp"] = tvalue;
-							int forecast = atoi(strarray[2].c_str());
-							root["result"][ii]["Forecast"] = forecast;
-							root["result"][ii]["ForecastStr"] = BMP_Forecast_Desc(forecast);
-							root["result"][ii]["Barometer"] = atof(strarray[1].c_str());
-
-							sprintf(szData, "%.1f %c, %.1f hPa", tvalue, tempsign, atof(strarray[1].c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+							if (dSubType == sTypeWIND4)
+							{
+								double tvalue = ConvertTemperature(atof(strarray[4].c_str()), state.tempsign);
+								item["Temp"] = tvalue;
+							}
+							double tvalue = ConvertTemperature(atof(strarray[5].c_str()), state.tempsign);
+							item["Chill"] = tvalue;
 
 							_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
 							uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
@@ -9855,1408 +10181,1237 @@ namespace http
 							{
 								tstate = m_mainworker.m_trend_calculator[tID].m_state;
 							}
-							root["result"][ii]["trend"] = (int)tstate;
+							item["trend"] = (int)tstate;
 						}
+						item["Data"] = sValue;
+						item["HaveTimeout"] = bHaveTimeout;
 					}
-					else if (dType == pTypeUV)
+				}
+				else if (dType == pTypeRAIN)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 2)
 					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 2)
+						// get lowest value of today, and max rate
+						_tTodayCounter today;
+						if (m_sql.GetTodayCounter(TCTABLE_RAIN, std::stoull(sd[0]), today))
 						{
-							float UVI = static_cast<float>(atof(strarray[0].c_str()));
-							root["result"][ii]["UVI"] = strarray[0];
-							if (dSubType == sTypeUV3)
-							{
-								double tvalue = ConvertTemperature(atof(strarray[1].c_str()), tempsign);
+							double total_real = 0;
+							float rate = 0;
 
-								root["result"][ii]["Temp"] = tvalue;
-								sprintf(szData, "%.1f UVI, %.1f&deg; %c", UVI, tvalue, tempsign);
-
-								_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
-								uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
-								if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
-								{
-									tstate = m_mainworker.m_trend_calculator[tID].m_state;
-								}
-								root["result"][ii]["trend"] = (int)tstate;
+							if (dSubType == sTypeRAINWU || dSubType == sTypeRAINByRate)
+							{
+								total_real = today.Last[0];
 							}
 							else
 							{
-								sprintf(szData, "%.1f UVI", UVI);
+								double total_min = today.Min[0];
+								double total_max = atof(strarray[1].c_str());
+								total_real = total_max - total_min;
 							}
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-						}
-					}
-					else if (dType == pTypeWIND)
-					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 6)
-						{
-							root["result"][ii]["Direction"] = atof(strarray[0].c_str());
-							root["result"][ii]["DirectionStr"] = strarray[1];
 
-							if (dSubType != sTypeWIND5)
+							total_real *= AddjMulti;
+							if (dSubType == sTypeRAINByRate)
 							{
-								int intSpeed = atoi(strarray[2].c_str());
-								if (m_sql.m_windunit != WINDUNIT_Beaufort)
-								{
-									sprintf(szTmp, "%.1f", float(intSpeed) * m_sql.m_windscale);
-								}
-								else
-								{
-									float windms = float(intSpeed) * 0.1F;
-									sprintf(szTmp, "%d", MStoBeaufort(windms));
-								}
-								root["result"][ii]["Speed"] = szTmp;
+								rate = static_cast<float>(today.Last[1] / 10000.0F);
 							}
-
-							// if (dSubType!=sTypeWIND6) //problem in RFXCOM firmware? gust=speed?
+							else
 							{
-								int intGust = atoi(strarray[3].c_str());
-								if (m_sql.m_windunit != WINDUNIT_Beaufort)
-								{
-									sprintf(szTmp, "%.1f", float(intGust) * m_sql.m_windscale);
-								}
-								else
-								{
-									float gustms = float(intGust) * 0.1F;
-									sprintf(szTmp, "%d", MStoBeaufort(gustms));
-								}
-								root["result"][ii]["Gust"] = szTmp;
+								rate = (static_cast<float>(atof(strarray[0].c_str())) / 100.0F) * float(AddjMulti);
 							}
-							if ((dSubType == sTypeWIND4) || (dSubType == sTypeWINDNoTemp))
-							{
-								if (dSubType == sTypeWIND4)
-								{
-									double tvalue = ConvertTemperature(atof(strarray[4].c_str()), tempsign);
-									root["result"][ii]["Temp"] = tvalue;
-								}
-								double tvalue = ConvertTemperature(atof(strarray[5].c_str()), tempsign);
-								root["result"][ii]["Chill"] = tvalue;
 
-								_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
-								uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
-								if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
-								{
-									tstate = m_mainworker.m_trend_calculator[tID].m_state;
-								}
-								root["result"][ii]["trend"] = (int)tstate;
-							}
-							root["result"][ii]["Data"] = sValue;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+							sprintf(szTmp, "%.1f", total_real);
+							item["Rain"] = szTmp;
+							sprintf(szTmp, "%g", rate);
+							item["RainRate"] = szTmp;
+							item["Data"] = sValue;
+							item["HaveTimeout"] = bHaveTimeout;
 						}
-					}
-					else if (dType == pTypeRAIN)
-					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 2)
+						else
 						{
-							// get lowest value of today, and max rate
-							time_t now = mytime(nullptr);
-							struct tm ltime;
-							localtime_r(&now, &ltime);
-							char szDate[40];
-							sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-							std::vector<std::vector<std::string>> result2;
-
-							if (dSubType == sTypeRAINWU || dSubType == sTypeRAINByRate)
-							{
-								result2 = m_sql.safe_query("SELECT Total, Rate FROM Rain WHERE (DeviceRowID='%q' AND Date>='%q') ORDER BY ROWID DESC LIMIT 1",
-									sd[0].c_str(), szDate);
-							}
-							else
-							{
-								result2 = m_sql.safe_query("SELECT MIN(Total), MAX(Total) FROM Rain WHERE (DeviceRowID='%q' AND Date>='%q')", sd[0].c_str(), szDate);
-							}
+							item["Rain"] = "0";
+							item["RainRate"] = "0";
+							item["Data"] = "0";
+							item["HaveTimeout"] = bHaveTimeout;
+						}
+					}
+				}
+				else if (dType == pTypeRFXMeter)
+				{
+					std::string ValueQuantity = options["ValueQuantity"];
+					std::string ValueUnits = options["ValueUnits"];
+					float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
 
-							if (!result2.empty())
-							{
-								double total_real = 0;
-								float rate = 0;
-								std::vector<std::string> sd2 = result2[0];
+					if (ValueQuantity.empty())
+					{
+						ValueQuantity = "Custom";
+					}
 
-								if (dSubType == sTypeRAINWU || dSubType == sTypeRAINByRate)
-								{
-									total_real = atof(sd2[0].c_str());
-								}
-								else
-								{
-									double total_min = atof(sd2[0].c_str());
-									double total_max = atof(strarray[1].c_str());
-									total_real = total_max - total_min;
-								}
+					// get value of today
+					_tTodayCounter today;
+					strcpy(szTmp, "0");
+					if (m_sql.GetTodayCounter(TCTABLE_METER, std::stoull(sd[0]), today))
+					{
+						int64_t total_first = (int64_t)today.First[0];
+						int64_t total_last = std::stoll(sValue);
+						int64_t total_real = total_last - total_first;
 
-								total_real *= AddjMulti;
-								if (dSubType == sTypeRAINByRate)
-								{
-									rate = static_cast<float>(atof(sd2[1].c_str()) / 10000.0F);
-								}
-								else
-								{
-									rate = (static_cast<float>(atof(strarray[0].c_str())) / 100.0F) * float(AddjMulti);
-								}
+						sprintf(szTmp, "%" PRId64, total_real);
 
-								sprintf(szTmp, "%.1f", total_real);
-								root["result"][ii]["Rain"] = szTmp;
-								sprintf(szTmp, "%g", rate);
-								root["result"][ii]["RainRate"] = szTmp;
-								root["result"][ii]["Data"] = sValue;
-								root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							}
-							else
+						double musage = 0.0F;
+						switch (metertype)
+						{
+						case MTYPE_ENERGY:
+						case MTYPE_ENERGY_GENERATED:
+							musage = double(total_real) / divider;
+							sprintf(szTmp, "%.3f kWh", musage);
+							break;
+						case MTYPE_GAS:
+							musage = double(total_real) / divider;
+							sprintf(szTmp, "%.3f m3", musage);
+							break;
+						case MTYPE_WATER:
+							musage = double(total_real) / (divider / 1000.0F);
+							sprintf(szTmp, "%d Liter", round(musage));
+							break;
+						case MTYPE_COUNTER:
+							musage = double(total_real) / divider;
+							sprintf(szTmp, "%.10g", musage);
+							if (!ValueUnits.empty())
 							{
-								root["result"][ii]["Rain"] = "0";
-								root["result"][ii]["RainRate"] = "0";
-								root["result"][ii]["Data"] = "0";
-								root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+								strcat(szTmp, " ");
+								strcat(szTmp, ValueUnits.c_str());
 							}
+							break;
+						default:
+							strcpy(szTmp, "?");
+							break;
 						}
 					}
-					else if (dType == pTypeRFXMeter)
-					{
-						std::string ValueQuantity = options["ValueQuantity"];
-						std::string ValueUnits = options["ValueUnits"];
-						float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
-
-						if (ValueQuantity.empty())
-						{
-							ValueQuantity = "Custom";
-						}
-
-						// get value of today
-						time_t now = mytime(nullptr);
-						struct tm ltime;
-						localtime_r(&now, &ltime);
-						char szDate[40];
-						sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+					item["CounterToday"] = szTmp;
 
-						std::vector<std::vector<std::string>> result2;
-						strcpy(szTmp, "0");
-						result2 = m_sql.safe_query("SELECT Value FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q') ORDER BY Date LIMIT 1", sd[0].c_str(), szDate);
-						if (!result2.empty())
-						{
-							std::vector<std::string> sd2 = result2[0];
+					item["SwitchTypeVal"] = metertype;
+					item["HaveTimeout"] = bHaveTimeout;
+					item["ValueQuantity"] = ValueQuantity;
+					item["ValueUnits"] = ValueUnits;
+					item["Divider"] = divider;
 
-							int64_t total_first = std::stoll(sd2[0]);
-							int64_t total_last = std::stoll(sValue);
-							int64_t total_real = total_last - total_first;
+					double meteroffset = AddjValue;
 
-							sprintf(szTmp, "%" PRId64, total_real);
+					double dvalue = static_cast<double>(atof(sValue.c_str()));
 
-							double musage = 0.0F;
-							switch (metertype)
-							{
-							case MTYPE_ENERGY:
-							case MTYPE_ENERGY_GENERATED:
-								musage = double(total_real) / divider;
-								sprintf(szTmp, "%.3f kWh", musage);
-								break;
-							case MTYPE_GAS:
-								musage = double(total_real) / divider;
-								sprintf(szTmp, "%.3f m3", musage);
-								break;
-							case MTYPE_WATER:
-								musage = double(total_real) / (divider / 1000.0F);
-								sprintf(szTmp, "%d Liter", round(musage));
-								break;
-							case MTYPE_COUNTER:
-								musage = double(total_real) / divider;
-								sprintf(szTmp, "%.10g", musage);
-								if (!ValueUnits.empty())
-								{
-									strcat(szTmp, " ");
-									strcat(szTmp, ValueUnits.c_str());
-								}
-								break;
-							default:
-								strcpy(szTmp, "?");
-								break;
-							}
+					switch (metertype)
+					{
+					case MTYPE_ENERGY:
+					case MTYPE_ENERGY_GENERATED:
+						sprintf(szTmp, "%.3f kWh", meteroffset + (dvalue / divider));
+						item["Data"] = szTmp;
+						item["Counter"] = szTmp;
+						break;
+					case MTYPE_GAS:
+						sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
+						item["Data"] = szTmp;
+						item["Counter"] = szTmp;
+						break;
+					case MTYPE_WATER:
+						sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
+						item["Data"] = szTmp;
+						item["Counter"] = szTmp;
+						break;
+					case MTYPE_COUNTER:
+						sprintf(szTmp, "%.10g", meteroffset + (dvalue / divider));
+						if (!ValueUnits.empty())
+						{
+							strcat(szTmp, " ");
+							strcat(szTmp, ValueUnits.c_str());
 						}
-						root["result"][ii]["CounterToday"] = szTmp;
+						item["Data"] = szTmp;
+						item["Counter"] = szTmp;
+						break;
+					default:
+						item["Data"] = "?";
+						item["Counter"] = "?";
+						break;
+					}
+				}
+				else if (dType == pTypeYouLess)
+				{
+					std::string ValueQuantity = options["ValueQuantity"];
+					std::string ValueUnits = options["ValueUnits"];
+					if (ValueQuantity.empty())
+					{
+						ValueQuantity = "Custom";
+					}
 
-						root["result"][ii]["SwitchTypeVal"] = metertype;
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-						root["result"][ii]["ValueQuantity"] = ValueQuantity;
-						root["result"][ii]["ValueUnits"] = ValueUnits;
-						root["result"][ii]["Divider"] = divider;
+					double musage = 0;
+					double divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
 
-						double meteroffset = AddjValue;
+					// get value of today
+					_tTodayCounter today;
+					strcpy(szTmp, "0");
+					if (m_sql.GetTodayCounter(TCTABLE_METER, std::stoull(sd[0]), today))
+					{
+						uint64_t total_min = (uint64_t)today.Min[0];
+						uint64_t total_max = (uint64_t)today.Max[0];
+						uint64_t total_real = total_max - total_min;
 
-						double dvalue = static_cast<double>(atof(sValue.c_str()));
+						sprintf(szTmp, "%" PRIu64, total_real);
 
+						musage = 0;
 						switch (metertype)
 						{
 						case MTYPE_ENERGY:
 						case MTYPE_ENERGY_GENERATED:
-							sprintf(szTmp, "%.3f kWh", meteroffset + (dvalue / divider));
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["Counter"] = szTmp;
+							musage = double(total_real) / divider;
+							sprintf(szTmp, "%.3f kWh", musage);
 							break;
 						case MTYPE_GAS:
-							sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["Counter"] = szTmp;
+							musage = double(total_real) / divider;
+							sprintf(szTmp, "%.3f m3", musage);
 							break;
 						case MTYPE_WATER:
-							sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["Counter"] = szTmp;
+							musage = double(total_real) / divider;
+							sprintf(szTmp, "%.3f m3", musage);
 							break;
 						case MTYPE_COUNTER:
-							sprintf(szTmp, "%.10g", meteroffset + (dvalue / divider));
+							sprintf(szTmp, "%.10g", double(total_real) / divider);
 							if (!ValueUnits.empty())
 							{
 								strcat(szTmp, " ");
 								strcat(szTmp, ValueUnits.c_str());
 							}
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["Counter"] = szTmp;
 							break;
 						default:
-							root["result"][ii]["Data"] = "?";
-							root["result"][ii]["Counter"] = "?";
+							strcpy(szTmp, "0");
 							break;
 						}
 					}
-					else if (dType == pTypeYouLess)
-					{
-						std::string ValueQuantity = options["ValueQuantity"];
-						std::string ValueUnits = options["ValueUnits"];
-						if (ValueQuantity.empty())
-						{
-							ValueQuantity = "Custom";
-						}
+					item["CounterToday"] = szTmp;
 
-						double musage = 0;
-						double divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
+					std::vector<std::string> splitresults;
+					StringSplit(sValue, ";", splitresults);
+					if (splitresults.size() < 2)
+						return false;
 
-						// get value of today
-						time_t now = mytime(nullptr);
-						struct tm ltime;
-						localtime_r(&now, &ltime);
-						char szDate[40];
-						sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-						std::vector<std::vector<std::string>> result2;
+					uint64_t total_actual = std::stoull(splitresults[0]);
+					musage = 0;
+					switch (metertype)
+					{
+					case MTYPE_ENERGY:
+					case MTYPE_ENERGY_GENERATED:
+						musage = double(total_actual) / divider;
+						sprintf(szTmp, "%.03f", musage);
+						break;
+					case MTYPE_GAS:
+					case MTYPE_WATER:
+						musage = double(total_actual) / divider;
+						sprintf(szTmp, "%.03f", musage);
+						break;
+					case MTYPE_COUNTER:
+						sprintf(szTmp, "%.10g", double(total_actual) / divider);
+						break;
+					default:
 						strcpy(szTmp, "0");
-						result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')", sd[0].c_str(), szDate);
-						if (!result2.empty())
-						{
-							std::vector<std::string> sd2 = result2[0];
-
-							uint64_t total_min = std::stoull(sd2[0]);
-							uint64_t total_max = std::stoull(sd2[1]);
-							uint64_t total_real = total_max - total_min;
-
-							sprintf(szTmp, "%" PRIu64, total_real);
-
-							musage = 0;
-							switch (metertype)
-							{
-							case MTYPE_ENERGY:
-							case MTYPE_ENERGY_GENERATED:
-								musage = double(total_real) / divider;
-								sprintf(szTmp, "%.3f kWh", musage);
-								break;
-							case MTYPE_GAS:
-								musage = double(total_real) / divider;
-								sprintf(szTmp, "%.3f m3", musage);
-								break;
-							case MTYPE_WATER:
-								musage = double(total_real) / divider;
-								sprintf(szTmp, "%.3f m3", musage);
-								break;
-							case MTYPE_COUNTER:
-								sprintf(szTmp, "%.10g", double(total_real) / divider);
-								if (!ValueUnits.empty())
-								{
-									strcat(szTmp, " ");
-									strcat(szTmp, ValueUnits.c_str());
-								}
-								break;
-							default:
-								strcpy(szTmp, "0");
-								break;
-							}
-						}
-						root["result"][ii]["CounterToday"] = szTmp;
+						break;
+					}
+					item["Counter"] = szTmp;
 
-						std::vector<std::string> splitresults;
-						StringSplit(sValue, ";", splitresults);
-						if (splitresults.size() < 2)
-							continue;
+					item["SwitchTypeVal"] = metertype;
 
-						uint64_t total_actual = std::stoull(splitresults[0]);
-						musage = 0;
-						switch (metertype)
+					uint64_t acounter = std::stoull(sValue);
+					musage = 0;
+					switch (metertype)
+					{
+					case MTYPE_ENERGY:
+					case MTYPE_ENERGY_GENERATED:
+						musage = double(acounter) / divider;
+						sprintf(szTmp, "%.3f kWh %s Watt", musage, splitresults[1].c_str());
+						break;
+					case MTYPE_GAS:
+						musage = double(acounter) / divider;
+						sprintf(szTmp, "%.3f m3", musage);
+						break;
+					case MTYPE_WATER:
+						musage = double(acounter) / divider;
+						sprintf(szTmp, "%.3f m3", musage);
+						break;
+					case MTYPE_COUNTER:
+						sprintf(szTmp, "%.10g", double(acounter) / divider);
+						if (!ValueUnits.empty())
 						{
-						case MTYPE_ENERGY:
-						case MTYPE_ENERGY_GENERATED:
-							musage = double(total_actual) / divider;
-							sprintf(szTmp, "%.03f", musage);
-							break;
-						case MTYPE_GAS:
-						case MTYPE_WATER:
-							musage = double(total_actual) / divider;
-							sprintf(szTmp, "%.03f", musage);
-							break;
-						case MTYPE_COUNTER:
-							sprintf(szTmp, "%.10g", double(total_actual) / divider);
-							break;
-						default:
-							strcpy(szTmp, "0");
-							break;
+							strcat(szTmp, " ");
+							strcat(szTmp, ValueUnits.c_str());
 						}
-						root["result"][ii]["Counter"] = szTmp;
-
-						root["result"][ii]["SwitchTypeVal"] = metertype;
-
-						uint64_t acounter = std::stoull(sValue);
-						musage = 0;
-						switch (metertype)
-						{
-						case MTYPE_ENERGY:
-						case MTYPE_ENERGY_GENERATED:
-							musage = double(acounter) / divider;
-							sprintf(szTmp, "%.3f kWh %s Watt", musage, splitresults[1].c_str());
-							break;
-						case MTYPE_GAS:
-							musage = double(acounter) / divider;
-							sprintf(szTmp, "%.3f m3", musage);
-							break;
-						case MTYPE_WATER:
-							musage = double(acounter) / divider;
-							sprintf(szTmp, "%.3f m3", musage);
-							break;
-						case MTYPE_COUNTER:
-							sprintf(szTmp, "%.10g", double(acounter) / divider);
-							if (!ValueUnits.empty())
-							{
-								strcat(szTmp, " ");
-								strcat(szTmp, ValueUnits.c_str());
-							}
-							break;
-						default:
-							strcpy(szTmp, "0");
-							break;
-						}
-						root["result"][ii]["Data"] = szTmp;
-						root["result"][ii]["ValueQuantity"] = ValueQuantity;
-						root["result"][ii]["ValueUnits"] = ValueUnits;
-						root["result"][ii]["Divider"] = divider;
+						break;
+					default:
+						strcpy(szTmp, "0");
+						break;
+					}
+					item["Data"] = szTmp;
+					item["ValueQuantity"] = ValueQuantity;
+					item["ValueUnits"] = ValueUnits;
+					item["Divider"] = divider;
 
-						switch (metertype)
-						{
-						case MTYPE_ENERGY:
-						case MTYPE_ENERGY_GENERATED:
-							sprintf(szTmp, "%s Watt", splitresults[1].c_str());
-							break;
-						case MTYPE_GAS:
-							sprintf(szTmp, "%s m3", splitresults[1].c_str());
-							break;
-						case MTYPE_WATER:
-							sprintf(szTmp, "%s m3", splitresults[1].c_str());
-							break;
-						case MTYPE_COUNTER:
-							sprintf(szTmp, "%s", splitresults[1].c_str());
-							break;
-						default:
-							strcpy(szTmp, "0");
-							break;
-						}
+					switch (metertype)
+					{
+					case MTYPE_ENERGY:
+					case MTYPE_ENERGY_GENERATED:
+						sprintf(szTmp, "%s Watt", splitresults[1].c_str());
+						break;
+					case MTYPE_GAS:
+						sprintf(szTmp, "%s m3", splitresults[1].c_str());
+						break;
+					case MTYPE_WATER:
+						sprintf(szTmp, "%s m3", splitresults[1].c_str());
+						break;
+					case MTYPE_COUNTER:
+						sprintf(szTmp, "%s", splitresults[1].c_str());
+						break;
+					default:
+						strcpy(szTmp, "0");
+						break;
+					}
 
-						root["result"][ii]["Usage"] = szTmp;
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+					item["Usage"] = szTmp;
+					item["HaveTimeout"] = bHaveTimeout;
+				}
+				else if (dType == pTypeP1Power)
+				{
+					std::vector<std::string> splitresults;
+					StringSplit(sValue, ";", splitresults);
+					if (splitresults.size() != 6)
+					{
+						item["SwitchTypeVal"] = MTYPE_ENERGY;
+						item["Counter"] = "0";
+						item["CounterDeliv"] = "0";
+						item["Usage"] = "Invalid";
+						item["UsageDeliv"] = "Invalid";
+						item["Data"] = "Invalid!: " + sValue;
+						item["HaveTimeout"] = true;
+						item["CounterToday"] = "Invalid";
+						item["CounterDelivToday"] = "Invalid";
 					}
-					else if (dType == pTypeP1Power)
+					else
 					{
-						std::vector<std::string> splitresults;
-						StringSplit(sValue, ";", splitresults);
-						if (splitresults.size() != 6)
+						float EnergyDivider = 1000.0F;
+						int tValue;
+						if (m_sql.GetPreferencesVar("MeterDividerEnergy", tValue))
 						{
-							root["result"][ii]["SwitchTypeVal"] = MTYPE_ENERGY;
-							root["result"][ii]["Counter"] = "0";
-							root["result"][ii]["CounterDeliv"] = "0";
-							root["result"][ii]["Usage"] = "Invalid";
-							root["result"][ii]["UsageDeliv"] = "Invalid";
-							root["result"][ii]["Data"] = "Invalid!: " + sValue;
-							root["result"][ii]["HaveTimeout"] = true;
-							root["result"][ii]["CounterToday"] = "Invalid";
-							root["result"][ii]["CounterDelivToday"] = "Invalid";
+							EnergyDivider = float(tValue);
 						}
-						else
-						{
-							float EnergyDivider = 1000.0F;
-							int tValue;
-							if (m_sql.GetPreferencesVar("MeterDividerEnergy", tValue))
-							{
-								EnergyDivider = float(tValue);
-							}
 
-							uint64_t powerusage1 = std::stoull(splitresults[0]);
-							uint64_t powerusage2 = std::stoull(splitresults[1]);
-							uint64_t powerdeliv1 = std::stoull(splitresults[2]);
-							uint64_t powerdeliv2 = std::stoull(splitresults[3]);
-							uint64_t usagecurrent = std::stoull(splitresults[4]);
-							uint64_t delivcurrent = std::stoull(splitresults[5]);
+						uint64_t powerusage1 = std::stoull(splitresults[0]);
+						uint64_t powerusage2 = std::stoull(splitresults[1]);
+						uint64_t powerdeliv1 = std::stoull(splitresults[2]);
+						uint64_t powerdeliv2 = std::stoull(splitresults[3]);
+						uint64_t usagecurrent = std::stoull(splitresults[4]);
+						uint64_t delivcurrent = std::stoull(splitresults[5]);
 
-							powerdeliv1 = (powerdeliv1 < 10) ? 0 : powerdeliv1;
-							powerdeliv2 = (powerdeliv2 < 10) ? 0 : powerdeliv2;
+						powerdeliv1 = (powerdeliv1 < 10) ? 0 : powerdeliv1;
+						powerdeliv2 = (powerdeliv2 < 10) ? 0 : powerdeliv2;
 
-							uint64_t powerusage = powerusage1 + powerusage2;
-							uint64_t powerdeliv = powerdeliv1 + powerdeliv2;
-							if (powerdeliv < 2)
-								powerdeliv = 0;
+						uint64_t powerusage = powerusage1 + powerusage2;
+						uint64_t powerdeliv = powerdeliv1 + powerdeliv2;
+						if (powerdeliv < 2)
+							powerdeliv = 0;
 
-							double musage = 0;
-
-							root["result"][ii]["SwitchTypeVal"] = MTYPE_ENERGY;
-							musage = double(powerusage) / EnergyDivider;
-							sprintf(szTmp, "%.03f", musage);
-							root["result"][ii]["Counter"] = szTmp;
-							musage = double(powerdeliv) / EnergyDivider;
-							sprintf(szTmp, "%.03f", musage);
-							root["result"][ii]["CounterDeliv"] = szTmp;
+						double musage = 0;
 
-							if (bHaveTimeout)
-							{
-								usagecurrent = 0;
-								delivcurrent = 0;
-							}
-							sprintf(szTmp, "%" PRIu64 " Watt", usagecurrent);
-							root["result"][ii]["Usage"] = szTmp;
-							sprintf(szTmp, "%" PRIu64 " Watt", delivcurrent);
-							root["result"][ii]["UsageDeliv"] = szTmp;
-							root["result"][ii]["Data"] = sValue;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-
-							// get value of today
-							time_t now = mytime(nullptr);
-							struct tm ltime;
-							localtime_r(&now, &ltime);
-							char szDate[40];
-							sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+						item["SwitchTypeVal"] = MTYPE_ENERGY;
+						musage = double(powerusage) / EnergyDivider;
+						sprintf(szTmp, "%.03f", musage);
+						item["Counter"] = szTmp;
+						musage = double(powerdeliv) / EnergyDivider;
+						sprintf(szTmp, "%.03f", musage);
+						item["CounterDeliv"] = szTmp;
 
-							std::vector<std::vector<std::string>> result2;
-							strcpy(szTmp, "0");
-							result2 = m_sql.safe_query("SELECT MIN(Value1), MIN(Value2), MIN(Value5), MIN(Value6) FROM MultiMeter WHERE (DeviceRowID='%q' AND Date>='%q')",
-								sd[0].c_str(), szDate);
-							if (!result2.empty())
-							{
-								std::vector<std::string> sd2 = result2[0];
+						if (bHaveTimeout)
+						{
+							usagecurrent = 0;
+							delivcurrent = 0;
+						}
+						sprintf(szTmp, "%" PRIu64 " Watt", usagecurrent);
+						item["Usage"] = szTmp;
+						sprintf(szTmp, "%" PRIu64 " Watt", delivcurrent);
+						item["UsageDeliv"] = szTmp;
+						item["Data"] = sValue;
+						item["HaveTimeout"] = bHaveTimeout;
 
-								uint64_t total_min_usage_1 = std::stoull(sd2[0]);
-								uint64_t total_min_deliv_1 = std::stoull(sd2[1]);
-								uint64_t total_min_usage_2 = std::stoull(sd2[2]);
-								uint64_t total_min_deliv_2 = std::stoull(sd2[3]);
-								uint64_t total_real_usage, total_real_deliv;
+						// get value of today
+						_tTodayCounter today;
+						strcpy(szTmp, "0");
+						if (m_sql.GetTodayCounter(TCTABLE_MULTIMETER, std::stoull(sd[0]), today))
+						{
+							uint64_t total_min_usage_1 = (uint64_t)today.Min[0];
+							uint64_t total_min_deliv_1 = (uint64_t)today.Min[1];
+							uint64_t total_min_usage_2 = (uint64_t)today.Min[4];
+							uint64_t total_min_deliv_2 = (uint64_t)today.Min[5];
+							uint64_t total_real_usage, total_real_deliv;
 
-								total_min_deliv_1 = (total_min_deliv_1 < 10) ? 0 : total_min_deliv_1;
-								total_min_deliv_2 = (total_min_deliv_2 < 10) ? 0 : total_min_deliv_2;
+							total_min_deliv_1 = (total_min_deliv_1 < 10) ? 0 : total_min_deliv_1;
+							total_min_deliv_2 = (total_min_deliv_2 < 10) ? 0 : total_min_deliv_2;
 
-								total_real_usage = powerusage - (total_min_usage_1 + total_min_usage_2);
-								total_real_deliv = powerdeliv - (total_min_deliv_1 + total_min_deliv_2);
+							total_real_usage = powerusage - (total_min_usage_1 + total_min_usage_2);
+							total_real_deliv = powerdeliv - (total_min_deliv_1 + total_min_deliv_2);
 
-								if (total_real_deliv < 2)
-									total_real_deliv = 0;
+							if (total_real_deliv < 2)
+								total_real_deliv = 0;
 
-								musage = double(total_real_usage) / EnergyDivider;
-								sprintf(szTmp, "%.3f kWh", musage);
-								root["result"][ii]["CounterToday"] = szTmp;
-								musage = double(total_real_deliv) / EnergyDivider;
-								sprintf(szTmp, "%.3f kWh", musage);
-								root["result"][ii]["CounterDelivToday"] = szTmp;
-							}
-							else
-							{
-								sprintf(szTmp, "%.3f kWh", 0.0F);
-								root["result"][ii]["CounterToday"] = szTmp;
-								root["result"][ii]["CounterDelivToday"] = szTmp;
-							}
+							musage = double(total_real_usage) / EnergyDivider;
+							sprintf(szTmp, "%.3f kWh", musage);
+							item["CounterToday"] = szTmp;
+							musage = double(total_real_deliv) / EnergyDivider;
+							sprintf(szTmp, "%.3f kWh", musage);
+							item["CounterDelivToday"] = szTmp;
+						}
+						else
+						{
+							sprintf(szTmp, "%.3f kWh", 0.0F);
+							item["CounterToday"] = szTmp;
+							item["CounterDelivToday"] = szTmp;
 						}
 					}
-					else if (dType == pTypeP1Gas)
-					{
-						root["result"][ii]["SwitchTypeVal"] = MTYPE_GAS;
-
-						// get lowest value of today
-						time_t now = mytime(nullptr);
-						struct tm ltime;
-						localtime_r(&now, &ltime);
-						char szDate[40];
-						sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
+				}
+				else if (dType == pTypeP1Gas)
+				{
+					item["SwitchTypeVal"] = MTYPE_GAS;
 
-						std::vector<std::vector<std::string>> result2;
+					// get lowest value of today
+					_tTodayCounter today;
 
-						float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
+					float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
 
-						strcpy(szTmp, "0");
-						result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')", sd[0].c_str(), szDate);
-						if (!result2.empty())
+					strcpy(szTmp, "0");
+					if (m_sql.GetTodayCounter(TCTABLE_METER, std::stoull(sd[0]), today))
+					{
+						uint64_t total_min_gas = (uint64_t)today.Min[0];
+						uint64_t gasactual;
+						try
 						{
-							std::vector<std::string> sd2 = result2[0];
-
-							uint64_t total_min_gas = std::stoull(sd2[0]);
-							uint64_t gasactual;
-							try
-							{
-								gasactual = std::stoull(sValue);
-							}
-							catch (std::invalid_argument e)
-							{
-								_log.Log(LOG_ERROR, "Gas - invalid value: '%s'", sValue.c_str());
-								continue;
-							}
-							uint64_t total_real_gas = gasactual - total_min_gas;
-
-							double musage = double(gasactual) / divider;
-							sprintf(szTmp, "%.03f", musage);
-							root["result"][ii]["Counter"] = szTmp;
-							musage = double(total_real_gas) / divider;
-							sprintf(szTmp, "%.03f m3", musage);
-							root["result"][ii]["CounterToday"] = szTmp;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							sprintf(szTmp, "%.03f", atof(sValue.c_str()) / divider);
-							root["result"][ii]["Data"] = szTmp;
+							gasactual = std::stoull(sValue);
 						}
-						else
+						catch (std::invalid_argument e)
 						{
-							sprintf(szTmp, "%.03f", 0.0F);
-							root["result"][ii]["Counter"] = szTmp;
-							sprintf(szTmp, "%.03f m3", 0.0F);
-							root["result"][ii]["CounterToday"] = szTmp;
-							sprintf(szTmp, "%.03f", atof(sValue.c_str()) / divider);
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+							_log.Log(LOG_ERROR, "Gas - invalid value: '%s'", sValue.c_str());
+							return false;
 						}
+						uint64_t total_real_gas = gasactual - total_min_gas;
+
+						double musage = double(gasactual) / divider;
+						sprintf(szTmp, "%.03f", musage);
+						item["Counter"] = szTmp;
+						musage = double(total_real_gas) / divider;
+						sprintf(szTmp, "%.03f m3", musage);
+						item["CounterToday"] = szTmp;
+						item["HaveTimeout"] = bHaveTimeout;
+						sprintf(szTmp, "%.03f", atof(sValue.c_str()) / divider);
+						item["Data"] = szTmp;
 					}
-					else if (dType == pTypeCURRENT)
+					else
 					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 3)
-						{
-							// CM113
-							int displaytype = 0;
-							int voltage = 230;
-							m_sql.GetPreferencesVar("CM113DisplayType", displaytype);
-							m_sql.GetPreferencesVar("ElectricVoltage", voltage);
+						sprintf(szTmp, "%.03f", 0.0F);
+						item["Counter"] = szTmp;
+						sprintf(szTmp, "%.03f m3", 0.0F);
+						item["CounterToday"] = szTmp;
+						sprintf(szTmp, "%.03f", atof(sValue.c_str()) / divider);
+						item["Data"] = szTmp;
+						item["HaveTimeout"] = bHaveTimeout;
+					}
+				}
+				else if (dType == pTypeCURRENT)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 3)
+					{
+						// CM113
+						int displaytype = 0;
+						int voltage = 230;
+						m_sql.GetPreferencesVar("CM113DisplayType", displaytype);
+						m_sql.GetPreferencesVar("ElectricVoltage", voltage);
 
-							double val1 = atof(strarray[0].c_str());
-							double val2 = atof(strarray[1].c_str());
-							double val3 = atof(strarray[2].c_str());
+						double val1 = atof(strarray[0].c_str());
+						double val2 = atof(strarray[1].c_str());
+						double val3 = atof(strarray[2].c_str());
 
-							if (displaytype == 0)
-							{
-								if ((val2 == 0) && (val3 == 0))
-									sprintf(szData, "%.1f A", val1);
-								else
-									sprintf(szData, "%.1f A, %.1f A, %.1f A", val1, val2, val3);
-							}
+						if (displaytype == 0)
+						{
+							if ((val2 == 0) && (val3 == 0))
+								sprintf(szData, "%.1f A", val1);
 							else
-							{
-								if ((val2 == 0) && (val3 == 0))
-									sprintf(szData, "%d Watt", int(val1 * voltage));
-								else
-									sprintf(szData, "%d Watt, %d Watt, %d Watt", int(val1 * voltage), int(val2 * voltage), int(val3 * voltage));
-							}
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["displaytype"] = displaytype;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+								sprintf(szData, "%.1f A, %.1f A, %.1f A", val1, val2, val3);
 						}
-					}
-					else if (dType == pTypeCURRENTENERGY)
-					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 4)
+						else
 						{
-							// CM180i
-							int displaytype = 0;
-							int voltage = 230;
-							m_sql.GetPreferencesVar("CM113DisplayType", displaytype);
-							m_sql.GetPreferencesVar("ElectricVoltage", voltage);
-
-							double total = atof(strarray[3].c_str());
-							if (displaytype == 0)
-							{
-								sprintf(szData, "%.1f A, %.1f A, %.1f A", atof(strarray[0].c_str()), atof(strarray[1].c_str()), atof(strarray[2].c_str()));
-							}
+							if ((val2 == 0) && (val3 == 0))
+								sprintf(szData, "%d Watt", int(val1 * voltage));
 							else
-							{
-								sprintf(szData, "%d Watt, %d Watt, %d Watt", int(atof(strarray[0].c_str()) * voltage), int(atof(strarray[1].c_str()) * voltage),
-									int(atof(strarray[2].c_str()) * voltage));
-							}
-							if (total > 0)
-							{
-								sprintf(szTmp, ", Total: %.3f kWh", total / 1000.0F);
-								strcat(szData, szTmp);
-							}
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["displaytype"] = displaytype;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+								sprintf(szData, "%d Watt, %d Watt, %d Watt", int(val1 * voltage), int(val2 * voltage), int(val3 * voltage));
 						}
+						item["Data"] = szData;
+						item["displaytype"] = displaytype;
+						item["HaveTimeout"] = bHaveTimeout;
 					}
-					else if (((dType == pTypeENERGY) || (dType == pTypePOWER)) || ((dType == pTypeGeneral) && (dSubType == sTypeKwh)))
+				}
+				else if (dType == pTypeCURRENTENERGY)
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 4)
 					{
-						std::vector<std::string> strarray;
-						StringSplit(sValue, ";", strarray);
-						if (strarray.size() == 2)
-						{
-							double total = atof(strarray[1].c_str()) / 1000;
-
-							time_t now = mytime(nullptr);
-							struct tm ltime;
-							localtime_r(&now, &ltime);
-							char szDate[40];
-							sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-							std::vector<std::vector<std::string>> result2;
-							strcpy(szTmp, "0");
-							// get the first value of the day instead of the minimum value, because counter can also decrease
-							// result2 = m_sql.safe_query("SELECT MIN(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')",
-							result2 = m_sql.safe_query("SELECT Value FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q') ORDER BY Date LIMIT 1", sd[0].c_str(), szDate);
-							if (!result2.empty())
-							{
-								float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
-
-								std::vector<std::string> sd2 = result2[0];
-								double minimum = atof(sd2[0].c_str()) / divider;
+						// CM180i
+						int displaytype = 0;
+						int voltage = 230;
+						m_sql.GetPreferencesVar("CM113DisplayType", displaytype);
+						m_sql.GetPreferencesVar("ElectricVoltage", voltage);
 
-								sprintf(szData, "%.3f kWh", total);
-								root["result"][ii]["Data"] = szData;
-								if ((dType == pTypeENERGY) || (dType == pTypePOWER))
-								{
-									sprintf(szData, "%ld Watt", atol(strarray[0].c_str()));
-								}
-								else
-								{
-									sprintf(szData, "%g Watt", atof(strarray[0].c_str()));
-								}
-								root["result"][ii]["Usage"] = szData;
-								root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-								sprintf(szTmp, "%.3f kWh", total - minimum);
-								root["result"][ii]["CounterToday"] = szTmp;
-							}
-							else
-							{
-								sprintf(szData, "%.3f kWh", total);
-								root["result"][ii]["Data"] = szData;
-								if ((dType == pTypeENERGY) || (dType == pTypePOWER))
-								{
-									sprintf(szData, "%ld Watt", atol(strarray[0].c_str()));
-								}
-								else
-								{
-									sprintf(szData, "%g Watt", atof(strarray[0].c_str()));
-								}
-								root["result"][ii]["Usage"] = szData;
-								root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-								sprintf(szTmp, "%d kWh", 0);
-								root["result"][ii]["CounterToday"] = szTmp;
-							}
+						double total = atof(strarray[3].c_str());
+						if (displaytype == 0)
+						{
+							sprintf(szData, "%.1f A, %.1f A, %.1f A", atof(strarray[0].c_str()), atof(strarray[1].c_str()), atof(strarray[2].c_str()));
 						}
-						root["result"][ii]["TypeImg"] = "current";
-						root["result"][ii]["SwitchTypeVal"] = switchtype;		    // MTYPE_ENERGY
-						root["result"][ii]["EnergyMeterMode"] = options["EnergyMeterMode"]; // for alternate Energy Reading
-					}
-					else if (dType == pTypeAirQuality)
-					{
-						if (bHaveTimeout)
-							nValue = 0;
-						sprintf(szTmp, "%d ppm", nValue);
-						root["result"][ii]["Data"] = szTmp;
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-						int airquality = nValue;
-						if (airquality < 700)
-							root["result"][ii]["Quality"] = "Excellent";
-						else if (airquality < 900)
-							root["result"][ii]["Quality"] = "Good";
-						else if (airquality < 1100)
-							root["result"][ii]["Quality"] = "Fair";
-						else if (airquality < 1600)
-							root["result"][ii]["Quality"] = "Mediocre";
 						else
-							root["result"][ii]["Quality"] = "Bad";
-					}
-					else if (dType == pTypeThermostat)
-					{
-						if (dSubType == sTypeThermSetpoint)
 						{
-							bHasTimers = m_sql.HasTimers(sd[0]);
-
-							double tempCelcius = atof(sValue.c_str());
-							double temp = ConvertTemperature(tempCelcius, tempsign);
-
-							sprintf(szTmp, "%.1f", temp);
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["SetPoint"] = szTmp;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "override_mini";
+							sprintf(szData, "%d Watt, %d Watt, %d Watt", int(atof(strarray[0].c_str()) * voltage), int(atof(strarray[1].c_str()) * voltage),
+								int(atof(strarray[2].c_str()) * voltage));
 						}
-					}
-					else if (dType == pTypeRadiator1)
-					{
-						if (dSubType == sTypeSmartwares)
+						if (total > 0)
 						{
-							bHasTimers = m_sql.HasTimers(sd[0]);
-
-							double tempCelcius = atof(sValue.c_str());
-							double temp = ConvertTemperature(tempCelcius, tempsign);
-
-							sprintf(szTmp, "%.1f", temp);
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["SetPoint"] = szTmp;
-							root["result"][ii]["HaveTimeout"] = false; // this device does not provide feedback, so no timeout!
-							root["result"][ii]["TypeImg"] = "override_mini";
+							sprintf(szTmp, ", Total: %.3f kWh", total / 1000.0F);
+							strcat(szData, szTmp);
 						}
+						item["Data"] = szData;
+						item["displaytype"] = displaytype;
+						item["HaveTimeout"] = bHaveTimeout;
 					}
-					else if (dType == pTypeGeneral)
+				}
+				else if (((dType == pTypeENERGY) || (dType == pTypePOWER)) || ((dType == pTypeGeneral) && (dSubType == sTypeKwh)))
+				{
+					std::vector<std::string> strarray;
+					StringSplit(sValue, ";", strarray);
+					if (strarray.size() == 2)
 					{
-						if (dSubType == sTypeVisibility)
+						double total = atof(strarray[1].c_str()) / 1000;
+
+						_tTodayCounter today;
+						strcpy(szTmp, "0");
+						// get the first value of the day instead of the minimum value, because counter can also decrease
+						if (m_sql.GetTodayCounter(TCTABLE_METER, std::stoull(sd[0]), today))
 						{
-							float vis = static_cast<float>(atof(sValue.c_str()));
-							if (metertype == 0)
+							float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
+
+							double minimum = today.First[0] / divider;
+
+							sprintf(szData, "%.3f kWh", total);
+							item["Data"] = szData;
+							if ((dType == pTypeENERGY) || (dType == pTypePOWER))
 							{
-								// km
-								sprintf(szTmp, "%.1f km", vis);
+								sprintf(szData, "%ld Watt", atol(strarray[0].c_str()));
 							}
 							else
 							{
-								// miles
-								sprintf(szTmp, "%.1f mi", vis * 0.6214F);
+								sprintf(szData, "%g Watt", atof(strarray[0].c_str()));
 							}
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["Visibility"] = atof(sValue.c_str());
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "visibility";
-							root["result"][ii]["SwitchTypeVal"] = metertype;
+							item["Usage"] = szData;
+							item["HaveTimeout"] = bHaveTimeout;
+							sprintf(szTmp, "%.3f kWh", total - minimum);
+							item["CounterToday"] = szTmp;
 						}
-						else if (dSubType == sTypeDistance)
+						else
 						{
-							float vis = static_cast<float>(atof(sValue.c_str()));
-							if (metertype == 0)
+							sprintf(szData, "%.3f kWh", total);
+							item["Data"] = szData;
+							if ((dType == pTypeENERGY) || (dType == pTypePOWER))
 							{
-								// Metric
-								sprintf(szTmp, "%.1f cm", vis);
+								sprintf(szData, "%ld Watt", atol(strarray[0].c_str()));
 							}
 							else
 							{
-								// Imperial
-								sprintf(szTmp, "%.1f in", vis * 0.3937007874015748F);
-							}
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "visibility";
-							root["result"][ii]["SwitchTypeVal"] = metertype;
-						}
-						else if (dSubType == sTypeSolarRadiation)
-						{
-							float radiation = static_cast<float>(atof(sValue.c_str()));
-							sprintf(szTmp, "%.1f Watt/m2", radiation);
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["Radiation"] = atof(sValue.c_str());
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "radiation";
-							root["result"][ii]["SwitchTypeVal"] = metertype;
-						}
-						else if (dSubType == sTypeSoilMoisture)
-						{
-							sprintf(szTmp, "%d cb", nValue);
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["Desc"] = Get_Moisture_Desc(nValue);
-							root["result"][ii]["TypeImg"] = "moisture";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["SwitchTypeVal"] = metertype;
-						}
-						else if (dSubType == sTypeLeafWetness)
-						{
-							sprintf(szTmp, "%d", nValue);
-							root["result"][ii]["Data"] = szTmp;
-							root["result"][ii]["TypeImg"] = "leaf";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["SwitchTypeVal"] = metertype;
-						}
-						else if (dSubType == sTypeSystemTemp)
-						{
-							double tvalue = ConvertTemperature(atof(sValue.c_str()), tempsign);
-							root["result"][ii]["Temp"] = tvalue;
-							sprintf(szData, "%.1f %c", tvalue, tempsign);
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Computer";
-							root["result"][ii]["TypeImg"] = "temperature";
-							root["result"][ii]["Type"] = "temperature";
-							_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
-							uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
-							if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
-							{
-								tstate = m_mainworker.m_trend_calculator[tID].m_state;
+								sprintf(szData, "%g Watt", atof(strarray[0].c_str()));
 							}
-							root["result"][ii]["trend"] = (int)tstate;
-						}
-						else if (dSubType == sTypePercentage)
-						{
-							sprintf(szData, "%g%%", atof(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "hardware";
-						}
-						else if (dSubType == sTypeWaterflow)
-						{
-							sprintf(szData, "%g l/min", atof(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Moisture";
-							root["result"][ii]["TypeImg"] = "moisture";
-						}
-						else if (dSubType == sTypeCustom)
-						{
-							std::string szAxesLabel;
-							int SensorType = 1;
-							std::vector<std::string> sResults;
-							StringSplit(sOptions, ";", sResults);
+							item["Usage"] = szData;
+							item["HaveTimeout"] = bHaveTimeout;
+							sprintf(szTmp, "%d kWh", 0);
+							item["CounterToday"] = szTmp;
+						}
+					}
+					item["TypeImg"] = "current";
+					item["SwitchTypeVal"] = switchtype;		    // MTYPE_ENERGY
+					item["EnergyMeterMode"] = options["EnergyMeterMode"]; // for alternate Energy Reading
+				}
+				else if (dType == pTypeAirQuality)
+				{
+					if (bHaveTimeout)
+						nValue = 0;
+					sprintf(szTmp, "%d ppm", nValue);
+					item["Data"] = szTmp;
+					item["HaveTimeout"] = bHaveTimeout;
+					int airquality = nValue;
+					if (airquality < 700)
+						item["Quality"] = "Excellent";
+					else if (airquality < 900)
+						item["Quality"] = "Good";
+					else if (airquality < 1100)
+						item["Quality"] = "Fair";
+					else if (airquality < 1600)
+						item["Quality"] = "Mediocre";
+					else
+						item["Quality"] = "Bad";
+				}
+				else if (dType == pTypeThermostat)
+				{
+					if (dSubType == sTypeThermSetpoint)
+					{
+						bHasTimers = m_sql.HasTimers(sd[0]);
+
+						double tempCelcius = atof(sValue.c_str());
+						double temp = ConvertTemperature(tempCelcius, state.tempsign);
 
-							if (sResults.size() == 2)
-							{
-								SensorType = atoi(sResults[0].c_str());
-								szAxesLabel = sResults[1];
-							}
-							sprintf(szData, "%g %s", atof(sValue.c_str()), szAxesLabel.c_str());
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["SensorType"] = SensorType;
-							root["result"][ii]["SensorUnit"] = szAxesLabel;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Custom";
-							root["result"][ii]["TypeImg"] = "Custom";
-						}
-						else if (dSubType == sTypeFan)
-						{
-							sprintf(szData, "%d RPM", atoi(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Fan";
-							root["result"][ii]["TypeImg"] = "Fan";
-						}
-						else if (dSubType == sTypeSoundLevel)
-						{
-							sprintf(szData, "%d dB", atoi(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["TypeImg"] = "Speaker";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-						}
-						else if (dSubType == sTypeVoltage)
-						{
-							sprintf(szData, "%g V", atof(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["TypeImg"] = "current";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["Voltage"] = atof(sValue.c_str());
-						}
-						else if (dSubType == sTypeCurrent)
+						sprintf(szTmp, "%.1f", temp);
+						item["Data"] = szTmp;
+						item["SetPoint"] = szTmp;
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "override_mini";
+					}
+				}
+				else if (dType == pTypeRadiator1)
+				{
+					if (dSubType == sTypeSmartwares)
+					{
+						bHasTimers = m_sql.HasTimers(sd[0]);
+
+						double tempCelcius = atof(sValue.c_str());
+						double temp = ConvertTemperature(tempCelcius, state.tempsign);
+
+						sprintf(szTmp, "%.1f", temp);
+						item["Data"] = szTmp;
+						item["SetPoint"] = szTmp;
+						item["HaveTimeout"] = false; // this device does not provide feedback, so no timeout!
+						item["TypeImg"] = "override_mini";
+					}
+				}
+				else if (dType == pTypeGeneral)
+				{
+					if (dSubType == sTypeVisibility)
+					{
+						float vis = static_cast<float>(atof(sValue.c_str()));
+						if (metertype == 0)
 						{
-							sprintf(szData, "%g A", atof(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["TypeImg"] = "current";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["Current"] = atof(sValue.c_str());
+							// km
+							sprintf(szTmp, "%.1f km", vis);
 						}
-						else if (dSubType == sTypeTextStatus)
+						else
 						{
-							root["result"][ii]["Data"] = sValue;
-							root["result"][ii]["TypeImg"] = "text";
-							root["result"][ii]["HaveTimeout"] = false;
-							root["result"][ii]["ShowNotifications"] = false;
+							// miles
+							sprintf(szTmp, "%.1f mi", vis * 0.6214F);
 						}
-						else if (dSubType == sTypeAlert)
+						item["Data"] = szTmp;
+						item["Visibility"] = atof(sValue.c_str());
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "visibility";
+						item["SwitchTypeVal"] = metertype;
+					}
+					else if (dSubType == sTypeDistance)
+					{
+						float vis = static_cast<float>(atof(sValue.c_str()));
+						if (metertype == 0)
 						{
-							if (nValue > 4)
-								nValue = 4;
-							sprintf(szData, "Level: %d", nValue);
-							root["result"][ii]["Data"] = szData;
-							if (!sValue.empty())
-								root["result"][ii]["Data"] = sValue;
-							else
-								root["result"][ii]["Data"] = Get_Alert_Desc(nValue);
-							root["result"][ii]["TypeImg"] = "Alert";
-							root["result"][ii]["Level"] = nValue;
-							root["result"][ii]["HaveTimeout"] = false;
+							// Metric
+							sprintf(szTmp, "%.1f cm", vis);
 						}
-						else if (dSubType == sTypePressure)
+						else
 						{
-							sprintf(szData, "%.1f Bar", atof(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["TypeImg"] = "gauge";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["Pressure"] = atof(sValue.c_str());
+							// Imperial
+							sprintf(szTmp, "%.1f in", vis * 0.3937007874015748F);
 						}
-						else if (dSubType == sTypeBaro)
+						item["Data"] = szTmp;
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "visibility";
+						item["SwitchTypeVal"] = metertype;
+					}
+					else if (dSubType == sTypeSolarRadiation)
+					{
+						float radiation = static_cast<float>(atof(sValue.c_str()));
+						sprintf(szTmp, "%.1f Watt/m2", radiation);
+						item["Data"] = szTmp;
+						item["Radiation"] = atof(sValue.c_str());
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "radiation";
+						item["SwitchTypeVal"] = metertype;
+					}
+					else if (dSubType == sTypeSoilMoisture)
+					{
+						sprintf(szTmp, "%d cb", nValue);
+						item["Data"] = szTmp;
+						item["Desc"] = Get_Moisture_Desc(nValue);
+						item["TypeImg"] = "moisture";
+						item["HaveTimeout"] = bHaveTimeout;
+						item["SwitchTypeVal"] = metertype;
+					}
+					else if (dSubType == sTypeLeafWetness)
+					{
+						sprintf(szTmp, "%d", nValue);
+						item["Data"] = szTmp;
+						item["TypeImg"] = "leaf";
+						item["HaveTimeout"] = bHaveTimeout;
+						item["SwitchTypeVal"] = metertype;
+					}
+					else if (dSubType == sTypeSystemTemp)
+					{
+						double tvalue = ConvertTemperature(atof(sValue.c_str()), state.tempsign);
+						item["Temp"] = tvalue;
+						sprintf(szData, "%.1f %c", tvalue, state.tempsign);
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+						if (!CustomImage)
+							item["Image"] = "Computer";
+						item["TypeImg"] = "temperature";
+						item["Type"] = "temperature";
+						_tTrendCalculator::_eTendencyType tstate = _tTrendCalculator::_eTendencyType::TENDENCY_UNKNOWN;
+						uint64_t tID = ((uint64_t)(hardwareID & 0x7FFFFFFF) << 32) | (devIdx & 0x7FFFFFFF);
+						if (m_mainworker.m_trend_calculator.find(tID) != m_mainworker.m_trend_calculator.end())
 						{
-							std::vector<std::string> tstrarray;
-							StringSplit(sValue, ";", tstrarray);
-							if (tstrarray.empty())
-								continue;
-							sprintf(szData, "%g hPa", atof(tstrarray[0].c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["TypeImg"] = "gauge";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							if (tstrarray.size() > 1)
-							{
-								root["result"][ii]["Barometer"] = atof(tstrarray[0].c_str());
-								int forecast = atoi(tstrarray[1].c_str());
-								root["result"][ii]["Forecast"] = forecast;
-								root["result"][ii]["ForecastStr"] = BMP_Forecast_Desc(forecast);
-							}
+							tstate = m_mainworker.m_trend_calculator[tID].m_state;
 						}
-						else if (dSubType == sTypeZWaveClock)
+						item["trend"] = (int)tstate;
+					}
+					else if (dSubType == sTypePercentage)
+					{
+						sprintf(szData, "%g%%", atof(sValue.c_str()));
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "hardware";
+					}
+					else if (dSubType == sTypeWaterflow)
+					{
+						sprintf(szData, "%g l/min", atof(sValue.c_str()));
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+						if (!CustomImage)
+							item["Image"] = "Moisture";
+						item["TypeImg"] = "moisture";
+					}
+					else if (dSubType == sTypeCustom)
+					{
+						std::string szAxesLabel;
+						int SensorType = 1;
+						std::vector<std::string> sResults;
+						StringSplit(sOptions, ";", sResults);
+
+						if (sResults.size() == 2)
 						{
-							std::vector<std::string> tstrarray;
-							StringSplit(sValue, ";", tstrarray);
-							int day = 0;
-							int hour = 0;
-							int minute = 0;
-							if (tstrarray.size() == 3)
-							{
-								day = atoi(tstrarray[0].c_str());
-								hour = atoi(tstrarray[1].c_str());
-								minute = atoi(tstrarray[2].c_str());
-							}
-							sprintf(szData, "%s %02d:%02d", ZWave_Clock_Days(day), hour, minute);
-							root["result"][ii]["DayTime"] = sValue;
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "clock";
+							SensorType = atoi(sResults[0].c_str());
+							szAxesLabel = sResults[1];
 						}
-						else if (dSubType == sTypeZWaveThermostatMode)
-						{
-							strcpy(szData, "");
-							root["result"][ii]["Mode"] = nValue;
-							root["result"][ii]["TypeImg"] = "mode";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							std::string modes;
-							// Add supported modes
+						sprintf(szData, "%g %s", atof(sValue.c_str()), szAxesLabel.c_str());
+						item["Data"] = szData;
+						item["SensorType"] = SensorType;
+						item["SensorUnit"] = szAxesLabel;
+						item["HaveTimeout"] = bHaveTimeout;
+
+						if (!CustomImage)
+							item["Image"] = "Custom";
+						item["TypeImg"] = "Custom";
+					}
+					else if (dSubType == sTypeFan)
+					{
+						sprintf(szData, "%d RPM", atoi(sValue.c_str()));
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+						if (!CustomImage)
+							item["Image"] = "Fan";
+						item["TypeImg"] = "Fan";
+					}
+					else if (dSubType == sTypeSoundLevel)
+					{
+						sprintf(szData, "%d dB", atoi(sValue.c_str()));
+						item["Data"] = szData;
+						item["TypeImg"] = "Speaker";
+						item["HaveTimeout"] = bHaveTimeout;
+					}
+					else if (dSubType == sTypeVoltage)
+					{
+						sprintf(szData, "%g V", atof(sValue.c_str()));
+						item["Data"] = szData;
+						item["TypeImg"] = "current";
+						item["HaveTimeout"] = bHaveTimeout;
+						item["Voltage"] = atof(sValue.c_str());
+					}
+					else if (dSubType == sTypeCurrent)
+					{
+						sprintf(szData, "%g A", atof(sValue.c_str()));
+						item["Data"] = szData;
+						item["TypeImg"] = "current";
+						item["HaveTimeout"] = bHaveTimeout;
+						item["Current"] = atof(sValue.c_str());
+					}
+					else if (dSubType == sTypeTextStatus)
+					{
+						item["Data"] = sValue;
+						item["TypeImg"] = "text";
+						item["HaveTimeout"] = false;
+						item["ShowNotifications"] = false;
+					}
+					else if (dSubType == sTypeAlert)
+					{
+						if (nValue > 4)
+							nValue = 4;
+						sprintf(szData, "Level: %d", nValue);
+						item["Data"] = szData;
+						if (!sValue.empty())
+							item["Data"] = sValue;
+						else
+							item["Data"] = Get_Alert_Desc(nValue);
+						item["TypeImg"] = "Alert";
+						item["Level"] = nValue;
+						item["HaveTimeout"] = false;
+					}
+					else if (dSubType == sTypePressure)
+					{
+						sprintf(szData, "%.1f Bar", atof(sValue.c_str()));
+						item["Data"] = szData;
+						item["TypeImg"] = "gauge";
+						item["HaveTimeout"] = bHaveTimeout;
+						item["Pressure"] = atof(sValue.c_str());
+					}
+					else if (dSubType == sTypeBaro)
+					{
+						std::vector<std::string> tstrarray;
+						StringSplit(sValue, ";", tstrarray);
+						if (tstrarray.empty())
+							return false;
+						sprintf(szData, "%g hPa", atof(tstrarray[0].c_str()));
+						item["Data"] = szData;
+						item["TypeImg"] = "gauge";
+						item["HaveTimeout"] = bHaveTimeout;
+						if (tstrarray.size() > 1)
+						{
+							item["Barometer"] = atof(tstrarray[0].c_str());
+							int forecast = atoi(tstrarray[1].c_str());
+							item["Forecast"] = forecast;
+							item["ForecastStr"] = BMP_Forecast_Desc(forecast);
+						}
+					}
+					else if (dSubType == sTypeZWaveClock)
+					{
+						std::vector<std::string> tstrarray;
+						StringSplit(sValue, ";", tstrarray);
+						int day = 0;
+						int hour = 0;
+						int minute = 0;
+						if (tstrarray.size() == 3)
+						{
+							day = atoi(tstrarray[0].c_str());
+							hour = atoi(tstrarray[1].c_str());
+							minute = atoi(tstrarray[2].c_str());
+						}
+						sprintf(szData, "%s %02d:%02d", ZWave_Clock_Days(day), hour, minute);
+						item["DayTime"] = sValue;
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "clock";
+					}
+					else if (dSubType == sTypeZWaveThermostatMode)
+					{
+						strcpy(szData, "");
+						item["Mode"] = nValue;
+						item["TypeImg"] = "mode";
+						item["HaveTimeout"] = bHaveTimeout;
+						std::string modes;
+						// Add supported modes
 #ifdef WITH_OPENZWAVE
-							if (pHardware)
+						if (pHardware)
+						{
+							if (pHardware->HwdType == HTYPE_OpenZWave)
 							{
-								if (pHardware->HwdType == HTYPE_OpenZWave)
+								COpenZWave* pZWave = dynamic_cast<COpenZWave*>(pHardware);
+								unsigned long ID;
+								std::stringstream s_strid;
+								s_strid << std::hex << sd[1];
+								s_strid >> ID;
+								std::vector<std::string> vmodes = pZWave->GetSupportedThermostatModes(ID);
+								int smode = 0;
+								char szTmp[200];
+								for (const auto& mode : vmodes)
 								{
-									COpenZWave* pZWave = dynamic_cast<COpenZWave*>(pHardware);
-									unsigned long ID;
-									std::stringstream s_strid;
-									s_strid << std::hex << sd[1];
-									s_strid >> ID;
-									std::vector<std::string> vmodes = pZWave->GetSupportedThermostatModes(ID);
-									int smode = 0;
-									char szTmp[200];
-									for (const auto& mode : vmodes)
-									{
-										// Value supported
-										sprintf(szTmp, "%d;%s;", smode, mode.c_str());
-										modes += szTmp;
-										smode++;
-									}
+									// Value supported
+									sprintf(szTmp, "%d;%s;", smode, mode.c_str());
+									modes += szTmp;
+									smode++;
+								}
 
-									if (!vmodes.empty())
+								if (!vmodes.empty())
+								{
+									if (nValue < (int)vmodes.size())
 									{
-										if (nValue < (int)vmodes.size())
-										{
-											sprintf(szData, "%s", vmodes[nValue].c_str());
-										}
+										sprintf(szData, "%s", vmodes[nValue].c_str());
 									}
 								}
 							}
-#endif
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["Modes"] = modes;
 						}
-						else if (dSubType == sTypeZWaveThermostatFanMode)
-						{
-							sprintf(szData, "%s", ZWave_Thermostat_Fan_Modes[nValue]);
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["Mode"] = nValue;
-							root["result"][ii]["TypeImg"] = "mode";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							// Add supported modes (add all for now)
-							bool bAddedSupportedModes = false;
-							std::string modes;
-							// Add supported modes
+#endif
+						item["Data"] = szData;
+						item["Modes"] = modes;
+					}
+					else if (dSubType == sTypeZWaveThermostatFanMode)
+					{
+						sprintf(szData, "%s", ZWave_Thermostat_Fan_Modes[nValue]);
+						item["Data"] = szData;
+						item["Mode"] = nValue;
+						item["TypeImg"] = "mode";
+						item["HaveTimeout"] = bHaveTimeout;
+						// Add supported modes (add all for now)
+						bool bAddedSupportedModes = false;
+						std::string modes;
+						// Add supported modes
 #ifdef WITH_OPENZWAVE
-							if (pHardware)
+						if (pHardware)
+						{
+							if (pHardware->HwdType == HTYPE_OpenZWave)
 							{
-								if (pHardware->HwdType == HTYPE_OpenZWave)
-								{
-									COpenZWave* pZWave = dynamic_cast<COpenZWave*>(pHardware);
-									unsigned long ID;
-									std::stringstream s_strid;
-									s_strid << std::hex << sd[1];
-									s_strid >> ID;
-									modes = pZWave->GetSupportedThermostatFanModes(ID);
-									bAddedSupportedModes = !modes.empty();
-								}
+								COpenZWave* pZWave = dynamic_cast<COpenZWave*>(pHardware);
+								unsigned long ID;
+								std::stringstream s_strid;
+								s_strid << std::hex << sd[1];
+								s_strid >> ID;
+								modes = pZWave->GetSupportedThermostatFanModes(ID);
+								bAddedSupportedModes = !modes.empty();
 							}
+						}
 #endif
-							if (!bAddedSupportedModes)
+						if (!bAddedSupportedModes)
+						{
+							int smode = 0;
+							while (ZWave_Thermostat_Fan_Modes[smode] != nullptr)
 							{
-								int smode = 0;
-								while (ZWave_Thermostat_Fan_Modes[smode] != nullptr)
-								{
-									sprintf(szTmp, "%d;%s;", smode, ZWave_Thermostat_Fan_Modes[smode]);
-									modes += szTmp;
-									smode++;
-								}
+								sprintf(szTmp, "%d;%s;", smode, ZWave_Thermostat_Fan_Modes[smode]);
+								modes += szTmp;
+								smode++;
 							}
-							root["result"][ii]["Modes"] = modes;
 						}
-						else if (dSubType == sTypeZWaveThermostatOperatingState)
+						item["Modes"] = modes;
+					}
+					else if (dSubType == sTypeZWaveThermostatOperatingState)
+					{
+						strcpy(szData, "");
+						item["State"] = nValue;
+						item["TypeImg"] = "Fan";
+						item["HaveTimeout"] = bHaveTimeout;
+						if (nValue == 1)
 						{
-							strcpy(szData, "");
-							root["result"][ii]["State"] = nValue;
-							root["result"][ii]["TypeImg"] = "Fan";
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							if (nValue == 1)
-							{
-								sprintf(szData, "%s", "Cooling");
-							}
-							else if (nValue == 2)
-							{
-								sprintf(szData, "%s", "Heating");
-							}
-							else
-							{
-								sprintf(szData, "%s", "Idle");
-							}
-							root["result"][ii]["Data"] = szData;
+							sprintf(szData, "%s", "Cooling");
 						}
-						else if (dSubType == sTypeZWaveAlarm)
+						else if (nValue == 2)
 						{
-							sprintf(szData, "Event: 0x%02X (%d)", nValue, nValue);
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["TypeImg"] = "Alert";
-							root["result"][ii]["Level"] = nValue;
-							root["result"][ii]["HaveTimeout"] = false;
+							sprintf(szData, "%s", "Heating");
 						}
-						else if (dSubType == sTypeCounterIncremental)
+						else
 						{
-							std::string ValueQuantity = options["ValueQuantity"];
-							std::string ValueUnits = options["ValueUnits"];
-							if (ValueQuantity.empty())
-							{
-								ValueQuantity = "Custom";
-							}
-
-							double divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
-
-							// get value of today
-							time_t now = mytime(nullptr);
-							struct tm ltime;
-							localtime_r(&now, &ltime);
-							char szDate[40];
-							sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-							std::vector<std::vector<std::string>> result2;
-							strcpy(szTmp, "0");
-							result2 = m_sql.safe_query("SELECT Value FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q') ORDER BY Date LIMIT 1", sd[0].c_str(), szDate);
-							if (!result2.empty())
-							{
-								std::vector<std::string> sd2 = result2[0];
-
-								int64_t total_first = std::stoll(sd2[0]);
-								int64_t total_last = std::stoll(sValue);
-								int64_t total_real = total_last - total_first;
+							sprintf(szData, "%s", "Idle");
+						}
+						item["Data"] = szData;
+					}
+					else if (dSubType == sTypeZWaveAlarm)
+					{
+						sprintf(szData, "Event: 0x%02X (%d)", nValue, nValue);
+						item["Data"] = szData;
+						item["TypeImg"] = "Alert";
+						item["Level"] = nValue;
+						item["HaveTimeout"] = false;
+					}
+					else if (dSubType == sTypeCounterIncremental)
+					{
+						std::string ValueQuantity = options["ValueQuantity"];
+						std::string ValueUnits = options["ValueUnits"];
+						if (ValueQuantity.empty())
+						{
+							ValueQuantity = "Custom";
+						}
 
-								double musage = 0;
-								switch (metertype)
-								{
-								case MTYPE_ENERGY:
-								case MTYPE_ENERGY_GENERATED:
-									musage = double(total_real) / divider;
-									sprintf(szTmp, "%.3f kWh", musage);
-									break;
-								case MTYPE_GAS:
-									musage = double(total_real) / divider;
-									sprintf(szTmp, "%.3f m3", musage);
-									break;
-								case MTYPE_WATER:
-									musage = double(total_real) / divider;
-									sprintf(szTmp, "%.3f m3", musage);
-									break;
-								case MTYPE_COUNTER:
-									sprintf(szTmp, "%.10g", double(total_real) / divider);
-									if (!ValueUnits.empty())
-									{
-										strcat(szTmp, " ");
-										strcat(szTmp, ValueUnits.c_str());
-									}
-									break;
-								default:
-									strcpy(szTmp, "0");
-									break;
-								}
-							}
-							root["result"][ii]["Counter"] = sValue;
-							root["result"][ii]["CounterToday"] = szTmp;
-							root["result"][ii]["SwitchTypeVal"] = metertype;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "counter";
-							root["result"][ii]["ValueQuantity"] = ValueQuantity;
-							root["result"][ii]["ValueUnits"] = ValueUnits;
-							root["result"][ii]["Divider"] = divider;
+						double divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
 
-							double dvalue = static_cast<double>(atof(sValue.c_str()));
-							double meteroffset = AddjValue;
+						// get value of today
+						_tTodayCounter today;
+						strcpy(szTmp, "0");
+						if (m_sql.GetTodayCounter(TCTABLE_METER, std::stoull(sd[0]), today))
+						{
+							int64_t total_first = (int64_t)today.First[0];
+							int64_t total_last = std::stoll(sValue);
+							int64_t total_real = total_last - total_first;
 
+							double musage = 0;
 							switch (metertype)
 							{
 							case MTYPE_ENERGY:
 							case MTYPE_ENERGY_GENERATED:
-								sprintf(szTmp, "%.3f kWh", meteroffset + (dvalue / divider));
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
+								musage = double(total_real) / divider;
+								sprintf(szTmp, "%.3f kWh", musage);
 								break;
 							case MTYPE_GAS:
-								sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
+								musage = double(total_real) / divider;
+								sprintf(szTmp, "%.3f m3", musage);
 								break;
 							case MTYPE_WATER:
-								sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
+								musage = double(total_real) / divider;
+								sprintf(szTmp, "%.3f m3", musage);
 								break;
 							case MTYPE_COUNTER:
-								sprintf(szTmp, "%.10g", meteroffset + (dvalue / divider));
+								sprintf(szTmp, "%.10g", double(total_real) / divider);
 								if (!ValueUnits.empty())
 								{
 									strcat(szTmp, " ");
 									strcat(szTmp, ValueUnits.c_str());
 								}
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
 								break;
 							default:
-								root["result"][ii]["Data"] = "?";
-								root["result"][ii]["Counter"] = "?";
+								strcpy(szTmp, "0");
 								break;
 							}
 						}
-						else if (dSubType == sTypeManagedCounter)
+						item["Counter"] = sValue;
+						item["CounterToday"] = szTmp;
+						item["SwitchTypeVal"] = metertype;
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "counter";
+						item["ValueQuantity"] = ValueQuantity;
+						item["ValueUnits"] = ValueUnits;
+						item["Divider"] = divider;
+
+						double dvalue = static_cast<double>(atof(sValue.c_str()));
+						double meteroffset = AddjValue;
+
+						switch (metertype)
 						{
-							std::string ValueQuantity = options["ValueQuantity"];
-							std::string ValueUnits = options["ValueUnits"];
-							if (ValueQuantity.empty())
+						case MTYPE_ENERGY:
+						case MTYPE_ENERGY_GENERATED:
+							sprintf(szTmp, "%.3f kWh", meteroffset + (dvalue / divider));
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						case MTYPE_GAS:
+							sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						case MTYPE_WATER:
+							sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						case MTYPE_COUNTER:
+							sprintf(szTmp, "%.10g", meteroffset + (dvalue / divider));
+							if (!ValueUnits.empty())
 							{
-								ValueQuantity = "Custom";
+								strcat(szTmp, " ");
+								strcat(szTmp, ValueUnits.c_str());
 							}
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						default:
+							item["Data"] = "?";
+							item["Counter"] = "?";
+							break;
+						}
+					}
+					else if (dSubType == sTypeManagedCounter)
+					{
+						std::string ValueQuantity = options["ValueQuantity"];
+						std::string ValueUnits = options["ValueUnits"];
+						if (ValueQuantity.empty())
+						{
+							ValueQuantity = "Custom";
+						}
 
-							float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
+						float divider = m_sql.GetCounterDivider(int(metertype), int(dType), float(AddjValue2));
 
-							std::vector<std::string> splitresults;
-							StringSplit(sValue, ";", splitresults);
-							double dvalue;
-							if (splitresults.size() < 2)
-							{
-								dvalue = static_cast<double>(atof(sValue.c_str()));
-							}
-							else
+						std::vector<std::string> splitresults;
+						StringSplit(sValue, ";", splitresults);
+						double dvalue;
+						if (splitresults.size() < 2)
+						{
+							dvalue = static_cast<double>(atof(sValue.c_str()));
+						}
+						else
+						{
+							dvalue = static_cast<double>(atof(splitresults[1].c_str()));
+							if (dvalue < 0.0)
 							{
-								dvalue = static_cast<double>(atof(splitresults[1].c_str()));
-								if (dvalue < 0.0)
-								{
-									dvalue = static_cast<double>(atof(splitresults[0].c_str()));
-								}
+								dvalue = static_cast<double>(atof(splitresults[0].c_str()));
 							}
-							root["result"][ii]["Data"] = root["result"][ii]["Counter"];
+						}
+						item["Data"] = item["Counter"];
 
-							root["result"][ii]["SwitchTypeVal"] = metertype;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["TypeImg"] = "counter";
-							root["result"][ii]["ValueQuantity"] = ValueQuantity;
-							root["result"][ii]["ValueUnits"] = ValueUnits;
-							root["result"][ii]["Divider"] = divider;
-							root["result"][ii]["ShowNotifications"] = false;
-							double meteroffset = AddjValue;
+						item["SwitchTypeVal"] = metertype;
+						item["HaveTimeout"] = bHaveTimeout;
+						item["TypeImg"] = "counter";
+						item["ValueQuantity"] = ValueQuantity;
+						item["ValueUnits"] = ValueUnits;
+						item["Divider"] = divider;
+						item["ShowNotifications"] = false;
+						double meteroffset = AddjValue;
 
-							switch (metertype)
+						switch (metertype)
+						{
+						case MTYPE_ENERGY:
+						case MTYPE_ENERGY_GENERATED:
+							sprintf(szTmp, "%.3f kWh", meteroffset + (dvalue / divider));
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						case MTYPE_GAS:
+							sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						case MTYPE_WATER:
+							sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						case MTYPE_COUNTER:
+							sprintf(szTmp, "%.10g", meteroffset + (dvalue / divider));
+							if (!ValueUnits.empty())
 							{
-							case MTYPE_ENERGY:
-							case MTYPE_ENERGY_GENERATED:
-								sprintf(szTmp, "%.3f kWh", meteroffset + (dvalue / divider));
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
-								break;
-							case MTYPE_GAS:
-								sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
-								break;
-							case MTYPE_WATER:
-								sprintf(szTmp, "%.3f m3", meteroffset + (dvalue / divider));
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
-								break;
-							case MTYPE_COUNTER:
-								sprintf(szTmp, "%.10g", meteroffset + (dvalue / divider));
-								if (!ValueUnits.empty())
-								{
-									strcat(szTmp, " ");
-									strcat(szTmp, ValueUnits.c_str());
-								}
-								root["result"][ii]["Data"] = szTmp;
-								root["result"][ii]["Counter"] = szTmp;
-								break;
-							default:
-								root["result"][ii]["Data"] = "?";
-								root["result"][ii]["Counter"] = "?";
-								break;
+								strcat(szTmp, " ");
+								strcat(szTmp, ValueUnits.c_str());
 							}
+							item["Data"] = szTmp;
+							item["Counter"] = szTmp;
+							break;
+						default:
+							item["Data"] = "?";
+							item["Counter"] = "?";
+							break;
 						}
 					}
-					else if (dType == pTypeLux)
+				}
+				else if (dType == pTypeLux)
+				{
+					sprintf(szTmp, "%.0f Lux", atof(sValue.c_str()));
+					item["Data"] = szTmp;
+					item["HaveTimeout"] = bHaveTimeout;
+				}
+				else if (dType == pTypeWEIGHT)
+				{
+					sprintf(szTmp, "%g %s", m_sql.m_weightscale * atof(sValue.c_str()), m_sql.m_weightsign.c_str());
+					item["Data"] = szTmp;
+					item["HaveTimeout"] = false;
+					item["SwitchTypeVal"] = (m_sql.m_weightsign == "kg") ? 0 : 1;
+				}
+				else if (dType == pTypeUsage)
+				{
+					if (dSubType == sTypeElectric)
 					{
-						sprintf(szTmp, "%.0f Lux", atof(sValue.c_str()));
-						root["result"][ii]["Data"] = szTmp;
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+						sprintf(szData, "%g Watt", atof(sValue.c_str()));
+						item["Data"] = szData;
 					}
-					else if (dType == pTypeWEIGHT)
+					else
 					{
-						sprintf(szTmp, "%g %s", m_sql.m_weightscale * atof(sValue.c_str()), m_sql.m_weightsign.c_str());
-						root["result"][ii]["Data"] = szTmp;
-						root["result"][ii]["HaveTimeout"] = false;
-						root["result"][ii]["SwitchTypeVal"] = (m_sql.m_weightsign == "kg") ? 0 : 1;
+						item["Data"] = sValue;
 					}
-					else if (dType == pTypeUsage)
+					item["HaveTimeout"] = bHaveTimeout;
+				}
+				else if (dType == pTypeRFXSensor)
+				{
+					switch (dSubType)
 					{
-						if (dSubType == sTypeElectric)
-						{
-							sprintf(szData, "%g Watt", atof(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-						}
-						else
-						{
-							root["result"][ii]["Data"] = sValue;
-						}
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+					case sTypeRFXSensorAD:
+						sprintf(szData, "%d mV", atoi(sValue.c_str()));
+						item["TypeImg"] = "current";
+						break;
+					case sTypeRFXSensorVolt:
+						sprintf(szData, "%d mV", atoi(sValue.c_str()));
+						item["TypeImg"] = "current";
+						break;
 					}
-					else if (dType == pTypeRFXSensor)
+					item["Data"] = szData;
+					item["HaveTimeout"] = bHaveTimeout;
+				}
+				else if (dType == pTypeRego6XXValue)
+				{
+					switch (dSubType)
 					{
-						switch (dSubType)
-						{
-						case sTypeRFXSensorAD:
-							sprintf(szData, "%d mV", atoi(sValue.c_str()));
-							root["result"][ii]["TypeImg"] = "current";
-							break;
-						case sTypeRFXSensorVolt:
-							sprintf(szData, "%d mV", atoi(sValue.c_str()));
-							root["result"][ii]["TypeImg"] = "current";
-							break;
-						}
-						root["result"][ii]["Data"] = szData;
-						root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-					}
-					else if (dType == pTypeRego6XXValue)
+					case sTypeRego6XXStatus:
 					{
-						switch (dSubType)
-						{
-						case sTypeRego6XXStatus:
-						{
-							std::string lstatus = "On";
-
-							if (atoi(sValue.c_str()) == 0)
-							{
-								lstatus = "Off";
-							}
-							root["result"][ii]["Status"] = lstatus;
-							root["result"][ii]["HaveDimmer"] = false;
-							root["result"][ii]["MaxDimLevel"] = 0;
-							root["result"][ii]["HaveGroupCmd"] = false;
-							root["result"][ii]["SwitchTypeVal"] = STYPE_OnOff;
-							root["result"][ii]["SwitchType"] = Switch_Type_Desc(STYPE_OnOff);
-							sprintf(szData, "%d", atoi(sValue.c_str()));
-							root["result"][ii]["Data"] = szData;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-							root["result"][ii]["StrParam1"] = strParam1;
-							root["result"][ii]["StrParam2"] = strParam2;
-							root["result"][ii]["Protected"] = (iProtected != 0);
-
-							if (!CustomImage)
-								root["result"][ii]["Image"] = "Light";
-							root["result"][ii]["TypeImg"] = "utility";
-
-							uint64_t camIDX = m_mainworker.m_cameras.IsDevSceneInCamera(0, sd[0]);
-							root["result"][ii]["UsedByCamera"] = (camIDX != 0) ? true : false;
-							if (camIDX != 0)
-							{
-								std::stringstream scidx;
-								scidx << camIDX;
-								root["result"][ii]["CameraIdx"] = scidx.str();
-								root["result"][ii]["CameraAspect"] = m_mainworker.m_cameras.GetCameraAspectRatio(scidx.str());
-							}
+						std::string lstatus = "On";
 
-							root["result"][ii]["Level"] = 0;
-							root["result"][ii]["LevelInt"] = atoi(sValue.c_str());
-						}
-						break;
-						case sTypeRego6XXCounter:
+						if (atoi(sValue.c_str()) == 0)
 						{
-							// get value of today
-							time_t now = mytime(nullptr);
-							struct tm ltime;
-							localtime_r(&now, &ltime);
-							char szDate[40];
-							sprintf(szDate, "%04d-%02d-%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday);
-
-							std::vector<std::vector<std::string>> result2;
-							strcpy(szTmp, "0");
-							result2 = m_sql.safe_query("SELECT MIN(Value), MAX(Value) FROM Meter WHERE (DeviceRowID='%q' AND Date>='%q')", sd[0].c_str(), szDate);
-							if (!result2.empty())
-							{
-								std::vector<std::string> sd2 = result2[0];
+							lstatus = "Off";
+						}
+						item["Status"] = lstatus;
+						item["HaveDimmer"] = false;
+						item["MaxDimLevel"] = 0;
+						item["HaveGroupCmd"] = false;
+						item["SwitchTypeVal"] = STYPE_OnOff;
+						item["SwitchType"] = Switch_Type_Desc(STYPE_OnOff);
+						sprintf(szData, "%d", atoi(sValue.c_str()));
+						item["Data"] = szData;
+						item["HaveTimeout"] = bHaveTimeout;
+						item["StrParam1"] = strParam1;
+						item["StrParam2"] = strParam2;
+						item["Protected"] = (iProtected != 0);
 
-								uint64_t total_min = std::stoull(sd2[0]);
-								uint64_t total_max = std::stoull(sd2[1]);
-								uint64_t total_real = total_max - total_min;
+						if (!CustomImage)
+							item["Image"] = "Light";
+						item["TypeImg"] = "utility";
 
-								sprintf(szTmp, "%" PRIu64, total_real);
-							}
-							root["result"][ii]["SwitchTypeVal"] = MTYPE_COUNTER;
-							root["result"][ii]["Counter"] = sValue;
-							root["result"][ii]["CounterToday"] = szTmp;
-							root["result"][ii]["Data"] = sValue;
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
-						}
-						break;
+						uint64_t camIDX = m_mainworker.m_cameras.IsDevSceneInCamera(0, sd[0]);
+						item["UsedByCamera"] = (camIDX != 0) ? true : false;
+						if (camIDX != 0)
+						{
+							std::stringstream scidx;
+							scidx << camIDX;
+							item["CameraIdx"] = scidx.str();
+							item["CameraAspect"] = m_mainworker.m_cameras.GetCameraAspectRatio(scidx.str());
 						}
+
+						item["Level"] = 0;
+						item["LevelInt"] = atoi(sValue.c_str());
 					}
-#ifdef ENABLE_PYTHON
-					if (pHardware != nullptr)
+					break;
+					case sTypeRego6XXCounter:
 					{
-						if (pHardware->HwdType == HTYPE_PythonPlugin)
+						// get value of today
+						_tTodayCounter today;
+						strcpy(szTmp, "0");
+						if (m_sql.GetTodayCounter(TCTABLE_METER, std::stoull(sd[0]), today))
 						{
-							Plugins::CPlugin* pPlugin = (Plugins::CPlugin*)pHardware;
-							bHaveTimeout = pPlugin->HasNodeFailed(sd[1].c_str(), atoi(sd[2].c_str()));
-							root["result"][ii]["HaveTimeout"] = bHaveTimeout;
+							uint64_t total_min = (uint64_t)today.Min[0];
+							uint64_t total_max = (uint64_t)today.Max[0];
+							uint64_t total_real = total_max - total_min;
+
+							sprintf(szTmp, "%" PRIu64, total_real);
 						}
+						item["SwitchTypeVal"] = MTYPE_COUNTER;
+						item["Counter"] = sValue;
+						item["CounterToday"] = szTmp;
+						item["Data"] = sValue;
+						item["HaveTimeout"] = bHaveTimeout;
+					}
+					break;
 					}
-#endif
-					root["result"][ii]["Timers"] = (bHasTimers == true) ? "true" : "false";
-					ii++;
 				}
-				catch (const std::exception& e)
+#ifdef ENABLE_PYTHON
+				if (pHardware != nullptr)
 				{
-					_log.Log(LOG_ERROR, "GetJSonDevices: exception occurred : '%s'", e.what());
-					continue;
+					if (pHardware->HwdType == HTYPE_PythonPlugin)
+					{
+						Plugins::CPlugin* pPlugin = (Plugins::CPlugin*)pHardware;
+						bHaveTimeout = pPlugin->HasNodeFailed(sd[1].c_str(), atoi(sd[2].c_str()));
+						item["HaveTimeout"] = bHaveTimeout;
+					}
 				}
+#endif
+				item["Timers"] = (bHasTimers == true) ? "true" : "false";
+				return true;
+			}
+			catch (const std::exception& e)
+			{
+				_log.Log(LOG_ERROR, "GetJSonDevices: exception occurred : '%s'", e.what());
+				return false;
 			}
 		}
 
@@ -11379,7 +11534,28 @@ namespace http
 						szAttachmentName = szVar + ".db";
 					}
 				}
-				reply::set_download_file(&rep, backupInfo["location"].asString(), szAttachmentName);
+				// Streamed like send_file does, but gzip compressed when the browser accepts it
+				std::string szBackupFile = backupInfo["location"].asString();
+				auto backupFile = std::make_shared<std::ifstream>(szBackupFile.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+				if (!backupFile->is_open())
+				{
+					session.reply_status = reply::internal_server_error;
+					return;
+				}
+				std::streamsize total_size = backupFile->tellg();
+				backupFile->seekg(0, std::ios::beg);
+				reply::set_stream(&rep, [backupFile](std::string &chunk) {
+					char buffer[16 * 1024];
+					backupFile->read(buffer, sizeof(buffer));
+					if (backupFile->bad() || (backupFile->fail() && !backupFile->eof()))
+						throw std::runtime_error("error reading the database backup"); // abort instead of ending the reply normally
+					chunk.append(buffer, static_cast<size_t>(backupFile->gcount()));
+					return !backupFile->eof();
+				});
+				reply::add_header_attachment(&rep, szAttachmentName);
+				reply::add_header(&rep, "Cache-Control", "max-age=0, private");
+				reply::add_header(&rep, "Content-Length", std::to_string(total_size));
+				reply::add_header(&rep, "Last-Modified", make_web_time(last_write_time(szBackupFile)));
 				backupInfo["duration"] = difftime(mytime(nullptr), now);
 				m_mainworker.m_notificationsystem.Notify(Notification::DZ_BACKUP_DONE, Notification::STATUS_INFO, JSonToRawString(backupInfo));
 			}
@@ -11817,6 +11993,11 @@ namespace http
 					CDomoticzHardwareBase* pHardware = m_mainworker.GetHardware(atoi(sd[0].c_str()));
 					if (pHardware != nullptr)
 					{
+						if (pHardware->m_SchedulerStats.runs != 0)
+						{
+							root["result"][ii]["PollRuns"] = static_cast<Json::UInt64>(pHardware->m_SchedulerStats.runs);
+							root["result"][ii]["PollCPUms"] = static_cast<Json::UInt64>(pHardware->m_SchedulerStats.cpu_us / 1000);
+						}
 						if ((pHardware->HwdType == HTYPE_RFXtrx315) || (pHardware->HwdType == HTYPE_RFXtrx433) || (pHardware->HwdType == HTYPE_RFXtrx868) ||
 							(pHardware->HwdType == HTYPE_RFXLAN))
 						{
@@ -11861,7 +12042,7 @@ namespace http
 			}
 		}
 
-		void CWebServer::RType_Devices(WebEmSession& session, const request& req, Json::Value& root)
+		CWebServer::json_stream_step CWebServer::RType_Devices(WebEmSession& session, const request& req)
 		{
 			std::string rfilter = request::findValue(&req, "filter");
 			std::string order = request::findValue(&req, "order");
@@ -11892,10 +12073,14 @@ namespace http
 				sstr >> LastUpdate;
 			}
 
+			Json::Value root;
 			root["status"] = "OK";
 			root["title"] = "Devices";
 			root["app_version"] = szAppVersion;
-			GetJSonDevices(root, rused, rfilter, order, rid, planid, floorid, bDisplayHidden, bDisabledDisabled, bFetchFavorites, LastUpdate, session.username, hwidx);
+			// the devices are read and sent one at a time
+			auto state = std::make_shared<_tDeviceListState>();
+			OpenJSonDevices(*state, root, rused, rfilter, order, rid, planid, floorid, bDisplayHidden, bDisabledDisabled, bFetchFavorites, LastUpdate, session.username, hwidx);
+			return JSonStreamResult(root, [this, state](Json::Value& row) { return NextJSonDevice(*state, row); });
 		}
 
 		void CWebServer::RType_Users(WebEmSession& session, const request& req, Json::Value& root)
@@ -12373,6 +12558,7 @@ namespace http
 			m_sql.safe_query("UPDATE DeviceStatus SET Name='%q' WHERE (ID == %d)", sname.c_str(), idx);
 			uint64_t ullidx = std::stoull(sidx);
 			m_mainworker.m_eventsystem.WWWUpdateSingleState(ullidx, sname, m_mainworker.m_eventsystem.REASON_DEVICE);
+			CBasePush::InvalidateDevice(ullidx);
 
 #ifdef ENABLE_PYTHON
 			// Notify plugin framework about the change
@@ -12703,6 +12889,9 @@ namespace http
 			m_sql.safe_query("UPDATE Percentage SET DeviceRowID='%q' WHERE (DeviceRowID == '%q') AND (Date>'%q')", sidx.c_str(), newidx.c_str(), szLastOldDate.c_str());
 			m_sql.safe_query("UPDATE Percentage_Calendar SET DeviceRowID='%q' WHERE (DeviceRowID == '%q') AND (Date>'%q')", sidx.c_str(), newidx.c_str(), szLastOldDate.c_str());
 
+			//today's short log rows of the new device now belong to the old one
+			m_sql.ClearTodayCounters(std::strtoull(sidx.c_str(), nullptr, 10));
+
 			m_sql.DeleteDevices(newidx);
 
 			m_mainworker.m_scheduler.ReloadSchedules();
@@ -12908,6 +13097,7 @@ namespace http
 						description.c_str(), switchtype, CustomImage, idx.c_str());
 				}
 			}
+			CBasePush::InvalidateDevice(std::strtoull(idx.c_str(), nullptr, 10));
 
 			if (bHasstrParam1)
 			{
@@ -13378,6 +13568,18 @@ namespace http
 				{
 					root["LogEventScriptTrigger"] = nValue;
 				}
+				else if (Key == "EventSystemBatchSize")
+				{
+					root["EventSystemBatchSize"] = nValue;
+				}
+				else if (Key == "EventSystemBatchWindow")
+				{
+					root["EventSystemBatchWindow"] = nValue;
+				}
+				else if (Key == "EventSystemDebounce")
+				{
+					root["EventSystemDebounce"] = nValue;
+				}
 				else if (Key == "(1WireSensorPollPeriod")
 				{
 					root["1WireSensorPollPeriod"] = nValue;
@@ -13465,8 +13667,11 @@ namespace http
 			}
 		}
 
-		void CWebServer::RType_LightLog(WebEmSession& session, const request& req, Json::Value& root)
+		CWebServer::json_stream_step CWebServer::RType_LightLog(WebEmSession& session, const request& req)
 		{
+			Json::Value root;
+			root["status"] = "ERR";
+
 			uint64_t idx = 0;
 			if (!request::findValue(&req, "idx").empty())
 			{
@@ -13476,7 +13681,7 @@ namespace http
 			// First get Device Type/SubType
 			result = m_sql.safe_query("SELECT Type, SubType, SwitchType, Options FROM DeviceStatus WHERE (ID == %" PRIu64 ")", idx);
 			if (result.empty())
-				return;
+				return JSonStreamResult(root, nullptr);
 
 			unsigned char dType = atoi(result[0][0].c_str());
 			unsigned char dSubType = atoi(result[0][1].c_str());
@@ -13488,22 +13693,23 @@ namespace http
 				(dType != pTypeEvohomeRelay) && (dType != pTypeCurtain) && (dType != pTypeBlinds) && (dType != pTypeRFY) && (dType != pTypeRego6XXValue) && (dType != pTypeChime) &&
 				(dType != pTypeThermostat2) && (dType != pTypeThermostat3) && (dType != pTypeThermostat4) && (dType != pTypeRemote) && (dType != pTypeGeneralSwitch) &&
 				(dType != pTypeHomeConfort) && (dType != pTypeFS20) && (!((dType == pTypeRadiator1) && (dSubType == sTypeSmartwaresSwitchRadiator))) && (dType != pTypeHunter))
-				return; // no light device! we should not be here!
-
-			root["status"] = "OK";
-			root["title"] = "LightLog";
+			{
+				// no light device! we should not be here!
+				return JSonStreamResult(root, nullptr);
+			}
 
-			result = m_sql.safe_query("SELECT ROWID, nValue, sValue, User, Date FROM LightingLog WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date DESC", idx);
-			if (!result.empty())
+			std::map<std::string, std::string> selectorStatuses;
+			if (switchtype == STYPE_Selector)
 			{
-				std::map<std::string, std::string> selectorStatuses;
-				if (switchtype == STYPE_Selector)
-				{
-					GetSelectorSwitchStatuses(options, selectorStatuses);
-				}
+				GetSelectorSwitchStatuses(options, selectorStatuses);
+			}
 
-				int ii = 0;
-				for (const auto& sd : result)
+			// Reads the next entry of the log, the first one also adds its flags to pFlags
+			auto cursor = m_sql.safe_cursor("SELECT ROWID, nValue, sValue, User, Date FROM LightingLog WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date DESC", idx);
+			int ii = 0;
+			auto readEntry = [cursor, dType, dSubType, switchtype, selectorStatuses, ii](Json::Value& row, Json::Value* pFlags) mutable {
+				std::vector<std::string> sd;
+				while (cursor->Step(sd))
 				{
 					std::string lidx = sd.at(0);
 					int nValue = atoi(sd.at(1).c_str());
@@ -13549,13 +13755,13 @@ namespace http
 						ldata = lstatus;
 					}
 
-					if (ii == 0)
+					if ((ii == 0) && (pFlags != nullptr))
 					{
 						// Log these parameters once
-						root["HaveDimmer"] = bHaveDimmer;
-						root["result"][ii]["MaxDimLevel"] = maxDimLevel;
-						root["HaveGroupCmd"] = bHaveGroupCmd;
-						root["HaveSelector"] = bHaveSelector;
+						(*pFlags)["HaveDimmer"] = bHaveDimmer;
+						(*pFlags)["HaveGroupCmd"] = bHaveGroupCmd;
+						(*pFlags)["HaveSelector"] = bHaveSelector;
+						row["MaxDimLevel"] = maxDimLevel;
 					}
 
 					// Corrent names for certain switch types
@@ -13575,42 +13781,57 @@ namespace http
 						break;
 					}
 
-					root["result"][ii]["idx"] = lidx;
-					root["result"][ii]["Date"] = ldate;
-					root["result"][ii]["Data"] = ldata;
-					root["result"][ii]["Status"] = lstatus;
-					root["result"][ii]["Level"] = llevel;
-					root["result"][ii]["User"] = sUser;
+					row["Data"] = ldata;
+					row["Date"] = ldate;
+					row["Level"] = llevel;
+					row["Status"] = lstatus;
+					row["User"] = sUser;
+					row["idx"] = lidx;
 					ii++;
+					return true;
 				}
-			}
+				return false;
+			};
+
+			// the flags of the first entry go in front of the result
+			Json::Value first;
+			bool bHaveFirst = readEntry(first, &root);
+			root["status"] = "OK";
+			root["title"] = "LightLog";
+			return JSonStreamResult(root, [readEntry, first, bHaveFirst](Json::Value& row) mutable {
+				if (bHaveFirst)
+				{
+					bHaveFirst = false;
+					row.swap(first);
+					return true;
+				}
+				return readEntry(row, nullptr);
+			});
 		}
 
-		void CWebServer::RType_TextLog(WebEmSession& session, const request& req, Json::Value& root)
+		CWebServer::json_stream_step CWebServer::RType_TextLog(WebEmSession& session, const request& req)
 		{
 			uint64_t idx = 0;
 			if (!request::findValue(&req, "idx").empty())
 			{
 				idx = std::stoull(request::findValue(&req, "idx"));
 			}
-			std::vector<std::vector<std::string>> result;
 
+			Json::Value root;
 			root["status"] = "OK";
 			root["title"] = "TextLog";
 
-			result = m_sql.safe_query("SELECT ROWID, sValue, User, Date FROM LightingLog WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date DESC", idx);
-			if (!result.empty())
-			{
-				int ii = 0;
-				for (const auto& sd : result)
-				{
-					root["result"][ii]["idx"] = sd[0];
-					root["result"][ii]["Data"] = sd[1];
-					root["result"][ii]["User"] = sd[2];
-					root["result"][ii]["Date"] = sd[3];
-					ii++;
-				}
-			}
+			auto cursor = m_sql.safe_cursor("SELECT ROWID, sValue, User, Date FROM LightingLog WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date DESC", idx);
+			return JSonStreamResult(root, [cursor](Json::Value& row) {
+				std::vector<std::string> sd;
+				if (!cursor->Step(sd))
+					return false;
+				row["Data"] = sd[1];
+				row["Date"] = sd[3];
+				row["User"] = sd[2];
+				row["idx"] = sd[0];
+				return true;
+			});
 		}
 
 		void CWebServer::RType_SceneLog(WebEmSession& session, const request& req, Json::Value& root)
@@ -13672,7 +13893,34 @@ namespace http
 			}
 		}
 
-		void CWebServer::RType_HandleGraph(WebEmSession& session, const request& req, Json::Value& root)
+		// The rows of a graph are added to the result in root, or returned in pRows to be read while the reply is sent
+		static void SetGraphRows(Json::Value& root, std::function<bool(Json::Value& row)>* pRows, const std::function<bool(Json::Value& row)>& rows)
+		{
+			if (pRows != nullptr)
+			{
+				*pRows = rows;
+				return;
+			}
+			Json::Value row;
+			int ii = 0;
+			while (rows(row))
+			{
+				root["result"][ii++].swap(row);
+				row = Json::Value();
+			}
+		}
+
+		CWebServer::json_stream_step CWebServer::RType_HandleGraphStream(WebEmSession& session, const request& req)
+		{
+			Json::Value root;
+			root["status"] = "ERR";
+			std::function<bool(Json::Value& row)> rows;
+			RType_HandleGraph(session, req, root, &rows);
+			return JSonStreamResult(root, rows);
+		}
+
+		// pRows: for the graphs of the short logs the rows are read from the database when the result is written
+		void CWebServer::RType_HandleGraph(WebEmSession& session, const request& req, Json::Value& root, std::function<bool(Json::Value& row)>* pRows)
 		{
 			uint64_t idx = 0;
 			if (!request::findValue(&req, "idx").empty())
@@ -13814,109 +14062,103 @@ namespace http
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Temperature, Chill, Humidity, Barometer, Date, SetPoint FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC",
+					auto cursor = m_sql.safe_cursor("SELECT Temperature, Chill, Humidity, Barometer, Date, SetPoint FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC",
 						dbasetable.c_str(), idx);
-					if (!result.empty())
-					{
-						int ii = 0;
-						for (const auto& sd : result)
+					SetGraphRows(root, pRows, [cursor, dType, dSubType, tempsign](Json::Value& row) {
+						std::vector<std::string> sd;
+						if (!cursor->Step(sd))
+							return false;
+						char szTmp[20];
+						row["d"] = sd[4].substr(0, 16);
+						if (dType == pTypeRego6XXTemp
+							|| dType == pTypeTEMP
+							|| dType == pTypeTEMP_HUM
+							|| dType == pTypeTEMP_HUM_BARO
+							|| dType == pTypeTEMP_BARO
+							|| dType == pTypeWIND && dSubType == sTypeWIND4
+							|| dType == pTypeUV && dSubType == sTypeUV3
+							|| dType == pTypeThermostat1
+							|| dType == pTypeRadiator1
+							|| dType == pTypeRFXSensor && dSubType == sTypeRFXSensorTemp
+							|| dType == pTypeGeneral && dSubType == sTypeSystemTemp
+							|| dType == pTypeGeneral && dSubType == sTypeBaro
+							|| dType == pTypeThermostat && dSubType == sTypeThermSetpoint
+							|| dType == pTypeEvohomeZone
+							|| dType == pTypeEvohomeWater
+							)
 						{
-							root["result"][ii]["d"] = sd[4].substr(0, 16);
-							if (dType == pTypeRego6XXTemp
-								|| dType == pTypeTEMP
-								|| dType == pTypeTEMP_HUM
-								|| dType == pTypeTEMP_HUM_BARO
-								|| dType == pTypeTEMP_BARO
-								|| dType == pTypeWIND && dSubType == sTypeWIND4
-								|| dType == pTypeUV && dSubType == sTypeUV3
-								|| dType == pTypeThermostat1
-								|| dType == pTypeRadiator1
-								|| dType == pTypeRFXSensor && dSubType == sTypeRFXSensorTemp
-								|| dType == pTypeGeneral && dSubType == sTypeSystemTemp
-								|| dType == pTypeGeneral && dSubType == sTypeBaro
-								|| dType == pTypeThermostat && dSubType == sTypeThermSetpoint
-								|| dType == pTypeEvohomeZone
-								|| dType == pTypeEvohomeWater
-								)
-							{
-								double tvalue = ConvertTemperature(atof(sd[0].c_str()), tempsign);
-								root["result"][ii]["te"] = tvalue;
-							}
-							if (((dType == pTypeWIND) && (dSubType == sTypeWIND4)) || ((dType == pTypeWIND) && (dSubType == sTypeWINDNoTemp)))
-							{
-								double tvalue = ConvertTemperature(atof(sd[1].c_str()), tempsign);
-								root["result"][ii]["ch"] = tvalue;
-							}
-							if ((dType == pTypeHUM) || (dType == pTypeTEMP_HUM) || (dType == pTypeTEMP_HUM_BARO))
-							{
-								root["result"][ii]["hu"] = sd[2];
-							}
-							if ((dType == pTypeTEMP_HUM_BARO) || (dType == pTypeTEMP_BARO) || ((dType == pTypeGeneral) && (dSubType == sTypeBaro)))
+							double tvalue = ConvertTemperature(atof(sd[0].c_str()), tempsign);
+							row["te"] = tvalue;
+						}
+						if (((dType == pTypeWIND) && (dSubType == sTypeWIND4)) || ((dType == pTypeWIND) && (dSubType == sTypeWINDNoTemp)))
+						{
+							double tvalue = ConvertTemperature(atof(sd[1].c_str()), tempsign);
+							row["ch"] = tvalue;
+						}
+						if ((dType == pTypeHUM) || (dType == pTypeTEMP_HUM) || (dType == pTypeTEMP_HUM_BARO))
+						{
+							row["hu"] = sd[2];
+						}
+						if ((dType == pTypeTEMP_HUM_BARO) || (dType == pTypeTEMP_BARO) || ((dType == pTypeGeneral) && (dSubType == sTypeBaro)))
+						{
+							if (dType == pTypeTEMP_HUM_BARO)
 							{
-								if (dType == pTypeTEMP_HUM_BARO)
-								{
-									if (dSubType == sTypeTHBFloat)
-									{
-										sprintf(szTmp, "%.1f", atof(sd[3].c_str()) / 10.0F);
-										root["result"][ii]["ba"] = szTmp;
-									}
-									else
-										root["result"][ii]["ba"] = sd[3];
-								}
-								else if (dType == pTypeTEMP_BARO)
-								{
-									sprintf(szTmp, "%.1f", atof(sd[3].c_str()) / 10.0F);
-									root["result"][ii]["ba"] = szTmp;
-								}
-								else if ((dType == pTypeGeneral) && (dSubType == sTypeBaro))
+								if (dSubType == sTypeTHBFloat)
 								{
 									sprintf(szTmp, "%.1f", atof(sd[3].c_str()) / 10.0F);
-									root["result"][ii]["ba"] = szTmp;
+									row["ba"] = szTmp;
 								}
+								else
+									row["ba"] = sd[3];
 							}
-							if ((dType == pTypeEvohomeZone) || (dType == pTypeEvohomeWater))
+							else if (dType == pTypeTEMP_BARO)
 							{
-								double se = ConvertTemperature(atof(sd[5].c_str()), tempsign);
-								root["result"][ii]["se"] = se;
+								sprintf(szTmp, "%.1f", atof(sd[3].c_str()) / 10.0F);
+								row["ba"] = szTmp;
+							}
+							else if ((dType == pTypeGeneral) && (dSubType == sTypeBaro))
+							{
+								sprintf(szTmp, "%.1f", atof(sd[3].c_str()) / 10.0F);
+								row["ba"] = szTmp;
 							}
-
-							ii++;
 						}
-					}
+						if ((dType == pTypeEvohomeZone) || (dType == pTypeEvohomeWater))
+						{
+							double se = ConvertTemperature(atof(sd[5].c_str()), tempsign);
+							row["se"] = se;
+						}
+						return true;
+					});
 				}
 				else if (sensor == "Percentage")
 				{
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Percentage, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
-					if (!result.empty())
-					{
-						int ii = 0;
-						for (const auto& sd : result)
-						{
-							root["result"][ii]["d"] = sd[1].substr(0, 16);
-							root["result"][ii]["v"] = sd[0];
-							ii++;
-						}
-					}
+					auto cursor = m_sql.safe_cursor("SELECT Percentage, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					SetGraphRows(root, pRows, [cursor](Json::Value& row) {
+						std::vector<std::string> sd;
+						if (!cursor->Step(sd))
+							return false;
+						row["d"] = sd[1].substr(0, 16);
+						row["v"] = sd[0];
+						return true;
+					});
 				}
 				else if (sensor == "fan")
 				{
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Speed, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
-					if (!result.empty())
-					{
-						int ii = 0;
-						for (const auto& sd : result)
-						{
-							root["result"][ii]["d"] = sd[1].substr(0, 16);
-							root["result"][ii]["v"] = sd[0];
-							ii++;
-						}
-					}
+					auto cursor = m_sql.safe_cursor("SELECT Speed, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					SetGraphRows(root, pRows, [cursor](Json::Value& row) {
+						std::vector<std::string> sd;
+						if (!cursor->Step(sd))
+							return false;
+						row["d"] = sd[1].substr(0, 16);
+						row["v"] = sd[0];
+						return true;
+					});
 				}
 				else if (sensor == "counter")
 				{
@@ -14835,17 +15077,15 @@ namespace http
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Level, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
-					if (!result.empty())
-					{
-						int ii = 0;
-						for (const auto& sd : result)
-						{
-							root["result"][ii]["d"] = sd[1].substr(0, 16);
-							root["result"][ii]["uvi"] = sd[0];
-							ii++;
-						}
-					}
+					auto cursor = m_sql.safe_cursor("SELECT Level, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					SetGraphRows(root, pRows, [cursor](Json::Value& row) {
+						std::vector<std::string> sd;
+						if (!cursor->Step(sd))
+							return false;
+						row["d"] = sd[1].substr(0, 16);
+						row["uvi"] = sd[0];
+						return true;
+					});
 				}
 				else if (sensor == "rain")
 				{
@@ -14916,37 +15156,36 @@ namespace http
 					root["status"] = "OK";
 					root["title"] = "Graph " + sensor + " " + srange;
 
-					result = m_sql.safe_query("SELECT Direction, Speed, Gust, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
-					if (!result.empty())
-					{
-						int ii = 0;
-						for (const auto& sd : result)
-						{
-							root["result"][ii]["d"] = sd[3].substr(0, 16);
-							root["result"][ii]["di"] = sd[0];
+					auto cursor = m_sql.safe_cursor("SELECT Direction, Speed, Gust, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+					SetGraphRows(root, pRows, [cursor](Json::Value& row) {
+						std::vector<std::string> sd;
+						if (!cursor->Step(sd))
+							return false;
+						char szTmp[20];
+						row["d"] = sd[3].substr(0, 16);
+						row["di"] = sd[0];
 
-							int intSpeed = atoi(sd[1].c_str());
-							int intGust = atoi(sd[2].c_str());
+						int intSpeed = atoi(sd[1].c_str());
+						int intGust = atoi(sd[2].c_str());
 
-							if (m_sql.m_windunit != WINDUNIT_Beaufort)
-							{
-								sprintf(szTmp, "%.1f", float(intSpeed) * m_sql.m_windscale);
-								root["result"][ii]["sp"] = szTmp;
-								sprintf(szTmp, "%.1f", float(intGust) * m_sql.m_windscale);
-								root["result"][ii]["gu"] = szTmp;
-							}
-							else
-							{
-								float windspeedms = float(intSpeed) * 0.1F;
-								float windgustms = float(intGust) * 0.1F;
-								sprintf(szTmp, "%d", MStoBeaufort(windspeedms));
-								root["result"][ii]["sp"] = szTmp;
-								sprintf(szTmp, "%d", MStoBeaufort(windgustms));
-								root["result"][ii]["gu"] = szTmp;
-							}
-							ii++;
+						if (m_sql.m_windunit != WINDUNIT_Beaufort)
+						{
+							sprintf(szTmp, "%.1f", float(intSpeed) * m_sql.m_windscale);
+							row["sp"] = szTmp;
+							sprintf(szTmp, "%.1f", float(intGust) * m_sql.m_windscale);
+							row["gu"] = szTmp;
 						}
-					}
+						else
+						{
+							float windspeedms = float(intSpeed) * 0.1F;
+							float windgustms = float(intGust) * 0.1F;
+							sprintf(szTmp, "%d", MStoBeaufort(windspeedms));
+							row["sp"] = szTmp;
+							sprintf(szTmp, "%d", MStoBeaufort(windgustms));
+							row["gu"] = szTmp;
+						}
+						return true;
+					});
 				}
 				else if (sensor == "winddir")
 				{
@@ -14,6 +14,9 @@ namespace Json
 	class Value;
 } // namespace Json
 
+class CSQLBenchmark;
+class CJSonStreamWriter;
+
 namespace http {
 	namespace server {
 		class cWebem;
@@ -21,6 +24,9 @@ namespace http {
 class CWebServer : public session_store, public std::enable_shared_from_this<CWebServer>
 {
 	typedef std::function<void(WebEmSession &session, const request &req, Json::Value &root)> webserver_response_function;
+	// Writes the next part of a streamed JSON reply, returns false once the reply is complete
+	typedef std::function<bool(CJSonStreamWriter &writer)> json_stream_step;
+	typedef std::function<json_stream_step(WebEmSession &session, const request &req)> webserver_stream_function;
 
       public:
 	struct _tCustomIcon
@@ -36,6 +42,10 @@ class CWebServer : public session_store, public std::enable_shared_from_this<CWe
 	void StopServer();
 	void RegisterCommandCode(const char *idname, const webserver_response_function &ResponseFunction, bool bypassAuthentication = false);
 	void RegisterRType(const char *idname, const webserver_response_function &ResponseFunction);
+	// For large responses: the handler checks the request and returns the step that writes the JSON, which is then
+	// called from the connection for every block sent to the client (reply::set_stream)
+	void RegisterRTypeStream(const char *idname, const webserver_stream_function &ResponseFunction);
+	void RegisterCommandStream(const char *idname, const webserver_stream_function &ResponseFunction);
 
 	void DisplaySwitchTypesCombo(std::string & content_part);
 	void DisplayMeterTypesCombo(std::string & content_part);
@@ -104,8 +114,19 @@ class CWebServer : public session_store, public std::enable_shared_from_this<CWe
 	std::string PluginHardwareDesc(int HwdID);
 
 private:
+	friend class ::CSQLBenchmark;
+
 	void HandleCommand(const std::string &cparam, WebEmSession & session, const request& req, Json::Value &root);
 	void HandleRType(const std::string &rtype, WebEmSession & session, const request& req, Json::Value &root);
+	json_stream_step JSonStreamResult(const Json::Value &root, const std::function<bool(Json::Value &row)> &next);
+
+	struct _tDeviceListState;
+	void OpenJSonDevices(_tDeviceListState &state, Json::Value &root, const std::string &rused, const std::string &rfilter, const std::string &order, const std::string &rowid,
+			     const std::string &planID, const std::string &floorID, bool bDisplayHidden, bool bDisplayDisabled, bool bFetchFavorites, time_t LastUpdate,
+			     const std::string &username, const std::string &hardwareid);
+	bool NextJSonDevice(_tDeviceListState &state, Json::Value &item);
+	bool GetJSonSceneRow(_tDeviceListState &state, const std::vector<std::string> &sd, Json::Value &item, Json::Value *prev);
+	bool GetJSonDeviceRow(_tDeviceListState &state, const std::vector<std::string> &sd, Json::Value &item, Json::Value *prev);
     void GroupBy(Json::Value &root, std::string dbasetable, uint64_t idx, std::string sgroupby, std::function<std::string (std::string)> counterExpr, std::function<std::string (std::string)> valueExpr, std::function<std::string (double)> sumToResult);
     void AddTodayValueToResult(Json::Value &root, const std::string &sgroupby, const std::string &today, const double todayValue, const std::string &formatString);
 
@@ -178,7 +199,7 @@ private:
 	void Cmd_GetUserVariables(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetUserVariable(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_AllowNewHardware(WebEmSession & session, const request& req, Json::Value &root);
-	void Cmd_GetLog(WebEmSession & session, const request& req, Json::Value &root);
+	json_stream_step Cmd_GetLog(WebEmSession & session, const request& req);
 	void Cmd_ClearLog(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_AddPlan(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_UpdatePlan(WebEmSession & session, const request& req, Json::Value &root);
@@ -309,15 +330,16 @@ private:
 #endif
 
 	//RTypes
-	void RType_HandleGraph(WebEmSession & session, const request& req, Json::Value &root);
-	void RType_LightLog(WebEmSession & session, const request& req, Json::Value &root);
-	void RType_TextLog(WebEmSession & session, const request& req, Json::Value &root);
+	void RType_HandleGraph(WebEmSession & session, const request& req, Json::Value &root, std::function<bool(Json::Value &row)> *pRows = nullptr);
+	json_stream_step RType_HandleGraphStream(WebEmSession & session, const request& req);
+	json_stream_step RType_LightLog(WebEmSession & session, const request& req);
+	json_stream_step RType_TextLog(WebEmSession & session, const request& req);
 	void RType_SceneLog(WebEmSession & session, const request& req, Json::Value &root);
 	void RType_RemoteWebClientsLog(WebEmSession& session, const request& req, Json::Value& root);
 	void RType_Settings(WebEmSession & session, const request& req, Json::Value &root);
 	void RType_Events(WebEmSession & session, const request& req, Json::Value &root);
 	void RType_Hardware(WebEmSession & session, const request& req, Json::Value &root);
-	void RType_Devices(WebEmSession & session, const request& req, Json::Value &root);
+	json_stream_step RType_Devices(WebEmSession & session, const request& req);
 	void RType_Cameras(WebEmSession& session, const request& req, Json::Value& root);
 	void RType_CamerasUser(WebEmSession& session, const request& req, Json::Value& root);
 	void RType_Users(WebEmSession & session, const request& req, Json::Value &root);
@@ -422,6 +444,8 @@ private:
 
 	std::map < std::string, webserver_response_function > m_webcommands;
 	std::map < std::string, webserver_response_function > m_webrtypes;
+	std::map < std::string, webserver_stream_function > m_webrtypes_stream;
+	std::map < std::string, webserver_stream_function > m_webcommands_stream;
 	void Do_Work();
 	std::vector<_tCustomIcon> m_custom_light_icons;
 	std::map<int, int> m_custom_light_icons_lookup;
@@ -28,6 +28,7 @@
 #include "Helper.h"
 #include "WebServerHelper.h"
 #include "SQLHelper.h"
+#include "SQLBenchmark.h"
 #include "../notifications/NotificationHelper.h"
 #include "appversion.h"
 #include "localtime_r.h"
@@ -84,6 +85,10 @@ namespace
 #endif
 		"\t-noupdates do not use the internal update functionality\n"
 		"\t-dbase_disable_wal_mode\n"
+		"\t-rxrecord file_path (write all received frames to this file)\n"
+		"\t-rxreplay file_path (replay recorded frames with a temporary database, log the timings and exit)\n"
+		"\t-rxrate frames_per_second (for -rxreplay, default=0 as fast as possible)\n"
+		"\t-sqlbench devices days [json_file] (time the database hot paths on a temporary synthetic database and exit)\n"
 #if defined WIN32
 		"\t-log file_path (for example D:\\domoticz.log)\n"
 		"\t-weblog file_path (for example D:\\domoticz_access.log)\n"
@@ -1029,6 +1034,51 @@ int main(int argc, char**argv)
 			dbasefile = cmdLine.GetSafeArgument("-dbase", 0, "domoticz.db");
 		}
 	}
+	std::string szRxReplayFile;
+	int iRxReplayRate = 0;
+	if (cmdLine.HasSwitch("-rxreplay"))
+	{
+		if (cmdLine.GetArgumentCount("-rxreplay") != 1)
+		{
+			_log.Log(LOG_ERROR, "Please specify the file with the recorded frames");
+			return 1;
+		}
+		szRxReplayFile = cmdLine.GetSafeArgument("-rxreplay", 0, "");
+		if (cmdLine.HasSwitch("-rxrate"))
+			iRxReplayRate = atoi(cmdLine.GetSafeArgument("-rxrate", 0, "0").c_str());
+	}
+	int iSQLBenchDevices = 0;
+	int iSQLBenchDays = 0;
+	std::string szSQLBenchFile;
+	if (cmdLine.HasSwitch("-sqlbench"))
+	{
+		if (cmdLine.GetArgumentCount("-sqlbench") >= 2)
+		{
+			iSQLBenchDevices = atoi(cmdLine.GetSafeArgument("-sqlbench", 0, "0").c_str());
+			iSQLBenchDays = atoi(cmdLine.GetSafeArgument("-sqlbench", 1, "0").c_str());
+		}
+		if ((iSQLBenchDevices < 1) || (iSQLBenchDays < 1))
+		{
+			_log.Log(LOG_ERROR, "Please specify the number of devices and days of history");
+			return 1;
+		}
+		szSQLBenchFile = cmdLine.GetSafeArgument("-sqlbench", 2, "");
+	}
+	const bool bTempDatabase = (!szRxReplayFile.empty()) || (iSQLBenchDevices > 0);
+	if (bTempDatabase)
+	{
+		//never touch the real database, and no web servers
+		dbasefile = szUserDataFolder + "domoticz_temp.db";
+		std::remove(dbasefile.c_str());
+		std::remove((dbasefile + "-wal").c_str());
+		std::remove((dbasefile + "-shm").c_str());
+		webserver_settings.listening_port = "0";
+		m_mainworker.SetWebserverSettings(webserver_settings);
+#ifdef WWW_ENABLE_SSL
+		secure_webserver_settings.listening_port = "0";
+		m_mainworker.SetSecureWebserverSettings(secure_webserver_settings);
+#endif
+	}
 	m_sql.SetDatabaseName(dbasefile);
 
 	if (!bUseConfigFile) {
@@ -1189,6 +1239,24 @@ int main(int argc, char**argv)
 
 	m_StartTime = time(nullptr);
 
+	if (cmdLine.HasSwitch("-rxrecord"))
+	{
+		m_mainworker.StartRxRecording(cmdLine.GetSafeArgument("-rxrecord", 0, "rxrecord.txt"));
+	}
+	int iExitCode = 0;
+	if (!szRxReplayFile.empty())
+	{
+		if (!m_mainworker.ReplayRxLog(szRxReplayFile, iRxReplayRate))
+			iExitCode = 1;
+		g_bStopApplication = true;
+	}
+	else if (iSQLBenchDevices > 0)
+	{
+		if (!CSQLBenchmark(iSQLBenchDevices, iSQLBenchDays).Run(szSQLBenchFile))
+			iExitCode = 1;
+		g_bStopApplication = true;
+	}
+
 	/* now, lets get into an infinite loop of doing nothing. */
 #if defined WIN32
 #ifndef _DEBUG
@@ -1246,6 +1314,12 @@ int main(int argc, char**argv)
 #endif
 	g_stop_watchdog = true;
 	thread_watchdog.join();
-	return 0;
+	if (bTempDatabase)
+	{
+		std::remove(dbasefile.c_str());
+		std::remove((dbasefile + "-wal").c_str());
+		std::remove((dbasefile + "-shm").c_str());
+	}
+	return iExitCode;
 }
 
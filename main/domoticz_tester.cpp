@@ -7,6 +7,12 @@
 #include "Helper.h"
 #include "appversion.h"
 #include "localtime_r.h"
+#include "../hardware/P1Telegram.h"
+#include "json_helper.h"
+#include "BlocklyRule.h"
+#include <chrono>
+#include <fstream>
+#include <map>
 
 #ifndef WIN32
 	#include <sys/stat.h>
@@ -33,6 +39,9 @@ constexpr const char *szHelp
 	"Available modules:\n"
 	"\thelper\n"
 	"\tbaroforecastcalculator\n"
+	"\tp1meter (P1MatchLine, P1CRC16, P1Telegram with a recorded telegram file as input)\n"
+	"\tjson (StreamWriter with a comma separated list of values as input)\n"
+	"\tblockly (Compile, Dependencies with a condition, Evaluate with a condition|#|operand=value;... as input)\n"
 	""
 };
 
@@ -60,6 +69,10 @@ bool bMeasure = false;
 
 #define INPUTSEPERATOR "|#|"
 
+#define MEASURE_RUNS 10000
+
+typedef bool (*tester_function)(const std::string szFunction, std::string &szInput, std::string &szOutput);
+
 /* **********
 Some supporting functions
 ********** */
@@ -197,6 +210,318 @@ bool helper_tester(const std::string szFunction, std::string &szInput, std::stri
 	return bSuccess;
 }
 
+/* **********
+hardware/P1Telegram.cpp
+********** */
+
+// Match a single line, M-Bus value lines are matched as if the device type line of their channel was read before
+int p1meter_matchline(const char *szLine)
+{
+	P1MatchState state;
+	int idx = P1FindMatch(szLine, state);
+	if (idx >= 0)
+		return idx;
+	state.bMBusTypeKnown = true;
+	P1SetMBusChannel(state, szLine[2]);
+	return P1FindMatch(szLine, state);
+}
+
+// Match and parse all lines of a telegram and validate its CRC, like P1MeterBase does per received line
+bool p1meter_telegram(const std::string &szTelegram, std::string &szOutput)
+{
+	int iLines = 0;
+	int iMatched = 0;
+	std::string szCRC = "none";
+	P1MatchState state;
+
+	size_t sPos = 0;
+	while (sPos < szTelegram.size())
+	{
+		size_t ePos = szTelegram.find('\n', sPos);
+		if (ePos == std::string::npos)
+			ePos = szTelegram.size();
+		std::string szLine = szTelegram.substr(sPos, ePos - sPos);
+		sPos = ePos + 1;
+		if (!szLine.empty() && szLine.back() == '\r')
+			szLine.pop_back();
+		if (szLine.empty())
+			continue;
+		iLines++;
+
+		state.linecount++;
+		const int idx = P1FindMatch(szLine.c_str(), state);
+		if (idx < 0)
+			continue;
+		iMatched++;
+
+		// keep the parser state up to date like P1MeterBase::MatchLine
+		const P1Match &t = P1GetMatch(idx);
+		if (t.matchtype == _eP1MatchType::ID)
+			state.linecount = 1;
+		else if (t.matchtype == _eP1MatchType::LINE17)
+			state.linecount = 17;
+		else if (t.matchtype == _eP1MatchType::DEVTYPE)
+		{
+			state.bMBusTypeKnown = true;
+			P1SetMBusChannel(state, szLine[2]);
+		}
+		else if ((t.matchtype == _eP1MatchType::MBUS) || (t.matchtype == _eP1MatchType::LINE18))
+			state.bMBusTypeKnown = false;
+		else if ((t.type == P1TYPE_VERSION) && (state.p1version == 0) && (t.start < szLine.size()))
+			state.p1version = szLine[t.start] - '0';
+		if (t.matchtype == _eP1MatchType::EXCLMARK)
+		{
+			size_t tStart = szTelegram.find('/');
+			size_t tEnd = szTelegram.find('!');
+			if ((tStart == std::string::npos) || (tEnd < tStart) || (szLine.size() < 5))
+				continue;
+			uint16_t crc = P1CRC16((const uint8_t *)szTelegram.c_str() + tStart, tEnd - tStart + 1);
+			szCRC = (crc == (uint16_t)strtoul(szLine.substr(1, 4).c_str(), nullptr, 16)) ? "OK" : "FAILED";
+		}
+		else if ((t.matchtype != _eP1MatchType::ID) && (t.type != P1TYPE_VERSION) && (t.type != P1TYPE_GASTIMESTAMP) && (t.start < szLine.size()))
+		{
+			P1ValueToFloat(szLine.c_str() + t.start);
+		}
+	}
+	szOutput = std_format("lines=%d matched=%d crc=%s", iLines, iMatched, szCRC.c_str());
+	return (iMatched > 0);
+}
+
+bool p1meter_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+
+	// P1CRC16
+	if (szFunction == "P1CRC16")
+	{
+		szOutput = std_format("%04X", P1CRC16((const uint8_t*)szInput.c_str(), szInput.length()));
+		bSuccess = true;
+	}
+	// P1MatchLine
+	else if (szFunction == "P1MatchLine")
+	{
+		const int idx = p1meter_matchline(szInput.c_str());
+		if (idx >= 0)
+		{
+			const P1Match &t = P1GetMatch(idx);
+			szOutput = t.topic;
+			if (t.start < szInput.size())
+			{
+				const char *pValue = szInput.c_str() + t.start;
+				szOutput += "=" + std::string(pValue, strcspn(pValue, "*)"));
+			}
+			bSuccess = true;
+		}
+	}
+	// P1Telegram
+	else if (szFunction == "P1Telegram")
+	{
+		// keep the recorded telegram in memory so -measure only times the parsing
+		static std::string szFile, szTelegram;
+		if (szFile != szInput)
+		{
+			std::ifstream infile(szInput, std::ios::in | std::ios::binary);
+			if (!infile.is_open())
+			{
+				szOutput = "Unable to open telegram file";
+				return false;
+			}
+			szTelegram.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+			szFile = szInput;
+		}
+		bSuccess = p1meter_telegram(szTelegram, szOutput);
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	return bSuccess;
+}
+
+/* **********
+json_helper.cpp
+********** */
+bool json_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+
+	// StreamWriter, writes a log like result with the input values and compares it with toStyledString
+	if (szFunction == "StreamWriter")
+	{
+		std::vector<std::string> svValues;
+		StringSplit(szInput, ",", svValues);
+
+		Json::Value root;
+		root["status"] = "OK";
+		root["title"] = "StreamWriter";
+		root["empty"] = Json::Value(Json::objectValue);
+		int ii = 0;
+		for (const auto &value : svValues)
+		{
+			root["result"][ii]["Data"] = value;
+			root["result"][ii]["Level"] = ii;
+			root["result"][ii]["On"] = ((ii % 2) == 0);
+			ii++;
+		}
+
+		std::string szStream;
+		CJSonStreamWriter writer(szStream);
+		writer.BeginObject();
+		writer.Key("empty");
+		writer.BeginObject();
+		writer.EndObject();
+		writer.Key("result");
+		writer.BeginArray();
+		ii = 0;
+		for (const auto &value : svValues)
+		{
+			writer.BeginObject();
+			writer.Member("Data", value);
+			writer.Member("Level", ii);
+			writer.Member("On", ((ii % 2) == 0));
+			writer.EndObject();
+			ii++;
+		}
+		writer.EndArray();
+		writer.Member("status", "OK");
+		writer.Member("title", "StreamWriter");
+		writer.EndObject();
+		writer.Finish();
+
+		bSuccess = (szStream == root.toStyledString());
+		szOutput = (bSuccess) ? "identical" : szStream;
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	return bSuccess;
+}
+
+/* **********
+BlocklyRule.cpp
+********** */
+// The text of an operand as it appears in a condition, used as the key of the test values
+std::string blockly_operand_key(const CBlocklyRule::_tOperand &operand)
+{
+	static const std::map<CBlocklyRule::_eOperandType, std::string> tables = {
+		{ CBlocklyRule::OPERAND_DEVICE, "device" },
+		{ CBlocklyRule::OPERAND_VARIABLE, "variable" },
+		{ CBlocklyRule::OPERAND_TEMPERATURE, "temperaturedevice" },
+		{ CBlocklyRule::OPERAND_HUMIDITY, "humiditydevice" },
+		{ CBlocklyRule::OPERAND_UTILITY, "utilitydevice" },
+		{ CBlocklyRule::OPERAND_TIMEOFDAY, "timeofday" },
+		{ CBlocklyRule::OPERAND_WEEKDAY, "weekday" },
+		{ CBlocklyRule::OPERAND_SECURITYSTATUS, "securitystatus" },
+		{ CBlocklyRule::OPERAND_SUNRISE, "@Sunrise" },
+		{ CBlocklyRule::OPERAND_SUNSET, "@Sunset" },
+	};
+	auto itt = tables.find(operand.type);
+	if (itt == tables.end())
+		return "?";
+	if (operand.type < CBlocklyRule::OPERAND_TIMEOFDAY)
+		return itt->second + "[" + std::to_string(operand.id) + "]";
+	return itt->second;
+}
+
+bool blockly_tester(const std::string szFunction, std::string &szInput, std::string &szOutput)
+{
+	bool bSuccess = false;
+
+	std::vector<std::string> svInputs;
+	StringSplit(szInput, INPUTSEPERATOR, svInputs);
+
+	CBlocklyRule rule;
+	bool bCompiled = (!svInputs.empty()) && rule.Compile(svInputs[0]);
+
+	// Compile, native when the condition is evaluated without Lua
+	if (szFunction == "Compile")
+	{
+		szOutput = (bCompiled) ? "native" : "lua";
+		bSuccess = true;
+	}
+	// Dependencies, the devices and variables (up to 100) the rule is selected for
+	else if (szFunction == "Dependencies")
+	{
+		if (!bCompiled)
+		{
+			szOutput = "not compiled";
+			return false;
+		}
+		std::string szDevices, szVariables;
+		for (uint64_t id = 0; id < 100; id++)
+		{
+			if (rule.DependsOnDevice(id))
+				szDevices += ((szDevices.empty()) ? "" : ",") + std::to_string(id);
+			if (rule.DependsOnVariable(id))
+				szVariables += ((szVariables.empty()) ? "" : ",") + std::to_string(id);
+		}
+		szOutput = "devices=" + szDevices + " variables=" + szVariables;
+		szOutput += std::string(" time=") + ((rule.DependsOnTime()) ? "yes" : "no");
+		szOutput += std::string(" security=") + ((rule.DependsOnSecurity()) ? "yes" : "no");
+		bSuccess = true;
+	}
+	// Evaluate, the values are operand=value pairs separated by ';'. A quoted value is a string,
+	// other values are numbers when they parse as one. Operands without a value are nil
+	else if (szFunction == "Evaluate")
+	{
+		if (!bCompiled)
+		{
+			szOutput = "not compiled";
+			return false;
+		}
+		std::map<std::string, CBlocklyRule::_tValue> values;
+		std::vector<std::string> svValues;
+		if (svInputs.size() > 1)
+			StringSplit(svInputs[1], ";", svValues);
+		for (const auto &sValue : svValues)
+		{
+			size_t pos = sValue.find('=');
+			if (pos == std::string::npos)
+				continue;
+			CBlocklyRule::_tValue &value = values[sValue.substr(0, pos)];
+			std::string szValue = sValue.substr(pos + 1);
+			char *pEnd = nullptr;
+			double number = strtod(szValue.c_str(), &pEnd);
+			if ((szValue.size() >= 2) && (szValue.front() == '\'') && (szValue.back() == '\''))
+			{
+				value.type = CBlocklyRule::_tValue::VALUE_STRING;
+				value.text = szValue.substr(1, szValue.size() - 2);
+			}
+			else if ((!szValue.empty()) && (*pEnd == 0))
+			{
+				value.type = CBlocklyRule::_tValue::VALUE_NUMBER;
+				value.number = number;
+			}
+			else
+			{
+				value.type = CBlocklyRule::_tValue::VALUE_STRING;
+				value.text = szValue;
+			}
+		}
+		std::string szError;
+		bool bResult = rule.Evaluate(
+			[&values](const CBlocklyRule::_tOperand &operand, CBlocklyRule::_tValue &value) {
+				auto itt = values.find(blockly_operand_key(operand));
+				if (itt != values.end())
+					value = itt->second;
+			},
+			szError);
+		if (!szError.empty())
+		{
+			szOutput = szError;
+			return false;
+		}
+		szOutput = (bResult) ? "true" : "false";
+		bSuccess = true;
+	}
+	else
+	{
+		szOutput = "NOT FOUND!";
+	}
+	return bSuccess;
+}
+
 /* **********
 Main function
 ********** */
@@ -295,21 +620,22 @@ int main(int argc, char**argv)
 	if (!bQuiet)
 		Log("Domoticztester testing function %s of Module %s with input: .%s.", szTestFunction.c_str(), szTestModule.c_str(), szTestInput.c_str());
 
+	tester_function pTester = nullptr;
 	if (szTestModule == "helper")
 	{
-		try
-		{
-			bSuccess = helper_tester(szTestFunction, szTestInput, szTestOutput);
-		}
-		catch(const std::exception& e)
-		{
-			Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
-			return 1;
-		}
+		pTester = helper_tester;
+	}
+	else if (szTestModule == "p1meter")
+	{
+		pTester = p1meter_tester;
+	}
+	else if (szTestModule == "json")
+	{
+		pTester = json_tester;
 	}
-	else if (false)
+	else if (szTestModule == "blockly")
 	{
-		/* code */
+		pTester = blockly_tester;
 	}
 	else
 	{
@@ -317,6 +643,25 @@ int main(int argc, char**argv)
 		return 1;
 	}
 
+	try
+	{
+		bSuccess = pTester(szTestFunction, szTestInput, szTestOutput);
+		if (bMeasure && bSuccess)
+		{
+			std::string szMeasureOutput;
+			auto tStart = std::chrono::steady_clock::now();
+			for (int i = 0; i < MEASURE_RUNS; i++)
+				pTester(szTestFunction, szTestInput, szMeasureOutput);
+			auto tElapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count();
+			Log("Measure : %s (%s) | %d runs, %.3f us per run", szTestFunction.c_str(), szTestModule.c_str(), MEASURE_RUNS, (tElapsed / 1000.0) / MEASURE_RUNS);
+		}
+	}
+	catch(const std::exception& e)
+	{
+		Log("Executing : %s (%s) | Crashed! (%s)", szTestFunction.c_str(), szTestModule.c_str(), e.what());
+		return 1;
+	}
+
 	std::stringstream sstr;
 	sstr << "Executing : " << szTestFunction << " (" << szTestModule << ") | ";
 	if (bSuccess)
@@ -12,6 +12,8 @@
 #include "dzVents.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <set>
+#include <sys/stat.h>
 #include "../webserver/Base64.h"
 
 extern "C" {
@@ -29,10 +31,94 @@ extern http::server::ssl_server_settings secure_webserver_settings;
 
 CdzVents CdzVents::m_dzvents;
 
+namespace
+{
+	constexpr const char *dzVentsPatchTable = "domoticzDataPatch";
+
+	template <typename T> void HashCombine(size_t &seed, const T &value)
+	{
+		seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+
+	size_t HashDevice(const CEventSystem::_tDeviceStatus &sitem)
+	{
+		size_t seed = 0;
+		HashCombine(seed, sitem.deviceName);
+		HashCombine(seed, sitem.protection);
+		HashCombine(seed, sitem.customImage);
+		HashCombine(seed, sitem.image);
+		HashCombine(seed, sitem.devType);
+		HashCombine(seed, sitem.subType);
+		HashCombine(seed, sitem.switchtype);
+		HashCombine(seed, sitem.lastUpdate);
+		HashCombine(seed, sitem.lastLevel);
+		HashCombine(seed, sitem.sValue);
+		HashCombine(seed, sitem.deviceID);
+		HashCombine(seed, sitem.description);
+		HashCombine(seed, sitem.batteryLevel);
+		HashCombine(seed, sitem.signalLevel);
+		HashCombine(seed, sitem.nValueWording);
+		HashCombine(seed, sitem.nValue);
+		HashCombine(seed, sitem.hardwareID);
+		for (const auto &item : sitem.JsonMapString)
+		{
+			HashCombine(seed, item.first);
+			HashCombine(seed, item.second);
+		}
+		for (const auto &item : sitem.JsonMapFloat)
+		{
+			HashCombine(seed, item.first);
+			HashCombine(seed, item.second);
+		}
+		for (const auto &item : sitem.JsonMapInt)
+		{
+			HashCombine(seed, item.first);
+			HashCombine(seed, item.second);
+		}
+		for (const auto &item : sitem.JsonMapBool)
+		{
+			HashCombine(seed, item.first);
+			HashCombine(seed, item.second);
+		}
+		return seed;
+	}
+
+	size_t HashSceneGroup(const CEventSystem::_tScenesGroups &sgitem)
+	{
+		size_t seed = 0;
+		HashCombine(seed, sgitem.scenesgroupName);
+		HashCombine(seed, sgitem.scenesgroupValue);
+		HashCombine(seed, sgitem.scenesgroupType);
+		HashCombine(seed, sgitem.protection);
+		HashCombine(seed, sgitem.lastUpdate);
+		HashCombine(seed, sgitem.description);
+		for (const auto &id : sgitem.memberID)
+			HashCombine(seed, id);
+		return seed;
+	}
+
+	size_t HashUserVariable(const CEventSystem::_tUserVariable &uvitem)
+	{
+		size_t seed = 0;
+		HashCombine(seed, uvitem.variableName);
+		HashCombine(seed, uvitem.variableValue);
+		HashCombine(seed, uvitem.variableType);
+		HashCombine(seed, uvitem.lastUpdate);
+		return seed;
+	}
+} // namespace
+
 CdzVents::CdzVents()
 	: m_version("3.1.8")
 {
 	m_bdzVentsExist = false;
+	m_runtimeRef = LUA_NOREF;
+}
+
+CdzVents::~CdzVents()
+{
+	if ((m_luaState != nullptr) && (!m_bStateBusy))
+		lua_close(m_luaState);
 }
 
 std::string CdzVents::GetVersion()
@@ -40,13 +126,144 @@ std::string CdzVents::GetVersion()
 	return m_version;
 }
 
-void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus)
+lua_State *CdzVents::AcquireLuaState()
+{
+	std::lock_guard<std::mutex> l(m_stateMutex);
+
+	// user scripts and modules are cached by require, so any change on disk means starting over
+	size_t signature = ScriptsSignature();
+	if (m_bReloadState.exchange(false) || (signature != m_scriptsSignature))
+	{
+		if (m_luaState != nullptr)
+		{
+			_log.Log(LOG_STATUS, "dzVents: Scripts changed, reloading runtime");
+			lua_close(m_luaState);
+			m_luaState = nullptr;
+		}
+		m_scriptsSignature = signature;
+	}
+	if (m_luaState != nullptr)
+		m_bStateBusy = true;
+	return m_luaState;
+}
+
+void CdzVents::AdoptLuaState(lua_State *lua_state)
 {
 	// reroute print library to Domoticz logger
 	luaL_openlibs(lua_state);
 	lua_pushcfunction(lua_state, l_domoticz_print);
 	lua_setglobal(lua_state, "print");
 
+	// the runtime prepends its search paths to package.path on every run, remember the pristine one
+	lua_getglobal(lua_state, "package");
+	lua_getfield(lua_state, -1, "path");
+	const char *path = lua_tostring(lua_state, -1);
+	std::string packagePath = (path != nullptr) ? path : "";
+	lua_pop(lua_state, 2);
+
+	std::lock_guard<std::mutex> l(m_stateMutex);
+	m_packagePath = packagePath;
+	m_luaState = lua_state;
+	m_bStateBusy = true;
+	m_runtimeRef = LUA_NOREF;
+	ResetDataCache();
+}
+
+int CdzVents::LoadRuntime(lua_State *lua_state, const std::string &filename)
+{
+	lua_getglobal(lua_state, "package");
+	lua_pushstring(lua_state, m_packagePath.c_str());
+	lua_setfield(lua_state, -2, "path");
+	lua_pop(lua_state, 1);
+
+	// Keep the compiled runtime chunk in the registry instead of parsing dzVents.lua for every trigger
+	if (m_runtimeRef == LUA_NOREF)
+	{
+		int status = luaL_loadfile(lua_state, filename.c_str());
+		if (status != 0)
+			return status;
+		m_runtimeRef = luaL_ref(lua_state, LUA_REGISTRYINDEX);
+	}
+	lua_rawgeti(lua_state, LUA_REGISTRYINDEX, m_runtimeRef);
+	return 0;
+}
+
+void CdzVents::ReleaseLuaState(lua_State *lua_state, const int status)
+{
+	std::lock_guard<std::mutex> l(m_stateMutex);
+	lua_settop(lua_state, 0);
+	if (lua_state != m_luaState)
+	{
+		// detached after a timeout, nobody else refers to it anymore
+		lua_close(lua_state);
+		return;
+	}
+	m_bStateBusy = false;
+	if (status != 0)
+	{
+		// a failing runtime may have left the framework half initialised
+		lua_close(m_luaState);
+		m_luaState = nullptr;
+	}
+	else
+		lua_gc(lua_state, LUA_GCSTEP, 0);
+}
+
+void CdzVents::DetachLuaState(lua_State *lua_state)
+{
+	std::lock_guard<std::mutex> l(m_stateMutex);
+	// Still running after the timeout: hand the state over to the Lua thread, which closes it when it returns
+	if ((lua_state == m_luaState) && (m_bStateBusy))
+	{
+		m_luaState = nullptr;
+		m_bStateBusy = false;
+	}
+}
+
+void CdzVents::RequestReload()
+{
+	m_bReloadState = true;
+}
+
+size_t CdzVents::ScriptsSignature()
+{
+#ifdef WIN32
+	const std::string sep = "\\";
+#else
+	const std::string sep = "/";
+#endif
+	// m_scriptsDir is <userdata>/scripts/dzVents/scripts/, the generated (web editor) scripts live next to it
+	std::string baseDir = m_scriptsDir.substr(0, m_scriptsDir.size() - strlen("scripts") - 1);
+	const std::string dirs[] = { m_scriptsDir, m_scriptsDir + "modules" + sep, baseDir + "generated_scripts" + sep };
+
+	size_t seed = 0;
+	for (const auto &dir : dirs)
+	{
+		std::vector<std::string> FileEntries;
+		DirectoryListing(FileEntries, dir, false, true);
+		for (const auto &file : FileEntries)
+		{
+			struct stat st;
+			if (stat((dir + file).c_str(), &st) != 0)
+				continue;
+			HashCombine(seed, file);
+			HashCombine(seed, (int64_t)st.st_mtime);
+			HashCombine(seed, (int64_t)st.st_size);
+		}
+	}
+	return seed;
+}
+
+void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus)
+{
+	// these are only published when their trigger is in the batch, do not leak them into the next run
+	static const char *eventGlobals[] = { "httpresponse", "shellcommandresponse", "securityupdates", "notification", "commandArray" };
+	for (const auto &name : eventGlobals)
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, name);
+	}
+
 	bool reasonTime = false;
 	bool reasonURL = false;
 	bool reasonShellCommand = false;
@@ -854,306 +1071,438 @@ void CdzVents::ExportHardwareData(CLuaTable &luaTable, int& index, const std::ve
 	;// to be implemented when hardware notification support is added
 }
 
-void CdzVents::ExportDomoticzDataToLua(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items)
+void CdzVents::ResetDataCache()
 {
-	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_mainworker.m_eventsystem.m_devicestatesMutex);
-	int index = 1;
-	time_t now = mytime(nullptr);
-	struct tm tm1;
-	localtime_r(&now, &tm1);
-	struct tm tLastUpdate;
-	localtime_r(&now, &tLastUpdate);
-	int SensorTimeOut = 60;
-	m_sql.GetPreferencesVar("SensorTimeout", SensorTimeOut);
+	m_dataEntries.clear();
+	m_dataSlots.clear();
+	m_dataFlags.clear();
+}
 
-	struct tm ntime;
-	time_t checktime;
+bool CdzVents::TrackDataEntry(const _tDataKey &key, const size_t hash, const bool changed, const std::string *lastUpdate, int &slot, bool &timedOut)
+{
+	_tDataEntry &entry = m_dataEntries[key];
+	bool bRewrite = (entry.slot == 0) || (entry.hash != hash);
+	if (entry.slot == 0)
+	{
+		m_dataSlots.push_back(key);
+		entry.slot = (int)m_dataSlots.size();
+	}
+	slot = entry.slot;
+	entry.generation = m_dataGeneration;
 
-	CLuaTable luaTable(lua_state, "domoticzData");
+	timedOut = false;
+	if (lastUpdate != nullptr)
+	{
+		if (bRewrite)
+		{
+			struct tm ntime;
+			ParseSQLdatetime(entry.lastUpdate, ntime, *lastUpdate, m_dataIsDst);
+		}
+		timedOut = (m_dataNow - entry.lastUpdate >= m_dataTimeOut);
+	}
 
-	// First export all the devices.
-	for (const auto &state : m_mainworker.m_eventsystem.m_devicestates)
+	if (!bRewrite)
 	{
-		CEventSystem::_tDeviceStatus sitem = state.second;
-		const char *dev_type = RFX_Type_Desc(sitem.devType, 1);
-		const char *sub_type = RFX_Type_SubType_Desc(sitem.devType, sitem.subType);
+		// unchanged entry, only the flags that depend on this run may need a touch
+		if (entry.changed != changed)
+			m_dataFlags.push_back({ slot, "changed", changed });
+		if ((lastUpdate != nullptr) && (entry.timedOut != timedOut))
+			m_dataFlags.push_back({ slot, "timedOut", timedOut });
+	}
+	entry.hash = hash;
+	entry.changed = changed;
+	entry.timedOut = timedOut;
+	return bRewrite;
+}
 
-		bool triggerDevice = false;
-		for (const auto &item : items)
+void CdzVents::ApplyDataPatch(lua_State *lua_state)
+{
+	lua_getglobal(lua_state, "domoticzData");
+	int dataIndex = lua_gettop(lua_state);
+
+	// copy the rebuilt entries over
+	lua_getglobal(lua_state, dzVentsPatchTable);
+	int patchIndex = lua_gettop(lua_state);
+	lua_pushnil(lua_state);
+	while (lua_next(lua_state, patchIndex) != 0)
+	{
+		lua_pushvalue(lua_state, -2);
+		lua_insert(lua_state, -2);
+		lua_rawset(lua_state, dataIndex);
+	}
+	lua_pop(lua_state, 1);
+	lua_pushnil(lua_state);
+	lua_setglobal(lua_state, dzVentsPatchTable);
+
+	for (const auto &flag : m_dataFlags)
+	{
+		lua_rawgeti(lua_state, dataIndex, flag.slot);
+		lua_pushboolean(lua_state, flag.value);
+		lua_setfield(lua_state, -2, flag.name);
+		lua_pop(lua_state, 1);
+	}
+	m_dataFlags.clear();
+
+	// Drop the entries that were not seen in this run. dzVents walks the array with ipairs so keep it
+	// contiguous by moving the last entry into the hole.
+	std::set<int> stale;
+	for (auto itt = m_dataEntries.begin(); itt != m_dataEntries.end();)
+	{
+		if (itt->second.generation != m_dataGeneration)
 		{
-			if (sitem.ID > 0 && sitem.ID == item.id && item.reason == m_mainworker.m_eventsystem.REASON_DEVICE)
-			{
-				triggerDevice = true;
-				sitem.lastUpdate = item.lastUpdate;
-				sitem.lastLevel = item.lastLevel;
-				sitem.sValue = item.sValue;
-				sitem.nValueWording = item.nValueWording;
-				sitem.nValue = item.nValue;
-				if (!item.JsonMapString.empty())
-					sitem.JsonMapString = item.JsonMapString;
-				if (!item.JsonMapFloat.empty())
-					sitem.JsonMapFloat = item.JsonMapFloat;
-				if (!item.JsonMapInt.empty())
-					sitem.JsonMapInt = item.JsonMapInt;
-				if (!item.JsonMapBool.empty())
-					sitem.JsonMapBool = item.JsonMapBool;
-			}
+			stale.insert(itt->second.slot);
+			itt = m_dataEntries.erase(itt);
 		}
-
-		ParseSQLdatetime(checktime, ntime, sitem.lastUpdate, tm1.tm_isdst);
-		bool timed_out = (now - checktime >= SensorTimeOut * 60);
-		if (sitem.ID > 0)
+		else
+			++itt;
+	}
+	while (!stale.empty())
+	{
+		int last = (int)m_dataSlots.size();
+		if (stale.find(last) == stale.end())
 		{
-			luaTable.OpenSubTableEntry(index, 1, 14);
-
-			luaTable.AddString("name", sitem.deviceName);
-			luaTable.AddBool("protected", (sitem.protection == 1) );
-			luaTable.AddInteger("id", sitem.ID);
-			luaTable.AddInteger("iconNumber", sitem.customImage);
-			luaTable.AddString("image", sitem.image);
-			luaTable.AddString("baseType","device");
-			luaTable.AddString("deviceType", dev_type);
-			luaTable.AddString("subType", sub_type);
-			luaTable.AddString("switchType", Switch_Type_Desc((_eSwitchType)sitem.switchtype));
-			luaTable.AddInteger("switchTypeValue", sitem.switchtype);
-			luaTable.AddString("lastUpdate", sitem.lastUpdate);
-			luaTable.AddInteger("lastLevel", sitem.lastLevel);
-			luaTable.AddBool("changed", triggerDevice);
-			luaTable.AddBool("timedOut", timed_out);
-
-			//get all svalues separate
-			std::vector<std::string> strarray;
-			StringSplit(sitem.sValue, ";", strarray);
-
-			luaTable.OpenSubTableEntry("rawData", 0, 0);
-			for (size_t i = 0; i < strarray.size(); i++)
-				luaTable.AddString(i + 1, strarray[i]);
+			int hole = *stale.begin();
+			lua_rawgeti(lua_state, dataIndex, last);
+			lua_rawseti(lua_state, dataIndex, hole);
+			m_dataSlots[hole - 1] = m_dataSlots[last - 1];
+			m_dataEntries[m_dataSlots[hole - 1]].slot = hole;
+			stale.erase(hole);
+		}
+		else
+			stale.erase(last);
+		lua_pushnil(lua_state);
+		lua_rawseti(lua_state, dataIndex, last);
+		m_dataSlots.pop_back();
+	}
+	lua_pop(lua_state, 1);
+}
 
-			luaTable.CloseSubTableEntry();
+void CdzVents::ExportDevice(CLuaTable &luaTable, const int slot, const CEventSystem::_tDeviceStatus &sitem, const bool changed, const bool timedOut)
+{
+	luaTable.OpenSubTableEntry(slot, 1, 14);
+
+	luaTable.AddString("name", sitem.deviceName);
+	luaTable.AddBool("protected", (sitem.protection == 1) );
+	luaTable.AddInteger("id", sitem.ID);
+	luaTable.AddInteger("iconNumber", sitem.customImage);
+	luaTable.AddString("image", sitem.image);
+	luaTable.AddString("baseType","device");
+	luaTable.AddString("deviceType", RFX_Type_Desc(sitem.devType, 1));
+	luaTable.AddString("subType", RFX_Type_SubType_Desc(sitem.devType, sitem.subType));
+	luaTable.AddString("switchType", Switch_Type_Desc((_eSwitchType)sitem.switchtype));
+	luaTable.AddInteger("switchTypeValue", sitem.switchtype);
+	luaTable.AddString("lastUpdate", sitem.lastUpdate);
+	luaTable.AddInteger("lastLevel", sitem.lastLevel);
+	luaTable.AddBool("changed", changed);
+	luaTable.AddBool("timedOut", timedOut);
+
+	//get all svalues separate
+	std::vector<std::string> strarray;
+	StringSplit(sitem.sValue, ";", strarray);
 
-			luaTable.AddString("deviceID", sitem.deviceID);
-			luaTable.AddString("description", sitem.description);
-			luaTable.AddInteger("batteryLevel", sitem.batteryLevel);
-			luaTable.AddInteger("signalLevel", sitem.signalLevel);
+	luaTable.OpenSubTableEntry("rawData", 0, 0);
+	for (size_t i = 0; i < strarray.size(); i++)
+		luaTable.AddString(i + 1, strarray[i]);
 
-			luaTable.OpenSubTableEntry("data", 0, 0);
-			luaTable.AddString("_state", sitem.nValueWording);
-			luaTable.AddInteger("_nValue", sitem.nValue);
-			luaTable.AddInteger("hardwareID", sitem.hardwareID);
-			if (sitem.devType == pTypeGeneral && sitem.subType == sTypeKwh)
-			{
-				long double value = 0.0F;
-				if (strarray.size() > 1)
-					value = atof(strarray[1].c_str());
-				luaTable.AddNumber("whTotal", value);
-				value = 0.0F;
-				if (!strarray.empty())
-					value = atof(strarray[0].c_str());
-				luaTable.AddNumber("whActual", value);
-			}
+	luaTable.CloseSubTableEntry();
 
-			// Now see if we have additional fields from the JSON data
-			if (!sitem.JsonMapString.empty())
-			{
-				for (const auto &item : sitem.JsonMapString)
-				{
-					if (strcmp(m_mainworker.m_eventsystem.JsonMap[item.first].szOriginal, "LevelNames") == 0
-					    || strcmp(m_mainworker.m_eventsystem.JsonMap[item.first].szOriginal, "LevelActions") == 0)
-						luaTable.AddString(m_mainworker.m_eventsystem.JsonMap[item.first].szNew,
-								   base64_decode(item.second));
-					else
-						luaTable.AddString(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-				}
-			}
+	luaTable.AddString("deviceID", sitem.deviceID);
+	luaTable.AddString("description", sitem.description);
+	luaTable.AddInteger("batteryLevel", sitem.batteryLevel);
+	luaTable.AddInteger("signalLevel", sitem.signalLevel);
 
-			if (!sitem.JsonMapFloat.empty())
-			{
-				for (const auto &item : sitem.JsonMapFloat)
-					luaTable.AddNumber(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-			}
+	luaTable.OpenSubTableEntry("data", 0, 0);
+	luaTable.AddString("_state", sitem.nValueWording);
+	luaTable.AddInteger("_nValue", sitem.nValue);
+	luaTable.AddInteger("hardwareID", sitem.hardwareID);
+	if (sitem.devType == pTypeGeneral && sitem.subType == sTypeKwh)
+	{
+		long double value = 0.0F;
+		if (strarray.size() > 1)
+			value = atof(strarray[1].c_str());
+		luaTable.AddNumber("whTotal", value);
+		value = 0.0F;
+		if (!strarray.empty())
+			value = atof(strarray[0].c_str());
+		luaTable.AddNumber("whActual", value);
+	}
 
-			if (!sitem.JsonMapInt.empty())
-			{
-				for (const auto &item : sitem.JsonMapInt)
-					luaTable.AddInteger(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-			}
+	// Now see if we have additional fields from the JSON data
+	if (!sitem.JsonMapString.empty())
+	{
+		for (const auto &item : sitem.JsonMapString)
+		{
+			if (strcmp(m_mainworker.m_eventsystem.JsonMap[item.first].szOriginal, "LevelNames") == 0
+			    || strcmp(m_mainworker.m_eventsystem.JsonMap[item.first].szOriginal, "LevelActions") == 0)
+				luaTable.AddString(m_mainworker.m_eventsystem.JsonMap[item.first].szNew,
+						   base64_decode(item.second));
+			else
+				luaTable.AddString(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
+		}
+	}
 
-			if (!sitem.JsonMapBool.empty())
-			{
-				for (const auto &item : sitem.JsonMapBool)
-					luaTable.AddBool(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
-			}
+	if (!sitem.JsonMapFloat.empty())
+	{
+		for (const auto &item : sitem.JsonMapFloat)
+			luaTable.AddNumber(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
+	}
 
-			luaTable.CloseSubTableEntry();
-			luaTable.CloseSubTableEntry();
-			index++;
-		}
+	if (!sitem.JsonMapInt.empty())
+	{
+		for (const auto &item : sitem.JsonMapInt)
+			luaTable.AddInteger(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
 	}
 
-	devicestatesMutexLock.unlock();
+	if (!sitem.JsonMapBool.empty())
+	{
+		for (const auto &item : sitem.JsonMapBool)
+			luaTable.AddBool(m_mainworker.m_eventsystem.JsonMap[item.first].szNew, item.second);
+	}
 
-	// Now do the scenes and groups.
-	boost::shared_lock<boost::shared_mutex> scenesgroupsMutexLock(m_mainworker.m_eventsystem.m_scenesgroupsMutex);
+	luaTable.CloseSubTableEntry();
+	luaTable.CloseSubTableEntry();
+}
 
-	std::vector<std::vector<std::string> > result;
+void CdzVents::ExportSceneGroup(CLuaTable &luaTable, const int slot, const CEventSystem::_tScenesGroups &sgitem, const bool changed)
+{
+	luaTable.OpenSubTableEntry(slot, 1, 7);
 
-	for (const auto &scene : m_mainworker.m_eventsystem.m_scenesgroups)
+	luaTable.AddString("name", sgitem.scenesgroupName);
+	luaTable.AddInteger("id", sgitem.ID);
+	luaTable.AddString("description", sgitem.description);
+	luaTable.AddString("baseType", (sgitem.scenesgroupType == 0) ? "scene" : "group");
+	luaTable.AddBool("protected", (lua_Number)sgitem.protection == 1);
+	luaTable.AddString("lastUpdate", sgitem.lastUpdate);
+	luaTable.AddBool("changed", changed);
+
+	luaTable.OpenSubTableEntry("data", 0, 0);
+
+	luaTable.AddString("_state", sgitem.scenesgroupValue);
+
+	luaTable.CloseSubTableEntry();
+
+	luaTable.OpenSubTableEntry("deviceIDs", 0, 0);
+	if (!sgitem.memberID.empty())
 	{
-		CEventSystem::_tScenesGroups sgitem = scene.second;
-		bool triggerScene = false;
-		for (const auto &item : items)
+		int index = 1;
+		for (const auto &id : sgitem.memberID)
 		{
-			if (sgitem.ID == item.id && item.reason == m_mainworker.m_eventsystem.REASON_SCENEGROUP)
-			{
-				triggerScene = true;
-				sgitem.lastUpdate = item.lastUpdate;
-				sgitem.scenesgroupValue = item.sValue;
-			}
+			luaTable.AddInteger(index, id);
+			index++;
 		}
+	}
 
-		luaTable.OpenSubTableEntry(index, 1, 7);
+	luaTable.CloseSubTableEntry(); // device table
+	luaTable.CloseSubTableEntry(); // end entry
+}
 
-		luaTable.AddString("name", sgitem.scenesgroupName);
-		luaTable.AddInteger("id", sgitem.ID);
-		luaTable.AddString("description", sgitem.description);
-		luaTable.AddString("baseType", (sgitem.scenesgroupType == 0) ? "scene" : "group");
-		luaTable.AddBool("protected", (lua_Number)sgitem.protection == 1);
-		luaTable.AddString("lastUpdate", sgitem.lastUpdate);
-		luaTable.AddBool("changed", triggerScene);
+void CdzVents::ExportUserVariable(CLuaTable &luaTable, const int slot, const CEventSystem::_tUserVariable &uvitem, const bool changed)
+{
+	std::string vtype;
 
-		luaTable.OpenSubTableEntry("data", 0, 0);
+	luaTable.OpenSubTableEntry(slot, 1, 5);
 
-		luaTable.AddString("_state", sgitem.scenesgroupValue);
+	luaTable.AddString("name", uvitem.variableName);
+	luaTable.AddInteger("id", uvitem.ID);
+	luaTable.AddString("baseType", "uservariable");
+	luaTable.AddString("lastUpdate", uvitem.lastUpdate);
+	luaTable.AddBool("changed", changed);
 
-		luaTable.CloseSubTableEntry();
+	luaTable.OpenSubTableEntry("data", 0, 0);
 
-		luaTable.OpenSubTableEntry("deviceIDs", 0, 0);
-		if (!sgitem.memberID.empty())
-		{
-			int index = 1;
-			for (const auto &id : sgitem.memberID)
-			{
-				luaTable.AddInteger(index, id);
-				index++;
-			}
-		}
-
-		luaTable.CloseSubTableEntry(); // device table
-		luaTable.CloseSubTableEntry(); // end entry
-		index++;
+	if (uvitem.variableType == 0)
+	{
+		luaTable.AddInteger("value", atoi(uvitem.variableValue.c_str()));
+		vtype = "integer";
+	}
+	else if (uvitem.variableType == 1)
+	{
+		//Float
+		luaTable.AddNumber("value", atof(uvitem.variableValue.c_str()));
+		vtype = "float";
+	}
+	else
+	{
+		//String,Date,Time
+		luaTable.AddString("value", uvitem.variableValue);
+		if (uvitem.variableType == 2)
+			vtype = "string";
+		else if (uvitem.variableType == 3)
+			vtype = "date";
+		else if (uvitem.variableType == 4)
+			vtype = "time";
+		else
+			vtype = "unknown";
 	}
-	scenesgroupsMutexLock.unlock();
 
-	std::string vtype;
+	luaTable.CloseSubTableEntry(); // data table
 
-	// Now do the user variables.
-	boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(m_mainworker.m_eventsystem.m_uservariablesMutex);
-	for (const auto &var : m_mainworker.m_eventsystem.m_uservariables)
+	luaTable.AddString("variableType", vtype);
+
+	luaTable.CloseSubTableEntry(); // end entry
+}
+
+void CdzVents::ExportDomoticzDataToLua(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items)
+{
+	// domoticzData survives between runs in the persistent state. Only entries whose content changed since
+	// the previous run are rebuilt (in a patch table that is merged afterwards), the others just get their
+	// changed/timedOut flags corrected.
+	lua_getglobal(lua_state, "domoticzData");
+	if (!lua_istable(lua_state, -1))
 	{
-		CEventSystem::_tUserVariable uvitem = var.second;
-		bool triggerVar = false;
-		for (const auto &item : items)
-		{
-			if (uvitem.ID == item.id && item.reason == m_mainworker.m_eventsystem.REASON_USERVARIABLE)
-			{
-				triggerVar = true;
-				uvitem.lastUpdate = item.lastUpdate;
-				uvitem.variableValue = item.sValue;
-			}
-		}
+		lua_newtable(lua_state);
+		lua_setglobal(lua_state, "domoticzData");
+		ResetDataCache();
+	}
+	lua_pop(lua_state, 1);
 
-		luaTable.OpenSubTableEntry(index, 1, 5);
+	m_dataGeneration++;
+	m_dataNow = mytime(nullptr);
+	struct tm tm1;
+	localtime_r(&m_dataNow, &tm1);
+	m_dataIsDst = tm1.tm_isdst;
+	int SensorTimeOut = 60;
+	m_sql.GetPreferencesVar("SensorTimeout", SensorTimeOut);
+	m_dataTimeOut = SensorTimeOut * 60;
 
-		luaTable.AddString("name", uvitem.variableName);
-		luaTable.AddInteger("id", uvitem.ID);
-		luaTable.AddString("baseType", "uservariable");
-		luaTable.AddString("lastUpdate", uvitem.lastUpdate);
-		luaTable.AddBool("changed", triggerVar);
+	// triggering items by reason and id, later items in the batch win
+	std::map<std::pair<int, uint64_t>, const CEventSystem::_tEventQueue *> triggers;
+	for (const auto &item : items)
+		triggers[std::make_pair((int)item.reason, item.id)] = &item;
 
-		luaTable.OpenSubTableEntry("data", 0, 0);
+	int slot;
+	bool timedOut;
+	CLuaTable luaTable(lua_state, dzVentsPatchTable);
 
-		if (uvitem.variableType == 0)
-		{
-			luaTable.AddInteger("value", atoi(uvitem.variableValue.c_str()));
-			vtype = "integer";
-		}
-		else if (uvitem.variableType == 1)
+	// First export all the devices.
+	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_mainworker.m_eventsystem.m_devicestatesMutex);
+	for (const auto &state : m_mainworker.m_eventsystem.m_devicestates)
+	{
+		const CEventSystem::_tDeviceStatus *pItem = &state.second;
+		if (pItem->ID == 0)
+			continue;
+
+		CEventSystem::_tDeviceStatus sitem;
+		auto itt = triggers.find(std::make_pair((int)CEventSystem::REASON_DEVICE, pItem->ID));
+		bool triggerDevice = (itt != triggers.end());
+		if (triggerDevice)
 		{
-			//Float
-			luaTable.AddNumber("value", atof(uvitem.variableValue.c_str()));
-			vtype = "float";
+			const CEventSystem::_tEventQueue &item = *itt->second;
+			sitem = *pItem;
+			sitem.lastUpdate = item.lastUpdate;
+			sitem.lastLevel = item.lastLevel;
+			sitem.sValue = item.sValue;
+			sitem.nValueWording = item.nValueWording;
+			sitem.nValue = item.nValue;
+			if (!item.JsonMapString.empty())
+				sitem.JsonMapString = item.JsonMapString;
+			if (!item.JsonMapFloat.empty())
+				sitem.JsonMapFloat = item.JsonMapFloat;
+			if (!item.JsonMapInt.empty())
+				sitem.JsonMapInt = item.JsonMapInt;
+			if (!item.JsonMapBool.empty())
+				sitem.JsonMapBool = item.JsonMapBool;
+			pItem = &sitem;
 		}
-		else
+
+		if (TrackDataEntry(std::make_pair(DATA_DEVICE, pItem->ID), HashDevice(*pItem), triggerDevice, &pItem->lastUpdate, slot, timedOut))
+			ExportDevice(luaTable, slot, *pItem, triggerDevice, timedOut);
+	}
+	devicestatesMutexLock.unlock();
+
+	// Now do the scenes and groups.
+	boost::shared_lock<boost::shared_mutex> scenesgroupsMutexLock(m_mainworker.m_eventsystem.m_scenesgroupsMutex);
+	for (const auto &scene : m_mainworker.m_eventsystem.m_scenesgroups)
+	{
+		const CEventSystem::_tScenesGroups *pItem = &scene.second;
+
+		CEventSystem::_tScenesGroups sgitem;
+		auto itt = triggers.find(std::make_pair((int)CEventSystem::REASON_SCENEGROUP, pItem->ID));
+		bool triggerScene = (itt != triggers.end());
+		if (triggerScene)
 		{
-			//String,Date,Time
-			luaTable.AddString("value", uvitem.variableValue);
-			if (uvitem.variableType == 2)
-				vtype = "string";
-			else if (uvitem.variableType == 3)
-				vtype = "date";
-			else if (uvitem.variableType == 4)
-				vtype = "time";
-			else
-				vtype = "unknown";
+			sgitem = *pItem;
+			sgitem.lastUpdate = itt->second->lastUpdate;
+			sgitem.scenesgroupValue = itt->second->sValue;
+			pItem = &sgitem;
 		}
 
-		luaTable.CloseSubTableEntry(); // data table
+		if (TrackDataEntry(std::make_pair(DATA_SCENEGROUP, pItem->ID), HashSceneGroup(*pItem), triggerScene, nullptr, slot, timedOut))
+			ExportSceneGroup(luaTable, slot, *pItem, triggerScene);
+	}
+	scenesgroupsMutexLock.unlock();
 
-		luaTable.AddString("variableType", vtype);
+	// Now do the user variables.
+	boost::shared_lock<boost::shared_mutex> uservariablesMutexLock(m_mainworker.m_eventsystem.m_uservariablesMutex);
+	for (const auto &var : m_mainworker.m_eventsystem.m_uservariables)
+	{
+		const CEventSystem::_tUserVariable *pItem = &var.second;
 
-		luaTable.CloseSubTableEntry(); // end entry
+		CEventSystem::_tUserVariable uvitem;
+		auto itt = triggers.find(std::make_pair((int)CEventSystem::REASON_USERVARIABLE, pItem->ID));
+		bool triggerVar = (itt != triggers.end());
+		if (triggerVar)
+		{
+			uvitem = *pItem;
+			uvitem.lastUpdate = itt->second->lastUpdate;
+			uvitem.variableValue = itt->second->sValue;
+			pItem = &uvitem;
+		}
 
-		index++;
+		if (TrackDataEntry(std::make_pair(DATA_USERVARIABLE, pItem->ID), HashUserVariable(*pItem), triggerVar, nullptr, slot, timedOut))
+			ExportUserVariable(luaTable, slot, *pItem, triggerVar);
 	}
+	uservariablesMutexLock.unlock();
 
 	// Now do the cameras.
+	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query("SELECT ID, Name FROM Cameras where enabled = '1' ORDER BY ID ASC");
-	if (!result.empty())
+	for (const auto &sd : result)
 	{
-		for (const auto &sd : result)
-		{
-			luaTable.OpenSubTableEntry(index, 1, 3);
-			luaTable.AddString("name", sd[1]);
-			luaTable.AddInteger("id", atoi(sd[0].c_str()));
-			luaTable.AddString("baseType", "camera");
-			luaTable.CloseSubTableEntry(); // end entry
-
-			index++;
-		}
+		size_t hash = std::hash<std::string>()(sd[1]);
+		if (!TrackDataEntry(std::make_pair(DATA_CAMERA, std::stoull(sd[0])), hash, false, nullptr, slot, timedOut))
+			continue;
+
+		luaTable.OpenSubTableEntry(slot, 1, 3);
+		luaTable.AddString("name", sd[1]);
+		luaTable.AddInteger("id", atoi(sd[0].c_str()));
+		luaTable.AddString("baseType", "camera");
+		luaTable.CloseSubTableEntry(); // end entry
 	}
 
 	// Now do the Hardware.
 	result = m_sql.safe_query("SELECT ID, Name, type FROM Hardware where enabled = '1' ORDER BY ID ASC");
 	int HardwareTypeVal;
 
-	if (!result.empty())
+	for (const auto &sd : result)
 	{
-		for (const auto &sd : result)
+		size_t hash = std::hash<std::string>()(sd[1] + ";" + sd[2]);
+		if (!TrackDataEntry(std::make_pair(DATA_HARDWARE, std::stoull(sd[0])), hash, false, nullptr, slot, timedOut))
+			continue;
+
+		HardwareTypeVal = atoi(sd[2].c_str());
+
+		luaTable.OpenSubTableEntry(slot, 1, 6);
+		luaTable.AddString("name", sd[1]);
+		luaTable.AddInteger("id", atoi(sd[0].c_str()));
+		luaTable.AddInteger("typeValue", HardwareTypeVal);
+		luaTable.AddString("baseType", "hardware");
+		if (HardwareTypeVal != HTYPE_PythonPlugin)
 		{
-			HardwareTypeVal = atoi(sd[2].c_str());
-
-			luaTable.OpenSubTableEntry(index, 1, 6);
-			luaTable.AddString("name", sd[1]);
-			luaTable.AddInteger("id", atoi(sd[0].c_str()));
-			luaTable.AddInteger("typeValue", HardwareTypeVal);
-			luaTable.AddString("baseType", "hardware");
-			if (HardwareTypeVal != HTYPE_PythonPlugin)
-			{
-				luaTable.AddString("typeName",Hardware_Type_Desc(HardwareTypeVal));
-				luaTable.AddBool("isPythonPlugin", false);
-			}
-			else
-			{
-				luaTable.AddString("typeName", "Python plugin");
-				luaTable.AddBool("isPythonPlugin", true);
-			}
-			luaTable.CloseSubTableEntry(); // end entry
-
-			index++;
+			luaTable.AddString("typeName",Hardware_Type_Desc(HardwareTypeVal));
+			luaTable.AddBool("isPythonPlugin", false);
 		}
+		else
+		{
+			luaTable.AddString("typeName", "Python plugin");
+			luaTable.AddBool("isPythonPlugin", true);
+		}
+		luaTable.CloseSubTableEntry(); // end entry
 	}
 
+	int index = (int)m_dataSlots.size() + 1;
 	ExportHardwareData(luaTable, index, items);
 
 	luaTable.Publish();
+	ApplyDataPatch(lua_state);
 }
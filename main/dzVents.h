@@ -1,12 +1,14 @@
 #pragma once
 #include "EventSystem.h"
 #include "LuaTable.h"
+#include <atomic>
+#include <mutex>
 
 class CdzVents
 {
 public:
   CdzVents();
-  ~CdzVents() = default;
+  ~CdzVents();
   static CdzVents *GetInstance()
   {
 	  return &m_dzvents;
@@ -16,6 +18,16 @@ public:
   bool processLuaCommand(lua_State *lua_state, const std::string &filename, const int tIndex);
   void EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus);
 
+  // The dzVents runtime lives in one long-lived Lua state so the framework and the script modules are loaded once.
+  // dzVents runs are serialized on the event system's script workers, one run owns the state between
+  // AcquireLuaState/AdoptLuaState and the matching ReleaseLuaState.
+  lua_State *AcquireLuaState();
+  void AdoptLuaState(lua_State *lua_state);
+  int LoadRuntime(lua_State *lua_state, const std::string &filename);
+  void ReleaseLuaState(lua_State *lua_state, const int status);
+  void DetachLuaState(lua_State *lua_state);
+  void RequestReload();
+
   std::string m_scriptsDir, m_runtimeDir;
   bool m_bdzVentsExist;
 
@@ -40,6 +52,31 @@ private:
 		std::string sValue;
 	};
 
+	enum _eDataKind
+	{
+		DATA_DEVICE,
+		DATA_SCENEGROUP,
+		DATA_USERVARIABLE,
+		DATA_CAMERA,
+		DATA_HARDWARE
+	};
+	typedef std::pair<int, uint64_t> _tDataKey;
+	struct _tDataEntry
+	{
+		int slot = 0;
+		size_t hash = 0;
+		uint32_t generation = 0;
+		time_t lastUpdate = 0;
+		bool changed = false;
+		bool timedOut = false;
+	};
+	struct _tDataFlag
+	{
+		int slot;
+		const char *name;
+		bool value;
+	};
+
 	float RandomTime(const int randomTime);
 	bool OpenURL(lua_State *lua_state, const std::vector<_tLuaTableValues> &vLuaTable);
 	bool ExecuteShellCommand(lua_State *lua_state, const std::vector<_tLuaTableValues> &vLuaTable);
@@ -50,6 +87,13 @@ private:
 	bool TriggerCustomEvent(lua_State *lua_state, const std::vector<_tLuaTableValues>& vLuaTable);
 	void ExportHardwareData(CLuaTable &luaTable, int& index, const std::vector<CEventSystem::_tEventQueue>& items);
 	void ExportDomoticzDataToLua(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items);
+	void ExportDevice(CLuaTable &luaTable, const int slot, const CEventSystem::_tDeviceStatus &sitem, const bool changed, const bool timedOut);
+	void ExportSceneGroup(CLuaTable &luaTable, const int slot, const CEventSystem::_tScenesGroups &sgitem, const bool changed);
+	void ExportUserVariable(CLuaTable &luaTable, const int slot, const CEventSystem::_tUserVariable &uvitem, const bool changed);
+	bool TrackDataEntry(const _tDataKey &key, const size_t hash, const bool changed, const std::string *lastUpdate, int &slot, bool &timedOut);
+	void ApplyDataPatch(lua_State *lua_state);
+	void ResetDataCache();
+	size_t ScriptsSignature();
 	void IterateTable(lua_State *lua_state, const int tIndex, std::vector<_tLuaTableValues> &vLuaTable);
 	void SetGlobalVariables(lua_State *lua_state, const bool reasonTime, const int secStatus);
 	void ProcessHttpResponse(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items);
@@ -60,4 +104,21 @@ private:
 	static int l_domoticz_print(lua_State* lua_state);
 	static CdzVents m_dzvents;
 	std::string m_version;
+
+	std::mutex m_stateMutex;
+	lua_State *m_luaState = nullptr;
+	bool m_bStateBusy = false;
+	std::atomic<bool> m_bReloadState{ false };
+	int m_runtimeRef;
+	std::string m_packagePath;
+	size_t m_scriptsSignature = 0;
+
+	// Shadow of the domoticzData array in the persistent state, keyed on (kind, id)
+	std::map<_tDataKey, _tDataEntry> m_dataEntries;
+	std::vector<_tDataKey> m_dataSlots;
+	std::vector<_tDataFlag> m_dataFlags;
+	uint32_t m_dataGeneration = 0;
+	time_t m_dataNow = 0;
+	int m_dataIsDst = 0;
+	int m_dataTimeOut = 0;
 };
@@ -52,3 +52,168 @@ bool JSonRenameKey(Json::Value& value, const std::string& srcKey, const std::str
 	value.removeMember(srcKey);
 	return true;
 }
+
+CJSonStreamWriter::CJSonStreamWriter(std::string &output)
+	: m_output(output)
+{
+}
+
+void CJSonStreamWriter::Indent()
+{
+	m_output += '\n';
+	m_output.append(m_levels.size(), '\t');
+}
+
+//Containers start on a line of their own (also after a key), scalars directly after the key
+void CJSonStreamWriter::BeforeValue()
+{
+	if (m_bAfterKey)
+	{
+		m_bAfterKey = false;
+		return;
+	}
+	if (m_levels.empty())
+		return;
+	if (m_levels.back().bHaveMembers)
+		m_output += ',';
+	m_levels.back().bHaveMembers = true;
+	Indent();
+}
+
+void CJSonStreamWriter::Begin(const char cOpen)
+{
+	size_t start;
+	if (m_bAfterKey)
+	{
+		m_bAfterKey = false;
+		start = m_output.size();
+		Indent();
+	}
+	else
+	{
+		BeforeValue();
+		start = m_output.size();
+	}
+	m_output += cOpen;
+	m_levels.push_back({ start, false });
+}
+
+void CJSonStreamWriter::End(const char *szEmpty, const char cClose)
+{
+	_tLevel level = m_levels.back();
+	m_levels.pop_back();
+	if (!level.bHaveMembers)
+	{
+		//empty ones are written inline
+		m_output.erase(level.start);
+		m_output += szEmpty;
+		return;
+	}
+	Indent();
+	m_output += cClose;
+}
+
+void CJSonStreamWriter::BeginObject()
+{
+	Begin('{');
+}
+
+void CJSonStreamWriter::EndObject()
+{
+	End("{}", '}');
+}
+
+void CJSonStreamWriter::BeginArray()
+{
+	Begin('[');
+}
+
+void CJSonStreamWriter::EndArray()
+{
+	End("[]", ']');
+}
+
+void CJSonStreamWriter::Key(const char *szKey)
+{
+	if (m_levels.back().bHaveMembers)
+		m_output += ',';
+	m_levels.back().bHaveMembers = true;
+	Indent();
+	m_output += Json::valueToQuotedString(szKey);
+	m_output += " : ";
+	m_bAfterKey = true;
+}
+
+void CJSonStreamWriter::Value(const std::string &value)
+{
+	BeforeValue();
+	m_output += Json::valueToQuotedString(value.c_str());
+}
+
+void CJSonStreamWriter::Value(const char *value)
+{
+	BeforeValue();
+	m_output += Json::valueToQuotedString(value);
+}
+
+void CJSonStreamWriter::Value(const int value)
+{
+	BeforeValue();
+	m_output += Json::valueToString(static_cast<Json::LargestInt>(value));
+}
+
+void CJSonStreamWriter::Value(const int64_t value)
+{
+	BeforeValue();
+	m_output += Json::valueToString(static_cast<Json::LargestInt>(value));
+}
+
+void CJSonStreamWriter::Value(const double value)
+{
+	BeforeValue();
+	m_output += Json::valueToString(value);
+}
+
+void CJSonStreamWriter::Value(const bool value)
+{
+	BeforeValue();
+	m_output += (value) ? "true" : "false";
+}
+
+void CJSonStreamWriter::Value(const Json::Value &value)
+{
+	std::string text = JSonToFormatString(value);
+	//objects and long arrays start on a line of their own after a key, like Begin(), short arrays are written inline
+	if ((m_bAfterKey) && (text.find('\n') != std::string::npos))
+	{
+		m_bAfterKey = false;
+		Indent();
+	}
+	else
+		BeforeValue();
+	size_t pos = 0;
+	size_t eol;
+	while ((eol = text.find('\n', pos)) != std::string::npos)
+	{
+		m_output.append(text, pos, eol - pos);
+		Indent();
+		pos = eol + 1;
+	}
+	m_output.append(text, pos, std::string::npos);
+}
+
+void CJSonStreamWriter::Finish()
+{
+	m_output += '\n';
+}
+
+void CJSonStreamWriter::TakeOutput(std::string &chunk)
+{
+	size_t length = m_output.size();
+	if ((!m_levels.empty()) && (!m_levels.back().bHaveMembers))
+		length = m_levels.back().start;
+	chunk.append(m_output, 0, length);
+	m_output.erase(0, length);
+	for (auto &level : m_levels)
+		level.start = (level.start > length) ? level.start - length : 0;
+}
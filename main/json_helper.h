@@ -7,3 +7,57 @@ bool ParseJSonStrict(const std::string& inStr, Json::Value& json_output, std::st
 std::string JSonToFormatString(const Json::Value& json_input);
 std::string JSonToRawString(const Json::Value& json_input);
 bool JSonRenameKey(Json::Value& value, const std::string& srcKey, const std::string& destKey);
+
+// Writes JSON directly into a string, in the same layout as JSonToFormatString / Json::Value::toStyledString,
+// so large responses do not need a Json::Value tree first.
+// Object keys have to be written in ascending order (the order Json::Value keeps them in), and arrays are always
+// written one element per line, so only use them for arrays of objects or arrays.
+class CJSonStreamWriter
+{
+      public:
+	explicit CJSonStreamWriter(std::string &output);
+
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+	void Key(const char *szKey);
+
+	void Value(const std::string &value);
+	void Value(const char *value);
+	void Value(int value);
+	void Value(int64_t value);
+	void Value(double value);
+	void Value(bool value);
+	// Writes a whole Json::Value (one row of a result) the way toStyledString would at this position
+	void Value(const Json::Value &value);
+
+	// Shortcut for Key() followed by Value()
+	template <typename T> void Member(const char *szKey, const T &value)
+	{
+		Key(szKey);
+		Value(value);
+	}
+
+	// Adds the line feed that toStyledString ends with
+	void Finish();
+
+	// Moves what has been written so far to the end of chunk, for replies that are sent while they are written.
+	// A container without members stays behind, it is rewritten inline when it ends empty.
+	void TakeOutput(std::string &chunk);
+
+      private:
+	void BeforeValue();
+	void Indent();
+	void Begin(char cOpen);
+	void End(const char *szEmpty, char cClose);
+
+	std::string &m_output;
+	struct _tLevel
+	{
+		size_t start; // where the object/array starts in the output, an empty one is rewritten inline
+		bool bHaveMembers;
+	};
+	std::vector<_tLevel> m_levels;
+	bool m_bAfterKey = false;
+};
@@ -178,11 +178,13 @@
 
 #ifdef PARSE_RFXCOM_DEVICE_LOG
 #include <iostream>
-#include <fstream>
 #endif
+#include <fstream>
 
 #define round(a) ( int ) ( a + .5 )
 
+#define RXREPLAY_HWID 999 // hardware that receives the frames of ReplayRxLog
+
 extern std::string szStartupFolder;
 extern std::string szUserDataFolder;
 extern std::string szWWWFolder;
@@ -1569,6 +1571,160 @@ void MainWorker::ParseRFXLogFile()
 #endif
 }
 
+bool MainWorker::StartRxRecording(const std::string &szFile)
+{
+	std::lock_guard<std::mutex> l(m_rxrecord_mutex);
+	if (m_rxrecordfile.is_open())
+		m_rxrecordfile.close();
+	m_rxrecordfile.open(szFile.c_str(), std::ios::out | std::ios::app);
+	if (!m_rxrecordfile.is_open())
+	{
+		_log.Log(LOG_ERROR, "RxRecord: cannot open %s", szFile.c_str());
+		return false;
+	}
+	_log.Log(LOG_STATUS, "RxRecord: recording received frames to %s", szFile.c_str());
+	m_bRxRecording = true;
+	return true;
+}
+
+void MainWorker::RecordRxMessage(const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel)
+{
+	std::string szName = (defaultName != nullptr) ? defaultName : "";
+	stdreplace(szName, ";", ",");
+	std::string szHex = ToHexString(pRXCommand, pRXCommand[0] + 1);
+	stdreplace(szHex, "0x", "");
+	stdreplace(szHex, " ", "");
+
+	std::lock_guard<std::mutex> l(m_rxrecord_mutex);
+	if (!m_rxrecordfile.is_open())
+		return;
+	m_rxrecordfile << szName << ";" << BatteryLevel << ";" << szHex << "\n";
+	m_rxrecordfile.flush();
+}
+
+void MainWorker::AddRxReplayTimings(const std::chrono::steady_clock::time_point &tPushed, const std::chrono::steady_clock::time_point &tStart, const uint64_t StatementTime)
+{
+	const double queued = std::chrono::duration<double, std::milli>(tStart - tPushed).count();
+	const double processed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	const double sql = (double)StatementTime / 1000000.0;
+	std::lock_guard<std::mutex> l(m_rxreplay_mutex);
+	m_rxreplay_queued.push_back(queued);
+	m_rxreplay_sql.push_back(sql);
+	m_rxreplay_decode.push_back((processed > sql) ? processed - sql : 0);
+}
+
+static std::string RxReplayPercentiles(std::vector<double> &values)
+{
+	if (values.empty())
+		return "no samples";
+	std::sort(values.begin(), values.end());
+	auto percentile = [&values](const double p) { return values[std::min(values.size() - 1, (size_t)(p * values.size()))]; };
+	return std_format("p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms", percentile(0.5), percentile(0.9), percentile(0.99), values.back());
+}
+
+bool MainWorker::ReplayRxLog(const std::string &szFile, const int FramesPerSecond)
+{
+	struct _tReplayFrame
+	{
+		std::string Name;
+		int BatteryLevel = 255;
+		std::vector<uint8_t> RXCommand;
+	};
+	std::vector<_tReplayFrame> frames;
+
+	std::ifstream infile(szFile.c_str());
+	if (!infile.is_open())
+	{
+		_log.Log(LOG_ERROR, "RxReplay: cannot open %s", szFile.c_str());
+		return false;
+	}
+	std::string sLine;
+	int iLine = 0;
+	while (std::getline(infile, sLine))
+	{
+		iLine++;
+		stdstring_trim(sLine);
+		if (sLine.empty() || (sLine[0] == '#'))
+			continue;
+		//"name;battery;hex" as written by RecordRxMessage, or only the hex frame
+		std::vector<std::string> fields;
+		StringSplit(sLine, ";", fields);
+		std::string szHex = fields.back();
+		stdreplace(szHex, " ", "");
+		std::vector<char> bytes;
+		if (isHexRepresentation(szHex))
+			bytes = HexToBytes(szHex);
+		if (bytes.empty() || ((size_t)(uint8_t)bytes[0] + 1 != bytes.size()))
+		{
+			_log.Log(LOG_ERROR, "RxReplay: invalid frame in line %d", iLine);
+			continue;
+		}
+		_tReplayFrame frame;
+		frame.RXCommand.assign(bytes.begin(), bytes.end());
+		if (fields.size() == 3)
+		{
+			frame.Name = fields[0];
+			frame.BatteryLevel = atoi(fields[1].c_str());
+		}
+		frames.push_back(frame);
+	}
+	infile.close();
+	if (frames.empty())
+	{
+		_log.Log(LOG_ERROR, "RxReplay: no frames found in %s", szFile.c_str());
+		return false;
+	}
+
+	//All frames are received by one dummy hardware, start it the same way as the configured hardware
+	//so the event system is running as well
+	CDummy *pHardware = new CDummy(RXREPLAY_HWID);
+	pHardware->m_Name = pHardware->m_ShortName = "RX replay";
+	AddDomoticzHardware(pHardware);
+	m_hardwareStartCounter = 0;
+	m_bStartHardware = true;
+	for (int ii = 0; (ii < 100) && m_bStartHardware; ii++)
+		sleep_milliseconds(100);
+
+	{
+		std::lock_guard<std::mutex> l(m_rxreplay_mutex);
+		m_rxreplay_queued.clear();
+		m_rxreplay_sql.clear();
+		m_rxreplay_decode.clear();
+	}
+	m_sql.SetStatementProfiling(true);
+	m_bRxReplayStats = true;
+
+	_log.Log(LOG_STATUS, "RxReplay: replaying %d frames from %s", (int)frames.size(), szFile.c_str());
+	auto tStart = std::chrono::steady_clock::now();
+	for (size_t ii = 0; ii < frames.size(); ii++)
+	{
+		if (FramesPerSecond > 0)
+			std::this_thread::sleep_until(tStart + std::chrono::microseconds((int64_t)ii * 1000000 / FramesPerSecond));
+		const _tReplayFrame &frame = frames[ii];
+		//the queue is processed in order, waiting for the last frame waits for all of them
+		if (ii + 1 < frames.size())
+			PushRxMessage(pHardware, &frame.RXCommand[0], frame.Name.c_str(), frame.BatteryLevel, "");
+		else
+			PushAndWaitRxMessage(pHardware, &frame.RXCommand[0], frame.Name.c_str(), frame.BatteryLevel, "");
+	}
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+	m_bRxReplayStats = false;
+	m_sql.SetStatementProfiling(false);
+
+	{
+		std::lock_guard<std::mutex> l(m_rxreplay_mutex);
+		_log.Log(LOG_STATUS, "RxReplay: %d frames processed in %.3f s (%.1f frames/s)", (int)m_rxreplay_queued.size(), elapsed,
+			 (elapsed > 0) ? m_rxreplay_queued.size() / elapsed : 0.0);
+		_log.Log(LOG_STATUS, "RxReplay: queued: %s", RxReplayPercentiles(m_rxreplay_queued).c_str());
+		_log.Log(LOG_STATUS, "RxReplay: sql: %s", RxReplayPercentiles(m_rxreplay_sql).c_str());
+		_log.Log(LOG_STATUS, "RxReplay: decode/events: %s", RxReplayPercentiles(m_rxreplay_decode).c_str());
+	}
+
+	RemoveDomoticzHardware(pHardware);
+	return true;
+}
+
 void MainWorker::Do_Work()
 {
 	int second_counter = 0;
@@ -1622,6 +1778,8 @@ void MainWorker::Do_Work()
 			continue;
 		second_counter = 0;
 
+		FlushCoalescedRxMessages();
+
 		if (m_bStartHardware)
 		{
 			m_hardwareStartCounter++;
@@ -1967,6 +2125,8 @@ void MainWorker::DecodeRXMessage(const CDomoticzHardwareBase* pHardware, const u
 {
 	if ((pHardware == nullptr) || (pRXCommand == nullptr))
 		return;
+	if (const_cast<CDomoticzHardwareBase*>(pHardware)->CollectRxBatchItem(pRXCommand, defaultName, BatteryLevel, userName))
+		return; //will be pushed by EndRxBatch
 	if ((pHardware->HwdType == HTYPE_Domoticz) && (pHardware->m_HwdID == 8765))
 	{
 		//Directly process the command
@@ -1989,6 +2149,8 @@ void MainWorker::PushRxMessage(const CDomoticzHardwareBase *pHardware, const uin
 void MainWorker::PushAndWaitRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel, const char *userName)
 {
 	// Check command, submit it and wait for it to be processed
+	if (pHardware != nullptr)
+		const_cast<CDomoticzHardwareBase *>(pHardware)->FlushRxBatch(); // what was collected before this one goes first
 	CheckAndPushRxMessage(pHardware, pRXCommand, defaultName, BatteryLevel, userName, true);
 }
 
@@ -2019,6 +2181,7 @@ void MainWorker::CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, c
 		rxMessage.UserName = userName;
 	rxMessage.rxMessageIdx = m_rxMessageIdx++;
 	rxMessage.hardwareId = pHardware->m_HwdID;
+	rxMessage.tPushed = std::chrono::steady_clock::now();
 	// defensive copy of the command
 	rxMessage.vrxCommand.resize(pRXCommand[0] + 1);
 	rxMessage.vrxCommand.insert(rxMessage.vrxCommand.begin(), pRXCommand, pRXCommand + pRXCommand[0] + 1);
@@ -2077,6 +2240,39 @@ void MainWorker::CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, c
 	}
 }
 
+void MainWorker::PushRxMessageBatch(const CDomoticzHardwareBase *pHardware, std::vector<_tRxBatchItem> &batch)
+{
+	if (batch.empty())
+		return;
+	if (batch.size() == 1)
+	{
+		const _tRxBatchItem &item = batch[0];
+		PushRxMessage(pHardware, &item.RXCommand[0], item.Name.c_str(), item.BatteryLevel, item.UserName.c_str());
+		return;
+	}
+	if (pHardware->m_HwdID < 1)
+	{
+		_log.Log(LOG_ERROR, "RxQueue: cannot push message batch with invalid hardware id (id=%d, type=%d, name=%s)",
+			pHardware->m_HwdID,
+			pHardware->HwdType,
+			pHardware->m_Name.c_str());
+		return;
+	}
+	if (m_TaskRXMessage.IsStopRequested(0)) {
+		// Server is stopping
+		return;
+	}
+
+	_tRxQueueItem rxMessage;
+	rxMessage.BatteryLevel = 0;
+	rxMessage.rxMessageIdx = m_rxMessageIdx++;
+	rxMessage.hardwareId = pHardware->m_HwdID;
+	rxMessage.crc = 0x0;
+	rxMessage.trigger = nullptr;
+	rxMessage.batch.swap(batch);
+	m_rxMessageQueue.push(rxMessage);
+}
+
 void MainWorker::UnlockRxMessageQueue()
 {
 #ifdef DEBUG_RXQUEUE
@@ -2091,6 +2287,18 @@ void MainWorker::UnlockRxMessageQueue()
 	m_rxMessageQueue.push(rxMessage);
 }
 
+// The message the RX worker is processing on this thread, used by CoalesceRxUpdate
+struct _tRxCurrentMessage
+{
+	int HardwareID;
+	bool bNoCoalesce;
+	const uint8_t *pRXCommand;
+	const char *defaultName;
+	int BatteryLevel;
+	const char *userName;
+};
+static thread_local const _tRxCurrentMessage *pRxCurrentMessage = nullptr;
+
 void MainWorker::Do_Work_On_Rx_Messages()
 {
 	_log.Log(LOG_STATUS, "RxQueue: queue worker started...");
@@ -2134,6 +2342,10 @@ void MainWorker::Do_Work_On_Rx_Messages()
 				rxQItem.trigger->popped();
 			continue;
 		}
+		if (!rxQItem.batch.empty()) {
+			ProcessRXMessageBatch(pHardware, rxQItem.batch);
+			continue;
+		}
 		if (rxQItem.vrxCommand.empty()) {
 			_log.Log(LOG_ERROR, "RxQueue: cannot retrieve command with id: %d", rxQItem.hardwareId);
 			if (rxQItem.trigger != nullptr)
@@ -2165,7 +2377,22 @@ void MainWorker::Do_Work_On_Rx_Messages()
 			pRXCommand[1],
 			pRXCommand[2]);
 #endif
+		if (m_bRxRecording && !rxQItem.bNoCoalesce)
+			RecordRxMessage(pRXCommand, rxQItem.Name.c_str(), rxQItem.BatteryLevel);
+		const bool bReplayStats = m_bRxReplayStats;
+		std::chrono::steady_clock::time_point tStart;
+		uint64_t StatementTime = 0;
+		if (bReplayStats)
+		{
+			tStart = std::chrono::steady_clock::now();
+			StatementTime = CSQLHelper::GetThreadStatementTime();
+		}
+		_tRxCurrentMessage rxCurrent = { rxQItem.hardwareId, rxQItem.bNoCoalesce, pRXCommand, rxQItem.Name.c_str(), rxQItem.BatteryLevel, rxQItem.UserName.c_str() };
+		pRxCurrentMessage = &rxCurrent;
 		ProcessRXMessage(pHardware, pRXCommand, rxQItem.Name.c_str(), rxQItem.BatteryLevel, rxQItem.UserName.c_str());
+		pRxCurrentMessage = nullptr;
+		if (bReplayStats)
+			AddRxReplayTimings(rxQItem.tPushed, tStart, CSQLHelper::GetThreadStatementTime() - StatementTime);
 		if (rxQItem.trigger != nullptr)
 		{
 			rxQItem.trigger->popped();
@@ -2175,6 +2402,147 @@ void MainWorker::Do_Work_On_Rx_Messages()
 	_log.Log(LOG_STATUS, "RxQueue: queue worker stopped...");
 }
 
+static thread_local bool bProcessingRxBatch = false;
+
+//True when any of the (numeric) values changed more than the given delta or percentage
+static bool IsSignificantRxChange(const int nValue, const char *sValue, const int oldnValue, const std::string &oldsValue, const double MaxDelta, const double MaxPercentage)
+{
+	std::vector<std::string> newValues, oldValues;
+	StringSplit(sValue, ";", newValues);
+	StringSplit(oldsValue, ";", oldValues);
+	if (newValues.size() != oldValues.size())
+		return true;
+	newValues.push_back(std::to_string(nValue));
+	oldValues.push_back(std::to_string(oldnValue));
+	for (size_t ii = 0; ii < newValues.size(); ii++)
+	{
+		if (newValues[ii] == oldValues[ii])
+			continue;
+		if (!is_number(newValues[ii]) || !is_number(oldValues[ii]))
+			return true; //text changed
+		double newValue = atof(newValues[ii].c_str());
+		double oldValue = atof(oldValues[ii].c_str());
+		double delta = std::fabs(newValue - oldValue);
+		if ((MaxDelta >= 0) && (delta > MaxDelta))
+			return true;
+		if ((MaxPercentage >= 0) && ((oldValue == 0) || (delta * 100.0 / std::fabs(oldValue) > MaxPercentage)))
+			return true;
+	}
+	return false;
+}
+
+bool MainWorker::CoalesceRxUpdate(const uint64_t DeviceRowIdx, const std::string &DeviceOptions, const unsigned char devType, const unsigned char subType, const int nValue, const char *sValue,
+				  const int oldnValue, const std::string &oldsValue)
+{
+	const _tRxCurrentMessage *pMessage = pRxCurrentMessage;
+	if (pMessage == nullptr)
+		return false; //not received by the RX worker (JSON, scripts, plugins)
+	if (DeviceOptions.find("CoalesceInterval") == std::string::npos)
+		return false;
+	if (IsLightOrSwitch(devType, subType) || ((devType == pTypeGeneral) && ((subType == sTypeCounterIncremental) || (subType == sTypeManagedCounter))))
+		return false; //state changes and increments are never held back
+
+	time_t now = mytime(nullptr);
+	if (pMessage->bNoCoalesce)
+	{
+		//this is a flushed message
+		std::lock_guard<std::mutex> l(m_rxcoalesce_mutex);
+		m_rxcoalesce[DeviceRowIdx].LastWrite = now;
+		return false;
+	}
+
+	auto options = m_sql.BuildDeviceOptions(DeviceOptions);
+	int Interval = atoi(options["CoalesceInterval"].c_str());
+	if (Interval <= 0)
+		return false;
+	double MaxDelta = (options.find("CoalesceDelta") != options.end()) ? atof(options["CoalesceDelta"].c_str()) : -1;
+	double MaxPercentage = (options.find("CoalescePercentage") != options.end()) ? atof(options["CoalescePercentage"].c_str()) : -1;
+
+	{
+		std::lock_guard<std::mutex> l(m_rxcoalesce_mutex);
+		_tRxCoalesceItem &citem = m_rxcoalesce[DeviceRowIdx];
+		if ((difftime(now, citem.LastWrite) >= Interval) || IsSignificantRxChange(nValue, sValue, oldnValue, oldsValue, MaxDelta, MaxPercentage))
+		{
+			citem.LastWrite = now;
+			citem.bPending = false;
+			return false;
+		}
+		//keep the latest message
+		citem.Interval = Interval;
+		citem.bPending = true;
+		_tRxQueueItem &rxMessage = citem.Pending;
+		rxMessage.hardwareId = pMessage->HardwareID;
+		rxMessage.vrxCommand.assign(pMessage->pRXCommand, pMessage->pRXCommand + pMessage->pRXCommand[0] + 1);
+		rxMessage.Name = pMessage->defaultName;
+		rxMessage.BatteryLevel = pMessage->BatteryLevel;
+		rxMessage.UserName = pMessage->userName;
+		rxMessage.crc = 0x0;
+		rxMessage.trigger = nullptr;
+		rxMessage.bNoCoalesce = true;
+	}
+	sOnDeviceLiveValue(pMessage->HardwareID, DeviceRowIdx, nValue, sValue);
+	return true;
+}
+
+void MainWorker::ClearRxCoalesce(const uint64_t DeviceRowIdx)
+{
+	std::lock_guard<std::mutex> l(m_rxcoalesce_mutex);
+	m_rxcoalesce.erase(DeviceRowIdx);
+}
+
+void MainWorker::FlushCoalescedRxMessages()
+{
+	std::vector<_tRxQueueItem> rxMessages;
+	time_t now = mytime(nullptr);
+	{
+		std::lock_guard<std::mutex> l(m_rxcoalesce_mutex);
+		for (auto &itt : m_rxcoalesce)
+		{
+			_tRxCoalesceItem &citem = itt.second;
+			if ((!citem.bPending) || (difftime(now, citem.LastWrite) < citem.Interval))
+				continue;
+			citem.bPending = false;
+			if (citem.Pending.hardwareId > 0)
+				rxMessages.push_back(std::move(citem.Pending));
+		}
+	}
+	for (auto &rxMessage : rxMessages)
+	{
+		rxMessage.rxMessageIdx = m_rxMessageIdx++;
+		m_rxMessageQueue.push(rxMessage);
+	}
+}
+
+bool MainWorker::IsProcessingRxBatch() const
+{
+	return bProcessingRxBatch;
+}
+
+//All messages of a batch are written in one transaction (committed early when another thread needs
+//the database in between), listeners of sOnDeviceBatchReceived (the websocket) get one notification
+//for the whole batch instead of one per device
+void MainWorker::ProcessRXMessageBatch(const CDomoticzHardwareBase *pHardware, const std::vector<_tRxBatchItem> &batch)
+{
+	time_t tBatchStart = mytime(nullptr);
+	bool bTransaction = m_sql.BeginTransaction();
+	bProcessingRxBatch = true;
+	for (const auto &item : batch)
+	{
+		if (item.RXCommand.empty())
+			continue;
+		if (m_bRxRecording)
+			RecordRxMessage(&item.RXCommand[0], item.Name.c_str(), item.BatteryLevel);
+		_tRxCurrentMessage rxCurrent = { pHardware->m_HwdID, false, &item.RXCommand[0], item.Name.c_str(), item.BatteryLevel, item.UserName.c_str() };
+		pRxCurrentMessage = &rxCurrent;
+		ProcessRXMessage(pHardware, &item.RXCommand[0], item.Name.c_str(), item.BatteryLevel, item.UserName.c_str());
+		pRxCurrentMessage = nullptr;
+	}
+	bProcessingRxBatch = false;
+	if (bTransaction)
+		m_sql.CommitTransaction();
+	sOnDeviceBatchReceived(pHardware->m_HwdID, tBatchStart);
+}
+
 void MainWorker::ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel, const char *userName)
 {
 	// current date/time based on current system
@@ -7,6 +7,9 @@
 #include "NotificationSystem.h"
 #include "Camera.h"
 #include <deque>
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include "WindCalculation.h"
 #include "TrendCalculator.h"
 #include "StoppableTask.h"
@@ -53,6 +56,21 @@ public:
 #endif
 	void DecodeRXMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName);
 	void PushAndWaitRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName);
+	void PushRxMessageBatch(const CDomoticzHardwareBase *pHardware, std::vector<_tRxBatchItem> &batch);
+	bool IsProcessingRxBatch() const;
+
+	// Writes every frame processed by the RX worker to szFile (one "name;battery;hex" line per frame)
+	bool StartRxRecording(const std::string &szFile);
+	// Pushes the frames of a recording through the RX worker (FramesPerSecond 0 = as fast as possible)
+	// and logs the throughput and the per stage latency percentiles
+	bool ReplayRxLog(const std::string &szFile, int FramesPerSecond);
+
+	// Returns true when this update of a device received by the RX worker should be held back. Enabled per device with the options
+	// CoalesceInterval (seconds), CoalesceDelta (absolute) and CoalescePercentage (relative change that is always written directly)
+	bool CoalesceRxUpdate(uint64_t DeviceRowIdx, const std::string &DeviceOptions, unsigned char devType, unsigned char subType, int nValue, const char *sValue,
+			      int oldnValue, const std::string &oldsValue);
+	// Forgets the coalescing state (and a held back update) of a deleted device
+	void ClearRxCoalesce(uint64_t DeviceRowIdx);
 
 	bool SwitchLight(const std::string &idx, const std::string &switchcmd, const std::string &level, const std::string &color, const std::string &ooc, int ExtraDelay, const std::string &User);
 	bool SwitchLight(uint64_t idx, const std::string &switchcmd, int level, _tColor color, bool ooc, int ExtraDelay, const std::string &User);
@@ -98,6 +116,10 @@ public:
 
 	boost::signals2::signal<void(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const uint8_t *pRXCommand)> sOnDeviceReceived;
 	boost::signals2::signal<void(const int m_HwdID, const uint64_t DeviceRowIdx)> sOnDeviceUpdate;
+	// Fired after a batch of received messages has been processed, with the time the batch started
+	boost::signals2::signal<void(const int m_HwdID, const time_t BatchStart)> sOnDeviceBatchReceived;
+	// Fired for every update that was held back by RX coalescing (the raw "live" values)
+	boost::signals2::signal<void(const int m_HwdID, const uint64_t DeviceRowIdx, const int nValue, const std::string &sValue)> sOnDeviceLiveValue;
 	boost::signals2::signal<void(const uint64_t SceneIdx, const std::string &SceneName)> sOnSwitchScene;
 
 	CScheduler m_scheduler;
@@ -203,13 +225,36 @@ private:
 		boost::uint16_t crc;
 		queue_element_trigger* trigger;
 		std::string UserName;
+		std::vector<_tRxBatchItem> batch; // when not empty, processed as one batch instead of vrxCommand
+		bool bNoCoalesce = false;
+		std::chrono::steady_clock::time_point tPushed;
 	};
 	concurrent_queue<_tRxQueueItem> m_rxMessageQueue;
+	struct _tRxCoalesceItem {
+		time_t LastWrite = 0;
+		int Interval = 0;
+		bool bPending = false;
+		_tRxQueueItem Pending; // latest held back message, pushed again when the interval has passed
+	};
+	std::mutex m_rxcoalesce_mutex;
+	std::map<uint64_t, _tRxCoalesceItem> m_rxcoalesce;
+	void FlushCoalescedRxMessages();
+	void RecordRxMessage(const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel);
+	void AddRxReplayTimings(const std::chrono::steady_clock::time_point &tPushed, const std::chrono::steady_clock::time_point &tStart, uint64_t StatementTime);
+	std::atomic<bool> m_bRxRecording{ false };
+	std::mutex m_rxrecord_mutex;
+	std::ofstream m_rxrecordfile;
+	std::atomic<bool> m_bRxReplayStats{ false };
+	std::mutex m_rxreplay_mutex;
+	std::vector<double> m_rxreplay_queued; // ms between push and start of processing
+	std::vector<double> m_rxreplay_sql; // ms spent in sqlite statements
+	std::vector<double> m_rxreplay_decode; // ms processing time outside sqlite (decoding, notifications, events)
 	void UnlockRxMessageQueue();
 	void PushRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName);
 	void CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel, const char *userName, bool wait);
 	void ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, int BatteryLevel,
 			      const char *userName); // battery level: 0-100, 255=no battery, -1 = don't set
+	void ProcessRXMessageBatch(const CDomoticzHardwareBase *pHardware, const std::vector<_tRxBatchItem> &batch);
 
 	struct _tRxMessageProcessingResult {
 		std::string DeviceName;
@@ -240,17 +240,52 @@ std::string CNotificationHelper::ParseCustomMessage(const std::string &cMessage,
 	return ret;
 }
 
-bool CNotificationHelper::ApplyRule(const std::string &rule, const bool equal, const bool less)
+static _eNotificationRule ParseNotificationRule(const std::string &rule)
 {
-	if (((rule == ">") || (rule == ">=")) && (!less) && (!equal))
-		return true;
-	if (((rule == "<") || (rule == "<=")) && (less))
-		return true;
-	if (((rule == "=") || (rule == ">=") || (rule == "<=")) && (equal))
-		return true;
-	if ((rule == "!=") && (!equal))
-		return true;
-	return false;
+	if (rule == "=")
+		return NRULE_EQUAL;
+	if (rule == "!=")
+		return NRULE_NOTEQUAL;
+	if (rule == "<")
+		return NRULE_LESS;
+	if (rule == "<=")
+		return NRULE_LESSEQUAL;
+	if (rule == ">")
+		return NRULE_GREATER;
+	if (rule == ">=")
+		return NRULE_GREATEREQUAL;
+	return NRULE_NONE;
+}
+
+//Splits and parses the Params ("type;rule;value;recovery") so the checks only have to compare
+static void ParseNotificationParams(_tNotification &n)
+{
+	n.SplitParams.clear();
+	StringSplit(n.Params, ";", n.SplitParams);
+	n.Rule = (n.SplitParams.size() > 1) ? ParseNotificationRule(n.SplitParams[1]) : NRULE_NONE;
+	n.Value = (n.SplitParams.size() > 2) ? static_cast<float>(atof(n.SplitParams[2].c_str())) : 0.0F;
+	n.Recovery = ((n.SplitParams.size() > 3) && (n.SplitParams[3] == "1"));
+}
+
+bool CNotificationHelper::ApplyRule(const _eNotificationRule rule, const bool equal, const bool less)
+{
+	switch (rule)
+	{
+	case NRULE_GREATER:
+		return (!less) && (!equal);
+	case NRULE_GREATEREQUAL:
+		return (!less);
+	case NRULE_LESS:
+		return less;
+	case NRULE_LESSEQUAL:
+		return (less) || (equal);
+	case NRULE_EQUAL:
+		return equal;
+	case NRULE_NOTEQUAL:
+		return (!equal);
+	default:
+		return false;
+	}
 }
 
 bool CNotificationHelper::CheckAndHandleNotification(const uint64_t DevRowIdx, const int HardwareID, const std::string &ID, const std::string &sName, const unsigned char unit, const unsigned char cType, const unsigned char cSubType, const int nValue) {
@@ -280,6 +315,9 @@ bool CNotificationHelper::CheckAndHandleNotification(const uint64_t DevRowIdx, c
 	if ((DevRowIdx == -1) || IsLightOrSwitch(cType, cSubType)) {
 		return false;
 	}
+	// Most devices have no notifications, don't bother splitting the value for those
+	if (!HasNotifications(DevRowIdx))
+		return false;
 
 	int meterType = 0;
 	std::vector<std::string> strarray;
@@ -554,13 +592,11 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 			bRecoveryMessage = CustomRecoveryMessage(n.ID, recoverymsg, true);
 			if ((atime < n.LastSend) && (!n.SendAlways) && (!bRecoveryMessage))
 				continue;
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 3)
+			if (n.SplitParams.size() < 3)
 				continue; //impossible
-			std::string ntype = splitresults[0];
+			const std::string &ntype = n.SplitParams[0];
 			std::string custommsg;
-			float svalue = static_cast<float>(atof(splitresults[2].c_str()));
+			float svalue = n.Value;
 			bool bSendNotification = false;
 			bool bCustomMessage = false;
 			bCustomMessage = CustomRecoveryMessage(n.ID, custommsg, false);
@@ -581,10 +617,10 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 				else if (temp > 10.0) szExtraData += "Image=temp-10-15|";
 				else if (temp > 5.0) szExtraData += "Image=temp-5-10|";
 				else szExtraData += "Image=temp48|";
-				bSendNotification = ApplyRule(splitresults[1], (temp == svalue), (temp < svalue));
+				bSendNotification = ApplyRule(n.Rule, (temp == svalue), (temp < svalue));
 				if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 				{
-					sprintf(szTmp, "%s Temperature is %.1f %s [%s %.1f %s]", devicename.c_str(), temp, label.c_str(), splitresults[1].c_str(), svalue, label.c_str());
+					sprintf(szTmp, "%s Temperature is %.1f %s [%s %.1f %s]", devicename.c_str(), temp, label.c_str(), n.SplitParams[1].c_str(), svalue, label.c_str());
 					msg = szTmp;
 					sprintf(szTmp, "%.1f", temp);
 					notValue = szTmp;
@@ -605,10 +641,10 @@ bool CNotificationHelper::CheckAndHandleTempHumidityNotification(
 			{
 				//humidity
 				szExtraData += "Image=moisture48|";
-				bSendNotification = ApplyRule(splitresults[1], (humidity == svalue), (humidity < svalue));
+				bSendNotification = ApplyRule(n.Rule, (humidity == svalue), (humidity < svalue));
 				if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 				{
-					sprintf(szTmp, "%s Humidity is %d %% [%s %.0f %%]", devicename.c_str(), humidity, splitresults[1].c_str(), svalue);
+					sprintf(szTmp, "%s Humidity is %d %% [%s %.0f %%]", devicename.c_str(), humidity, n.SplitParams[1].c_str(), svalue);
 					msg = szTmp;
 					sprintf(szTmp, "%d", humidity);
 					notValue = szTmp;
@@ -671,11 +707,9 @@ bool CNotificationHelper::CheckAndHandleDewPointNotification(
 			TouchLastUpdate(n.ID);
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.empty())
+			if (n.SplitParams.empty())
 				continue; //impossible
-			std::string ntype = splitresults[0];
+			const std::string &ntype = n.SplitParams[0];
 
 			if (ntype == signdewpoint)
 			{
@@ -726,12 +760,10 @@ bool CNotificationHelper::CheckAndHandleValueNotification(
 			TouchLastUpdate(n.ID);
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 2)
+			if (n.SplitParams.size() < 2)
 				continue; //impossible
-			std::string ntype = splitresults[0];
-			int svalue = static_cast<int>(atoi(splitresults[1].c_str()));
+			const std::string &ntype = n.SplitParams[0];
+			int svalue = static_cast<int>(atoi(n.SplitParams[1].c_str()));
 
 			if (ntype == signvalue)
 			{
@@ -793,14 +825,12 @@ bool CNotificationHelper::CheckAndHandleAmpere123Notification(
 			bRecoveryMessage = CustomRecoveryMessage(n.ID, recoverymsg, true);
 			if ((atime < n.LastSend) && (!n.SendAlways) && (!bRecoveryMessage))
 				continue;
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 3)
+			if (n.SplitParams.size() < 3)
 				continue; //impossible
-			std::string ntype = splitresults[0];
+			const std::string &ntype = n.SplitParams[0];
 			std::string custommsg;
 			std::string ltype;
-			float svalue = static_cast<float>(atof(splitresults[2].c_str()));
+			float svalue = n.Value;
 			float ampere = 0.0F;
 			bool bSendNotification = false;
 			bool bCustomMessage = false;
@@ -821,10 +851,10 @@ bool CNotificationHelper::CheckAndHandleAmpere123Notification(
 				ampere = Ampere3;
 				ltype = Notification_Type_Desc(NTYPE_AMPERE3, 0);
 			}
-			bSendNotification = ApplyRule(splitresults[1], (ampere == svalue), (ampere < svalue));
+			bSendNotification = ApplyRule(n.Rule, (ampere == svalue), (ampere < svalue));
 			if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 			{
-				sprintf(szTmp, "%s %s is %.1f Ampere [%s %.1f Ampere]", devicename.c_str(), ltype.c_str(), ampere, splitresults[1].c_str(), svalue);
+				sprintf(szTmp, "%s %s is %.1f Ampere [%s %.1f Ampere]", devicename.c_str(), ltype.c_str(), ampere, n.SplitParams[1].c_str(), svalue);
 				msg = szTmp;
 				sprintf(szTmp, "%.1f", ampere);
 				notValue = szTmp;
@@ -866,12 +896,11 @@ bool CNotificationHelper::CheckAndHandleNotification(
 	if (notifications.empty())
 		return false;
 
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT SwitchType, CustomImage FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
-	if (result.empty())
+	_tNotificationDeviceMeta meta;
+	if (!GetDeviceMeta(Idx, meta))
 		return false;
 
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|CustomImage=" + result[0][1] + "|";
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + meta.SwitchType + "|CustomImage=" + meta.CustomImage + "|";
 	std::string notValue;
 
 	time_t atime = mytime(nullptr);
@@ -884,12 +913,9 @@ bool CNotificationHelper::CheckAndHandleNotification(
 	{
 		if (n.LastUpdate)
 			TouchLastUpdate(n.ID);
-		std::vector<std::string> splitresults;
-		StringSplit(n.Params, ";", splitresults);
-		if (splitresults.empty())
+		if (n.SplitParams.empty())
 			continue; //impossible
-		std::string atype = splitresults[0];
-		if (atype == ltype)
+		if (n.SplitParams[0] == ltype)
 		{
 			if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 			{
@@ -926,11 +952,10 @@ bool CNotificationHelper::CheckAndHandleNotification(
 		sprintf(szTmp, "%.1f", mvalue);
 	pvalue = szTmp;
 
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT SwitchType FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
-	if (result.empty())
+	_tNotificationDeviceMeta meta;
+	if (!GetDeviceMeta(Idx, meta))
 		return false;
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|";
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + meta.SwitchType + "|";
 
 	time_t atime = mytime(nullptr);
 
@@ -955,23 +980,21 @@ bool CNotificationHelper::CheckAndHandleNotification(
 			bRecoveryMessage = CustomRecoveryMessage(n.ID, recoverymsg, true);
 			if ((atime < n.LastSend) && (!n.SendAlways) && (!bRecoveryMessage))
 				continue;
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.size() < 3)
+			if (n.SplitParams.size() < 3)
 				continue; //impossible
-			std::string ntype = splitresults[0];
+			const std::string &ntype = n.SplitParams[0];
 			std::string custommsg;
-			float svalue = static_cast<float>(atof(splitresults[2].c_str()));
+			float svalue = n.Value;
 			bool bSendNotification = false;
 			bool bCustomMessage = false;
 			bCustomMessage = CustomRecoveryMessage(n.ID, custommsg, false);
 
 			if (ntype == nsign)
 			{
-				bSendNotification = ApplyRule(splitresults[1], (mvalue == svalue), (mvalue < svalue));
+				bSendNotification = ApplyRule(n.Rule, (mvalue == svalue), (mvalue < svalue));
 				if (bSendNotification && (!bRecoveryMessage || n.SendAlways))
 				{
-					sprintf(szTmp, "%s %s is %s %s [%s %.1f %s]", devicename.c_str(), ltype.c_str(), pvalue.c_str(), label.c_str(), splitresults[1].c_str(), svalue, label.c_str());
+					sprintf(szTmp, "%s %s is %s %s [%s %.1f %s]", devicename.c_str(), ltype.c_str(), pvalue.c_str(), label.c_str(), n.SplitParams[1].c_str(), svalue, label.c_str());
 					msg = szTmp;
 				}
 				else if (!bSendNotification && bRecoveryMessage)
@@ -1011,14 +1034,11 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	if (notifications.empty())
 		return false;
 
-	std::vector<std::vector<std::string> > result;
-
-	result = m_sql.safe_query("SELECT SwitchType, CustomImage FROM DeviceStatus WHERE (ID=%" PRIu64 ")",
-		Idx);
-	if (result.empty())
+	_tNotificationDeviceMeta meta;
+	if (!GetDeviceMeta(Idx, meta))
 		return false;
-	_eSwitchType switchtype = (_eSwitchType)atoi(result[0][0].c_str());
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|CustomImage=" + result[0][1] + "|";
+	_eSwitchType switchtype = (_eSwitchType)atoi(meta.SwitchType.c_str());
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + meta.SwitchType + "|CustomImage=" + meta.CustomImage + "|";
 
 	std::string msg;
 
@@ -1031,11 +1051,9 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	{
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.empty())
+			if (n.SplitParams.empty())
 				continue; //impossible
-			std::string atype = splitresults[0];
+			const std::string &atype = n.SplitParams[0];
 
 			bool bSendNotification = false;
 			std::string notValue;
@@ -1123,15 +1141,12 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	std::vector<_tNotification> notifications = GetNotifications(Idx);
 	if (notifications.empty())
 		return false;
-	std::vector<std::vector<std::string> > result;
-
-	result = m_sql.safe_query("SELECT SwitchType, CustomImage, Options FROM DeviceStatus WHERE (ID=%" PRIu64 ")",
-		Idx);
-	if (result.empty())
+	_tNotificationDeviceMeta meta;
+	if (!GetDeviceMeta(Idx, meta))
 		return false;
-	_eSwitchType switchtype = (_eSwitchType)atoi(result[0][0].c_str());
-	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + result[0][0] + "|CustomImage=" + result[0][1] + "|";
-	std::string sOptions = result[0][2];
+	_eSwitchType switchtype = (_eSwitchType)atoi(meta.SwitchType.c_str());
+	std::string szExtraData = "|Name=" + devicename + "|SwitchType=" + meta.SwitchType + "|CustomImage=" + meta.CustomImage + "|";
+	const std::string &sOptions = meta.Options;
 
 	std::string msg;
 
@@ -1144,11 +1159,9 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 	{
 		if ((atime >= n.LastSend) || (n.SendAlways)) // emergency always goes true
 		{
-			std::vector<std::string> splitresults;
-			StringSplit(n.Params, ";", splitresults);
-			if (splitresults.empty())
+			if (n.SplitParams.empty())
 				continue; //impossible
-			std::string atype = splitresults[0];
+			const std::string &atype = n.SplitParams[0];
 
 			bool bSendNotification = false;
 			std::string notValue;
@@ -1158,10 +1171,10 @@ bool CNotificationHelper::CheckAndHandleSwitchNotification(
 				msg = devicename;
 				if (ntype == NTYPE_SWITCH_ON)
 				{
-					if (splitresults.size() < 3)
+					if (n.SplitParams.size() < 3)
 						continue; //impossible
-					bool bWhenEqual = (splitresults[1] == "=");
-					int iLevel = atoi(splitresults[2].c_str());
+					bool bWhenEqual = (n.Rule == NRULE_EQUAL);
+					int iLevel = atoi(n.SplitParams[2].c_str());
 					if (!bWhenEqual || iLevel < 10 || iLevel > 100)
 						continue; //invalid
 
@@ -1215,14 +1228,13 @@ bool CNotificationHelper::CheckAndHandleRainNotification(
 	const _eNotificationTypes ntype,
 	const float mvalue)
 {
-	std::vector<std::vector<std::string> > result;
+	if (!HasNotifications(Idx))
+		return false;
 
-	result = m_sql.safe_query("SELECT AddjValue,AddjMulti FROM DeviceStatus WHERE (ID=%" PRIu64 ")",
-		Idx);
-	if (result.empty())
+	_tNotificationDeviceMeta meta;
+	if (!GetDeviceMeta(Idx, meta))
 		return false;
-	//double AddjValue = atof(result[0][0].c_str());
-	double AddjMulti = atof(result[0][1].c_str());
+	double AddjMulti = meta.AddjMulti;
 
 	char szDateEnd[40];
 
@@ -1249,13 +1261,9 @@ bool CNotificationHelper::CheckAndHandleRainNotification(
 	}
 	else
 	{
-		result = m_sql.safe_query("SELECT MIN(Total) FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
-			Idx, szDateEnd);
-		if (!result.empty())
+		float total_min;
+		if (GetRainBaseline(Idx, szDateEnd, mvalue, total_min))
 		{
-			std::vector<std::string> sd = result[0];
-
-			float total_min = static_cast<float>(atof(sd[0].c_str()));
 			float total_max = mvalue;
 			double total_real = total_max - total_min;
 			total_real *= AddjMulti;
@@ -1281,12 +1289,10 @@ void CNotificationHelper::CheckAndHandleLastUpdateNotification()
 			if (((atime >= n2.LastSend) || (n2.SendAlways) || (!n2.CustomMessage.empty()))
 			    && (n2.LastUpdate)) // emergency always goes true
 			{
-				std::vector<std::string> splitresults;
-				StringSplit(n2.Params, ";", splitresults);
-				if (splitresults.size() < 3)
+				if (n2.SplitParams.size() < 3)
 					continue;
 				std::string ttype = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
-				if (splitresults[0] == ttype)
+				if (n2.SplitParams[0] == ttype)
 				{
 					std::string recoverymsg;
 					bool bRecoveryMessage = false;
@@ -1299,10 +1305,10 @@ void CNotificationHelper::CheckAndHandleLastUpdateNotification()
 					std::string szExtraData;
 					std::string custommsg;
 					uint64_t Idx = n.first;
-					uint32_t SensorTimeOut = static_cast<uint32_t>(atoi(splitresults[2].c_str()));  // minutes
+					uint32_t SensorTimeOut = static_cast<uint32_t>(atoi(n2.SplitParams[2].c_str()));  // minutes
 					uint32_t diff = static_cast<uint32_t>(round(difftime(btime, n2.LastUpdate)));
 					bool bStartTime = (difftime(btime, m_StartTime) < SensorTimeOut * 60);
-					bool bSendNotification = ApplyRule(splitresults[1], (diff == SensorTimeOut * 60), (diff < SensorTimeOut * 60));
+					bool bSendNotification = ApplyRule(n2.Rule, (diff == SensorTimeOut * 60), (diff < SensorTimeOut * 60));
 					bool bCustomMessage = false;
 					bCustomMessage = CustomRecoveryMessage(n2.ID, custommsg, false);
 
@@ -1310,11 +1316,10 @@ void CNotificationHelper::CheckAndHandleLastUpdateNotification()
 					{
 						if (SystemUptime() < SensorTimeOut * 60 && (!bRecoveryMessage || n2.SendAlways))
 							continue;
-						std::vector<std::vector<std::string> > result;
-						result = m_sql.safe_query("SELECT SwitchType FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
-						if (result.empty())
+						_tNotificationDeviceMeta meta;
+						if (!GetDeviceMeta(Idx, meta))
 							continue;
-						szExtraData = "|Name=" + n2.DeviceName + "|SwitchType=" + result[0][0] + "|";
+						szExtraData = "|Name=" + n2.DeviceName + "|SwitchType=" + meta.SwitchType + "|";
 						std::string ltype = Notification_Type_Desc(NTYPE_LASTUPDATE, 0);
 						std::string label = Notification_Type_Label(NTYPE_LASTUPDATE);
 						char szDate[50];
@@ -1324,7 +1329,7 @@ void CNotificationHelper::CheckAndHandleLastUpdateNotification()
 						sprintf(szDate, "%04d-%02d-%02d %02d:%02d:%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday,
 							ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
 						sprintf(szTmp, "Sensor %s %s: %s [%s %d %s]", n2.DeviceName.c_str(), ltype.c_str(), szDate,
-							splitresults[1].c_str(), SensorTimeOut, label.c_str());
+							n2.SplitParams[1].c_str(), SensorTimeOut, label.c_str());
 						msg = szTmp;
 					}
 					else if (!bSendNotification && bRecoveryMessage)
@@ -1365,109 +1370,80 @@ void CNotificationHelper::TouchNotification(const uint64_t ID)
 
 	//Also touch it internally
 	std::lock_guard<std::mutex> l(m_mutex);
-
-	for (auto &m : m_notifications)
-	{
-		for (auto &n : m.second)
-		{
-			if (n.ID == ID)
-			{
-				n.LastSend = atime;
-				return;
-			}
-		}
-	}
+	_tNotification *pNotification = FindNotification(ID);
+	if (pNotification)
+		pNotification->LastSend = atime;
 }
 
 void CNotificationHelper::TouchLastUpdate(const uint64_t ID)
 {
 	time_t atime = mytime(nullptr);
 	std::lock_guard<std::mutex> l(m_mutex);
-
-	for (auto &m : m_notifications)
-	{
-		for (auto &n : m.second)
-		{
-			if (n.ID == ID)
-			{
-				n.LastUpdate = atime;
-				return;
-			}
-		}
-	}
+	_tNotification *pNotification = FindNotification(ID);
+	if (pNotification)
+		pNotification->LastUpdate = atime;
 }
 
 bool CNotificationHelper::CustomRecoveryMessage(const uint64_t ID, std::string &msg, const bool isRecovery)
 {
 	std::lock_guard<std::mutex> l(m_mutex);
 
-	for (auto &m : m_notifications)
+	_tNotification *pNotification = FindNotification(ID);
+	if (!pNotification)
+		return false;
+	_tNotification &n = *pNotification;
+
+	if ((isRecovery) && (!n.Recovery))
+		return false;
+
+	std::vector<std::string> splitresults;
+	std::string szTmp;
+	StringSplit(n.CustomMessage, ";;", splitresults);
+	if (msg.empty())
 	{
-		for (auto &n : m.second)
+		if (!splitresults.empty())
 		{
-			if (n.ID == ID)
+			if (!splitresults[0].empty() && !isRecovery)
 			{
-				std::vector<std::string> splitresults;
-				if (isRecovery)
-				{
-					StringSplit(n.Params, ";", splitresults);
-					if (splitresults.size() < 4)
-						return false;
-					if (splitresults[3] != "1")
-						return false;
-				}
-
-				std::string szTmp;
-				StringSplit(n.CustomMessage, ";;", splitresults);
-				if (msg.empty())
-				{
-					if (!splitresults.empty())
-					{
-						if (!splitresults[0].empty() && !isRecovery)
-						{
-							szTmp = splitresults[0];
-							msg = szTmp;
-							return true;
-						}
-						if (splitresults.size() > 1)
-						{
-							if (!splitresults[1].empty() && isRecovery)
-							{
-								szTmp = splitresults[1];
-								msg = szTmp;
-								return true;
-							}
-						}
-					}
-					return false;
-				}
-				if (!isRecovery)
-					return false;
-
-				if (!splitresults.empty())
-				{
-					if (!splitresults[0].empty())
-						szTmp = splitresults[0];
-				}
-				if ((msg.find('!') != 0) && (msg.size() > 1))
+				szTmp = splitresults[0];
+				msg = szTmp;
+				return true;
+			}
+			if (splitresults.size() > 1)
+			{
+				if (!splitresults[1].empty() && isRecovery)
 				{
-					szTmp.append(";;[Recovered] ");
-					szTmp.append(msg);
+					szTmp = splitresults[1];
+					msg = szTmp;
+					return true;
 				}
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT ID FROM Notifications WHERE (ID=='%" PRIu64 "') AND (Params=='%q')", n.ID,
-							  n.Params.c_str());
-				if (result.empty())
-					return false;
-
-				m_sql.safe_query("UPDATE Notifications SET CustomMessage='%q' WHERE ID=='%" PRIu64 "'", szTmp.c_str(),
-						 n.ID);
-				n.CustomMessage = szTmp;
-				return true;
 			}
 		}
+		return false;
 	}
-	return false;
+	if (!isRecovery)
+		return false;
+
+	if (!splitresults.empty())
+	{
+		if (!splitresults[0].empty())
+			szTmp = splitresults[0];
+	}
+	if ((msg.find('!') != 0) && (msg.size() > 1))
+	{
+		szTmp.append(";;[Recovered] ");
+		szTmp.append(msg);
+	}
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT ID FROM Notifications WHERE (ID=='%" PRIu64 "') AND (Params=='%q')", n.ID,
+				  n.Params.c_str());
+	if (result.empty())
+		return false;
+
+	m_sql.safe_query("UPDATE Notifications SET CustomMessage='%q' WHERE ID=='%" PRIu64 "'", szTmp.c_str(),
+			 n.ID);
+	n.CustomMessage = szTmp;
+	return true;
 }
 
 bool CNotificationHelper::AddNotification(
@@ -1545,11 +1521,99 @@ bool CNotificationHelper::HasNotifications(const uint64_t DevIdx)
 	return (m_notifications.find(DevIdx) != m_notifications.end());
 }
 
+//m_mutex should be locked by the caller
+_tNotification *CNotificationHelper::FindNotification(const uint64_t ID)
+{
+	auto itt = m_notification_devices.find(ID);
+	if (itt == m_notification_devices.end())
+		return nullptr;
+	auto itt2 = m_notifications.find(itt->second);
+	if (itt2 == m_notifications.end())
+		return nullptr;
+	for (auto &n : itt2->second)
+	{
+		if (n.ID == ID)
+			return &n;
+	}
+	return nullptr;
+}
+
+bool CNotificationHelper::GetDeviceMeta(const uint64_t DevIdx, _tNotificationDeviceMeta &meta)
+{
+	uint64_t generation;
+	{
+		std::lock_guard<std::mutex> l(m_metamutex);
+		auto itt = m_devicemeta.find(DevIdx);
+		if (itt != m_devicemeta.end())
+		{
+			meta = itt->second;
+			return true;
+		}
+		generation = m_devicemeta_generation;
+	}
+	//not queried while holding the lock, the database has its own
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_queryWriter("SELECT SwitchType, CustomImage, Options, AddjMulti FROM DeviceStatus WHERE (ID=%" PRIu64 ")", DevIdx);
+	if (result.empty())
+		return false;
+	meta.SwitchType = result[0][0];
+	meta.CustomImage = result[0][1];
+	meta.Options = result[0][2];
+	meta.AddjMulti = atof(result[0][3].c_str());
+
+	std::lock_guard<std::mutex> l(m_metamutex);
+	if (generation == m_devicemeta_generation) //not written while we were reading it
+		m_devicemeta[DevIdx] = meta;
+	return true;
+}
+
+//Called by the DeviceStatus update hook for every write that could change the SwitchType, CustomImage, Options or AddjMulti of a device
+void CNotificationHelper::InvalidateDeviceMeta(const uint64_t DevIdx)
+{
+	std::lock_guard<std::mutex> l(m_metamutex);
+	m_devicemeta.erase(DevIdx);
+	m_devicemeta_generation++;
+	m_rainbaseline.erase(DevIdx);
+}
+
+//The lowest rain counter of today, only queried once a day (or when the counter went below it, e.g. after a reset)
+bool CNotificationHelper::GetRainBaseline(const uint64_t DevIdx, const std::string &szDate, const float mvalue, float &total_min)
+{
+	{
+		std::lock_guard<std::mutex> l(m_metamutex);
+		auto itt = m_rainbaseline.find(DevIdx);
+		if ((itt != m_rainbaseline.end()) && (itt->second.first == szDate) && (mvalue >= itt->second.second))
+		{
+			total_min = itt->second.second;
+			return true;
+		}
+	}
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT MIN(Total) FROM Rain WHERE (DeviceRowID=%" PRIu64 " AND Date>='%q')",
+		DevIdx, szDate.c_str());
+	if (result.empty())
+		return false;
+	total_min = static_cast<float>(atof(result[0][0].c_str()));
+
+	std::lock_guard<std::mutex> l(m_metamutex);
+	if (result[0][0].empty())
+		m_rainbaseline.erase(DevIdx); //no history yet for today, ask again next time
+	else
+		m_rainbaseline[DevIdx] = std::make_pair(szDate, total_min);
+	return true;
+}
+
 //Re(Loads) all notifications stored in the database, so we do not have to query this all the time
 void CNotificationHelper::ReloadNotifications()
 {
 	std::lock_guard<std::mutex> l(m_mutex);
 	m_notifications.clear();
+	m_notification_devices.clear();
+	{
+		//device metadata is only cached for devices with notifications
+		std::lock_guard<std::mutex> l2(m_metamutex);
+		m_devicemeta.clear();
+	}
 	std::vector<std::vector<std::string> > result;
 
 	m_sql.GetPreferencesVar("NotificationSensorInterval", m_NotificationSensorInterval);
@@ -1562,7 +1626,6 @@ void CNotificationHelper::ReloadNotifications()
 	time_t mtime = mytime(nullptr);
 	struct tm atime;
 	localtime_r(&mtime, &atime);
-	std::vector<std::string> splitresults;
 
 	std::stringstream sstr;
 
@@ -1589,6 +1652,8 @@ void CNotificationHelper::ReloadNotifications()
 		notification.ActiveSystems = sd[5];
 		notification.Priority = atoi(sd[6].c_str());
 		notification.SendAlways = (atoi(sd[7].c_str())!=0);
+		notification.LastUpdate = 0;
+		ParseNotificationParams(notification);
 
 		std::string stime = sd[8];
 		if (stime == "0")
@@ -1601,8 +1666,7 @@ void CNotificationHelper::ReloadNotifications()
 			ParseSQLdatetime(notification.LastSend, ntime, stime, atime.tm_isdst);
 		}
 		std::string ttype = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
-		StringSplit(notification.Params, ";", splitresults);
-		if (splitresults[0] == ttype) {
+		if ((!notification.SplitParams.empty()) && (notification.SplitParams[0] == ttype)) {
 			std::vector<std::vector<std::string> > result2;
 			result2 = m_sql.safe_query(
 				"SELECT B.Name, B.LastUpdate "
@@ -1621,6 +1685,7 @@ void CNotificationHelper::ReloadNotifications()
 				ParseSQLdatetime(notification.LastUpdate, ntime, stime, atime.tm_isdst);
 			}
 		}
+		m_notification_devices[notification.ID] = Idx;
 		m_notifications[Idx].push_back(notification);
 	}
 }
@@ -3,9 +3,21 @@
 #include "../webserver/cWebem.h"
 
 #include <string>
+#include <unordered_map>
 
 #define NOTIFYALL std::string("")
 
+enum _eNotificationRule
+{
+	NRULE_NONE = 0,
+	NRULE_EQUAL,
+	NRULE_NOTEQUAL,
+	NRULE_LESS,
+	NRULE_LESSEQUAL,
+	NRULE_GREATER,
+	NRULE_GREATEREQUAL
+};
+
 struct _tNotification
 {
 	uint64_t ID;
@@ -18,6 +30,20 @@ struct _tNotification
 	std::string CustomAction;
 	std::string ActiveSystems;
 	bool SendAlways;
+	// Params split and parsed once when the notifications are (re)loaded
+	std::vector<std::string> SplitParams;
+	_eNotificationRule Rule;
+	float Value;
+	bool Recovery;
+};
+
+// DeviceStatus fields used for notifications, cached until the DeviceStatus update hook sees a write to the device
+struct _tNotificationDeviceMeta
+{
+	std::string SwitchType;
+	std::string CustomImage;
+	std::string Options;
+	double AddjMulti;
 };
 
 class CNotificationHelper
@@ -47,6 +73,7 @@ class CNotificationHelper
 	bool CustomRecoveryMessage(uint64_t ID, std::string &msg, bool isRecovery);
 	bool HasNotifications(uint64_t DevIdx);
 	bool HasNotifications(const std::string &DevIdx);
+	void InvalidateDeviceMeta(uint64_t DevIdx);
 
 	bool CheckAndHandleNotification(uint64_t DevRowIdx, int HardwareID, const std::string &ID, const std::string &sName, unsigned char unit, unsigned char cType, unsigned char cSubType,
 					int nValue);
@@ -81,9 +108,17 @@ class CNotificationHelper
 	bool CheckAndHandleAmpere123Notification(uint64_t Idx, const std::string &DeviceName, float Ampere1, float Ampere2, float Ampere3);
 
 	std::string ParseCustomMessage(const std::string &cMessage, const std::string &sName, const std::string &sValue);
-	bool ApplyRule(const std::string &rule, bool equal, bool less);
+	bool ApplyRule(_eNotificationRule rule, bool equal, bool less);
+	_tNotification *FindNotification(uint64_t ID);
+	bool GetDeviceMeta(uint64_t DevIdx, _tNotificationDeviceMeta &meta);
+	bool GetRainBaseline(uint64_t DevIdx, const std::string &szDate, float mvalue, float &total_min);
 	std::mutex m_mutex;
-	std::map<uint64_t, std::vector<_tNotification>> m_notifications;
+	std::unordered_map<uint64_t, std::vector<_tNotification>> m_notifications;
+	std::unordered_map<uint64_t, uint64_t> m_notification_devices; // notification ID -> DeviceRowID
+	std::mutex m_metamutex;
+	std::unordered_map<uint64_t, _tNotificationDeviceMeta> m_devicemeta;
+	uint64_t m_devicemeta_generation{ 0 };
+	std::unordered_map<uint64_t, std::pair<std::string, float>> m_rainbaseline; // DeviceRowID -> (date, MIN(Total) of that day)
 	int m_NotificationSensorInterval;
 	int m_NotificationSwitchInterval;
 };
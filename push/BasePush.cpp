@@ -7,6 +7,7 @@
 #include "../main/RFXtrx.h"
 #include "../main/SQLHelper.h"
 #include "../main/WebServer.h"
+#include "../main/localtime_r.h"
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -374,8 +375,15 @@ const char* RFX_Type_SubType_Values(const unsigned char dType, const unsigned ch
 	return findTableID1ID2(Table, dType, sType);
 }
 
+std::atomic<int> CBasePush::m_DevicesGeneration{ 0 };
+std::mutex CBasePush::m_value_mutex;
+std::map<uint64_t, CBasePush::_tDeviceValue> CBasePush::m_device_values;
+uint64_t CBasePush::m_device_values_generation = 0;
+std::map<uint64_t, uint32_t> CBasePush::m_linked_devices;
+
 CBasePush::CBasePush()
 {
+	m_PushType = PushType::PUSHTYPE_UNKNOWN;
 	m_bLinkActive = false;
 }
 
@@ -899,12 +907,20 @@ std::string CBasePush::getUnit(const int devType, const int devSubType, const in
 void CBasePush::ReloadPushLinks(const PushType PType)
 {
 	std::lock_guard<std::mutex> l(m_link_mutex);
+	m_PushType = PType;
+	ReloadPushLinksInt();
+}
+
+void CBasePush::ReloadPushLinksInt()
+{
+	m_LinksGeneration = m_DevicesGeneration;
 	m_pushlinks.clear();
 	std::vector<std::vector<std::string>> result;
-	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Name, B.Type, B.SubType, B.SwitchType "
+	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Name, B.Type, B.SubType, B.SwitchType, "
+		"A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, A.IncludeUnit "
 		"FROM PushLink as A, DeviceStatus as B "
 		"WHERE (A.PushType==%d AND A.Enabled==1 AND A.DeviceRowID == B.ID)",
-		PType);
+		m_PushType);
 	for (const auto& sd : result)
 	{
 		_tPushLinks tlink;
@@ -914,28 +930,121 @@ void CBasePush::ReloadPushLinks(const PushType PType)
 		tlink.devType = std::stoi(sd[4]);
 		tlink.devSubType = std::stoi(sd[5]);
 		tlink.metertype = std::stoi(sd[6]);
-		m_pushlinks.push_back(tlink);
+		tlink.pushType = m_PushType;
+		tlink.TargetType = std::stoi(sd[7]);
+		tlink.TargetVariable = sd[8];
+		tlink.TargetDeviceID = sd[9];
+		tlink.TargetProperty = sd[10];
+		tlink.IncludeUnit = std::stoi(sd[11]);
+		m_pushlinks[tlink.DeviceRowIdx].push_back(tlink);
 	}
+
+	// Let the value cache know which devices we are interested in
+	uint32_t typeMask = 1U << static_cast<int>(m_PushType);
+	std::lock_guard<std::mutex> l(m_value_mutex);
+	for (auto itt = m_linked_devices.begin(); itt != m_linked_devices.end();)
+	{
+		itt->second &= ~typeMask;
+		if (itt->second == 0)
+		{
+			m_device_values.erase(itt->first);
+			itt = m_linked_devices.erase(itt);
+		}
+		else
+			++itt;
+	}
+	for (const auto& itt : m_pushlinks)
+		m_linked_devices[itt.first] |= typeMask;
+}
+
+void CBasePush::CheckLinksUpToDate()
+{
+	// m_link_mutex should be locked
+	if (m_LinksGeneration != m_DevicesGeneration)
+		ReloadPushLinksInt();
 }
 
 bool CBasePush::IsLinkInDatabase(const uint64_t DeviceRowIdx)
 {
 	std::lock_guard<std::mutex> l(m_link_mutex);
-	return std::any_of(m_pushlinks.begin(), m_pushlinks.end(), [&](const _tPushLinks& val) { return DeviceRowIdx == val.DeviceRowIdx; });
+	CheckLinksUpToDate();
+	return (m_pushlinks.find(DeviceRowIdx) != m_pushlinks.end());
 }
 
 bool CBasePush::GetPushLink(const uint64_t DeviceRowIdx, _tPushLinks& plink)
 {
 	std::lock_guard<std::mutex> l(m_link_mutex);
-	for (const auto& itt : m_pushlinks)
+	CheckLinksUpToDate();
+	auto itt = m_pushlinks.find(DeviceRowIdx);
+	if (itt == m_pushlinks.end())
+		return false;
+	plink = itt->second.front();
+	return true;
+}
+
+bool CBasePush::GetPushLinks(const uint64_t DeviceRowIdx, std::vector<_tPushLinks>& plinks)
+{
+	std::lock_guard<std::mutex> l(m_link_mutex);
+	CheckLinksUpToDate();
+	auto itt = m_pushlinks.find(DeviceRowIdx);
+	if (itt == m_pushlinks.end())
+		return false;
+	plinks = itt->second;
+	return true;
+}
+
+// STATIC
+void CBasePush::SetDeviceValue(const uint64_t DeviceRowIdx, const int nValue, const std::string& sValue)
+{
+	std::lock_guard<std::mutex> l(m_value_mutex);
+	if (m_linked_devices.find(DeviceRowIdx) == m_linked_devices.end())
+		return;
+	_tDeviceValue& dValue = m_device_values[DeviceRowIdx];
+	dValue.nValue = nValue;
+	dValue.sValue = sValue;
+	dValue.LastUpdate = mytime(nullptr);
+}
+
+// STATIC
+void CBasePush::InvalidateDevice(const uint64_t DeviceRowIdx, const bool bConfigChanged)
+{
+	{
+		std::lock_guard<std::mutex> l(m_value_mutex);
+		m_device_values.erase(DeviceRowIdx);
+		m_device_values_generation++;
+		if ((!bConfigChanged) || (m_linked_devices.find(DeviceRowIdx) == m_linked_devices.end()))
+			return;
+	}
+	// Name/Type/SwitchType could have been changed, links will be reloaded on next use
+	m_DevicesGeneration++;
+}
+
+// STATIC
+bool CBasePush::GetDeviceValue(const uint64_t DeviceRowIdx, _tDeviceValue& dValue)
+{
+	uint64_t generation;
 	{
-		if (itt.DeviceRowIdx == DeviceRowIdx)
+		std::lock_guard<std::mutex> l(m_value_mutex);
+		auto itt = m_device_values.find(DeviceRowIdx);
+		if (itt != m_device_values.end())
 		{
-			plink = itt;
+			dValue = itt->second;
 			return true;
 		}
+		generation = m_device_values_generation;
 	}
-	return false;
+	// Not seen since startup (or invalidated by a write), get it from the database once
+	auto result = m_sql.safe_queryWriter("SELECT nValue, sValue, strftime('%%s', LastUpdate) FROM DeviceStatus WHERE (ID == %" PRIu64 ")", DeviceRowIdx);
+	if (result.empty())
+		return false;
+	dValue.nValue = atoi(result[0][0].c_str());
+	dValue.sValue = result[0][1];
+	dValue.LastUpdate = static_cast<time_t>(atoll(result[0][2].c_str())) - get_tzoffset(); // LastUpdate is stored in local time
+
+	std::lock_guard<std::mutex> l(m_value_mutex);
+	if ((generation == m_device_values_generation) && (m_linked_devices.find(DeviceRowIdx) != m_linked_devices.end()))
+		m_device_values.insert(std::make_pair(DeviceRowIdx, dValue)); // don't overwrite a newer value set in the meantime
+	return true;
 }
 
 
@@ -3,6 +3,7 @@
 #define BOOST_ALLOW_DEPRECATED_HEADERS
 #include <boost/signals2.hpp>
 #include "../main/StoppableTask.h"
+#include <atomic>
 #include <mutex>
 
 class CBasePush : public StoppableTask
@@ -26,6 +27,17 @@ public:
 		int devSubType;
 		int metertype;
 		PushType pushType;
+		int TargetType;
+		std::string TargetVariable;
+		std::string TargetDeviceID;
+		std::string TargetProperty;
+		int IncludeUnit;
+	};
+	struct _tDeviceValue
+	{
+		int nValue;
+		std::string sValue;
+		time_t LastUpdate;
 	};
 
 	CBasePush();
@@ -36,6 +48,12 @@ public:
 
 	void ReloadPushLinks(const PushType PType);
 	bool GetPushLink(const uint64_t DeviceRowIdx, _tPushLinks& plink);
+	bool GetPushLinks(const uint64_t DeviceRowIdx, std::vector<_tPushLinks>& plinks);
+
+	// Last value of linked devices, shared by all push targets so pushing does not need to query the database
+	static void SetDeviceValue(const uint64_t DeviceRowIdx, const int nValue, const std::string& sValue);
+	// Values are invalidated by the DeviceStatus update hook, call with bConfigChanged when a device was renamed, type changed or deleted
+	static void InvalidateDevice(const uint64_t DeviceRowIdx, const bool bConfigChanged = true);
 
 protected:
 	PushType m_PushType;
@@ -53,10 +71,21 @@ protected:
 	static void replaceAll(std::string& context, const std::string& from, const std::string& to);
 
 	bool IsLinkInDatabase(const uint64_t DeviceRowIdx);
+	static bool GetDeviceValue(const uint64_t DeviceRowIdx, _tDeviceValue& dValue);
 
 	std::mutex m_link_mutex;
 
 private:
-	std::vector<_tPushLinks> m_pushlinks;
+	void ReloadPushLinksInt();
+	void CheckLinksUpToDate();
+
+	std::map<uint64_t, std::vector<_tPushLinks>> m_pushlinks;
+	int m_LinksGeneration{ 0 };
+
+	static std::atomic<int> m_DevicesGeneration;
+	static std::mutex m_value_mutex;
+	static std::map<uint64_t, _tDeviceValue> m_device_values;
+	static uint64_t m_device_values_generation; // bumped on invalidation, a value read from the database before that is not cached
+	static std::map<uint64_t, uint32_t> m_linked_devices; // bitmask of PushTypes linking this device
 };
 
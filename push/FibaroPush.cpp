@@ -52,12 +52,11 @@ void CFibaroPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowId
 
 void CFibaroPush::DoFibaroPush(const uint64_t DeviceRowIdx)
 {
-	std::vector<std::vector<std::string>> result;
-	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, "
-				  "A.IncludeUnit, B.SwitchType FROM PushLink as A, DeviceStatus as B "
-				  "WHERE (A.PushType==%d AND A.DeviceRowID == '%" PRIu64 "' AND A.Enabled = '1' AND A.DeviceRowID==B.ID)",
-				  PushType::PUSHTYPE_FIBARO, DeviceRowIdx);
-	if (result.empty())
+	std::vector<_tPushLinks> links;
+	if (!GetPushLinks(DeviceRowIdx, links))
+		return;
+	_tDeviceValue dValue;
+	if (!GetDeviceValue(DeviceRowIdx, dValue))
 		return;
 
 	std::string fibaroIP;
@@ -80,20 +79,20 @@ void CFibaroPush::DoFibaroPush(const uint64_t DeviceRowIdx)
 
 	if ((fibaroIP.empty()) || (fibaroUsername.empty()) || (fibaroPassword.empty()))
 		return;
-	for (const auto &sd : result)
+	for (const auto &link : links)
 	{
 		std::string sendValue;
-		int delpos = atoi(sd[1].c_str());
-		int dType = atoi(sd[3].c_str());
-		int dSubType = atoi(sd[4].c_str());
-		int nValue = atoi(sd[5].c_str());
-		std::string sValue = sd[6];
-		int targetType = atoi(sd[7].c_str());
-		std::string targetVariable = sd[8];
-		int targetDeviceID = atoi(sd[9].c_str());
-		std::string targetProperty = sd[10];
-		int includeUnit = atoi(sd[11].c_str());
-		int metertype = atoi(sd[12].c_str());
+		int delpos = link.DelimiterPos;
+		int dType = link.devType;
+		int dSubType = link.devSubType;
+		int nValue = dValue.nValue;
+		std::string sValue = dValue.sValue;
+		int targetType = link.TargetType;
+		std::string targetVariable = link.TargetVariable;
+		int targetDeviceID = atoi(link.TargetDeviceID.c_str());
+		std::string targetProperty = link.TargetProperty;
+		int includeUnit = link.IncludeUnit;
+		int metertype = link.metertype;
 		std::string lstatus;
 
 		if ((targetType == 0) || (targetType == 1)) {
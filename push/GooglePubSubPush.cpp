@@ -103,12 +103,11 @@ boost::python::dict toPythonDict(std::map<K, V> map) {
 
 void CGooglePubSubPush::DoGooglePubSubPush(const uint64_t DeviceRowIdx)
 {
-	std::vector<std::vector<std::string>> result;
-	result = m_sql.safe_query("SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, "
-				  "A.IncludeUnit, B.SwitchType, strftime('%%s', B.LastUpdate), B.Name FROM PushLink as A, DeviceStatus as B "
-				  "WHERE (A.PushType==%d AND A.DeviceRowID == '%" PRIu64 "' AND A.Enabled = '1' AND A.DeviceRowID==B.ID)",
-				  PushType::PUSHTYPE_GOOGLE_PUB_SUB, DeviceRowIdx);
-	if (result.empty())
+	std::vector<_tPushLinks> links;
+	if (!GetPushLinks(DeviceRowIdx, links))
+		return;
+	_tDeviceValue dValue;
+	if (!GetDeviceValue(DeviceRowIdx, dValue))
 		return;
 
 	std::string googlePubSubData;
@@ -121,7 +120,7 @@ void CGooglePubSubPush::DoGooglePubSubPush(const uint64_t DeviceRowIdx)
 		googlePubSubDebugActive = true;
 	}
 #endif
-	for (const auto &sd : result)
+	for (const auto &link : links)
 	{
 		std::string sendValue;
 
@@ -130,28 +129,25 @@ void CGooglePubSubPush::DoGooglePubSubPush(const uint64_t DeviceRowIdx)
 			return;
 
 
-		std::string sdeviceId = sd[0];
-		std::string ldelpos = sd[1];
-		int delpos = atoi(sd[1].c_str());
-		int dType = atoi(sd[3].c_str());
-		int dSubType = atoi(sd[4].c_str());
-		int nValue = atoi(sd[5].c_str());
-		std::string sValue = sd[6];
-		//int targetType = atoi(sd[7].c_str());
-		std::string targetVariable = sd[8];
-		//int targetDeviceID = atoi(sd[9].c_str());
-		std::string targetProperty = sd[10];
-		int includeUnit = atoi(sd[11].c_str());
-		int metertype = atoi(sd[12].c_str());
-		int lastUpdate = atoi(sd[13].c_str());
-		std::string ltargetVariable = sd[8];
-		std::string ltargetDeviceId = sd[9];
-		std::string lname = sd[14];
+		std::string sdeviceId = std::to_string(DeviceRowIdx);
+		std::string ldelpos = std::to_string(link.DelimiterPos);
+		int delpos = link.DelimiterPos;
+		int dType = link.devType;
+		int dSubType = link.devSubType;
+		int nValue = dValue.nValue;
+		std::string sValue = dValue.sValue;
+		std::string targetVariable = link.TargetVariable;
+		std::string targetProperty = link.TargetProperty;
+		int includeUnit = link.IncludeUnit;
+		int metertype = link.metertype;
+		std::string ltargetVariable = link.TargetVariable;
+		std::string ltargetDeviceId = link.TargetDeviceID;
+		std::string lname = link.DeviceName;
 		sendValue = sValue;
 
 		unsigned long tzoffset = get_tzoffset();
-		uint64_t localTime = lastUpdate;
-		uint64_t localTimeUtc = localTime - tzoffset;
+		uint64_t localTimeUtc = dValue.LastUpdate;
+		uint64_t localTime = localTimeUtc + tzoffset;
 
 		char szLocalTime[21];
 		sprintf(szLocalTime, "%" PRIu64, localTime);
@@ -13,10 +13,19 @@
 #include "../webserver/Base64.h"
 #include "../webserver/cWebem.h"
 #include "../main/localtime_r.h"
+#include "../webserver/GZipHelper.h"
+#include <fstream>
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
+#define INFLUX_MAX_QUEUE_ITEMS 10000			// in-memory items, oldest are dropped when the worker can't keep up
+#define INFLUX_MAX_BATCH_BYTES (256 * 1024)		// maximum (uncompressed) size of one write request
+#define INFLUX_MIN_GZIP_BYTES 1024				// smaller requests are sent uncompressed
+#define INFLUX_MAX_SPOOL_BYTES (64 * 1024 * 1024)	// maximum size of the on-disk spool file
+#define INFLUX_MAX_RETRY_DELAY 300				// seconds
+
 extern CInfluxPush m_influxpush;
+extern std::string szUserDataFolder;
 
 CInfluxPush::CInfluxPush()
 {
@@ -30,6 +39,13 @@ bool CInfluxPush::Start()
 
 	RequestStart();
 
+	// Values that could not be sent are kept in an append-only spool file and retried later.
+	// A spool left over from a previous run is sent again completely, InfluxDB overwrites points with identical timestamps.
+	m_szSpoolFile = szUserDataFolder + "influxpush.spool";
+	m_SpoolReadPos = 0;
+	m_RetryDelay = 0;
+	m_NextRetry = 0;
+
 	UpdateSettings();
 	ReloadPushLinks(m_PushType);
 
@@ -118,30 +134,26 @@ void CInfluxPush::DoInfluxPush(const uint64_t DeviceRowIdx, const bool bForced)
 {
 	if (!m_bLinkActive)
 		return;
-	if (!IsLinkInDatabase(DeviceRowIdx))
+	std::vector<_tPushLinks> links;
+	if (!GetPushLinks(DeviceRowIdx, links))
 		return;
-
-	std::vector<std::vector<std::string>> result;
-	result = m_sql.safe_query(
-		"SELECT A.DeviceRowID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.IncludeUnit, B.Name, B.SwitchType FROM PushLink as A, DeviceStatus as B "
-		"WHERE (A.PushType==%d AND A.DeviceRowID == '%" PRIu64 "' AND A.Enabled==1 AND A.DeviceRowID==B.ID)",
-		PushType::PUSHTYPE_INFLUXDB, DeviceRowIdx);
-	if (result.empty())
+	_tDeviceValue dValue;
+	if (!GetDeviceValue(DeviceRowIdx, dValue))
 		return;
 
 	time_t atime = mytime(nullptr);
-	for (const auto &sd : result)
+	for (const auto &link : links)
 	{
 		std::string sendValue;
-		int delpos = atoi(sd[1].c_str());
-		int dType = atoi(sd[3].c_str());
-		int dSubType = atoi(sd[4].c_str());
-		int nValue = atoi(sd[5].c_str());
-		std::string sValue = sd[6];
-		int targetType = atoi(sd[7].c_str());
-		int includeUnit = atoi(sd[8].c_str());
-		std::string name = sd[9];
-		int metertype = atoi(sd[10].c_str());
+		int delpos = link.DelimiterPos;
+		int dType = link.devType;
+		int dSubType = link.devSubType;
+		int nValue = dValue.nValue;
+		const std::string &sValue = dValue.sValue;
+		int targetType = link.TargetType;
+		int includeUnit = link.IncludeUnit;
+		std::string name = link.DeviceName;
+		int metertype = link.metertype;
 
 		std::vector<std::string> strarray;
 		if (sValue.find(';') != std::string::npos)
@@ -163,7 +175,7 @@ void CInfluxPush::DoInfluxPush(const uint64_t DeviceRowIdx, const bool bForced)
 		std::string vType = CBasePush::DropdownOptionsValue(dType, dSubType, delpos);
 		stdreplace(vType, " ", "-");
 		stdreplace(name, " ", "-");
-		szKey = vType + ",idx=" + sd[0] + ",name=" + name;
+		szKey = vType + ",idx=" + std::to_string(DeviceRowIdx) + ",name=" + name;
 
 		_tPushItem pItem;
 		pItem.skey = szKey;
@@ -183,83 +195,248 @@ void CInfluxPush::DoInfluxPush(const uint64_t DeviceRowIdx, const bool bForced)
 		}
 
 		std::lock_guard<std::mutex> l(m_background_task_mutex);
-		if (m_background_task_queue.size() < 50)
-			m_background_task_queue.push_back(pItem);
+		if (m_background_task_queue.size() >= INFLUX_MAX_QUEUE_ITEMS)
+		{
+			m_background_task_queue.pop_front();
+			m_DroppedItems++;
+		}
+		m_background_task_queue.push_back(pItem);
 	}
 }
 
+void CInfluxPush::AppendLineProtocol(std::string &sLines, const _tPushItem &item)
+{
+	size_t startPos = sLines.size();
+	sLines += item.skey;
+	sLines += " value=";
+	sLines += item.svalue;
+	if (m_bInfluxDebugActive)
+	{
+		_log.Log(LOG_NORM, "InfluxLink: value %s", sLines.c_str() + startPos);
+	}
+	sLines += ' ';
+	sLines += std::to_string(item.stimestamp);
+	sLines += '\n';
+}
+
 void CInfluxPush::Do_Work()
 {
-	std::vector<_tPushItem> _items2do;
+	m_sql.SetThreadReadPool(true);
+	std::deque<_tPushItem> _items2do;
+	std::string sLines;
 
 	while (!IsStopRequested(500))
 	{
+		size_t nDropped = 0;
 		{ // additional scope for lock (accessing size should be within lock too)
 			std::lock_guard<std::mutex> l(m_background_task_mutex);
-			if (m_background_task_queue.empty())
-				continue;
-			_items2do = m_background_task_queue;
-			m_background_task_queue.clear();
+			_items2do.swap(m_background_task_queue);
+			nDropped = m_DroppedItems;
+			m_DroppedItems = 0;
 		}
+		if (nDropped != 0)
+			_log.Log(LOG_ERROR, "InfluxLink: Queue full, %d values dropped!", static_cast<int>(nDropped));
 
 		if (m_szURL.empty())
+		{
+			_items2do.clear();
 			continue;
+		}
 
-		std::string sSendData;
-
+		sLines.clear();
 		for (const auto &item : _items2do)
+			AppendLineProtocol(sLines, item);
+		_items2do.clear();
+
+		time_t atime = mytime(nullptr);
+		bool bInBackoff = (atime < m_NextRetry);
+
+		// Keep the order of the values, when older values are waiting in the spool (or we can't send), new ones go there as well
+		if ((bInBackoff) || (HaveSpoolData()))
 		{
-			if (!sSendData.empty())
-				sSendData += '\n';
+			if (!sLines.empty())
+				AppendToSpool(sLines);
+			if (bInBackoff)
+				continue;
 
-			std::stringstream sziData;
-			sziData << item.skey << " value=" << item.svalue;
-			if (m_bInfluxDebugActive)
+			while ((!IsStopRequested(0)) && (HaveSpoolData()))
 			{
-				_log.Log(LOG_NORM, "InfluxLink: value %s", sziData.str().c_str());
+				std::string sSpoolLines;
+				std::streamoff nextPos = 0;
+				if (!ReadSpoolBatch(sSpoolLines, nextPos))
+					break;
+				_ePostResult pResult = PostData(sSpoolLines);
+				if (pResult == _ePostResult::POST_RETRY)
+				{
+					HandleFailure();
+					break;
+				}
+				ConsumeSpool(nextPos);
+				m_RetryDelay = 0;
 			}
-			sziData << " " << item.stimestamp;
-			sSendData += sziData.str();
+			continue;
 		}
-		std::vector<std::string> ExtraHeaders;
-		std::string sResult;
-		if (m_bInfluxVersion2)
+
+		// Send directly, in batches limited in size
+		size_t startPos = 0;
+		while (startPos < sLines.size())
 		{
-			ExtraHeaders.push_back("Authorization: Token " + base64_decode(m_InfluxPassword));
-			ExtraHeaders.push_back("Content-type: text/plain");
+			size_t endPos = sLines.size();
+			if (endPos - startPos > INFLUX_MAX_BATCH_BYTES)
+			{
+				endPos = sLines.rfind('\n', startPos + INFLUX_MAX_BATCH_BYTES - 1);
+				if ((endPos == std::string::npos) || (endPos < startPos))
+					endPos = sLines.find('\n', startPos + INFLUX_MAX_BATCH_BYTES - 1);
+				endPos = (endPos == std::string::npos) ? sLines.size() : endPos + 1;
+			}
+			_ePostResult pResult = PostData(sLines.substr(startPos, endPos - startPos));
+			if (pResult == _ePostResult::POST_RETRY)
+			{
+				AppendToSpool(sLines.substr(startPos));
+				HandleFailure();
+				break;
+			}
+			m_RetryDelay = 0;
+			startPos = endPos;
 		}
+	}
+}
+
+CInfluxPush::_ePostResult CInfluxPush::PostData(const std::string &sSendData)
+{
+	std::vector<std::string> ExtraHeaders;
+	std::vector<std::string> vHeaderData;
+	std::string sResult;
+	if (m_bInfluxVersion2)
+	{
+		ExtraHeaders.push_back("Authorization: Token " + base64_decode(m_InfluxPassword));
+		ExtraHeaders.push_back("Content-type: text/plain");
+	}
 
-		bool bRet = HTTPClient::POST(m_szURL, sSendData, ExtraHeaders, sResult, true, true);
-		if (!bRet)
+	bool bRet;
+	if (sSendData.size() >= INFLUX_MIN_GZIP_BYTES)
+	{
+		CA2GZIP gzip((char *)sSendData.c_str(), (int)sSendData.size());
+		if ((gzip.Length > 0) && (gzip.Length < (int)sSendData.size()))
 		{
-			_log.Log(LOG_ERROR, "InfluxLink: Error sending data to InfluxDB server! (check address/port/database/username/password)");
+			ExtraHeaders.push_back("Content-Encoding: gzip");
+			bRet = HTTPClient::POST(m_szURL, std::string((char *)gzip.pgzip, gzip.Length), ExtraHeaders, sResult, vHeaderData, true, true);
 		}
-		else if (!sResult.empty())
+		else
+			bRet = HTTPClient::POST(m_szURL, sSendData, ExtraHeaders, sResult, vHeaderData, true, true);
+	}
+	else
+		bRet = HTTPClient::POST(m_szURL, sSendData, ExtraHeaders, sResult, vHeaderData, true, true);
+
+	if (!bRet)
+	{
+		_log.Log(LOG_ERROR, "InfluxLink: Error sending data to InfluxDB server! (check address/port/database/username/password)");
+		return _ePostResult::POST_RETRY;
+	}
+
+	// The last status line is the one of the final response (after redirects)
+	int httpCode = 0;
+	for (const auto &hline : vHeaderData)
+	{
+		if (hline.find("HTTP/") == 0)
 		{
-			Json::Value root;
-			bool ret = ParseJSon(sResult, root);
-			if (root.isObject())
-			{
-				if (!root["code"].empty())
-				{
-					std::string szCode = root["code"].asString();
-					bool bHaveError = false;
-					std::string szMessage;
-
-					if (szCode == "unauthorized")
-					{
-						bHaveError = true;
-						szMessage = root["message"].asString();
-					}
-
-					if (bHaveError)
-					{
-						_log.Log(LOG_ERROR, "InfluxLink: Error sending data to InfluxDB server! (%s)", szMessage.c_str());
-					}
-				}
-			}
+			size_t pos = hline.find(' ');
+			if (pos != std::string::npos)
+				httpCode = atoi(hline.c_str() + pos + 1);
+		}
+	}
+
+	if ((httpCode == 0) || ((httpCode >= 200) && (httpCode < 300)))
+		return _ePostResult::POST_OK;
+
+	std::string szMessage = "HTTP " + std::to_string(httpCode);
+	if (!sResult.empty())
+	{
+		Json::Value root;
+		bool ret = ParseJSon(sResult, root);
+		if ((ret) && (root.isObject()))
+		{
+			if (!root["message"].empty())
+				szMessage += ", " + root["message"].asString();
+			else if (!root["error"].empty())
+				szMessage += ", " + root["error"].asString();
 		}
 	}
+
+	if ((httpCode >= 500) || (httpCode == 408) || (httpCode == 429))
+	{
+		_log.Log(LOG_ERROR, "InfluxLink: InfluxDB server not available, will retry! (%s)", szMessage.c_str());
+		return _ePostResult::POST_RETRY;
+	}
+	_log.Log(LOG_ERROR, "InfluxLink: Error sending data to InfluxDB server, data dropped! (%s)", szMessage.c_str());
+	return _ePostResult::POST_REJECTED;
+}
+
+void CInfluxPush::HandleFailure()
+{
+	m_RetryDelay = (m_RetryDelay == 0) ? 2 : std::min(m_RetryDelay * 2, INFLUX_MAX_RETRY_DELAY);
+	m_NextRetry = mytime(nullptr) + m_RetryDelay;
+	if (m_bInfluxDebugActive)
+	{
+		_log.Log(LOG_NORM, "InfluxLink: retrying in %d seconds", m_RetryDelay);
+	}
+}
+
+bool CInfluxPush::HaveSpoolData()
+{
+	std::ifstream infile(m_szSpoolFile, std::ios::binary | std::ios::ate);
+	if (!infile.is_open())
+		return false;
+	return (infile.tellg() > m_SpoolReadPos);
+}
+
+void CInfluxPush::AppendToSpool(const std::string &sLines)
+{
+	std::ofstream outfile(m_szSpoolFile, std::ios::binary | std::ios::app);
+	if (!outfile.is_open())
+	{
+		_log.Log(LOG_ERROR, "InfluxLink: Unable to open spool file (%s), data lost!", m_szSpoolFile.c_str());
+		return;
+	}
+	if (outfile.tellp() + static_cast<std::streamoff>(sLines.size()) > INFLUX_MAX_SPOOL_BYTES)
+	{
+		_log.Log(LOG_ERROR, "InfluxLink: Spool file full, data lost!");
+		return;
+	}
+	outfile.write(sLines.c_str(), sLines.size());
+}
+
+bool CInfluxPush::ReadSpoolBatch(std::string &sLines, std::streamoff &nextPos)
+{
+	std::ifstream infile(m_szSpoolFile, std::ios::binary);
+	if (!infile.is_open())
+		return false;
+	infile.seekg(m_SpoolReadPos);
+	sLines.resize(INFLUX_MAX_BATCH_BYTES);
+	infile.read(&sLines[0], INFLUX_MAX_BATCH_BYTES);
+	sLines.resize(static_cast<size_t>(infile.gcount()));
+	if (sLines.empty())
+		return false;
+	if (!infile.eof())
+	{
+		// only send complete lines
+		size_t pos = sLines.rfind('\n');
+		if (pos != std::string::npos)
+			sLines.resize(pos + 1);
+	}
+	nextPos = m_SpoolReadPos + static_cast<std::streamoff>(sLines.size());
+	return true;
+}
+
+void CInfluxPush::ConsumeSpool(std::streamoff nextPos)
+{
+	m_SpoolReadPos = nextPos;
+	if (!HaveSpoolData())
+	{
+		// Everything is sent, start over with an empty spool
+		std::remove(m_szSpoolFile.c_str());
+		m_SpoolReadPos = 0;
+	}
 }
 
 // Webserver helpers
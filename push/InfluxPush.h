@@ -1,5 +1,6 @@
 #pragma once
 #include "BasePush.h"
+#include <deque>
 
 class CInfluxPush : public CBasePush
 {
@@ -16,14 +17,31 @@ private:
 		time_t stimestamp;
 		std::string svalue;
 	};
+	enum class _ePostResult
+	{
+		POST_OK = 0,
+		POST_RETRY,  // connection problem or server busy, try again later
+		POST_REJECTED // server refused the data, retrying will not help
+	};
 	void OnDeviceReceived(int m_HwdID, uint64_t DeviceRowIdx, const std::string& DeviceName, const unsigned char* pRXCommand);
 
 	std::shared_ptr<std::thread> m_thread;
 	std::mutex m_background_task_mutex;
 	void Do_Work();
 
+	void AppendLineProtocol(std::string &sLines, const _tPushItem &item);
+	_ePostResult PostData(const std::string &sSendData);
+	void HandleFailure();
+
+	// on-disk spool
+	bool HaveSpoolData();
+	void AppendToSpool(const std::string &sLines);
+	bool ReadSpoolBatch(std::string &sLines, std::streamoff &nextPos);
+	void ConsumeSpool(std::streamoff nextPos);
+
 	std::map<std::string, _tPushItem> m_PushedItems;
-	std::vector<_tPushItem> m_background_task_queue;
+	std::deque<_tPushItem> m_background_task_queue;
+	size_t m_DroppedItems{ 0 };
 	std::string m_szURL;
 	std::string m_InfluxIP;
 	int m_InfluxPort{ 8086 };
@@ -33,5 +51,10 @@ private:
 	std::string m_InfluxUsername;
 	std::string m_InfluxPassword;
 	bool m_bInfluxDebugActive{ false };
+
+	std::string m_szSpoolFile;
+	std::streamoff m_SpoolReadPos{ 0 };
+	int m_RetryDelay{ 0 };
+	time_t m_NextRetry{ 0 };
 };
 extern CInfluxPush m_influxpush;
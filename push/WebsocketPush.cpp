@@ -10,6 +10,7 @@ CWebSocketPush::CWebSocketPush(http::server::CWebsocketHandler *sock)
 	m_PushType = PushType::PUSHTYPE_WEBSOCKET;
 	listenRoomplan = false;
 	listenDeviceTable = false;
+	listenLiveValues = false;
 	m_sock = sock;
 	isStarted = false;
 }
@@ -21,6 +22,8 @@ void CWebSocketPush::Start()
 	}
 	m_sConnection = m_mainworker.sOnDeviceReceived.connect([this](auto id, auto idx, auto &&name, auto rx) { OnDeviceReceived(id, idx, name, rx); });
 	m_sDeviceUpdate = m_mainworker.sOnDeviceUpdate.connect([this](auto id, auto idx) { OnDeviceUpdate(id, idx); });
+	m_sDeviceBatch = m_mainworker.sOnDeviceBatchReceived.connect([this](auto id, auto tstart) { OnDeviceBatchReceived(id, tstart); });
+	m_sDeviceLive = m_mainworker.sOnDeviceLiveValue.connect([this](auto id, auto idx, auto nvalue, auto &&svalue) { OnDeviceLiveValue(id, idx, nvalue, svalue); });
 	m_sNotification = sOnNotificationReceived.connect([this](auto &&s, auto &&t, auto &&e, auto p, auto &&sound, auto n) { OnNotificationReceived(s, t, e, p, sound, n); });
 	m_sSceneChanged = m_mainworker.sOnSwitchScene.connect([this](auto idx, auto &&name) { OnSceneChange(idx, name); });
 	isStarted = true;
@@ -39,6 +42,12 @@ void CWebSocketPush::Stop()
 	if (m_sDeviceUpdate.connected())
 		m_sDeviceUpdate.disconnect();
 
+	if (m_sDeviceBatch.connected())
+		m_sDeviceBatch.disconnect();
+
+	if (m_sDeviceLive.connected())
+		m_sDeviceLive.disconnect();
+
 	if (m_sNotification.connected())
 		m_sNotification.disconnect();
 
@@ -46,6 +55,7 @@ void CWebSocketPush::Stop()
 		m_sSceneChanged.disconnect();
 
 	isStarted = false;
+	listenLiveValues = false;
 	ClearListenTable();
 }
 
@@ -90,6 +100,16 @@ void CWebSocketPush::UnlistenToDeviceTable()
 	listenDeviceTable = false;
 }
 
+void CWebSocketPush::ListenToLiveValues()
+{
+	listenLiveValues = true;
+}
+
+void CWebSocketPush::UnlistenToLiveValues()
+{
+	listenLiveValues = false;
+}
+
 void CWebSocketPush::onRoomplanChanged()
 {
 	if (listenRoomplan) {
@@ -116,6 +136,9 @@ void CWebSocketPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRo
 	if (!isStarted) {
 		return;
 	}
+	if (m_mainworker.IsProcessingRxBatch()) {
+		return; // sent as one update by OnDeviceBatchReceived
+	}
 
 	m_sock->OnDeviceChanged(DeviceRowIdx);
 	if (WeListenTo(DeviceRowIdx)) {
@@ -123,6 +146,27 @@ void CWebSocketPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRo
 	}
 }
 
+void CWebSocketPush::OnDeviceBatchReceived(const int m_HwdID, const time_t BatchStart)
+{
+	std::unique_lock<std::mutex> lock(handlerMutex);
+	if (!isStarted) {
+		return;
+	}
+	m_sock->OnDevicesChanged(m_HwdID, BatchStart);
+}
+
+void CWebSocketPush::OnDeviceLiveValue(const int m_HwdID, const uint64_t DeviceRowIdx, const int nValue, const std::string &sValue)
+{
+	if (!listenLiveValues) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(handlerMutex);
+	if (!isStarted) {
+		return;
+	}
+	m_sock->SendDeviceLiveValue(DeviceRowIdx, nValue, sValue);
+}
+
 void CWebSocketPush::OnDeviceUpdate(const int m_HwdID, const uint64_t DeviceRowIdx)
 {
 	std::unique_lock<std::mutex> lock(handlerMutex);
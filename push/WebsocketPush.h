@@ -20,6 +20,9 @@ public:
 	void UnlistenToRoomplan();
 	void ListenToDeviceTable();
 	void UnlistenToDeviceTable();
+	// The values held back by RX coalescing are only sent to clients that subscribed to them
+	void ListenToLiveValues();
+	void UnlistenToLiveValues();
 	void onRoomplanChanged();
 	void onDeviceTableChanged(); // device added, or deleted
 	// etc, we need a notification of all changes that need to be reflected in the UI
@@ -28,14 +31,19 @@ public:
       private:
 	void OnDeviceReceived(int m_HwdID, uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
 	void OnDeviceUpdate(int m_HwdID, uint64_t DeviceRowIdx);
+	void OnDeviceBatchReceived(int m_HwdID, time_t BatchStart);
+	void OnDeviceLiveValue(int m_HwdID, uint64_t DeviceRowIdx, int nValue, const std::string &sValue);
 	void OnNotificationReceived(const std::string &Subject, const std::string &Text, const std::string &ExtraData, int Priority, const std::string &Sound, bool bFromNotification);
 	void OnSceneChange(uint64_t SceneRowIdx, const std::string &SceneName);
 	bool listenRoomplan;
 	bool listenDeviceTable;
+	std::atomic<bool> listenLiveValues;
 	std::vector<uint64_t> listenIdxs;
 	std::mutex listenMutex;
 	std::mutex handlerMutex;
 	http::server::CWebsocketHandler *m_sock;
 	bool isStarted;
+	boost::signals2::connection m_sDeviceBatch;
+	boost::signals2::connection m_sDeviceLive;
 };
 
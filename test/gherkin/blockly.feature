@@ -0,0 +1,78 @@
+Feature: Blockly rule evaluation
+    Blockly event conditions of the supported shape are compiled into a predicate tree and evaluated
+    without a Lua state, with the results and errors the Lua interpreter would give. Other conditions
+    are left to Lua. It can be found in main/BlocklyRule.cpp
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test Blockly and binding tighter than or
+        Given I am testing the "blockly" module
+        When I test the function "Evaluate"
+        And I provide the following input "device[1] == "On" or device[2] == "On" and device[3] == "On"|#|device[1]=On;device[2]=Off;device[3]=Off"
+        Then I expect the function to succeed
+        And have the following result "true"
+
+    Scenario: Test Blockly parentheses
+        Given I am testing the "blockly" module
+        When I test the function "Evaluate"
+        And I provide the following input "(device[1] == "On" or device[2] == "On") and device[3] == "On"|#|device[1]=On;device[2]=Off;device[3]=Off"
+        Then I expect the function to succeed
+        And have the following result "false"
+
+    Scenario: Test Blockly native compilation
+        Given I am testing the "blockly" module
+        When I test the function "Compile"
+        And I provide the following input "device[1] == "On" and temperaturedevice[2] > 20"
+        Then I expect the function to succeed
+        And have the following result "native"
+
+    Scenario: Test Blockly fallback to Lua on an unsupported expression
+        Given I am testing the "blockly" module
+        When I test the function "Compile"
+        And I provide the following input "device[1] == "On" and otherdevices["Lamp"] == "On""
+        Then I expect the function to succeed
+        And have the following result "lua"
+
+    Scenario: Test Blockly comparing nil
+        Given I am testing the "blockly" module
+        When I test the function "Evaluate"
+        And I provide the following input "temperaturedevice[5] > 20"
+        Then I expect the function to fail
+        And have the following result "attempt to compare nil with number"
+
+    Scenario: Test Blockly comparing a string with a number
+        Given I am testing the "blockly" module
+        When I test the function "Evaluate"
+        And I provide the following input "variable[3] < 10|#|variable[3]='abc'"
+        Then I expect the function to fail
+        And have the following result "attempt to compare string with number"
+
+    Scenario: Test Blockly equality of nil
+        Given I am testing the "blockly" module
+        When I test the function "Evaluate"
+        And I provide the following input "device[9] == "On""
+        Then I expect the function to succeed
+        And have the following result "false"
+
+    Scenario: Test Blockly equality of a string and a number
+        Given I am testing the "blockly" module
+        When I test the function "Evaluate"
+        And I provide the following input "variable[3] == 5|#|variable[3]='5'"
+        Then I expect the function to succeed
+        And have the following result "false"
+
+    Scenario: Test Blockly or skipping an error after a true condition
+        Given I am testing the "blockly" module
+        When I test the function "Evaluate"
+        And I provide the following input "device[1] == "On" or temperaturedevice[5] > 20|#|device[1]=On"
+        Then I expect the function to succeed
+        And have the following result "true"
+
+    Scenario: Test Blockly dependencies
+        Given I am testing the "blockly" module
+        When I test the function "Dependencies"
+        And I provide the following input "(device[12] == "On" or temperaturedevice[7] > 20) and variable[3] ~= 1 and timeofday >= @Sunset"
+        Then I expect the function to succeed
+        And have the following result "devices=7,12 variables=3 time=yes security=no"
@@ -0,0 +1,21 @@
+Feature: JSON stream writer
+    Large API responses are written with CJSonStreamWriter instead of through a Json::Value,
+    the output has to stay identical to toStyledString. It can be found in main/json_helper.cpp
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test JSON stream writer
+        Given I am testing the "json" module
+        When I test the function "StreamWriter"
+        And I provide the following input "On,Off,Set Level: 50 %"
+        Then I expect the function to succeed
+        And have the following result "identical"
+
+    Scenario: Test JSON stream writer with escaped characters
+        Given I am testing the "json" module
+        When I test the function "StreamWriter"
+        And I provide the following input "back\slash,Ünïcode,a/b"
+        Then I expect the function to succeed
+        And have the following result "identical"
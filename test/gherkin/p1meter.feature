@@ -0,0 +1,43 @@
+Feature: P1 Smart Meter telegram routines
+    The P1 Smart Meter hardware matches each telegram line against a table of OBIS codes
+    and validates the CRC at the end of a DSMR 4.0+ telegram, these routines can be found
+    in hardware/P1Telegram.cpp
+
+    Background:
+        Given Command domoticztester is available
+        And can be executed on the commandline
+
+    Scenario: Test P1 CRC16 function
+        Given I am testing the "p1meter" module
+        When I test the function "P1CRC16"
+        And I provide the following input "123456789"
+        Then I expect the function to succeed
+        And have the following result "BB3D"
+
+    Scenario: Test P1 OBIS line matching
+        Given I am testing the "p1meter" module
+        When I test the function "P1MatchLine"
+        And I provide the following input "1-0:1.8.2(123456.789*kWh)"
+        Then I expect the function to succeed
+        And have the following result "powerusage=123456.789"
+
+    Scenario: Test P1 OBIS line matching on a shared hash bucket
+        Given I am testing the "p1meter" module
+        When I test the function "P1MatchLine"
+        And I provide the following input "0-0:96.7.9(00002)"
+        Then I expect the function to succeed
+        And have the following result "numlongpwrfail=00002"
+
+    Scenario: Test P1 OBIS line matching on a M-Bus channel
+        Given I am testing the "p1meter" module
+        When I test the function "P1MatchLine"
+        And I provide the following input "0-2:24.2.1(101209112500W)(12785.123*m3)"
+        Then I expect the function to succeed
+        And have the following result "mbus_meter=12785.123"
+
+    Scenario: Test P1 recorded telegram
+        Given I am testing the "p1meter" module
+        When I test the function "P1Telegram"
+        And I provide the following input "test/p1meter/dsmr50.telegram"
+        Then I expect the function to succeed
+        And have the following result "lines=37 matched=31 crc=OK"
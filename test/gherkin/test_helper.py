@@ -41,10 +41,84 @@ def test_md5hash():
 def test_calculatedewpoint():
     pass
 
+@scenario('p1meter.feature', 'Test P1 CRC16 function')
+def test_p1crc16():
+    pass
+
+@scenario('p1meter.feature', 'Test P1 OBIS line matching')
+def test_p1matchline():
+    pass
+
+@scenario('p1meter.feature', 'Test P1 OBIS line matching on a shared hash bucket')
+def test_p1matchline_bucket():
+    pass
+
+@scenario('p1meter.feature', 'Test P1 OBIS line matching on a M-Bus channel')
+def test_p1matchline_mbus():
+    pass
+
+@scenario('p1meter.feature', 'Test P1 recorded telegram')
+def test_p1telegram():
+    pass
+
+@scenario('json.feature', 'Test JSON stream writer')
+def test_jsonstreamwriter():
+    pass
+
+@scenario('json.feature', 'Test JSON stream writer with escaped characters')
+def test_jsonstreamwriter_escape():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly and binding tighter than or')
+def test_blockly_precedence():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly parentheses')
+def test_blockly_parentheses():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly native compilation')
+def test_blockly_native():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly fallback to Lua on an unsupported expression')
+def test_blockly_fallback():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly comparing nil')
+def test_blockly_nil():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly comparing a string with a number')
+def test_blockly_typemismatch():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly equality of nil')
+def test_blockly_nil_equality():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly equality of a string and a number')
+def test_blockly_string_number():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly or skipping an error after a true condition')
+def test_blockly_or_shortcut():
+    pass
+
+@scenario('blockly.feature', 'Test Blockly dependencies')
+def test_blockly_dependencies():
+    pass
+
 @given(parsers.parse('I am testing the "{module}" module'))
 def setup_test_module(test_domoticz, module):
     if module == "helper":
         test_domoticz.sTestModule = "helper"
+    elif module == "p1meter":
+        test_domoticz.sTestModule = "p1meter"
+    elif module == "json":
+        test_domoticz.sTestModule = "json"
+    elif module == "blockly":
+        test_domoticz.sTestModule = "blockly"
     else:
         assert False
 
@@ -483,4 +483,47 @@ class CGZIP2AT
 
 };
 typedef CGZIP2AT<> CGZIP2A;
+
+// Incremental gzip compressor for streamed replies: every Compress() call
+// returns the gzip bytes for that block flushed to a byte boundary, so each
+// block can be put on the wire as soon as it is produced.
+class CGZIPStream
+{
+  public:
+  CGZIPStream()
+  {
+	m_zstream.zalloc = (alloc_func) nullptr;
+	m_zstream.zfree = (free_func) nullptr;
+	m_zstream.opaque = (voidpf) nullptr;
+	// windowBits + 16 lets zlib write the gzip header and trailer itself
+	m_bInit = (deflateInit2(&m_zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) == Z_OK);
+  }
+  ~CGZIPStream()
+  {
+	if (m_bInit)
+		deflateEnd(&m_zstream);
+  }
+  bool Compress(const std::string &in, std::string &out, bool bFinish)
+  {
+	if (!m_bInit)
+		return false;
+	m_zstream.next_in = (Bytef*)in.data();
+	m_zstream.avail_in = (uInt)in.size();
+	Byte outbuf[Z_BUFSIZE];
+	int err;
+	do
+	{
+		m_zstream.next_out = outbuf;
+		m_zstream.avail_out = Z_BUFSIZE;
+		err = deflate(&m_zstream, bFinish ? Z_FINISH : Z_SYNC_FLUSH);
+		if ((err != Z_OK) && (err != Z_STREAM_END) && (err != Z_BUF_ERROR))
+			return false;
+		out.append((const char*)outbuf, Z_BUFSIZE - m_zstream.avail_out);
+	} while (m_zstream.avail_out == 0);
+	return true;
+  }
+  private:
+   z_stream m_zstream;
+   bool     m_bInit;
+};
 #endif
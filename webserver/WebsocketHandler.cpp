@@ -57,6 +57,18 @@ namespace http {
 					return true;
 				}
 				std::string szEvent = value["event"].asString();
+				if ((szEvent == "subscribe") || (szEvent == "unsubscribe"))
+				{
+					// opt-in channels: "device_live" sends the values held back by RX coalescing at full rate
+					if (value["channel"].asString() == "device_live")
+					{
+						if (szEvent == "subscribe")
+							m_Push.ListenToLiveValues();
+						else
+							m_Push.UnlistenToLiveValues();
+					}
+					return true;
+				}
 				if (szEvent.find("request") == std::string::npos)
 					return true;
 
@@ -70,6 +82,14 @@ namespace http {
 				req.content.clear();
 				reply rep;
 				if (myWebem->CheckForPageOverride(session, req, rep)) {
+					if ((rep.status == reply::stream_content) && rep.producer)
+					{
+						// the response goes out as a single websocket message, so collect the whole stream
+						while (rep.producer(rep.content))
+							;
+						rep.producer = nullptr;
+						rep.status = reply::ok;
+					}
 					if (rep.status == reply::ok) {
 						jsonValue["request"] = szEvent;
 						jsonValue["event"] = "response";
@@ -190,6 +210,26 @@ namespace http {
 			}
 		}
 
+		// All devices of a hardware that changed since the given time, in one response
+		void CWebsocketHandler::OnDevicesChanged(const int HardwareID, const time_t Since)
+		{
+			try
+			{
+				// LastUpdate has a resolution of one second and may be stamped before the batch started, keep a second of margin
+				std::string query = "type=devices&hwidx=" + std::to_string(HardwareID) + "&lastupdate=" + std::to_string(Since - 1);
+				Json::Value request;
+				request["event"] = "device_request";
+				request["requestid"] = -1;
+				request["query"] = query;
+				std::string packet = JSonToFormatString(request);
+				Handle(packet, true);
+			}
+			catch (std::exception& e)
+			{
+				_log.Log(LOG_ERROR, "WebsocketHandler::%s Exception: %s", __func__, e.what());
+			}
+		}
+
 		void CWebsocketHandler::OnSceneChanged(const uint64_t SceneRowIdx)
 		{
 			try
@@ -224,6 +264,19 @@ namespace http {
 			MyWrite(response);
 		}
 
+		// Values that are not stored yet because of RX coalescing, for subscribed clients only
+		void CWebsocketHandler::SendDeviceLiveValue(const uint64_t DeviceRowIdx, const int nValue, const std::string &sValue)
+		{
+			Json::Value json;
+
+			json["event"] = "device_live";
+			json["idx"] = std::to_string(DeviceRowIdx);
+			json["nValue"] = nValue;
+			json["sValue"] = sValue;
+			std::string response = json.toStyledString();
+			MyWrite(response);
+		}
+
 		void CWebsocketHandler::SendDateTime()
 		{
 			if (!m_mainworker.m_LastSunriseSet.empty())
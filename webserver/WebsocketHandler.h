@@ -25,6 +25,8 @@ namespace http
 			virtual void Start();
 			virtual void Stop();
 			virtual void OnDeviceChanged(uint64_t DeviceRowIdx);
+			virtual void OnDevicesChanged(int HardwareID, time_t Since);
+			virtual void SendDeviceLiveValue(uint64_t DeviceRowIdx, int nValue, const std::string &sValue);
 			virtual void OnSceneChanged(uint64_t SceneRowIdx);
 			virtual void SendNotification(const std::string &Subject, const std::string &Text, const std::string &ExtraData, int Priority, const std::string &Sound,
 						      bool bFromNotification);
@@ -768,7 +768,8 @@ namespace http {
 					}
 				}
 
-				reply::add_header(&rep, "Content-Length", std::to_string(rep.content.size()));
+				if (rep.status != reply::stream_content)
+					reply::add_header(&rep, "Content-Length", std::to_string(rep.content.size()));
 				if (!boost::algorithm::starts_with(strMimeType, "image"))
 				{
 					reply::add_header(&rep, "Cache-Control", "no-cache");
@@ -1898,18 +1899,28 @@ namespace http {
 			}
 		}
 
-		bool cWebemRequestHandler::CompressWebOutput(const request& req, reply& rep)
+		bool cWebemRequestHandler::ClientAcceptsGZip(const request& req)
 		{
 			if (myWebem->m_gzipmode != WWW_USE_GZIP)
 				return false;
+			const char *encoding_header = request::get_req_header(&req, "Accept-Encoding");
+			return (encoding_header != nullptr) && (strstr(encoding_header, "gzip") != nullptr);
+		}
 
+		bool cWebemRequestHandler::IsCompressedImage(const request& req)
+		{
 			std::string request_path;
 			if (!url_decode(req.uri, request_path))
+				return true;
+			return (request_path.find(".png") != std::string::npos) || (request_path.find(".jpg") != std::string::npos);
+		}
+
+		bool cWebemRequestHandler::CompressWebOutput(const request& req, reply& rep)
+		{
+			if (myWebem->m_gzipmode != WWW_USE_GZIP)
 				return false;
-			if (
-				(request_path.find(".png") != std::string::npos) ||
-				(request_path.find(".jpg") != std::string::npos)
-				)
+
+			if (IsCompressedImage(req))
 			{
 				//don't compress 'compressed' images
 				return false;
@@ -2567,7 +2578,12 @@ namespace http {
 					if (rep.status == reply::status_type::download_file)
 						return;
 
-					if (!rep.bIsGZIP)
+					if (rep.status == reply::status_type::stream_content)
+					{
+						// streamed replies are compressed block by block by the connection
+						rep.bIsGZIP = ClientAcceptsGZip(req) && !IsCompressedImage(req);
+					}
+					else if (!rep.bIsGZIP)
 					{
 						CompressWebOutput(req, rep);
 					}
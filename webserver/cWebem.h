@@ -134,6 +134,8 @@ namespace http
 				private:
 			char *strftime_t(const char *format, time_t rawtime);
 			bool CompressWebOutput(const request &req, reply &rep);
+			bool ClientAcceptsGZip(const request &req);
+			bool IsCompressedImage(const request &req);
 			/// Websocket methods
 			bool is_upgrade_request(WebEmSession &session, const request &req, reply &rep);
 			std::string compute_accept_header(const std::string &websocket_key);
@@ -16,6 +16,7 @@
 #include "../main/Helper.h"
 #include "../main/localtime_r.h"
 #include "../main/Logger.h"
+#include "GZipHelper.h"
 
 namespace http {
 	namespace server {
@@ -39,6 +40,8 @@ namespace http {
 			secure_ = false;
 			keepalive_ = false;
 			write_in_progress = false;
+			stream_chunked_ = false;
+			stream_done_ = false;
 			connection_type = ConnectionType::connection_http;
 			socket_ = std::make_unique<boost::asio::ip::tcp::socket>(io_service);
 		}
@@ -61,12 +64,16 @@ namespace http {
 			secure_ = true;
 			keepalive_ = false;
 			write_in_progress = false;
+			stream_chunked_ = false;
+			stream_done_ = false;
 			connection_type = ConnectionType::connection_http;
 			socket_ = nullptr;
 			sslsocket_ = std::make_unique<ssl_socket>(io_service, context);
 		}
 #endif
 
+		connection::~connection() = default;
+
 #ifdef WWW_ENABLE_SSL
 		// get the attached client socket of this connection
 		ssl_socket::lowest_layer_type& connection::socket()
@@ -348,6 +355,113 @@ namespace http {
 			return true;
 		}
 
+		void connection::handle_write_stream(const boost::system::error_code& error, size_t bytes_transferred)
+		{
+			write_buffer.clear();
+			while (!error && !stream_done_ && write_buffer.empty())
+			{
+				// ask the producer for the next block only now the previous one is on the wire,
+				// so a fast producer can never queue more than a single block for a slow client
+				std::string block;
+				bool bMore = false;
+				try
+				{
+					bMore = stream_producer_(block);
+				}
+				catch (...)
+				{
+					// drop the connection without the terminating chunk so the client sees an incomplete reply
+					_log.Log(LOG_ERROR, "[web] Exception while streaming reply to %s", host_remote_endpoint_address_.c_str());
+					break;
+				}
+				stream_done_ = !bMore;
+
+				std::string data;
+				if (stream_gzip_)
+				{
+					if (!stream_gzip_->Compress(block, data, stream_done_))
+						break;
+				}
+				else
+					data.swap(block);
+
+				if (!stream_chunked_)
+				{
+					write_buffer.swap(data);
+					continue;
+				}
+				if (!data.empty())
+					write_buffer = std_format("%zx\r\n", data.size()) + data + "\r\n";
+				if (stream_done_)
+					write_buffer += "0\r\n\r\n";
+			}
+
+			if (write_buffer.empty())
+			{
+				// done, or the client went away, or the producer failed
+				stream_producer_ = nullptr;
+				stream_gzip_.reset();
+				connection_manager_.stop(shared_from_this());
+				return;
+			}
+
+			if (secure_) {
+#ifdef WWW_ENABLE_SSL
+				boost::asio::async_write(*sslsocket_, boost::asio::buffer(write_buffer), [self = shared_from_this()](auto &&err, auto bytes) { self->handle_write_stream(err, bytes); });
+#endif
+			}
+			else {
+				boost::asio::async_write(*socket_, boost::asio::buffer(write_buffer), [self = shared_from_this()](auto &&err, auto bytes) { self->handle_write_stream(err, bytes); });
+			}
+		}
+
+		bool connection::send_stream(const request& req, reply& rep)
+		{
+			if (!rep.producer)
+			{
+				rep = reply::stock_reply(reply::internal_server_error);
+				return false;
+			}
+			stream_producer_ = rep.producer;
+			rep.producer = nullptr;
+			rep.status = reply::ok;
+
+			// the handler can know the size of the body, that no longer holds once the blocks are compressed
+			bool bHaveLength = false;
+			auto ittLength = std::find_if(rep.headers.begin(), rep.headers.end(), [](const header &h) { return boost::iequals(h.name, "Content-Length"); });
+			if (ittLength != rep.headers.end())
+			{
+				if (rep.bIsGZIP)
+					rep.headers.erase(ittLength);
+				else
+					bHaveLength = true;
+			}
+			if (rep.bIsGZIP)
+			{
+				stream_gzip_ = std::make_unique<CGZIPStream>();
+				reply::add_header(&rep, "Content-Encoding", "gzip");
+			}
+			// HTTP/1.0 clients do not understand chunked encoding, for them closing the connection ends the body
+			stream_chunked_ = (!bHaveLength) && ((req.http_version_major > 1) || ((req.http_version_major == 1) && (req.http_version_minor >= 1)));
+			if (stream_chunked_)
+				reply::add_header(&rep, "Transfer-Encoding", "chunked");
+			reply::add_header(&rep, "Connection", "close");
+			stream_done_ = (req.method == "HEAD");
+
+			//write headers, the body follows from handle_write_stream
+			write_buffer = rep.header_to_string();
+
+			if (secure_) {
+#ifdef WWW_ENABLE_SSL
+				boost::asio::async_write(*sslsocket_, boost::asio::buffer(write_buffer), [self = shared_from_this()](auto &&err, auto bytes) { self->handle_write_stream(err, bytes); });
+#endif
+			}
+			else {
+				boost::asio::async_write(*socket_, boost::asio::buffer(write_buffer), [self = shared_from_this()](auto &&err, auto bytes) { self->handle_write_stream(err, bytes); });
+			}
+			return true;
+		}
+
 		void connection::handle_read(const boost::system::error_code& error, std::size_t bytes_transferred)
 		{
 			status_ = READING;
@@ -487,6 +601,10 @@ namespace http {
 									return;
 							}
 						}
+						else if (reply_.status == reply::stream_content) {
+							if (send_stream(request_, reply_))
+								return;
+						}
 
 						if (request_.keep_alive && ((reply_.status == reply::ok) || (reply_.status == reply::no_content) || (reply_.status == reply::not_modified))) {
 							// Allows request handler to override the header (but it should not)
@@ -24,6 +24,8 @@
 typedef boost::asio::ssl::stream<boost::asio::ip::tcp::socket> ssl_socket;
 #endif
 
+class CGZIPStream;
+
 namespace http {
 	namespace server {
 
@@ -50,7 +52,7 @@ namespace http {
 			explicit connection(boost::asio::io_service& io_service,
 				connection_manager& manager, request_handler& handler, int timeout, boost::asio::ssl::context& context);
 #endif
-			~connection() = default;
+			~connection();
 
 			/// Get the socket associated with the connection.
 #ifdef WWW_ENABLE_SSL
@@ -97,6 +99,14 @@ namespace http {
 #define FILE_SEND_BUFFER_SIZE 16 * 1024
 			std::unique_ptr<std::array<uint8_t, FILE_SEND_BUFFER_SIZE>> send_buffer_;
 
+			/// Streamed replies (reply::set_stream), sent chunked and optionally gzip compressed
+			bool send_stream(const request& req, reply& rep);
+			void handle_write_stream(const boost::system::error_code& e, size_t bytes_transferred);
+			reply::stream_producer stream_producer_;
+			std::unique_ptr<CGZIPStream> stream_gzip_;
+			bool stream_chunked_;
+			bool stream_done_;
+
 			/// Initialize read timeout timer
 			void set_read_timeout();
 			/// Stop read timeout timer
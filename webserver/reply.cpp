@@ -22,6 +22,7 @@ namespace status_strings {
 
 	constexpr auto switching_protocols = "HTTP/1.1 101 Switching Protocols\r\n";
 	constexpr auto download_file = "HTTP/1.1 102 Download File\r\n";
+	constexpr auto stream_content = "HTTP/1.1 200 OK\r\n";
 	constexpr auto ok = "HTTP/1.1 200 OK\r\n";
 	constexpr auto created = "HTTP/1.1 201 Created\r\n";
 	constexpr auto accepted = "HTTP/1.1 202 Accepted\r\n";
@@ -47,6 +48,8 @@ namespace status_strings {
 				return switching_protocols;
 			case reply::download_file:
 				return download_file;
+			case reply::stream_content:
+				return stream_content;
 			case reply::ok:
 				return ok;
 			case reply::created:
@@ -117,12 +120,14 @@ void reply::reset()
 	headers.clear();
 	content = "";
 	bIsGZIP = false;
+	producer = nullptr;
 }
 
 namespace stock_replies {
 
 	constexpr auto switching_protocols = "";
 	constexpr auto download_file = "";
+	constexpr auto stream_content = "";
 	constexpr auto ok = "";
 	constexpr auto created = "<html>"
 				 "<head><title>Created</title></head>"
@@ -187,6 +192,8 @@ namespace stock_replies {
 				return switching_protocols;
 			case reply::download_file:
 				return download_file;
+			case reply::stream_content:
+				return stream_content;
 			case reply::ok:
 				return ok;
 			case reply::created:
@@ -341,6 +348,13 @@ bool reply::set_download_file(reply* rep, const std::string& file_path, const st
 	return true;
 }
 
+void reply::set_stream(reply *rep, const stream_producer &producer)
+{
+	rep->status = reply::status_type::stream_content;
+	rep->content.clear();
+	rep->producer = producer;
+}
+
 void reply::add_header_attachment(reply *rep, const std::string &attachment)
 {
 	reply::add_header(rep, "Content-Disposition", "attachment; filename=" + attachment);
@@ -13,6 +13,7 @@
 
 #include <string>
 #include <iterator>
+#include <functional>
 #include <boost/asio.hpp>
 #include "header.hpp"
 
@@ -27,6 +28,7 @@ struct reply
   {
 	switching_protocols = 101,
 	download_file = 102,
+	stream_content = 103,
 
     ok = 200,
     created = 201,
@@ -53,6 +55,14 @@ struct reply
   std::string content;
   bool bIsGZIP;
 
+  /// Producer for a streamed reply. It appends the next block of the body to
+  /// chunk and returns false once the body is complete. The connection only
+  /// calls it again after the previous block has been written to the socket.
+  /// Throwing drops the connection, so the client sees an incomplete reply.
+  /// A Content-Length header set by the handler is kept when the body is not compressed.
+  typedef std::function<bool(std::string &chunk)> stream_producer;
+  stream_producer producer;
+
   /// The origin of the web request when behind proxies, etc.
   std::string originHost;
 
@@ -68,6 +78,7 @@ struct reply
   static bool set_content_from_file(reply *rep, const std::string & file_path);
   static bool set_content_from_file(reply *rep, const std::string & file_path, const std::string & attachment, bool set_content_type = false);
   static bool set_download_file(reply* rep, const std::string& file_path, const std::string& attachment);
+  static void set_stream(reply *rep, const stream_producer &producer);
   static void add_header_attachment(reply *rep, const std::string & attachment);
   static void add_header_content_type(reply *rep, const std::string & content_type);
   static void add_security_headers(reply *rep);
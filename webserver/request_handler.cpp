@@ -34,6 +34,9 @@ extern bool bDoCachePages;
 
 #define ZIPREADBUFFERSIZE (8192)
 
+#define ASSET_CACHE_MAX_FILE (2 * 1024 * 1024)	// larger files are always read from disk
+#define ASSET_CACHE_MAX_SIZE (32 * 1024 * 1024)	// the cache starts over when it grows beyond this
+
 #define HTTP_DATE_RFC_1123 "%a, %d %b %Y %H:%M:%S %Z" // Sun, 06 Nov 1994 08:49:37 GMT
 #define HTTP_DATE_RFC_850  "%A, %d-%b-%y %H:%M:%S %Z" // Sunday, 06-Nov-94 08:49:37 GMT
 #define HTTP_DATE_ASCTIME  "%a %b %e %H:%M:%S %Y"     // Sun Nov  6 08:49:37 1994
@@ -219,6 +222,87 @@ bool request_handler::not_modified(const std::string &full_path, const request &
 	return false;
 }
 
+// Returns the cached file, (re)loading it when it changed on disk, or nullptr when it is not
+// cacheable (missing, too large or generated)
+std::shared_ptr<const request_handler::static_asset> request_handler::get_static_asset(const std::string &full_path, const bool bIsCompressibleType)
+{
+	struct stat sb;
+	std::string source_path = full_path;
+	bool bGZSource = false;
+	if (bIsCompressibleType && (stat((full_path + ".gz").c_str(), &sb) == 0))
+	{
+		source_path += ".gz";
+		bGZSource = true;
+	}
+	else if (stat(full_path.c_str(), &sb) != 0)
+		return nullptr;
+	if (((sb.st_mode & S_IFREG) != S_IFREG) || (sb.st_size > ASSET_CACHE_MAX_FILE))
+		return nullptr;
+
+	{
+		std::lock_guard<std::mutex> l(m_assets_mutex);
+		auto itt = m_assets.find(full_path);
+		if ((itt != m_assets.end()) && (itt->second->mtime == sb.st_mtime) && (itt->second->size == sb.st_size) && (itt->second->source_path == source_path))
+			return (itt->second->generated) ? nullptr : itt->second;
+	}
+
+	std::ifstream is(source_path.c_str(), std::ios::in | std::ios::binary);
+	if (!is.is_open())
+		return nullptr;
+	std::string content((std::istreambuf_iterator<char>(is)), (std::istreambuf_iterator<char>()));
+
+	auto asset = std::make_shared<static_asset>();
+	asset->source_path = source_path;
+	asset->mtime = sb.st_mtime;
+	asset->size = sb.st_size;
+	asset->generated = false;
+	if (bGZSource)
+	{
+		CGZIP2AT<> decompress((LPGZIP)content.c_str(), content.size());
+		asset->identity.assign(decompress.psz, decompress.Length);
+		asset->gzip = std::move(content);
+	}
+	else
+	{
+		asset->identity = std::move(content);
+		if (bIsCompressibleType)
+		{
+			asset->generated = (asset->identity.find("<!--#embed") != std::string::npos);
+			if (!asset->generated)
+			{
+				CA2GZIP gzip((char *)asset->identity.c_str(), (int)asset->identity.size());
+				if ((gzip.Length > 0) && (gzip.Length < (int)asset->identity.size()))
+					asset->gzip.assign((char *)gzip.pgzip, gzip.Length);
+			}
+		}
+	}
+	if (asset->generated)
+	{
+		asset->identity.clear();
+	}
+	else
+	{
+		// strong validators, one per representation
+		std::stringstream sstr;
+		sstr << std::hex << std::hash<std::string>()(asset->identity) << "-" << asset->identity.size();
+		asset->etag = "\"" + sstr.str() + "\"";
+		asset->etag_gzip = "\"" + sstr.str() + "-gz\"";
+	}
+
+	std::lock_guard<std::mutex> l(m_assets_mutex);
+	if (m_assets_size + asset->identity.size() + asset->gzip.size() > ASSET_CACHE_MAX_SIZE)
+	{
+		m_assets.clear();
+		m_assets_size = 0;
+	}
+	auto itt = m_assets.find(full_path);
+	if (itt != m_assets.end())
+		m_assets_size -= itt->second->identity.size() + itt->second->gzip.size();
+	m_assets_size += asset->identity.size() + asset->gzip.size();
+	m_assets[full_path] = asset;
+	return (asset->generated) ? nullptr : asset;
+}
+
 void request_handler::handle_request(const request& req, reply& rep)
 {
 	modify_info mInfo;
@@ -337,18 +421,53 @@ void request_handler::handle_request(const request &req, reply &rep, modify_info
 	// Determine if we have a gzip compressed  or an uncompressed file as source
 	bool bHaveLoadedgzip = false;
 	bool bHaveCompressed = false;
-	bool bIsCompressibleType = false;
 
+	// Check gzip source file support. Only for js/htm(l) and css files.
+	bool bIsCompressibleType = ((extension.find("js") != std::string::npos) || (extension.find("htm") != std::string::npos) || (extension.find("css") != std::string::npos));
+
+	std::shared_ptr<const static_asset> asset;
 #ifndef WEBSERVER_DONT_USE_ZIP
 	if (!m_bIsZIP)
+#endif
+		asset = get_static_asset(full_path, bIsCompressibleType);
+
+	if (asset)
+	{
+		// Serve the cached file, no disk reads and no compression per request
+		bool bSendGZip = (bClientHasGZipSupport && (!asset->gzip.empty()));
+		const std::string &etag = (bSendGZip) ? asset->etag_gzip : asset->etag;
+		if ((if_none_match != nullptr) && (etag == if_none_match))
+		{
+			rep = reply::stock_reply(reply::not_modified);
+			return;
+		}
+		if (asset->source_path != full_path)
+			mInfo.delay_status = false; // loaded from the .gz file
+		if (request_path.find("styles/") == std::string::npos)
+		{
+			if (not_modified(asset->source_path, req, rep, mInfo))
+			{
+				rep = reply::stock_reply(reply::not_modified);
+				return;
+			}
+		}
+		rep.content = (bSendGZip) ? asset->gzip : asset->identity;
+		rep.bIsGZIP = bSendGZip;
+		bHaveCompressed = bSendGZip;
+		if (bDoCachePages)
+			reply::add_header(&rep, "ETag", etag, true);
+		rep.status = reply::ok;
+	}
+#ifndef WEBSERVER_DONT_USE_ZIP
+	else if (!m_bIsZIP)
+#else
+	else
 #endif
 	{
 		std::ifstream is;
 
-		// Check gzip source file support. Only for js/htm(l) and css files.
-		if ((extension.find("js")!=std::string::npos) || (extension.find("htm") != std::string::npos) || (extension.find("css") != std::string::npos))
+		if (bIsCompressibleType)
 		{
-			bIsCompressibleType = true;
 			// Let's see if there is an gzipped version of the source file
 			std::string full_path_withgz = full_path + ".gz";
 			is.open(full_path_withgz.c_str(), std::ios::in | std::ios::binary);
@@ -11,7 +11,10 @@
 #ifndef HTTP_REQUEST_HANDLER_HPP
 #define HTTP_REQUEST_HANDLER_HPP
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include "../main/Noncopyable.h"
 #ifndef WEBSERVER_DONT_USE_ZIP
 	#include <minizip/unzip.h>
@@ -64,6 +67,24 @@ protected:
 
 private:
 	bool not_modified(const std::string &full_path, const request &req, reply &rep, modify_info &mInfo);
+
+	// A static file as it is sent, kept until the file changes on disk
+	struct static_asset
+	{
+		std::string source_path; // the file that was read (can be the .gz one)
+		time_t mtime;
+		off_t size;
+		bool generated; // has <!--#embed --> content, served from disk every time
+		std::string identity;
+		std::string gzip; // empty when there is no (smaller) compressed variant
+		std::string etag;
+		std::string etag_gzip;
+	};
+	std::mutex m_assets_mutex;
+	std::unordered_map<std::string, std::shared_ptr<const static_asset>> m_assets;
+	size_t m_assets_size = 0;
+	std::shared_ptr<const static_asset> get_static_asset(const std::string &full_path, bool bIsCompressibleType);
+
 	//zip support
 #ifndef WEBSERVER_DONT_USE_ZIP
 	  zlib_filefunc_def m_ffunc;
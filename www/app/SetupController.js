@@ -579,6 +579,15 @@ define(['app'], function (app) {
 					if (typeof data.EventSystemLogFullURL != 'undefined') {
 						$("#eventsystemtable #EventSystemLogFullURL").prop('checked', data.EventSystemLogFullURL == 1);
 					}
+					if (typeof data.EventSystemBatchSize != 'undefined') {
+						$("#eventsystemtable #EventSystemBatchSize").val(data.EventSystemBatchSize);
+					}
+					if (typeof data.EventSystemBatchWindow != 'undefined') {
+						$("#eventsystemtable #EventSystemBatchWindow").val(data.EventSystemBatchWindow);
+					}
+					if (typeof data.EventSystemDebounce != 'undefined') {
+						$("#eventsystemtable #EventSystemDebounce").prop('checked', data.EventSystemDebounce == 1);
+					}
 
 					if (typeof data.FloorplanPopupDelay != 'undefined') {
 						$("#floorplanoptionstable #FloorplanPopupDelay").val(data.FloorplanPopupDelay);